@@ -21,6 +21,8 @@ public:
 #else
         __get_cpuid(1, (unsigned int*)&cpuInfo[0], (unsigned int*)&cpuInfo[1], (unsigned int*)&cpuInfo[2], (unsigned int*)&cpuInfo[3]);
 #endif
+        m_hasSSE41 = (cpuInfo[2] & (1 << 19)) != 0;
+        m_hasAES = (cpuInfo[2] & (1 << 25)) != 0;
         m_hasAVX = (cpuInfo[2] & (1 << 28)) != 0;
 
 #if defined(_MSC_VER)
@@ -66,12 +68,16 @@ public:
     }
 
     bool hasBMI2() const override { return m_hasBMI2; }
+    bool hasSSE41() const override { return m_hasSSE41; }
+    bool hasAES() const override { return m_hasAES; }
     bool hasAVX() const override { return m_hasAVX; }
     bool hasAVX2() const override { return m_hasAVX2; }
     bool hasXOP() const override { return m_hasXOP; }
     bool jccErratum() const override { return m_jccErratum; }
 
 private:
+    bool m_hasSSE41 = false;
+    bool m_hasAES = false;
     bool m_hasAVX = false;
     bool m_hasAVX2 = false;
     bool m_hasBMI2 = false;
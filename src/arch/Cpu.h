@@ -10,6 +10,8 @@ class ICpuInfo {
 public:
     virtual ~ICpuInfo() = default;
     virtual bool hasBMI2() const = 0;
+    virtual bool hasSSE41() const = 0;
+    virtual bool hasAES() const = 0;
     virtual bool hasAVX() const = 0;
     virtual bool hasAVX2() const = 0;
     virtual bool hasXOP() const = 0;
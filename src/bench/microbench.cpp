@@ -0,0 +1,440 @@
+// src/bench/microbench.cpp
+//
+// zartrux-microbench: mide por separado cada kernel de RandomX del que depende el minero
+// (AES, Blake2b, Argon2, programas superescalares, JIT e intérprete de bytecode).
+// Cada kernel se calienta, se calibra para que una repetición dure --time-ms y se repite
+// --reps veces; se informa la mediana, el mínimo y la dispersión en ns/op y ciclos/op.
+//
+// Uso: zartrux-microbench [--filter=texto] [--reps=N] [--time-ms=M] [--cpu=N] [--json=FICHERO]
+
+#include "crypto/randomx/common.hpp"
+#include "crypto/randomx/aes_hash.hpp"
+#include "crypto/randomx/blake2/blake2.h"
+#include "crypto/randomx/blake2_generator.hpp"
+#include "crypto/randomx/bytecode_machine.hpp"
+#include "crypto/randomx/intrin_portable.h"
+#include "crypto/randomx/program.hpp"
+#include "crypto/randomx/superscalar.hpp"
+#include "crypto/randomx/superscalar_program.hpp"
+#if RANDOMX_HAVE_COMPILER && (defined(_M_X64) || defined(__x86_64__))
+#include "crypto/randomx/jit_compiler_x86.hpp"
+#include "crypto/randomx/randomx.h"
+#define MICROBENCH_JIT_X86 1
+#endif
+#if defined(ZARTRUX_MICROBENCH_AVX2)
+#include "crypto/randomx/blake2/avx2/blake2b.h"
+#endif
+
+extern "C" {
+#include "argon2.h"
+#include "crypto/argon2/lib/impl-select.h"
+}
+
+#include "arch/Cpu.h"
+#include "memory/NumaTopology.h"
+
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace std::chrono;
+
+namespace {
+
+struct Settings {
+    std::string filter;
+    unsigned reps = 15;
+    unsigned timeMs = 20;       // duración objetivo de cada repetición
+    int cpu = -1;
+    std::string jsonFile;
+};
+
+struct Kernel {
+    std::string name;
+    bool available = true;
+    std::string skipReason;
+    std::function<void(uint64_t)> run;      // ejecuta la operación N veces seguidas
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;    // operaciones por repetición
+    double medianNs = 0.0;
+    double minNs = 0.0;
+    double stddevPct = 0.0;     // desviación típica relativa a la media
+    double medianCycles = 0.0;  // 0 si no hay contador de ciclos
+};
+
+// Ciclos del TSC (frecuencia nominal, no la de turbo); 0 fuera de x86
+inline uint64_t readCycles() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+Result measure(const Kernel& kernel, const Settings& settings) {
+    // Calibración (sirve también de calentamiento): duplicar hasta llenar una repetición
+    const auto target = milliseconds(settings.timeMs);
+    uint64_t iterations = 1;
+    for (;;) {
+        const auto start = steady_clock::now();
+        kernel.run(iterations);
+        if (steady_clock::now() - start >= target / 2 || iterations >= (uint64_t(1) << 30)) break;
+        iterations *= 2;
+    }
+    kernel.run(iterations);
+    rx_reset_float_state();
+
+    std::vector<double> ns, cycles;
+    for (unsigned r = 0; r < settings.reps; ++r) {
+        const uint64_t c0 = readCycles();
+        const auto t0 = steady_clock::now();
+        kernel.run(iterations);
+        const auto t1 = steady_clock::now();
+        const uint64_t c1 = readCycles();
+        rx_reset_float_state();
+        ns.push_back(duration<double, std::nano>(t1 - t0).count() / iterations);
+        cycles.push_back(static_cast<double>(c1 - c0) / iterations);
+    }
+
+    Result result;
+    result.name = kernel.name;
+    result.iterations = iterations;
+    result.medianNs = median(ns);
+    result.minNs = *std::min_element(ns.begin(), ns.end());
+    result.medianCycles = median(cycles);
+    double mean = 0.0, variance = 0.0;
+    for (double v : ns) mean += v;
+    mean /= ns.size();
+    for (double v : ns) variance += (v - mean) * (v - mean);
+    result.stddevPct = mean > 0 ? std::sqrt(variance / ns.size()) / mean * 100.0 : 0.0;
+    return result;
+}
+
+// Buffers compartidos por los kernels, reservados una vez
+struct Buffers {
+    std::vector<uint8_t> scratchpad;
+    std::vector<uint8_t> blob;
+    alignas(64) uint64_t hash[8] = {};
+    alignas(64) uint64_t fillState[8] = {};
+    alignas(64) randomx::Program program;
+    randomx::ProgramConfiguration config{};
+    std::vector<randomx::InstructionByteCode> bytecode;
+    randomx::NativeRegisterFile registers;
+    std::vector<block> argonMemory;
+
+    Buffers()
+        : scratchpad(RandomX_CurrentConfig.ScratchpadL3_Size)
+        , blob(76)
+        , bytecode(randomx::BytecodeMaxSize)
+        , argonMemory(512)
+    {
+        for (size_t i = 0; i < blob.size(); ++i) blob[i] = static_cast<uint8_t>(i);
+        for (size_t i = 0; i < 8; ++i) fillState[i] = 0x9e3779b97f4a7c15ULL * (i + 1);
+        fillAes1Rx4<1>(fillState, scratchpad.size(), scratchpad.data());
+        fillAes4Rx4<1>(fillState, 128 + RandomX_CurrentConfig.ProgramSize * 8, &program);
+
+        // Configuración del programa como en randomx_vm::initialize(); la máscara de exponentes
+        // es fija porque sólo cambia los valores, no el coste de las instrucciones
+        auto addressRegisters = program.getEntropy(12);
+        config.readReg0 = 0 + (addressRegisters & 1); addressRegisters >>= 1;
+        config.readReg1 = 2 + (addressRegisters & 1); addressRegisters >>= 1;
+        config.readReg2 = 4 + (addressRegisters & 1); addressRegisters >>= 1;
+        config.readReg3 = 6 + (addressRegisters & 1);
+        config.eMask[0] = config.eMask[1] = 0x3c000000001fffffULL;
+
+        for (unsigned i = 0; i < randomx::RegisterCountFlt; ++i) {
+            registers.f[i] = rx_set_vec_f128(0x3ff0000000000000ULL + i, 0x3ff0000000000000ULL + i);
+            registers.e[i] = rx_set_vec_f128(0x3ff8000000000000ULL + i, 0x3ff8000000000000ULL + i);
+            registers.a[i] = rx_set_vec_f128(0x4000000000000000ULL + i, 0x4000000000000000ULL + i);
+        }
+    }
+};
+
+void addAesKernels(std::vector<Kernel>& kernels, Buffers& b) {
+    const bool hardAes = zartrux::Cpu::info()->hasAES();
+    const size_t programBytes = 128 + RandomX_CurrentConfig.ProgramSize * 8;
+
+    auto add = [&](std::string name, bool needsAes, std::function<void(uint64_t)> run) {
+        Kernel k;
+        k.name = std::move(name);
+        k.available = !needsAes || hardAes;
+        k.skipReason = "la CPU no tiene AES-NI";
+        k.run = std::move(run);
+        kernels.push_back(std::move(k));
+    };
+
+    add("hashAes1Rx4<soft> 2MB", false, [&b](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) hashAes1Rx4<1>(b.scratchpad.data(), b.scratchpad.size(), b.hash);
+    });
+    add("hashAes1Rx4<hard> 2MB", true, [&b](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) hashAes1Rx4<0>(b.scratchpad.data(), b.scratchpad.size(), b.hash);
+    });
+    add("fillAes1Rx4<soft> 2MB", false, [&b](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) fillAes1Rx4<1>(b.fillState, b.scratchpad.size(), b.scratchpad.data());
+    });
+    add("fillAes1Rx4<hard> 2MB", true, [&b](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) fillAes1Rx4<0>(b.fillState, b.scratchpad.size(), b.scratchpad.data());
+    });
+    add("fillAes4Rx4<soft> programa", false, [&b, programBytes](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) fillAes4Rx4<1>(b.hash, programBytes, &b.program);
+    });
+    add("fillAes4Rx4<hard> programa", true, [&b, programBytes](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) fillAes4Rx4<0>(b.hash, programBytes, &b.program);
+    });
+
+    // Todas las variantes instanciadas en aes_hash.cpp (<softAes, unroll>)
+    struct Variant { const char* name; hashAndFillAes1Rx4_impl* impl; bool needsAes; };
+    const Variant variants[] = {
+        {"hashAndFillAes1Rx4<0,2> 2MB", &hashAndFillAes1Rx4<0, 2>, true},
+        {"hashAndFillAes1Rx4<1,1> 2MB", &hashAndFillAes1Rx4<1, 1>, false},
+        {"hashAndFillAes1Rx4<2,1> 2MB", &hashAndFillAes1Rx4<2, 1>, false},
+        {"hashAndFillAes1Rx4<2,2> 2MB", &hashAndFillAes1Rx4<2, 2>, false},
+        {"hashAndFillAes1Rx4<2,4> 2MB", &hashAndFillAes1Rx4<2, 4>, false},
+    };
+    for (const auto& v : variants) {
+        add(v.name, v.needsAes, [&b, impl = v.impl](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) impl(b.scratchpad.data(), b.scratchpad.size(), b.hash, b.fillState);
+        });
+    }
+}
+
+void addBlake2bKernels(std::vector<Kernel>& kernels, Buffers& b) {
+    // Compresión de un bloque de 128 bytes y hash completo de la entrada del minero (76 -> 64 bytes)
+    auto compress = [&](std::string name, bool available, std::string reason,
+                        void (*fn)(blake2b_state*, const uint8_t*)) {
+        Kernel k;
+        k.name = std::move(name);
+        k.available = available;
+        k.skipReason = std::move(reason);
+        k.run = [&b, fn](uint64_t n) {
+            blake2b_state state;
+            rx_blake2b_init(&state, 64);
+            for (uint64_t i = 0; i < n; ++i) fn(&state, b.scratchpad.data());
+            b.hash[0] ^= state.h[0];
+        };
+        kernels.push_back(std::move(k));
+    };
+    auto full = [&](std::string name, bool available, std::string reason,
+                    void (*compressFn)(blake2b_state*, const uint8_t*),
+                    int (*hashFn)(void*, size_t, const void*, size_t)) {
+        Kernel k;
+        k.name = std::move(name);
+        k.available = available;
+        k.skipReason = std::move(reason);
+        k.run = [&b, compressFn, hashFn](uint64_t n) {
+            // rx_blake2b_default usa el puntero global de compresión: se fija durante la medida
+            auto* previous = rx_blake2b_compress;
+            if (compressFn) rx_blake2b_compress = compressFn;
+            for (uint64_t i = 0; i < n; ++i) hashFn(b.hash, 64, b.blob.data(), b.blob.size());
+            rx_blake2b_compress = previous;
+        };
+        kernels.push_back(std::move(k));
+    };
+
+    compress("blake2b compress (escalar)", true, "", &rx_blake2b_compress_integer);
+    full("blake2b 76B (escalar)", true, "", &rx_blake2b_compress_integer, &rx_blake2b_default);
+#if defined(_M_X64) || defined(__x86_64__)
+    const bool sse41 = zartrux::Cpu::info()->hasSSE41();
+    compress("blake2b compress (SSE4.1)", sse41, "la CPU no tiene SSE4.1", &rx_blake2b_compress_sse41);
+    full("blake2b 76B (SSE4.1)", sse41, "la CPU no tiene SSE4.1", &rx_blake2b_compress_sse41, &rx_blake2b_default);
+#endif
+#if defined(ZARTRUX_MICROBENCH_AVX2)
+    full("blake2b 76B (AVX2)", zartrux::Cpu::info()->hasAVX2(), "la CPU no tiene AVX2", nullptr, &blake2b_avx2);
+#endif
+}
+
+void addArgon2Kernels(std::vector<Kernel>& kernels, Buffers& b) {
+    // Un segmento (128 bloques de 1 KB) de una instancia Argon2d de 512 bloques, como la
+    // selección de implementación de impl-select.c
+    auto add = [&](const std::string& name, int (*check)(void),
+                   void (*fill)(const argon2_instance_t*, argon2_position_t)) {
+        Kernel k;
+        k.name = "argon2 fill_segment (" + name + ")";
+        k.available = check == nullptr || check();
+        k.skipReason = "la CPU no soporta esta implementación";
+        k.run = [&b, fill](uint64_t n) {
+            argon2_instance_t instance{};
+            instance.version = ARGON2_VERSION_NUMBER;
+            instance.memory = b.argonMemory.data();
+            instance.passes = 1;
+            instance.memory_blocks = static_cast<uint32_t>(b.argonMemory.size());
+            instance.segment_length = instance.memory_blocks / ARGON2_SYNC_POINTS;
+            instance.lane_length = instance.segment_length * ARGON2_SYNC_POINTS;
+            instance.lanes = 1;
+            instance.threads = 1;
+            instance.type = Argon2_d;
+            argon2_position_t position{};
+            for (uint64_t i = 0; i < n; ++i) fill(&instance, position);
+        };
+        kernels.push_back(std::move(k));
+    };
+
+    add("default", nullptr, &fill_segment_default);
+    argon2_impl_list impls{};
+    argon2_get_impl_list(&impls);
+    for (size_t i = 0; i < impls.count; ++i) {
+        add(impls.entries[i].name, impls.entries[i].check, impls.entries[i].fill_segment);
+    }
+}
+
+void addProgramKernels(std::vector<Kernel>& kernels, Buffers& b) {
+    {
+        Kernel k;
+        k.name = "generateSuperscalar (1 programa)";
+        k.run = [&b](uint64_t n) {
+            randomx::SuperscalarProgram program;
+            for (uint64_t i = 0; i < n; ++i) {
+                randomx::Blake2Generator gen(b.blob.data(), 32, static_cast<int>(i));
+                randomx::generateSuperscalar(program, gen);
+            }
+            b.hash[0] ^= program.getSize();
+        };
+        kernels.push_back(std::move(k));
+    }
+
+#if defined(MICROBENCH_JIT_X86)
+    {
+        Kernel k;
+        k.name = "JitCompilerX86::generateProgram";
+        k.run = [&b](uint64_t n) {
+            static randomx::JitCompilerX86 jit(false, false);
+            for (uint64_t i = 0; i < n; ++i) jit.generateProgram(b.program, b.config, 0);
+        };
+        kernels.push_back(std::move(k));
+    }
+    // Coste JIT por programa (8 por hash) con el ciclo de protección completo: buffer
+    // único con mprotect RW/RX frente a buffer de doble mapeo (las llamadas no hacen nada)
+    for (const bool dual : {false, true}) {
+        Kernel k;
+        k.name = dual ? "JIT por programa (doble mapeo RW/RX)" : "JIT por programa (mprotect RW/RX)";
+        k.run = [&b, dual](uint64_t n) {
+            static std::unique_ptr<randomx::JitCompilerX86> jits[2];
+            auto& jit = jits[dual ? 1 : 0];
+            if (!jit) {
+                randomx_set_dual_mapped_jit(dual);
+                jit = std::make_unique<randomx::JitCompilerX86>(false, false);
+                randomx_set_dual_mapped_jit(false);
+            }
+            for (uint64_t i = 0; i < n; ++i) {
+                jit->enableWriting();
+                jit->generateProgram(b.program, b.config, 0);
+                jit->enableExecution();
+                b.hash[0] ^= reinterpret_cast<uintptr_t>(jit->getProgramFunc()) & 0xFF;
+            }
+        };
+        kernels.push_back(std::move(k));
+    }
+#else
+    kernels.push_back({"JitCompilerX86::generateProgram", false, "build sin JIT x86", {}});
+#endif
+
+    {
+        Kernel k;
+        k.name = "bytecode compileProgram";
+        k.run = [&b](uint64_t n) {
+            randomx::BytecodeMachine machine;
+            for (uint64_t i = 0; i < n; ++i) machine.compileProgram(b.program, b.bytecode.data(), b.registers);
+        };
+        kernels.push_back(std::move(k));
+    }
+    {
+        // Una iteración del programa (ProgramSize instrucciones) sobre el scratchpad
+        Kernel k;
+        k.name = "bytecode executeBytecode (1 iteración)";
+        k.run = [&b](uint64_t n) {
+            randomx::BytecodeMachine machine;
+            machine.compileProgram(b.program, b.bytecode.data(), b.registers);
+            for (uint64_t i = 0; i < n; ++i) {
+                randomx::BytecodeMachine::executeBytecode(b.bytecode.data(), b.scratchpad.data(), b.config);
+            }
+        };
+        kernels.push_back(std::move(k));
+    }
+}
+
+Settings parseArguments(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto eq = arg.find('=');
+        const std::string name = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--filter") settings.filter = value;
+        else if (name == "--reps") settings.reps = std::max(1, std::stoi(value));
+        else if (name == "--time-ms") settings.timeMs = std::max(1, std::stoi(value));
+        else if (name == "--cpu") settings.cpu = std::stoi(value);
+        else if (name == "--json") settings.jsonFile = value;
+        else {
+            fmt::print(stderr, "Opción desconocida: {}\n"
+                       "Uso: zartrux-microbench [--filter=texto] [--reps=N] [--time-ms=M] [--cpu=N] [--json=FICHERO]\n",
+                       arg);
+            std::exit(2);
+        }
+    }
+    return settings;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const Settings settings = parseArguments(argc, argv);
+    if (settings.cpu >= 0 && !zartrux::NumaTopology::pinThreadToCpu(static_cast<unsigned>(settings.cpu))) {
+        fmt::print(stderr, "No se pudo fijar el hilo a la CPU {}\n", settings.cpu);
+    }
+
+    Buffers buffers;
+    std::vector<Kernel> kernels;
+    addAesKernels(kernels, buffers);
+    addBlake2bKernels(kernels, buffers);
+    addArgon2Kernels(kernels, buffers);
+    addProgramKernels(kernels, buffers);
+
+    fmt::print("{:<42} {:>12} {:>12} {:>8} {:>14}\n", "kernel", "ns/op", "mín ns/op", "±%", "ciclos/op");
+    nlohmann::json report = nlohmann::json::array();
+    for (const auto& kernel : kernels) {
+        if (!settings.filter.empty() && kernel.name.find(settings.filter) == std::string::npos) continue;
+        if (!kernel.available) {
+            fmt::print("{:<42} {:>12}  ({})\n", kernel.name, "-", kernel.skipReason);
+            continue;
+        }
+        const Result r = measure(kernel, settings);
+        fmt::print("{:<42} {:>12.1f} {:>12.1f} {:>7.1f}% {:>14.0f}\n",
+                   r.name, r.medianNs, r.minNs, r.stddevPct, r.medianCycles);
+        report.push_back({{"kernel", r.name}, {"ns_per_op", r.medianNs}, {"min_ns_per_op", r.minNs},
+                          {"stddev_pct", r.stddevPct}, {"cycles_per_op", r.medianCycles},
+                          {"ops_per_rep", r.iterations}, {"reps", settings.reps}});
+    }
+    fmt::print("\nciclos: contador TSC (frecuencia nominal); {} repeticiones de ~{} ms por kernel\n",
+               settings.reps, settings.timeMs);
+
+    if (!settings.jsonFile.empty()) {
+        std::ofstream out(settings.jsonFile);
+        out << report.dump(2) << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,1458 @@
+// src/bench/mockpool.cpp
+//
+// zartrux-mockpool: pool Stratum simulada en localhost para ejercitar la ruta de red y de
+// trabajos (StratumClient, PoolFailover, JobManager y el cambio de trabajo de los workers)
+// sin depender de una pool real. Emite trabajos al ritmo y con la semilla que se le indique,
+// varía la dificultad, corta conexiones y retrasa respuestas a propósito, verifica cada share
+// con una VM ligera de RandomX y cuenta aceptadas, rechazadas y caducadas.
+//
+// Mide además lo que ve el minero: el tiempo desde que se le envía un trabajo hasta su primera
+// share de ese trabajo, y cuánto tarda en dejar de enviar shares del trabajo anterior.
+//
+// Con --daemon hace de nodo monerod para la minería en solitario (DaemonClient): plantillas de
+// bloque, submit_block, /get_height y notificaciones ZMQ; --job-ms es entonces el intervalo
+// entre bloques de la red y --seed-every cuenta bloques.
+//
+// Uso: zartrux-mockpool [--bind=IP] [--port=N] [--job-ms=M] [--job-jitter=F] [--block-every=N]
+//                       [--seed=HEX] [--seed-every=N] [--diff=D] [--diff-jitter=F] [--rng=N]
+//                       [--disconnect-s=S] [--slow-ms=M] [--slow-prob=P] [--no-verify]
+//                       [--report-s=S] [--duration-s=S] [--json=FICHERO]
+//                       [--daemon] [--zmq-port=N] [--txs=N]
+
+#include "crypto/randomx/randomx.h"
+#include "crypto/randomx/configuration.h"
+#include "core/NonceValidator.h"
+#include "core/hash.h"
+#include "network/BlockTemplate.h"
+#include "network/StratumParser.h"
+#include "utils/Hex.h"
+#include "utils/LatencyHistogram.h"
+#include "arch/Cpu.h"
+#include "memory/VirtualMemory.h"
+
+#include <boost/asio.hpp>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace asio = boost::asio;
+using tcp = asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+using zartrux::network::LineBuffer;
+using zartrux::network::StratumParser;
+using zartrux::network::StratumRequest;
+
+namespace {
+
+constexpr size_t BLOB_SIZE = 76;
+constexpr size_t NONCE_OFFSET = 39;
+constexpr size_t SESSION_OFFSET = 43;       // bytes propios de cada conexión (hace de extra nonce)
+constexpr size_t MAX_RECENT_JOBS = 8;       // trabajos por los que aún se aceptan shares
+constexpr size_t MAX_VERIFY_BACKLOG = 256;  // por encima, las shares se aceptan sin calcular el hash
+constexpr size_t MAX_OUTGOING_BYTES = 1 << 20;
+
+struct Settings {
+    std::string bind = "127.0.0.1";
+    uint16_t port = 3334;
+    unsigned jobMs = 5000;          // intervalo medio entre trabajos
+    double jobJitter = 0.0;         // ± fracción aleatoria sobre jobMs
+    unsigned blockEvery = 1;        // trabajos por altura; al subir, los anteriores caducan
+    std::string seed;               // semilla de RandomX (64 hex); vacía = aleatoria
+    unsigned seedEvery = 0;         // trabajos por semilla; 0 = no cambia nunca
+    uint64_t difficulty = 5000;
+    double diffJitter = 0.0;        // ± fracción aleatoria sobre la dificultad de cada trabajo
+    uint64_t rng = 1;               // semilla del generador: misma semilla, misma secuencia
+    double disconnectS = 0.0;       // media (exponencial) entre cortes por conexión; 0 = nunca
+    unsigned slowMs = 0;            // retraso de las respuestas lentas
+    double slowProb = 0.0;          // probabilidad de que una respuesta salga con retraso
+    bool verify = true;
+    unsigned reportS = 10;
+    unsigned durationS = 0;         // 0 = hasta Ctrl+C
+    std::string jsonFile;
+    // Nodo simulado (--daemon)
+    bool daemon = false;
+    uint16_t zmqPort = 0;           // 0 = sin publicador ZMQ
+    unsigned txCount = 8;           // transacciones (hashes aleatorios) por plantilla
+};
+
+using hash_t = NonceValidator::hash_t;
+
+struct Job {
+    uint64_t serial = 0;
+    std::string id;
+    std::vector<uint8_t> blob;      // plantilla; cada conexión recibe su variante (sessionBlob)
+    uint64_t difficulty = 0;
+    std::string targetHex;
+    NonceValidator::ShareTarget target;
+    uint32_t height = 0;
+    std::string seedHex;
+    std::vector<uint8_t> seedKey;
+    std::unordered_set<uint64_t> submitted;     // (conexión << 32) | nonce, para las duplicadas
+};
+
+struct Counters {
+    uint64_t connections = 0;
+    uint64_t logins = 0;
+    uint64_t jobs = 0;
+    uint64_t seedChanges = 0;
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+    uint64_t stale = 0;
+    uint64_t unverified = 0;        // aceptadas sin hash por exceso de cola
+    uint64_t acceptedDifficulty = 0;
+    uint64_t injectedDisconnects = 0;
+    uint64_t delayedResponses = 0;
+    std::map<std::string, uint64_t> rejectReasons;
+};
+
+// Objetivo compacto como lo envían las pools de Monero: 4 bytes mientras la dificultad quepa
+std::string compactTarget(uint64_t difficulty) {
+    const bool shortForm = difficulty <= 0xFFFFFFFFull;
+    const uint64_t raw = shortForm ? 0xFFFFFFFFull / difficulty : 0xFFFFFFFFFFFFFFFFull / difficulty;
+    uint8_t bytes[8];
+    for (size_t i = 0; i < sizeof(bytes); ++i) bytes[i] = static_cast<uint8_t>(raw >> (8 * i));
+    return zartrux::hex::encode(bytes, shortForm ? 4 : 8);
+}
+
+std::vector<uint8_t> sessionBlob(const Job& job, uint32_t session) {
+    std::vector<uint8_t> blob = job.blob;
+    for (size_t i = 0; i < 4; ++i) blob[SESSION_OFFSET + i] ^= static_cast<uint8_t>(session >> (8 * i));
+    return blob;
+}
+
+/**
+ * VM ligera de RandomX (sólo caché, sin dataset) para verificar shares. No es thread-safe:
+ * la usa únicamente el hilo verificador. La caché se reconstruye al cambiar de semilla.
+ */
+class LightHasher {
+public:
+    LightHasher() {
+        const size_t cacheBytes = static_cast<size_t>(RandomX_CurrentConfig.ArgonMemory) * 1024;
+        zartrux::VirtualMemory::AllocationOptions options;
+        options.label = "mockpool cache";
+        m_cacheMemory = zartrux::VirtualMemory::allocate(cacheBytes, options).ptr;
+        if (!m_cacheMemory) throw std::runtime_error("No se pudo reservar la caché de RandomX");
+        // La VM usa el scratchpad tal cual: tiene que venir reservado y alineado
+        options.label = "mockpool scratchpad";
+        m_scratchpad = zartrux::VirtualMemory::allocate(RANDOMX_SCRATCHPAD_L3_MAX_SIZE, options).ptr;
+        if (!m_scratchpad) {
+            zartrux::VirtualMemory::release(m_cacheMemory);
+            throw std::runtime_error("No se pudo reservar el scratchpad de RandomX");
+        }
+
+        m_flags = randomx_have_jit() ? RANDOMX_FLAG_JIT : RANDOMX_FLAG_DEFAULT;
+        if (zartrux::Cpu::info()->hasAES()) m_flags = static_cast<randomx_flags>(m_flags | RANDOMX_FLAG_HARD_AES);
+        m_cache = randomx_create_cache(m_flags, static_cast<uint8_t*>(m_cacheMemory));
+        if (!m_cache) {
+            zartrux::VirtualMemory::release(m_scratchpad);
+            zartrux::VirtualMemory::release(m_cacheMemory);
+            throw std::runtime_error("No se pudo crear la caché de RandomX");
+        }
+    }
+
+    ~LightHasher() {
+        if (m_vm) randomx_destroy_vm(m_vm);
+        randomx_release_cache(m_cache);
+        zartrux::VirtualMemory::release(m_scratchpad);
+        zartrux::VirtualMemory::release(m_cacheMemory);
+    }
+
+    LightHasher(const LightHasher&) = delete;
+    LightHasher& operator=(const LightHasher&) = delete;
+
+    hash_t hash(const std::vector<uint8_t>& key, const std::vector<uint8_t>& blob) {
+        if (key != m_key) {
+            const auto start = Clock::now();
+            randomx_init_cache(m_cache, key.data(), key.size());
+            m_key = key;
+            if (m_vm) {
+                randomx_vm_set_cache(m_vm, m_cache);
+            } else {
+                m_vm = randomx_create_vm(m_flags, m_cache, nullptr, static_cast<uint8_t*>(m_scratchpad), 0);
+                if (!m_vm) throw std::runtime_error("No se pudo crear la VM de RandomX");
+            }
+            fmt::print("Caché de RandomX lista para la semilla {}... en {:.0f} ms\n",
+                       zartrux::hex::encode(key.data(), std::min<size_t>(key.size(), 4)),
+                       std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        hash_t out{};
+        randomx_calculate_hash(m_vm, blob.data(), blob.size(), out.data());
+        return out;
+    }
+
+private:
+    randomx_flags m_flags = RANDOMX_FLAG_DEFAULT;
+    void* m_cacheMemory = nullptr;
+    void* m_scratchpad = nullptr;
+    randomx_cache* m_cache = nullptr;
+    randomx_vm* m_vm = nullptr;
+    std::vector<uint8_t> m_key;
+};
+
+class MockPool {
+public:
+    MockPool(asio::io_context& io_context, Settings settings)
+        : m_io_context(io_context)
+        , m_settings(std::move(settings))
+        , m_acceptor(io_context)
+        , m_jobTimer(io_context)
+        , m_reportTimer(io_context)
+        , m_rng(m_settings.rng)
+        , m_firstShare(std::chrono::hours(24))
+        , m_switchLag(std::chrono::hours(24))
+        , m_verifyTime(std::chrono::hours(24)) {}
+
+    ~MockPool() {
+        stopVerifier();
+    }
+
+    void start() {
+        if (m_settings.seed.empty()) m_settings.seed = randomSeed();
+        if (m_settings.verify) startVerifier();
+
+        const tcp::endpoint endpoint(asio::ip::make_address(m_settings.bind), m_settings.port);
+        m_acceptor.open(endpoint.protocol());
+        m_acceptor.set_option(tcp::acceptor::reuse_address(true));
+        m_acceptor.bind(endpoint);
+        m_acceptor.listen(asio::socket_base::max_listen_connections);
+        m_startedAt = Clock::now();
+        m_running = true;
+
+        newJob();
+        accept();
+        armJobTimer();
+        armReportTimer();
+        fmt::print("Pool simulada en {}:{} | trabajo cada {} ms | dificultad {} | verificación {}\n",
+                   m_settings.bind, m_settings.port, m_settings.jobMs, m_settings.difficulty,
+                   m_settings.verify ? "RandomX ligera" : "desactivada");
+    }
+
+    void stop() {
+        m_running = false;
+        boost::system::error_code ignored;
+        m_acceptor.close(ignored);
+        m_jobTimer.cancel();
+        m_reportTimer.cancel();
+        for (auto& session : std::vector<std::shared_ptr<Session>>(m_sessions.begin(), m_sessions.end())) {
+            close(session, "fin de la simulación", false);
+        }
+        stopVerifier();
+    }
+
+    void printReport() const;
+    nlohmann::json jsonReport() const;
+
+private:
+    struct Session {
+        explicit Session(asio::io_context& io_context)
+            : socket(io_context), disconnectTimer(io_context), holdTimer(io_context) {}
+
+        tcp::socket socket;
+        asio::steady_timer disconnectTimer;
+        asio::steady_timer holdTimer;       // respuesta lenta en curso: no sale nada hasta que venza
+        LineBuffer recv{2048, 16 * 1024};
+        std::string outgoing;
+        std::string writing;
+        bool writeInFlight = false;
+        bool holding = false;
+        bool open = false;
+        bool loggedIn = false;
+        uint32_t number = 0;
+        std::string id;
+        std::string worker;
+        // Último trabajo enviado: para la latencia hasta la primera share y el cambio de trabajo
+        uint64_t jobSerial = 0;
+        Clock::time_point jobSentAt;
+        bool firstShareSeen = false;
+    };
+
+    void accept() {
+        auto session = std::make_shared<Session>(m_io_context);
+        m_acceptor.async_accept(session->socket, [this, session](const boost::system::error_code& ec) {
+            if (!m_running || ec == asio::error::operation_aborted) return;
+            if (!ec) {
+                boost::system::error_code ignored;
+                session->socket.set_option(tcp::no_delay(true), ignored);
+                session->open = true;
+                session->number = ++m_sessionCounter;
+                m_sessions.insert(session);
+                ++m_counters.connections;
+                armDisconnect(session);
+                read(session);
+            }
+            accept();
+        });
+    }
+
+    void read(const std::shared_ptr<Session>& session) {
+        auto buffer = session->recv.prepare(1024);
+        if (buffer.empty()) {
+            close(session, "línea demasiado larga", false);
+            return;
+        }
+        session->socket.async_read_some(asio::buffer(buffer.data(), buffer.size()),
+            [this, session](const boost::system::error_code& ec, size_t bytes) {
+                if (ec || bytes == 0) {
+                    close(session, ec == asio::error::eof ? "conexión cerrada" : ec.message(), false);
+                    return;
+                }
+                session->recv.commit(bytes);
+                while (session->open) {
+                    auto line = session->recv.nextLine();
+                    if (!line) break;
+                    if (!line->empty()) handleLine(session, *line);
+                }
+                if (session->open) read(session);
+            });
+    }
+
+    void handleLine(const std::shared_ptr<Session>& session, std::string_view line) {
+        StratumRequest request;
+        if (!StratumParser::parseRequest(line, request)) {
+            close(session, "JSON no válido", false);
+            return;
+        }
+        switch (request.method) {
+            case StratumRequest::Method::Login:
+                handleLogin(session, request);
+                break;
+            case StratumRequest::Method::Submit:
+                handleSubmit(session, request);
+                break;
+            case StratumRequest::Method::Keepalived:
+                respond(session, request.id, R"({"status":"KEEPALIVED"})", {});
+                break;
+            case StratumRequest::Method::Unknown:
+                respond(session, request.id, {}, "Método no soportado");
+                break;
+        }
+    }
+
+    void handleLogin(const std::shared_ptr<Session>& session, const StratumRequest& request) {
+        if (!session->loggedIn) {
+            session->loggedIn = true;
+            ++m_counters.logins;
+        }
+        session->worker.assign(request.login.substr(0, 64));
+        session->id = fmt::format("mock-{}", session->number);
+
+        const auto& job = *m_jobs.back();
+        markJobSent(session, job);
+        respond(session, request.id,
+                fmt::format(R"({{"id":"{}","job":{},"extensions":["keepalive"],"status":"OK"}})",
+                            session->id, jobParams(job, session->number)), {});
+    }
+
+    void handleSubmit(const std::shared_ptr<Session>& session, const StratumRequest& request) {
+        const auto now = Clock::now();
+        if (!session->loggedIn || request.sessionId != session->id) {
+            reject(session, request.id, "Unauthenticated");
+            return;
+        }
+
+        uint8_t nonce[4];
+        hash_t claimed{};
+        if (request.nonce.size() != 8 || !zartrux::hex::decode(request.nonce, nonce) ||
+            request.result.size() != 64 || !zartrux::hex::decode(request.result, claimed.data())) {
+            reject(session, request.id, "Malformed share");
+            return;
+        }
+
+        auto it = std::find_if(m_jobs.begin(), m_jobs.end(),
+                               [&](const std::shared_ptr<Job>& job) { return job->id == request.jobId; });
+        if (it == m_jobs.end()) {
+            reject(session, request.id, "Unknown job");
+            return;
+        }
+        const auto job = *it;
+
+        // Latencias vistas desde el minero
+        if (job->serial == session->jobSerial) {
+            if (!session->firstShareSeen) {
+                session->firstShareSeen = true;
+                m_firstShare.record(std::chrono::duration<double, std::milli>(now - session->jobSentAt).count());
+            }
+        } else if (job->serial < session->jobSerial) {
+            m_switchLag.record(std::chrono::duration<double, std::milli>(now - session->jobSentAt).count());
+        }
+
+        uint32_t value;
+        std::memcpy(&value, nonce, sizeof(value));
+        if (!job->submitted.insert((static_cast<uint64_t>(session->number) << 32) | value).second) {
+            reject(session, request.id, "Duplicate share");
+            return;
+        }
+        if (job->height < m_height) {
+            ++m_counters.stale;
+            respond(session, request.id, {}, "Block expired");
+            return;
+        }
+
+        if (!m_settings.verify || m_verifyBacklog >= MAX_VERIFY_BACKLOG) {
+            if (m_settings.verify) ++m_counters.unverified;
+            finishShare(session, std::string(request.id), job, claimed, claimed);
+            return;
+        }
+
+        // El hash se calcula en el hilo verificador; la respuesta sale al volver
+        auto blob = sessionBlob(*job, session->number);
+        std::memcpy(blob.data() + NONCE_OFFSET, nonce, sizeof(nonce));
+        ++m_verifyBacklog;
+        asio::post(m_verifyContext, [this, session, id = std::string(request.id), job, claimed, blob = std::move(blob)] {
+            const auto start = Clock::now();
+            const hash_t computed = m_hasher->hash(job->seedKey, blob);
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            asio::post(m_io_context, [this, session, id, job, claimed, computed, ms] {
+                --m_verifyBacklog;
+                m_verifyTime.record(ms);
+                finishShare(session, id, job, claimed, computed);
+            });
+        });
+    }
+
+    void finishShare(const std::shared_ptr<Session>& session, const std::string& id,
+                     const std::shared_ptr<Job>& job, const hash_t& claimed, const hash_t& computed) {
+        if (claimed != computed) {
+            reject(session, id, "Invalid result");
+        } else if (!NonceValidator::meetsTarget(computed, job->target)) {
+            reject(session, id, "Low difficulty share");
+        } else {
+            ++m_counters.accepted;
+            m_counters.acceptedDifficulty += job->difficulty;
+            respond(session, id, R"({"status":"OK"})", {});
+        }
+    }
+
+    void reject(const std::shared_ptr<Session>& session, std::string_view id, const std::string& reason) {
+        ++m_counters.rejected;
+        ++m_counters.rejectReasons[reason];
+        respond(session, id, {}, reason);
+    }
+
+    // Respuesta a una petición; una fracción sale con retraso (--slow-ms/--slow-prob) y, como en
+    // una pool atascada, lo que venga detrás para esa conexión espera con ella y llega en orden
+    void respond(const std::shared_ptr<Session>& session, std::string_view id,
+                 std::string_view result, std::string_view error) {
+        std::string message = error.empty()
+            ? fmt::format(R"({{"id":{},"jsonrpc":"2.0","error":null,"result":{}}})" "\n",
+                          id.empty() ? std::string_view("null") : id, result)
+            : fmt::format(R"({{"id":{},"jsonrpc":"2.0","error":{{"code":-1,"message":{}}},"result":null}})" "\n",
+                          id.empty() ? std::string_view("null") : id, nlohmann::json(std::string(error)).dump());
+
+        if (session->holding || m_settings.slowMs == 0 || !chance(m_settings.slowProb)) {
+            write(session, message);
+            return;
+        }
+        ++m_counters.delayedResponses;
+        session->holding = true;
+        write(session, message);
+        session->holdTimer.expires_after(std::chrono::milliseconds(m_settings.slowMs));
+        session->holdTimer.async_wait([this, session](const boost::system::error_code& ec) {
+            if (ec) return;
+            session->holding = false;
+            flush(session);
+        });
+    }
+
+    void write(const std::shared_ptr<Session>& session, std::string_view message) {
+        if (!session->open) return;
+        if (session->outgoing.size() + message.size() > MAX_OUTGOING_BYTES) {
+            close(session, "no lee lo que se le envía", false);
+            return;
+        }
+        session->outgoing.append(message);
+        if (!session->holding) flush(session);
+    }
+
+    void flush(const std::shared_ptr<Session>& session) {
+        if (!session->open || session->writeInFlight || session->outgoing.empty()) return;
+        session->writing.clear();
+        session->writing.swap(session->outgoing);
+        session->writeInFlight = true;
+        asio::async_write(session->socket, asio::buffer(session->writing),
+            [this, session](const boost::system::error_code& ec, size_t) {
+                session->writeInFlight = false;
+                if (ec) {
+                    close(session, ec.message(), false);
+                    return;
+                }
+                flush(session);
+            });
+    }
+
+    void close(const std::shared_ptr<Session>& session, std::string_view reason, bool injected) {
+        if (!session->open) return;
+        session->open = false;
+        session->disconnectTimer.cancel();
+        session->holdTimer.cancel();
+        boost::system::error_code ignored;
+        session->socket.shutdown(tcp::socket::shutdown_both, ignored);
+        session->socket.close(ignored);
+        m_sessions.erase(session);
+        if (injected) ++m_counters.injectedDisconnects;
+        if (session->loggedIn) {
+            fmt::print("Conexión {} ({}) cerrada: {}\n", session->number, session->worker, reason);
+        }
+    }
+
+    // Corte simulado: intervalo exponencial con media --disconnect-s
+    void armDisconnect(const std::shared_ptr<Session>& session) {
+        if (m_settings.disconnectS <= 0.0) return;
+        std::exponential_distribution<double> interval(1.0 / m_settings.disconnectS);
+        session->disconnectTimer.expires_after(std::chrono::milliseconds(
+            static_cast<int64_t>(interval(m_rng) * 1000.0) + 1));
+        session->disconnectTimer.async_wait([this, session](const boost::system::error_code& ec) {
+            if (!ec) close(session, "desconexión simulada", true);
+        });
+    }
+
+    void armJobTimer() {
+        m_jobTimer.expires_after(std::chrono::milliseconds(jittered(m_settings.jobMs, m_settings.jobJitter)));
+        m_jobTimer.async_wait([this](const boost::system::error_code& ec) {
+            if (ec || !m_running) return;
+            newJob();
+            for (const auto& session : m_sessions) {
+                if (!session->loggedIn) continue;
+                markJobSent(session, *m_jobs.back());
+                write(session, fmt::format(R"({{"jsonrpc":"2.0","method":"job","params":{}}})" "\n",
+                                           jobParams(*m_jobs.back(), session->number)));
+            }
+            armJobTimer();
+        });
+    }
+
+    void newJob() {
+        auto job = std::make_shared<Job>();
+        job->serial = ++m_jobSerial;
+        job->id = fmt::format("{:08x}", job->serial);
+
+        if (m_settings.seedEvery > 0 && job->serial > 1 && (job->serial - 1) % m_settings.seedEvery == 0) {
+            m_settings.seed = randomSeed();
+            ++m_counters.seedChanges;
+        }
+        if (job->serial == 1 || (m_settings.blockEvery > 0 && (job->serial - 1) % m_settings.blockEvery == 0)) {
+            ++m_height;
+        }
+
+        job->blob.resize(BLOB_SIZE);
+        for (auto& byte : job->blob) byte = static_cast<uint8_t>(m_rng());
+        job->blob[0] = 16;      // versión mayor de Monero (RandomX)
+        job->blob[1] = 16;
+        std::memset(job->blob.data() + NONCE_OFFSET, 0, 4);
+
+        job->difficulty = std::max<uint64_t>(1, jittered(m_settings.difficulty, m_settings.diffJitter));
+        job->targetHex = compactTarget(job->difficulty);
+        job->target = NonceValidator::ShareTarget::fromHex(job->targetHex);
+        job->height = m_height;
+        job->seedHex = m_settings.seed;
+        job->seedKey = core::seedKeyFromString(m_settings.seed);
+
+        m_jobs.push_back(std::move(job));
+        if (m_jobs.size() > MAX_RECENT_JOBS) m_jobs.pop_front();
+        ++m_counters.jobs;
+    }
+
+    std::string jobParams(const Job& job, uint32_t session) const {
+        const auto blob = sessionBlob(job, session);
+        return fmt::format(R"({{"blob":"{}","job_id":"{}","target":"{}","height":{},"seed_hash":"{}","algo":"rx/0"}})",
+                           zartrux::hex::encode(blob.data(), blob.size()), job.id, job.targetHex,
+                           job.height, job.seedHex);
+    }
+
+    void markJobSent(const std::shared_ptr<Session>& session, const Job& job) {
+        session->jobSerial = job.serial;
+        session->jobSentAt = Clock::now();
+        session->firstShareSeen = false;
+    }
+
+    void armReportTimer() {
+        if (m_settings.reportS == 0) return;
+        m_reportTimer.expires_after(std::chrono::seconds(m_settings.reportS));
+        m_reportTimer.async_wait([this](const boost::system::error_code& ec) {
+            if (ec || !m_running) return;
+            printReport();
+            armReportTimer();
+        });
+    }
+
+    void startVerifier() {
+        m_hasher = std::make_unique<LightHasher>();
+        m_verifyContext.restart();
+        m_verifyThread = std::thread([this] {
+            auto guard = asio::make_work_guard(m_verifyContext);
+            m_verifyContext.run();
+        });
+    }
+
+    void stopVerifier() {
+        if (!m_verifyThread.joinable()) return;
+        m_verifyContext.stop();
+        m_verifyThread.join();
+        m_hasher.reset();
+    }
+
+    std::string randomSeed() {
+        uint8_t bytes[32];
+        for (auto& byte : bytes) byte = static_cast<uint8_t>(m_rng());
+        return zartrux::hex::encode(bytes, sizeof(bytes));
+    }
+
+    uint64_t jittered(uint64_t value, double jitter) {
+        if (jitter <= 0.0) return value;
+        std::uniform_real_distribution<double> factor(1.0 - jitter, 1.0 + jitter);
+        return static_cast<uint64_t>(static_cast<double>(value) * std::max(0.0, factor(m_rng)));
+    }
+
+    bool chance(double probability) {
+        return probability > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < probability;
+    }
+
+    asio::io_context& m_io_context;
+    Settings m_settings;
+    tcp::acceptor m_acceptor;
+    asio::steady_timer m_jobTimer;
+    asio::steady_timer m_reportTimer;
+    bool m_running = false;
+    std::mt19937_64 m_rng;
+    Clock::time_point m_startedAt;
+
+    std::unordered_set<std::shared_ptr<Session>> m_sessions;
+    uint32_t m_sessionCounter = 0;
+    std::deque<std::shared_ptr<Job>> m_jobs;
+    uint64_t m_jobSerial = 0;
+    uint32_t m_height = 0;
+
+    // Verificación en un hilo aparte para que el hash no retrase trabajos ni respuestas
+    asio::io_context m_verifyContext;
+    std::thread m_verifyThread;
+    std::unique_ptr<LightHasher> m_hasher;
+    size_t m_verifyBacklog = 0;
+
+    Counters m_counters;
+    zartrux::LatencyHistogram m_firstShare;     // trabajo enviado -> primera share de ese trabajo
+    zartrux::LatencyHistogram m_switchLag;      // trabajo nuevo enviado -> share tardía del anterior
+    zartrux::LatencyHistogram m_verifyTime;
+};
+
+void MockPool::printReport() const {
+    const double elapsed = std::chrono::duration<double>(Clock::now() - m_startedAt).count();
+    const auto first = m_firstShare.snapshot();
+    const auto lag = m_switchLag.snapshot();
+    fmt::print("[{:.0f} s] conexiones {} | trabajos {} (altura {}) | aceptadas {} rechazadas {} caducadas {}"
+               " | ~{:.1f} H/s\n",
+               elapsed, m_sessions.size(), m_counters.jobs, m_height, m_counters.accepted,
+               m_counters.rejected, m_counters.stale,
+               elapsed > 0 ? static_cast<double>(m_counters.acceptedDifficulty) / elapsed : 0.0);
+    fmt::print("    1ª share tras trabajo: n={} p50 {:.1f} ms p95 {:.1f} ms p99 {:.1f} ms"
+               " | shares del trabajo anterior: n={} p99 {:.1f} ms\n",
+               first.count, first.p50Ms, first.p95Ms, first.p99Ms, lag.count, lag.p99Ms);
+    if (!m_counters.rejectReasons.empty()) {
+        std::string reasons;
+        for (const auto& [reason, count] : m_counters.rejectReasons) {
+            reasons += fmt::format("{}{}: {}", reasons.empty() ? "" : ", ", reason, count);
+        }
+        fmt::print("    rechazos: {}\n", reasons);
+    }
+}
+
+nlohmann::json MockPool::jsonReport() const {
+    auto histogram = [](const zartrux::LatencyHistogram& h) {
+        const auto s = h.snapshot();
+        return nlohmann::json{{"count", s.count}, {"mean_ms", s.meanMs}, {"p50_ms", s.p50Ms},
+                              {"p95_ms", s.p95Ms}, {"p99_ms", s.p99Ms}};
+    };
+    const double elapsed = std::chrono::duration<double>(Clock::now() - m_startedAt).count();
+    return {
+        {"settings", {
+            {"job_ms", m_settings.jobMs}, {"job_jitter", m_settings.jobJitter},
+            {"block_every", m_settings.blockEvery}, {"seed_every", m_settings.seedEvery},
+            {"difficulty", m_settings.difficulty}, {"diff_jitter", m_settings.diffJitter},
+            {"rng", m_settings.rng}, {"disconnect_s", m_settings.disconnectS},
+            {"slow_ms", m_settings.slowMs}, {"slow_prob", m_settings.slowProb},
+            {"verify", m_settings.verify},
+        }},
+        {"elapsed_s", elapsed},
+        {"connections", m_counters.connections},
+        {"logins", m_counters.logins},
+        {"jobs", m_counters.jobs},
+        {"seed_changes", m_counters.seedChanges},
+        {"accepted", m_counters.accepted},
+        {"rejected", m_counters.rejected},
+        {"stale", m_counters.stale},
+        {"unverified", m_counters.unverified},
+        {"reject_reasons", m_counters.rejectReasons},
+        {"hashrate", elapsed > 0 ? static_cast<double>(m_counters.acceptedDifficulty) / elapsed : 0.0},
+        {"injected_disconnects", m_counters.injectedDisconnects},
+        {"delayed_responses", m_counters.delayedResponses},
+        {"first_share", histogram(m_firstShare)},
+        {"switch_lag", histogram(m_switchLag)},
+        {"verify", histogram(m_verifyTime)},
+    };
+}
+
+/**
+ * Nodo simulado compatible con el RPC de monerod para la minería en solitario (--daemon):
+ * `get_block_template`, `submit_block` y `/get_height` sobre HTTP/1.1 con keep-alive, y un
+ * publicador ZMQ (ZMTP 3.0, mecanismo NULL) del tema json-minimal-chain_main si se pide
+ * --zmq-port. Cada --job-ms llega un bloque "de la red"; un bloque enviado que cumple la
+ * dificultad avanza la cadena igual. Mide desde aquí cuánto tarda el minero en pedir la
+ * plantilla nueva tras cada bloque (el trabajo que desperdicia mientras tanto).
+ */
+class MockDaemon {
+public:
+    MockDaemon(asio::io_context& io_context, Settings settings)
+        : m_io_context(io_context)
+        , m_settings(std::move(settings))
+        , m_acceptor(io_context)
+        , m_zmqAcceptor(io_context)
+        , m_blockTimer(io_context)
+        , m_reportTimer(io_context)
+        , m_rng(m_settings.rng)
+        , m_refreshLag(std::chrono::hours(24))
+        , m_verifyTime(std::chrono::hours(24)) {}
+
+    ~MockDaemon() {
+        stopVerifier();
+    }
+
+    void start() {
+        if (m_settings.seed.empty()) m_settings.seed = randomSeed();
+        m_hasher = std::make_unique<LightHasher>();
+        m_verifyContext.restart();
+        m_verifyThread = std::thread([this] {
+            auto guard = asio::make_work_guard(m_verifyContext);
+            m_verifyContext.run();
+        });
+
+        listen(m_acceptor, m_settings.port);
+        if (m_settings.zmqPort) listen(m_zmqAcceptor, m_settings.zmqPort);
+        m_startedAt = Clock::now();
+        m_running = true;
+
+        m_height = 1000;
+        for (auto& byte : m_tip) byte = static_cast<uint8_t>(m_rng());
+        m_difficulty = std::max<uint64_t>(1, jittered(m_settings.difficulty, m_settings.diffJitter));
+        m_tipAt = Clock::now();
+        m_tipServed = true;     // el arranque no cuenta como bloque nuevo
+
+        accept();
+        if (m_settings.zmqPort) acceptZmq();
+        armBlockTimer();
+        armReportTimer();
+        fmt::print("Nodo simulado en http://{}:{}{} | bloque cada {} ms | dificultad {} | {} transacciones\n",
+                   m_settings.bind, m_settings.port,
+                   m_settings.zmqPort ? fmt::format(" | ZMQ tcp://{}:{}", m_settings.bind, m_settings.zmqPort) : "",
+                   m_settings.jobMs, m_settings.difficulty, m_settings.txCount);
+    }
+
+    void stop() {
+        m_running = false;
+        boost::system::error_code ignored;
+        m_acceptor.close(ignored);
+        m_zmqAcceptor.close(ignored);
+        m_blockTimer.cancel();
+        m_reportTimer.cancel();
+        for (auto& session : std::vector<std::shared_ptr<Session>>(m_sessions.begin(), m_sessions.end())) {
+            close(session);
+        }
+        for (auto& subscriber : std::vector<std::shared_ptr<Subscriber>>(m_subscribers.begin(), m_subscribers.end())) {
+            closeSubscriber(subscriber);
+        }
+        stopVerifier();
+    }
+
+    void printReport() const;
+    nlohmann::json jsonReport() const;
+
+private:
+    static constexpr size_t MAX_REQUEST_BYTES = 8 << 20;
+    static constexpr const char* ZMQ_TOPIC = "json-minimal-chain_main";
+
+    struct Session {
+        explicit Session(asio::io_context& io_context) : socket(io_context), holdTimer(io_context) {}
+
+        tcp::socket socket;
+        asio::steady_timer holdTimer;
+        std::string inbox;
+        std::string outgoing;
+        std::string writing;
+        bool writeInFlight = false;
+        bool busy = false;          // petición en curso: las siguientes esperan (sin pipelining)
+        bool closeAfter = false;
+        bool open = false;
+    };
+
+    struct Subscriber {
+        explicit Subscriber(asio::io_context& io_context) : socket(io_context) {}
+
+        tcp::socket socket;
+        std::vector<uint8_t> in;
+        std::deque<std::string> outgoing;
+        std::string topic;
+        bool subscribed = false;
+        bool open = false;
+    };
+
+    void listen(tcp::acceptor& acceptor, uint16_t port) {
+        const tcp::endpoint endpoint(asio::ip::make_address(m_settings.bind), port);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen(asio::socket_base::max_listen_connections);
+    }
+
+    void accept() {
+        auto session = std::make_shared<Session>(m_io_context);
+        m_acceptor.async_accept(session->socket, [this, session](const boost::system::error_code& ec) {
+            if (!m_running || ec == asio::error::operation_aborted) return;
+            if (!ec) {
+                boost::system::error_code ignored;
+                session->socket.set_option(tcp::no_delay(true), ignored);
+                session->open = true;
+                m_sessions.insert(session);
+                ++m_counters.connections;
+                read(session);
+            }
+            accept();
+        });
+    }
+
+    void read(const std::shared_ptr<Session>& session) {
+        auto buffer = std::make_shared<std::array<char, 4096>>();
+        session->socket.async_read_some(asio::buffer(*buffer),
+            [this, session, buffer](const boost::system::error_code& ec, size_t bytes) {
+                if (ec || bytes == 0) {
+                    close(session);
+                    return;
+                }
+                session->inbox.append(buffer->data(), bytes);
+                if (session->inbox.size() > MAX_REQUEST_BYTES) {
+                    close(session);
+                    return;
+                }
+                process(session);
+                if (session->open) read(session);
+            });
+    }
+
+    // Atiende las peticiones completas del buffer, de una en una
+    void process(const std::shared_ptr<Session>& session) {
+        while (session->open && !session->busy) {
+            const auto headerEnd = session->inbox.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) return;
+
+            const std::string_view head(session->inbox.data(), headerEnd);
+            const auto lineEnd = head.find("\r\n");
+            const std::string_view requestLine = head.substr(0, lineEnd);
+            size_t contentLength = 0;
+            bool keepAlive = requestLine.find("HTTP/1.0") == std::string_view::npos;
+            for (size_t pos = lineEnd; pos != std::string_view::npos && pos < head.size();) {
+                const auto next = head.find("\r\n", pos + 2);
+                std::string header(head.substr(pos + 2, next == std::string_view::npos ? std::string_view::npos : next - pos - 2));
+                std::transform(header.begin(), header.end(), header.begin(), [](unsigned char c) { return std::tolower(c); });
+                if (header.rfind("content-length:", 0) == 0) contentLength = std::strtoull(header.c_str() + 15, nullptr, 10);
+                else if (header.rfind("connection:", 0) == 0) keepAlive = header.find("close") == std::string::npos;
+                pos = next;
+            }
+            if (contentLength > MAX_REQUEST_BYTES) {
+                close(session);
+                return;
+            }
+            if (session->inbox.size() < headerEnd + 4 + contentLength) return;
+
+            const auto firstSpace = requestLine.find(' ');
+            const auto secondSpace = requestLine.find(' ', firstSpace + 1);
+            const std::string path(requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1));
+            const std::string body = session->inbox.substr(headerEnd + 4, contentLength);
+            session->inbox.erase(0, headerEnd + 4 + contentLength);
+            session->closeAfter = !keepAlive;
+            session->busy = true;
+            handleRequest(session, path, body);
+        }
+    }
+
+    void handleRequest(const std::shared_ptr<Session>& session, const std::string& path, const std::string& body) {
+        ++m_counters.requests;
+        if (path == "/get_height") {
+            ++m_counters.heightPolls;
+            respond(session, 200, nlohmann::json{{"height", m_height}, {"hash", tipHex()},
+                                                 {"status", "OK"}, {"untrusted", false}}.dump());
+            return;
+        }
+        if (path != "/json_rpc") {
+            respond(session, 404, R"({"error":"not found"})");
+            return;
+        }
+
+        const auto request = nlohmann::json::parse(body, nullptr, false);
+        if (request.is_discarded() || !request.is_object()) {
+            rpcError(session, nlohmann::json(), -32700, "Parse error");
+            return;
+        }
+        const auto id = request.value("id", nlohmann::json());
+        const auto method = request.value("method", std::string());
+        const auto params = request.value("params", nlohmann::json());
+        if (method == "get_block_template") handleGetBlockTemplate(session, id, params);
+        else if (method == "submit_block") handleSubmitBlock(session, id, params);
+        else rpcError(session, id, -32601, "Method not found");
+    }
+
+    void handleGetBlockTemplate(const std::shared_ptr<Session>& session, const nlohmann::json& id,
+                                const nlohmann::json& params) {
+        const auto reserveSize = params.is_object() ? params.value("reserve_size", uint64_t{0}) : 0;
+        const auto wallet = params.is_object() ? params.value("wallet_address", std::string()) : std::string();
+        if (wallet.empty() || reserveSize > 255) {
+            rpcError(session, id, -2, "Failed to parse wallet address or bad reserve size");
+            return;
+        }
+        ++m_counters.templates;
+        if (!m_tipServed) {
+            m_tipServed = true;
+            m_refreshLag.record(std::chrono::duration<double, std::milli>(Clock::now() - m_tipAt).count());
+        }
+
+        // Cabecera (versiones 16, timestamp, bloque anterior, nonce) y coinbase v2 con RingCT nulo:
+        // una salida con view tag y extra = clave pública + nonce reservado
+        std::vector<uint8_t> blob;
+        auto varint = [&blob](uint64_t value) {
+            for (; value >= 0x80; value >>= 7) blob.push_back(static_cast<uint8_t>(value & 0x7f) | 0x80);
+            blob.push_back(static_cast<uint8_t>(value));
+        };
+        auto random = [&](size_t bytes) { for (size_t i = 0; i < bytes; ++i) blob.push_back(static_cast<uint8_t>(m_rng())); };
+        varint(16);
+        varint(16);
+        varint(static_cast<uint64_t>(std::time(nullptr)));
+        blob.insert(blob.end(), m_tip.begin(), m_tip.end());
+        blob.insert(blob.end(), 4, 0);
+
+        varint(2);
+        varint(m_height + 60);
+        varint(1);
+        blob.push_back(0xff);
+        varint(m_height);
+        varint(1);
+        varint(600000000000ull);
+        blob.push_back(0x03);
+        random(33);
+        varint(1 + 32 + 2 + reserveSize);
+        blob.push_back(0x01);
+        random(32);
+        blob.push_back(0x02);
+        blob.push_back(static_cast<uint8_t>(reserveSize));
+        const size_t reservedOffset = blob.size();
+        blob.insert(blob.end(), reserveSize, 0);
+        blob.push_back(0x00);
+        varint(m_settings.txCount);
+        random(32 * m_settings.txCount);
+
+        const zartrux::network::BlockTemplate block(blob, reservedOffset, reserveSize);
+        const auto hashing = block.hashingBlob();
+        const bool seedChanging = m_settings.seedEvery > 0 && (m_height + 1) % m_settings.seedEvery == 0;
+        if (seedChanging && m_nextSeed.empty()) m_nextSeed = randomSeed();
+
+        const nlohmann::json result = {
+            {"blocktemplate_blob", zartrux::hex::encode(blob.data(), blob.size())},
+            {"blockhashing_blob", zartrux::hex::encode(hashing.data(), hashing.size())},
+            {"difficulty", m_difficulty},
+            {"wide_difficulty", fmt::format("0x{:x}", m_difficulty)},
+            {"expected_reward", 600000000000ull},
+            {"height", m_height},
+            {"prev_hash", tipHex()},
+            {"reserved_offset", reservedOffset},
+            {"seed_hash", m_settings.seed},
+            {"next_seed_hash", seedChanging ? m_nextSeed : std::string()},
+            {"status", "OK"},
+            {"untrusted", false},
+        };
+        rpcResult(session, id, result);
+    }
+
+    void handleSubmitBlock(const std::shared_ptr<Session>& session, const nlohmann::json& id,
+                           const nlohmann::json& params) {
+        ++m_counters.submitted;
+        if (!params.is_array() || params.empty() || !params[0].is_string()) {
+            rejectBlock(session, id, -6, "Wrong block blob");
+            return;
+        }
+        const auto hex = params[0].get<std::string>();
+        std::vector<uint8_t> blob(hex.size() / 2);
+        if (hex.size() % 2 != 0 || !zartrux::hex::decode(hex, blob.data())) {
+            rejectBlock(session, id, -6, "Wrong block blob");
+            return;
+        }
+
+        std::shared_ptr<const zartrux::network::BlockTemplate> block;
+        try {
+            block = std::make_shared<const zartrux::network::BlockTemplate>(std::move(blob), 0, 0);
+        } catch (const std::exception&) {
+            rejectBlock(session, id, -6, "Wrong block blob");
+            return;
+        }
+        if (!std::equal(m_tip.begin(), m_tip.end(), block->prevId().begin())) {
+            ++m_counters.staleBlocks;
+            rejectBlock(session, id, -7, "Block not accepted");
+            return;
+        }
+
+        // Prueba de trabajo en el hilo verificador; la respuesta sale al volver
+        const auto seedKey = core::seedKeyFromString(m_settings.seed);
+        const auto target = NonceValidator::ShareTarget::fromDifficulty(m_difficulty);
+        asio::post(m_verifyContext, [this, session, id, block, seedKey, target] {
+            const auto start = Clock::now();
+            const hash_t pow = m_hasher->hash(seedKey, block->hashingBlob());
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            const bool valid = NonceValidator::meetsTarget(pow, target);
+            asio::post(m_io_context, [this, session, id, block, valid, ms] {
+                m_verifyTime.record(ms);
+                if (!valid) {
+                    rejectBlock(session, id, -7, "Block not accepted");
+                    return;
+                }
+                // Otro bloque pudo llegar mientras se verificaba
+                if (!std::equal(m_tip.begin(), m_tip.end(), block->prevId().begin())) {
+                    ++m_counters.staleBlocks;
+                    rejectBlock(session, id, -7, "Block not accepted");
+                    return;
+                }
+                ++m_counters.acceptedBlocks;
+                advance(block->blockId(block->nonce()), true);
+                rpcResult(session, id, nlohmann::json{{"status", "OK"}, {"untrusted", false}});
+            });
+        });
+    }
+
+    void rejectBlock(const std::shared_ptr<Session>& session, const nlohmann::json& id, int code,
+                     const std::string& message) {
+        ++m_counters.rejectedBlocks;
+        ++m_counters.rejectReasons[message];
+        rpcError(session, id, code, message);
+    }
+
+    void rpcResult(const std::shared_ptr<Session>& session, const nlohmann::json& id, const nlohmann::json& result) {
+        respond(session, 200, nlohmann::json{{"id", id}, {"jsonrpc", "2.0"}, {"result", result}}.dump());
+    }
+
+    void rpcError(const std::shared_ptr<Session>& session, const nlohmann::json& id, int code, const std::string& message) {
+        respond(session, 200, nlohmann::json{{"id", id}, {"jsonrpc", "2.0"},
+                                             {"error", {{"code", code}, {"message", message}}}}.dump());
+    }
+
+    // Respuesta HTTP; con --slow-ms/--slow-prob una fracción sale con retraso
+    void respond(const std::shared_ptr<Session>& session, int status, const std::string& body) {
+        std::string message = fmt::format("HTTP/1.1 {} {}\r\nContent-Type: application/json\r\nContent-Length: {}\r\n{}\r\n{}",
+                                          status, status == 200 ? "Ok" : "Not Found", body.size(),
+                                          session->closeAfter ? "Connection: close\r\n" : "", body);
+        auto send = [this, session, message = std::move(message)] {
+            if (!session->open) return;
+            session->outgoing.append(message);
+            session->busy = false;
+            flush(session);
+            process(session);
+        };
+        if (m_settings.slowMs == 0 || !chance(m_settings.slowProb)) {
+            send();
+            return;
+        }
+        ++m_counters.delayedResponses;
+        session->holdTimer.expires_after(std::chrono::milliseconds(m_settings.slowMs));
+        session->holdTimer.async_wait([send = std::move(send)](const boost::system::error_code& ec) {
+            if (!ec) send();
+        });
+    }
+
+    void flush(const std::shared_ptr<Session>& session) {
+        if (!session->open || session->writeInFlight || session->outgoing.empty()) return;
+        session->writing.clear();
+        session->writing.swap(session->outgoing);
+        session->writeInFlight = true;
+        asio::async_write(session->socket, asio::buffer(session->writing),
+            [this, session](const boost::system::error_code& ec, size_t) {
+                session->writeInFlight = false;
+                if (ec) {
+                    close(session);
+                    return;
+                }
+                if (session->closeAfter && session->outgoing.empty()) {
+                    close(session);
+                    return;
+                }
+                flush(session);
+            });
+    }
+
+    void close(const std::shared_ptr<Session>& session) {
+        if (!session->open) return;
+        session->open = false;
+        session->holdTimer.cancel();
+        boost::system::error_code ignored;
+        session->socket.shutdown(tcp::socket::shutdown_both, ignored);
+        session->socket.close(ignored);
+        m_sessions.erase(session);
+    }
+
+    // --- ZMQ (lado PUB) ---
+
+    void acceptZmq() {
+        auto subscriber = std::make_shared<Subscriber>(m_io_context);
+        m_zmqAcceptor.async_accept(subscriber->socket, [this, subscriber](const boost::system::error_code& ec) {
+            if (!m_running || ec == asio::error::operation_aborted) return;
+            if (!ec) {
+                subscriber->open = true;
+                m_subscribers.insert(subscriber);
+                // Saludo + READY (Socket-Type=PUB); después se lee el del suscriptor
+                std::string hello(64, '\0');
+                hello[0] = '\xff';
+                hello[9] = '\x7f';
+                hello[10] = 3;
+                hello.replace(12, 4, "NULL");
+                const std::string ready = std::string("\x05READY\x0bSocket-Type\0\0\0\x03PUB", 24);
+                hello += '\x04';
+                hello += static_cast<char>(ready.size());
+                hello += ready;
+                sendZmq(subscriber, std::move(hello));
+
+                subscriber->in.resize(64);
+                asio::async_read(subscriber->socket, asio::buffer(subscriber->in),
+                    [this, subscriber](const boost::system::error_code& ec, size_t) {
+                        if (ec || subscriber->in[0] != 0xff) {
+                            closeSubscriber(subscriber);
+                            return;
+                        }
+                        readZmqFrame(subscriber);
+                    });
+            }
+            acceptZmq();
+        });
+    }
+
+    void readZmqFrame(const std::shared_ptr<Subscriber>& subscriber) {
+        subscriber->in.resize(2);
+        asio::async_read(subscriber->socket, asio::buffer(subscriber->in),
+            [this, subscriber](const boost::system::error_code& ec, size_t) {
+                // Los suscriptores sólo mandan tramas cortas (READY y suscripciones)
+                if (ec || (subscriber->in[0] & 0x02)) {
+                    closeSubscriber(subscriber);
+                    return;
+                }
+                const uint8_t flags = subscriber->in[0];
+                subscriber->in.resize(subscriber->in[1]);
+                asio::async_read(subscriber->socket, asio::buffer(subscriber->in),
+                    [this, subscriber, flags](const boost::system::error_code& ec, size_t) {
+                        if (ec) {
+                            closeSubscriber(subscriber);
+                            return;
+                        }
+                        if (!(flags & 0x04) && !subscriber->in.empty() && subscriber->in[0] == 0x01) {
+                            subscriber->topic.assign(subscriber->in.begin() + 1, subscriber->in.end());
+                            subscriber->subscribed = std::string_view(ZMQ_TOPIC).starts_with(subscriber->topic);
+                            if (subscriber->subscribed) ++m_counters.zmqSubscriptions;
+                        }
+                        readZmqFrame(subscriber);
+                    });
+            });
+    }
+
+    void publish(const std::string& message) {
+        std::string frame;
+        if (message.size() < 256) {
+            frame += '\x00';
+            frame += static_cast<char>(message.size());
+        } else {
+            frame += '\x02';
+            for (int shift = 56; shift >= 0; shift -= 8) frame += static_cast<char>(message.size() >> shift);
+        }
+        frame += message;
+        for (const auto& subscriber : m_subscribers) {
+            if (!subscriber->subscribed) continue;
+            ++m_counters.zmqPublished;
+            sendZmq(subscriber, frame);
+        }
+    }
+
+    void sendZmq(const std::shared_ptr<Subscriber>& subscriber, std::string data) {
+        subscriber->outgoing.push_back(std::move(data));
+        if (subscriber->outgoing.size() > 1) return;
+        writeZmq(subscriber);
+    }
+
+    void writeZmq(const std::shared_ptr<Subscriber>& subscriber) {
+        asio::async_write(subscriber->socket, asio::buffer(subscriber->outgoing.front()),
+            [this, subscriber](const boost::system::error_code& ec, size_t) {
+                if (ec) {
+                    closeSubscriber(subscriber);
+                    return;
+                }
+                subscriber->outgoing.pop_front();
+                if (!subscriber->outgoing.empty()) writeZmq(subscriber);
+            });
+    }
+
+    void closeSubscriber(const std::shared_ptr<Subscriber>& subscriber) {
+        if (!subscriber->open) return;
+        subscriber->open = false;
+        boost::system::error_code ignored;
+        subscriber->socket.close(ignored);
+        m_subscribers.erase(subscriber);
+    }
+
+    // --- Cadena ---
+
+    void armBlockTimer() {
+        m_blockTimer.expires_after(std::chrono::milliseconds(jittered(m_settings.jobMs, m_settings.jobJitter)));
+        m_blockTimer.async_wait([this](const boost::system::error_code& ec) {
+            if (ec || !m_running) return;
+            ++m_counters.networkBlocks;
+            hash_t id;
+            for (auto& byte : id) byte = static_cast<uint8_t>(m_rng());
+            advance(id, false);
+            armBlockTimer();
+        });
+    }
+
+    void advance(const hash_t& blockId, bool mined) {
+        const std::string prevHex = tipHex();
+        std::copy(blockId.begin(), blockId.end(), m_tip.begin());
+        ++m_height;
+        if (m_settings.seedEvery > 0 && m_height % m_settings.seedEvery == 0) {
+            m_settings.seed = m_nextSeed.empty() ? randomSeed() : m_nextSeed;
+            m_nextSeed.clear();
+            ++m_counters.seedChanges;
+        }
+        m_difficulty = std::max<uint64_t>(1, jittered(m_settings.difficulty, m_settings.diffJitter));
+        m_tipAt = Clock::now();
+        m_tipServed = false;
+
+        publish(fmt::format(R"({}:{{"first_height":{},"first_prev_id":"{}","ids":["{}"]}})",
+                            ZMQ_TOPIC, m_height - 1, prevHex, tipHex()));
+        if (mined) {
+            fmt::print("Bloque {} aceptado en altura {}\n", tipHex(), m_height - 1);
+        }
+    }
+
+    std::string tipHex() const {
+        return zartrux::hex::encode(m_tip.data(), m_tip.size());
+    }
+
+    void armReportTimer() {
+        if (m_settings.reportS == 0) return;
+        m_reportTimer.expires_after(std::chrono::seconds(m_settings.reportS));
+        m_reportTimer.async_wait([this](const boost::system::error_code& ec) {
+            if (ec || !m_running) return;
+            printReport();
+            armReportTimer();
+        });
+    }
+
+    void stopVerifier() {
+        if (!m_verifyThread.joinable()) return;
+        m_verifyContext.stop();
+        m_verifyThread.join();
+        m_hasher.reset();
+    }
+
+    std::string randomSeed() {
+        uint8_t bytes[32];
+        for (auto& byte : bytes) byte = static_cast<uint8_t>(m_rng());
+        return zartrux::hex::encode(bytes, sizeof(bytes));
+    }
+
+    uint64_t jittered(uint64_t value, double jitter) {
+        if (jitter <= 0.0) return value;
+        std::uniform_real_distribution<double> factor(1.0 - jitter, 1.0 + jitter);
+        return static_cast<uint64_t>(static_cast<double>(value) * std::max(0.0, factor(m_rng)));
+    }
+
+    bool chance(double probability) {
+        return probability > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < probability;
+    }
+
+    struct DaemonCounters {
+        uint64_t connections = 0;
+        uint64_t requests = 0;
+        uint64_t heightPolls = 0;
+        uint64_t templates = 0;
+        uint64_t networkBlocks = 0;
+        uint64_t submitted = 0;
+        uint64_t acceptedBlocks = 0;
+        uint64_t rejectedBlocks = 0;
+        uint64_t staleBlocks = 0;
+        uint64_t seedChanges = 0;
+        uint64_t delayedResponses = 0;
+        uint64_t zmqSubscriptions = 0;
+        uint64_t zmqPublished = 0;
+        std::map<std::string, uint64_t> rejectReasons;
+    };
+
+    asio::io_context& m_io_context;
+    Settings m_settings;
+    tcp::acceptor m_acceptor;
+    tcp::acceptor m_zmqAcceptor;
+    asio::steady_timer m_blockTimer;
+    asio::steady_timer m_reportTimer;
+    bool m_running = false;
+    std::mt19937_64 m_rng;
+    Clock::time_point m_startedAt;
+
+    std::unordered_set<std::shared_ptr<Session>> m_sessions;
+    std::unordered_set<std::shared_ptr<Subscriber>> m_subscribers;
+
+    uint32_t m_height = 0;              // altura de la cadena = altura del bloque siguiente
+    hash_t m_tip{};
+    uint64_t m_difficulty = 0;
+    std::string m_nextSeed;
+    Clock::time_point m_tipAt;          // llegada del último bloque
+    bool m_tipServed = false;           // ya se entregó una plantilla sobre esa punta
+
+    asio::io_context m_verifyContext;
+    std::thread m_verifyThread;
+    std::unique_ptr<LightHasher> m_hasher;
+
+    DaemonCounters m_counters;
+    zartrux::LatencyHistogram m_refreshLag;     // bloque nuevo -> primera plantilla pedida sobre él
+    zartrux::LatencyHistogram m_verifyTime;
+};
+
+void MockDaemon::printReport() const {
+    const double elapsed = std::chrono::duration<double>(Clock::now() - m_startedAt).count();
+    const auto lag = m_refreshLag.snapshot();
+    fmt::print("[{:.0f} s] altura {} | bloques de la red {} | plantillas {} | sondeos {} | enviados {}"
+               " aceptados {} rechazados {} (obsoletos {}) | ZMQ {} suscripciones\n",
+               elapsed, m_height, m_counters.networkBlocks, m_counters.templates, m_counters.heightPolls,
+               m_counters.submitted, m_counters.acceptedBlocks, m_counters.rejectedBlocks,
+               m_counters.staleBlocks, m_counters.zmqSubscriptions);
+    fmt::print("    bloque -> plantilla nueva: n={} p50 {:.1f} ms p95 {:.1f} ms p99 {:.1f} ms\n",
+               lag.count, lag.p50Ms, lag.p95Ms, lag.p99Ms);
+}
+
+nlohmann::json MockDaemon::jsonReport() const {
+    auto histogram = [](const zartrux::LatencyHistogram& h) {
+        const auto s = h.snapshot();
+        return nlohmann::json{{"count", s.count}, {"mean_ms", s.meanMs}, {"p50_ms", s.p50Ms},
+                              {"p95_ms", s.p95Ms}, {"p99_ms", s.p99Ms}};
+    };
+    return {
+        {"settings", {
+            {"mode", "daemon"}, {"block_ms", m_settings.jobMs}, {"block_jitter", m_settings.jobJitter},
+            {"seed_every", m_settings.seedEvery}, {"difficulty", m_settings.difficulty},
+            {"diff_jitter", m_settings.diffJitter}, {"rng", m_settings.rng}, {"txs", m_settings.txCount},
+            {"zmq_port", m_settings.zmqPort}, {"slow_ms", m_settings.slowMs}, {"slow_prob", m_settings.slowProb},
+        }},
+        {"elapsed_s", std::chrono::duration<double>(Clock::now() - m_startedAt).count()},
+        {"height", m_height},
+        {"connections", m_counters.connections},
+        {"requests", m_counters.requests},
+        {"height_polls", m_counters.heightPolls},
+        {"templates", m_counters.templates},
+        {"network_blocks", m_counters.networkBlocks},
+        {"submitted", m_counters.submitted},
+        {"accepted_blocks", m_counters.acceptedBlocks},
+        {"rejected_blocks", m_counters.rejectedBlocks},
+        {"stale_blocks", m_counters.staleBlocks},
+        {"reject_reasons", m_counters.rejectReasons},
+        {"seed_changes", m_counters.seedChanges},
+        {"delayed_responses", m_counters.delayedResponses},
+        {"zmq_subscriptions", m_counters.zmqSubscriptions},
+        {"zmq_published", m_counters.zmqPublished},
+        {"template_refresh", histogram(m_refreshLag)},
+        {"verify", histogram(m_verifyTime)},
+    };
+}
+
+Settings parseArguments(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto eq = arg.find('=');
+        const std::string name = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--bind") settings.bind = value;
+        else if (name == "--port") settings.port = static_cast<uint16_t>(std::stoi(value));
+        else if (name == "--job-ms") settings.jobMs = std::max(1, std::stoi(value));
+        else if (name == "--job-jitter") settings.jobJitter = std::clamp(std::stod(value), 0.0, 1.0);
+        else if (name == "--block-every") settings.blockEvery = std::max(1, std::stoi(value));
+        else if (name == "--seed") settings.seed = value;
+        else if (name == "--seed-every") settings.seedEvery = std::max(0, std::stoi(value));
+        else if (name == "--diff") settings.difficulty = std::max<uint64_t>(1, std::stoull(value));
+        else if (name == "--diff-jitter") settings.diffJitter = std::clamp(std::stod(value), 0.0, 1.0);
+        else if (name == "--rng") settings.rng = std::stoull(value);
+        else if (name == "--disconnect-s") settings.disconnectS = std::max(0.0, std::stod(value));
+        else if (name == "--slow-ms") settings.slowMs = std::max(0, std::stoi(value));
+        else if (name == "--slow-prob") settings.slowProb = std::clamp(std::stod(value), 0.0, 1.0);
+        else if (name == "--no-verify") settings.verify = false;
+        else if (name == "--report-s") settings.reportS = std::max(0, std::stoi(value));
+        else if (name == "--duration-s") settings.durationS = std::max(0, std::stoi(value));
+        else if (name == "--json") settings.jsonFile = value;
+        else if (name == "--daemon") settings.daemon = true;
+        else if (name == "--zmq-port") settings.zmqPort = static_cast<uint16_t>(std::stoi(value));
+        else if (name == "--txs") settings.txCount = std::max(0, std::stoi(value));
+        else {
+            fmt::print(stderr, "Opción desconocida: {}\n"
+                       "Uso: zartrux-mockpool [--bind=IP] [--port=N] [--job-ms=M] [--job-jitter=F] [--block-every=N]\n"
+                       "                      [--seed=HEX] [--seed-every=N] [--diff=D] [--diff-jitter=F] [--rng=N]\n"
+                       "                      [--disconnect-s=S] [--slow-ms=M] [--slow-prob=P] [--no-verify]\n"
+                       "                      [--report-s=S] [--duration-s=S] [--json=FICHERO]\n"
+                       "                      [--daemon] [--zmq-port=N] [--txs=N]\n",
+                       arg);
+            std::exit(2);
+        }
+    }
+    return settings;
+}
+
+template <typename Server>
+int run(const Settings& settings) {
+    asio::io_context io_context;
+    Server pool(io_context, settings);
+    try {
+        pool.start();
+    } catch (const std::exception& e) {
+        fmt::print(stderr, "No se pudo arrancar la simulación: {}\n", e.what());
+        return 1;
+    }
+
+    asio::signal_set signals(io_context, SIGINT, SIGTERM);
+    asio::steady_timer deadline(io_context);
+    auto finish = [&] {
+        signals.cancel();
+        deadline.cancel();
+        pool.stop();
+    };
+    signals.async_wait([&](const boost::system::error_code& ec, int) { if (!ec) finish(); });
+    if (settings.durationS > 0) {
+        deadline.expires_after(std::chrono::seconds(settings.durationS));
+        deadline.async_wait([&](const boost::system::error_code& ec) { if (!ec) finish(); });
+    }
+    io_context.run();
+
+    pool.printReport();
+    if (!settings.jsonFile.empty()) {
+        std::ofstream out(settings.jsonFile);
+        out << pool.jsonReport().dump(2) << '\n';
+        fmt::print("Informe JSON escrito en {}\n", settings.jsonFile);
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const Settings settings = parseArguments(argc, argv);
+    return settings.daemon ? run<MockDaemon>(settings) : run<MockPool>(settings);
+}
@@ -0,0 +1,330 @@
+#include "core/Benchmark.h"
+#include "core/hash.h"
+#include "core/threads/JobBlob.h"
+#include "core/threads/WorkerThread.h"
+#include "memory/VirtualMemory.h"
+#include "runtime/Profiler.h"
+#include "utils/Logger.h"
+#include "crypto/randomx/configuration.h"
+#include <randomx.h>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+using json = nlohmann::json;
+using namespace std::chrono;
+
+namespace {
+    // Entradas fijas del benchmark: clave y cabecera de bloque (nonce 0 en los bytes 39..42)
+    // del vector de prueba oficial de RandomX. Cambiarlas invalida KNOWN_CHECKSUMS: subir BENCH_VERSION.
+    constexpr int BENCH_VERSION = 2;
+    const std::string BENCH_SEED = "test key 001";
+    constexpr uint8_t BENCH_BLOB[] = {
+        0x0b, 0x0b, 0x98, 0xbe, 0xa7, 0xe8, 0x05, 0xe0, 0x01, 0x0a, 0x21, 0x26,
+        0xd2, 0x87, 0xa2, 0xa0, 0xcc, 0x83, 0x3d, 0x31, 0x2c, 0xb7, 0x86, 0x38,
+        0x5a, 0x7c, 0x2f, 0x9d, 0xe6, 0x9d, 0x25, 0x53, 0x7f, 0x58, 0x4a, 0x9b,
+        0xc9, 0x97, 0x7b, 0x00, 0x00, 0x00, 0x00, 0x66, 0x6f, 0xd8, 0x75, 0x3b,
+        0xf6, 0x1a, 0x86, 0x31, 0xf1, 0x29, 0x84, 0xe3, 0xfd, 0x44, 0xf4, 0x01,
+        0x4e, 0xca, 0x62, 0x92, 0x76, 0x81, 0x7b, 0x56, 0xf3, 0x2e, 0x9b, 0x68,
+        0xbd, 0x82, 0xf4, 0x16,
+    };
+
+    // XOR esperado de los nonces [0, N), calculado fuera de este código. N = 1 es el hash
+    // publicado con el vector de prueba; cada ejecución lo comprueba con el intérprete.
+    struct KnownChecksum {
+        uint64_t hashes;
+        const char* checksum;
+    };
+    constexpr KnownChecksum KNOWN_CHECKSUMS[] = {
+        {1, "c56414121acda1713c2f2a819d8ae38aed7c80c35c2a769298d34f03833cd5f1"},
+    };
+
+    // Nonces verificados con la VM interpretada (unas decenas de H/s: pocos segundos)
+    constexpr uint64_t SAMPLE_HASHES = 16;
+    constexpr uint64_t MAX_HASHES = uint64_t(1) << 32;     // nonce de Monero de 4 bytes
+    constexpr auto PROGRESS_INTERVAL = seconds(5);
+
+    std::string toHex(const NonceValidator::hash_t& hash) {
+        static constexpr char HEX[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(hash.size() * 2);
+        for (uint8_t byte : hash) {
+            out += HEX[byte >> 4];
+            out += HEX[byte & 0x0F];
+        }
+        return out;
+    }
+
+    const char* memoryModeName(MinerCore::MemoryMode mode) {
+        switch (mode) {
+            case MinerCore::MemoryMode::Full:  return "full";
+            case MinerCore::MemoryMode::Light: return "light";
+            default:                           return "auto";
+        }
+    }
+
+    uint64_t parseCount(const std::string& option, const std::string& value) {
+        size_t used = 0;
+        uint64_t count = 0;
+        try {
+            count = std::stoull(value, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used == 0 || used != value.size()) {
+            throw std::invalid_argument(option + ": valor no numérico '" + value + "'");
+        }
+        return count;
+    }
+}
+
+std::optional<Benchmark::Options> Benchmark::parseArguments(int argc, char* argv[]) {
+    std::optional<Options> options;
+    Options parsed;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto eq = arg.find('=');
+        const std::string name = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        if (name == "--bench") {
+            parsed.hashes = parseCount(name, value);
+            if (parsed.hashes == 0 || parsed.hashes > MAX_HASHES) {
+                throw std::invalid_argument("--bench: N debe estar entre 1 y 2^32");
+            }
+            options = parsed;
+        } else if (name == "--bench-mode") {
+            if (value == "full") parsed.memoryMode = MinerCore::MemoryMode::Full;
+            else if (value == "light") parsed.memoryMode = MinerCore::MemoryMode::Light;
+            else if (value == "auto") parsed.memoryMode = MinerCore::MemoryMode::Auto;
+            else throw std::invalid_argument("--bench-mode: se espera full, light o auto");
+        } else if (name == "--bench-threads") {
+            parsed.threads = static_cast<unsigned>(parseCount(name, value));
+        } else if (name == "--bench-out") {
+            parsed.resultFile = value;
+        }
+    }
+    // Las opciones pueden ir antes o después de --bench=N
+    if (options) {
+        parsed.hashes = options->hashes;
+        options = parsed;
+    }
+    return options;
+}
+
+Benchmark::Benchmark(Options options, MinerCore::MiningConfig mining)
+    : m_options(std::move(options))
+    , m_mining(std::move(mining))
+{
+    // Entradas fijas: nonce estándar de Monero y sin prefijo de NiceHash
+    m_mining.seed = BENCH_SEED;
+    m_mining.mode = "benchmark";
+    m_mining.noncePosition = 39;
+    m_mining.nonceSize = 4;
+    m_mining.nonceEndianness = NonceValidator::Endianness::LITTLE;
+    m_mining.niceHash = false;
+    if (m_options.memoryMode) m_mining.memoryMode = *m_options.memoryMode;
+    if (m_options.threads) m_mining.threadCount = m_options.threads;
+}
+
+std::vector<uint8_t> Benchmark::referenceBlob() {
+    // El nonce (bytes 39..42) lo sobrescriben los workers
+    return std::vector<uint8_t>(std::begin(BENCH_BLOB), std::end(BENCH_BLOB));
+}
+
+NonceValidator::hash_t Benchmark::interpretedChecksum(uint64_t count) const {
+    NonceValidator::hash_t checksum{};
+    const auto epoch = core::RandomXContext::getInstance().currentEpoch();
+    if (!epoch || count == 0) return checksum;
+
+    zartrux::VirtualMemory::AllocationOptions options;
+    options.label = "bench-scratchpad";
+    const auto scratchpad = zartrux::VirtualMemory::allocate(RANDOMX_SCRATCHPAD_L3_MAX_SIZE, options);
+    if (!scratchpad) throw std::runtime_error("sin memoria para el scratchpad de verificación");
+
+    // Camino más simple de la librería: comparte con los workers sólo la cache
+    randomx_vm* vm = randomx_create_vm(RANDOMX_FLAG_DEFAULT, epoch->cache(), nullptr,
+                                       static_cast<uint8_t*>(scratchpad.ptr), 0);
+    if (!vm) {
+        zartrux::VirtualMemory::release(scratchpad.ptr);
+        throw std::runtime_error("no se pudo crear la VM interpretada");
+    }
+    std::vector<uint8_t> blob = referenceBlob();
+    NonceValidator::hash_t hash;
+    for (uint64_t nonce = 0; nonce < count; ++nonce) {
+        MoneroNonceLayout::write(blob.data(), nonce);
+        randomx_calculate_hash(vm, blob.data(), blob.size(), hash.data());
+        for (size_t i = 0; i < hash.size(); ++i) checksum[i] ^= hash[i];
+    }
+    randomx_destroy_vm(vm);
+    zartrux::VirtualMemory::release(scratchpad.ptr);
+    return checksum;
+}
+
+Benchmark::ReferenceStatus Benchmark::checkReference(uint64_t hashes, const std::string& checksum) {
+    for (const auto& known : KNOWN_CHECKSUMS) {
+        if (known.hashes == hashes) {
+            return checksum == known.checksum ? ReferenceStatus::Match : ReferenceStatus::Mismatch;
+        }
+    }
+    return ReferenceStatus::Missing;
+}
+
+int Benchmark::run() {
+    const uint64_t hashes = m_options.hashes;
+    Logger::info("Benchmark", fmt::format("Benchmark offline: {} hashes, modo {}, semilla fija v{}",
+                 hashes, memoryModeName(m_mining.memoryMode), BENCH_VERSION));
+
+    auto state = std::make_shared<WorkerThread::BenchmarkState>();
+    state->hashLimit = hashes;
+    state->sampleLimit = std::min(hashes, SAMPLE_HASHES);
+
+    auto jobManager = std::make_shared<JobManager>();
+    MinerCore miner(jobManager, m_mining.threadCount);
+    miner.setBenchmark(state);
+
+    const auto initStart = steady_clock::now();
+    if (!miner.initialize(m_mining)) {
+        Logger::error("Benchmark", "No se pudo inicializar el minero");
+        return EXIT_FAILED;
+    }
+    const uint64_t initMs = static_cast<uint64_t>(
+        duration_cast<milliseconds>(steady_clock::now() - initStart).count());
+    const unsigned threads = miner.getNumThreads();
+
+    // Objetivo 0: ningún hash es share, así que no se envía nada
+    jobManager->setJob(referenceBlob(), "bench", 0, 0);
+    const auto start = steady_clock::now();
+    miner.startMining();
+
+    auto nextProgress = start + PROGRESS_INTERVAL;
+    while (state->finished.load(std::memory_order_acquire) < threads) {
+        std::this_thread::sleep_for(milliseconds(100));
+        if (steady_clock::now() >= nextProgress) {
+            const uint64_t taken = std::min(state->nextNonce.load(std::memory_order_relaxed), hashes);
+            Logger::info("Benchmark", fmt::format("{:.1f}% de los nonces repartidos", 100.0 * taken / hashes));
+            nextProgress += PROGRESS_INTERVAL;
+        }
+    }
+    const double elapsed = duration<double>(steady_clock::now() - start).count();
+    miner.stopMining();
+
+    uint64_t done = 0;
+    bool failed = false;
+    std::sort(state->threads.begin(), state->threads.end(),
+              [](const auto& a, const auto& b) { return a.id < b.id; });
+    for (const auto& t : state->threads) {
+        done += t.hashes;
+        failed |= t.failed;
+    }
+    const bool completed = done == hashes && !failed;
+
+    // Verificación: el intérprete contra el vector oficial, los workers contra el intérprete
+    // y, si N tiene valor conocido, el checksum total contra él
+    const std::string checksum = toHex(state->checksum);
+    const std::string sampleChecksum = toHex(state->sampleChecksum);
+    std::string interpreted;
+    ReferenceStatus knownAnswer = ReferenceStatus::Missing;
+    try {
+        interpreted = toHex(interpretedChecksum(state->sampleLimit));
+        knownAnswer = checkReference(1, toHex(interpretedChecksum(1)));
+    } catch (const std::exception& ex) {
+        Logger::error("Benchmark", fmt::format("Verificación con el intérprete fallida: {}", ex.what()));
+    }
+    const bool sampleOk = !interpreted.empty() && interpreted == sampleChecksum &&
+                          knownAnswer == ReferenceStatus::Match;
+    const ReferenceStatus reference = completed
+        ? checkReference(hashes, checksum)
+        : ReferenceStatus::Missing;
+
+    const auto epoch = core::RandomXContext::getInstance().currentEpoch();
+    const core::BuildTimings timings = epoch ? epoch->timings() : core::BuildTimings{};
+    const auto& plan = miner.getMemoryPlan();
+    const auto system = zartrux::runtime::Profiler::getSystemInfo();
+    const double totalRate = elapsed > 0 ? hashes / elapsed : 0.0;
+
+    // Informe por consola
+    fmt::print("\nzartrux-miner benchmark v{} ({})\n", BENCH_VERSION, system.cpuName);
+    fmt::print("  hashes: {}  hilos: {} x {} vías  modo: {}\n", done, threads, miner.getHashWays(),
+               plan.fullMemory ? "full" : "light");
+    fmt::print("  dataset: {} ms (argon2 {} ms, programas {} ms, prefault {} ms, items {} ms, {} hilos{})\n",
+               timings.totalMs, timings.argonMs, timings.programsMs, timings.prefaultMs, timings.itemsMs,
+               timings.threads, timings.jitInit ? ", init JIT" : "");
+    fmt::print("  inicialización total: {} ms\n", initMs);
+    json threadResults = json::array();
+    for (const auto& t : state->threads) {
+        const double rate = t.seconds > 0 ? t.hashes / t.seconds : 0.0;
+        fmt::print("  hilo {:>3}: {:>10.2f} H/s ({} hashes){}\n", t.id, rate, t.hashes, t.failed ? " ERROR" : "");
+        threadResults.push_back({{"id", t.id}, {"hashes", t.hashes}, {"seconds", t.seconds},
+                                 {"hashrate", rate}, {"failed", t.failed}});
+    }
+    fmt::print("  total: {:.2f} H/s en {:.2f} s\n", totalRate, elapsed);
+
+    json memory = json::array();
+    for (const auto& r : zartrux::VirtualMemory::report()) {
+        if (r.allocation.size < (size_t(2) << 20)) continue;
+        fmt::print("  {}: {} MB en {} ({:.1f}% páginas grandes)\n", r.label, r.allocation.size >> 20,
+                   zartrux::VirtualMemory::pageKindName(r.allocation.kind), r.coverage.fraction() * 100.0);
+        memory.push_back({{"label", r.label}, {"size_mb", r.allocation.size >> 20},
+                          {"pages", zartrux::VirtualMemory::pageKindName(r.allocation.kind)},
+                          {"huge_coverage", r.coverage.fraction()}});
+    }
+
+    static constexpr const char* REFERENCE_NAMES[] = {"match", "mismatch", "missing"};
+    const char* referenceName = REFERENCE_NAMES[static_cast<int>(reference)];
+    fmt::print("  checksum: {}\n", checksum);
+    fmt::print("  intérprete ({} nonces, vector oficial {}): {}\n", state->sampleLimit,
+               REFERENCE_NAMES[static_cast<int>(knownAnswer)], sampleOk ? "OK" : "DISTINTO");
+    fmt::print("  referencia para N = {}: {}\n", hashes, referenceName);
+
+    const json result = {
+        {"version", BENCH_VERSION},
+        {"cpu", system.cpuName},
+        {"hashes", hashes},
+        {"completed_hashes", done},
+        {"threads", threads},
+        {"hash_ways", miner.getHashWays()},
+        {"memory_mode", plan.fullMemory ? "full" : "light"},
+        {"seconds", elapsed},
+        {"hashrate", totalRate},
+        {"per_thread", threadResults},
+        {"init_ms", initMs},
+        {"dataset_build", {
+            {"argon2_ms", timings.argonMs},
+            {"programs_ms", timings.programsMs},
+            {"alloc_ms", timings.allocMs},
+            {"prefault_ms", timings.prefaultMs},
+            {"items_ms", timings.itemsMs},
+            {"total_ms", timings.totalMs},
+            {"threads", timings.threads},
+            {"jit_init", timings.jitInit}
+        }},
+        {"memory", memory},
+        {"checksum", checksum},
+        {"sample_hashes", state->sampleLimit},
+        {"sample_verified", sampleOk},
+        {"known_answer", REFERENCE_NAMES[static_cast<int>(knownAnswer)]},
+        {"reference", referenceName}
+    };
+    std::ofstream out(m_options.resultFile);
+    if (out) {
+        out << result.dump(2) << '\n';
+    } else {
+        Logger::warn("Benchmark", fmt::format("No se pudo escribir {}", m_options.resultFile));
+    }
+
+    if (!completed) {
+        Logger::error("Benchmark", fmt::format("Benchmark incompleto: {} de {} hashes", done, hashes));
+        return EXIT_FAILED;
+    }
+    if (!sampleOk || reference == ReferenceStatus::Mismatch) {
+        Logger::error("Benchmark", "Checksum incorrecto: posible fallo de compilación o de hardware");
+        return EXIT_MISMATCH;
+    }
+    return EXIT_OK;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/MinerCore.h"
+#include "core/NonceValidator.h"
+
+/**
+ * @class Benchmark
+ * @brief Benchmark offline reproducible (`zartrux-miner --bench=N`): semilla y blob fijos, sin red.
+ *
+ * Ejecuta el pipeline real de minado (MinerCore, workers N-vías, dataset o cache) sobre los
+ * nonces [0, N) y calcula el XOR de todos los hashes. Ese checksum no depende del número de
+ * hilos ni de vías, así que sirve para calificar hardware nuevo y comparar builds:
+ *  - la semilla y el blob son los del vector de prueba oficial de RandomX, así que el hash
+ *    del nonce 0 se conoce de antemano y la VM interpretada (sin JIT, AES por software,
+ *    sin dataset) debe reproducirlo;
+ *  - los primeros nonces se recalculan con esa VM y su XOR parcial debe coincidir con el de
+ *    los workers;
+ *  - si N tiene checksum conocido (KNOWN_CHECKSUMS), el total se compara con él. Nunca se
+ *    toma como referencia un valor calculado por el propio binario.
+ */
+class Benchmark {
+public:
+    struct Options {
+        uint64_t hashes = 0;
+        std::optional<MinerCore::MemoryMode> memoryMode;   // sin valor: el de la configuración
+        unsigned threads = 0;                               // 0 = el de la configuración
+        std::string resultFile = "bench_result.json";
+    };
+
+    // Códigos de salida del proceso
+    static constexpr int EXIT_OK = 0;
+    static constexpr int EXIT_FAILED = 1;       // no se pudo completar el benchmark
+    static constexpr int EXIT_MISMATCH = 2;     // checksum distinto del conocido o del intérprete
+
+    /**
+     * @brief Lee --bench=N y sus opciones de la línea de comandos.
+     * @return nullopt si no se pidió benchmark.
+     * @throws std::invalid_argument si algún valor no es válido.
+     */
+    static std::optional<Options> parseArguments(int argc, char* argv[]);
+
+    /**
+     * @param mining Configuración de minado habitual; semilla, nonce y modo se fijan aquí.
+     */
+    Benchmark(Options options, MinerCore::MiningConfig mining);
+
+    /**
+     * @brief Ejecuta el benchmark, imprime el informe y escribe el JSON de resultado.
+     * @return Código de salida (EXIT_OK, EXIT_FAILED o EXIT_MISMATCH).
+     */
+    int run();
+
+private:
+    enum class ReferenceStatus { Match, Mismatch, Missing };
+
+    // Blob de 76 bytes de la cabecera de referencia con el nonce en la posición de Monero
+    static std::vector<uint8_t> referenceBlob();
+    // XOR de los hashes de los nonces [0, count) con una VM interpretada sobre la cache
+    NonceValidator::hash_t interpretedChecksum(uint64_t count) const;
+    // Compara con el checksum conocido para [0, hashes); Missing si no hay ninguno
+    static ReferenceStatus checkReference(uint64_t hashes, const std::string& checksum);
+
+    Options m_options;
+    MinerCore::MiningConfig m_mining;
+};
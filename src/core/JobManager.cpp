@@ -6,6 +6,15 @@
 #include <iostream>
 #include <cstring>
 #include "utils/Logger.h"
+#include "core/hash.h"
+#include "core/SmartCache.h"
+
+namespace {
+    // El checkpoint no guarda el trabajo: al arrancar ya está obsoleto y el pool manda uno
+    // nuevo al conectar. Sólo se conservan la época y el contador de nonces.
+    constexpr uint32_t CHECKPOINT_MAGIC = 0x4b434a5a;   // "ZJCK"
+    constexpr uint32_t CHECKPOINT_VERSION = 2;
+}
 
 JobManager::JobManager()
     : m_iaEndpoint("")
@@ -30,33 +39,96 @@ void JobManager::stop() {
     m_cv.notify_all();
 }
 
+std::shared_ptr<const JobManager::Job> JobManager::getCurrentJob() const {
+    return m_currentJob.load(std::memory_order_acquire);
+}
+
+bool JobManager::waitForJob(uint64_t knownEpoch, const std::atomic<bool>& running,
+                            std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(m_jobWaitMutex);
+    m_jobCv.wait_for(lock, timeout, [&] {
+        return m_jobEpoch.load(std::memory_order_acquire) != knownEpoch || !running.load();
+    });
+    return m_jobEpoch.load(std::memory_order_acquire) != knownEpoch;
+}
+
+void JobManager::wakeWaiters() const {
+    // Tomar el mutex evita perder la señal entre la comprobación del predicado y la espera
+    { std::lock_guard<std::mutex> lock(m_jobWaitMutex); }
+    m_jobCv.notify_all();
+}
+
 std::vector<uint8_t> JobManager::getCurrentBlob() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_currentJob.blob;
+    auto job = getCurrentJob();
+    return job ? job->blob : std::vector<uint8_t>{};
 }
 
 uint64_t JobManager::getCurrentTarget() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_currentJob.target;
+    auto job = getCurrentJob();
+    return job ? job->target : 0;
 }
 
 std::string JobManager::getCurrentJobId() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_currentJob.jobId;
+    auto job = getCurrentJob();
+    return job ? job->jobId : std::string{};
 }
 
 uint32_t JobManager::getCurrentHeight() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_currentJob.height;
+    auto job = getCurrentJob();
+    return job ? job->height : 0;
 }
 
 void JobManager::setJob(const std::vector<uint8_t>& blob, const std::string& jobId, uint64_t target, uint32_t height) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_currentJob.blob = blob;
-    m_currentJob.jobId = jobId;
-    m_currentJob.target = target;
-    m_currentJob.height = height;
-    
+    auto shareTarget = NonceValidator::ShareTarget::fromCompact(target);
+    publishJob(blob, jobId, target, shareTarget, height);
+}
+
+void JobManager::setJob(const std::vector<uint8_t>& blob, const std::string& jobId,
+                        const NonceValidator::ShareTarget& shareTarget, uint32_t height) {
+    publishJob(blob, jobId, shareTarget.high, shareTarget, height);
+}
+
+void JobManager::setJob(const MiningJob& job) {
+    publishJob(job.blobBytes(), job.id, job.target.high, job.target, job.height);
+}
+
+void JobManager::setSeedHash(const std::string& seedHash, const std::string& nextSeedHash) {
+    auto& rx = core::RandomXContext::getInstance();
+    auto key = core::seedKeyFromString(seedHash);
+    // Primer trabajo de una semilla nueva sin preparar: se construye ya; los hilos esperan
+    // a ella al recibir el trabajo, pero la construcción no bloquea al hilo de red.
+    if (!key.empty()) rx.prepare(key);
+    if (!nextSeedHash.empty() && nextSeedHash != seedHash) {
+        rx.prepare(core::seedKeyFromString(nextSeedHash));
+    }
+
+    std::lock_guard<std::mutex> lock(m_jobWaitMutex);
+    m_seedKey = std::move(key);
+}
+
+void JobManager::publishJob(std::span<const uint8_t> blob, const std::string& jobId, uint64_t target,
+                            const NonceValidator::ShareTarget& shareTarget, uint32_t height) {
+    auto job = std::make_shared<Job>();
+    job->blob.assign(blob.begin(), blob.end());
+    job->jobId = jobId;
+    job->target = target;
+    job->height = height;
+    job->shareTarget = shareTarget;
+    job->receivedAt = std::chrono::steady_clock::now();
+
+    // El prefijo de nonces debe estar vigente antes de que los workers vean la nueva época
+    m_nonceAllocator.onNewJob(blob);
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobWaitMutex);
+        job->seedKey = m_seedKey;
+        job->epoch = m_jobEpoch.load(std::memory_order_relaxed) + 1;
+        const uint64_t epoch = job->epoch;
+        m_currentJob.store(std::move(job), std::memory_order_release);
+        m_jobEpoch.store(epoch, std::memory_order_release);
+    }
+    m_jobCv.notify_all();
+
     saveCheckpoint();
 }
 
@@ -88,8 +160,9 @@ void JobManager::injectIANonces(const std::vector<uint32_t>& nonces) {
         m_iaQueue = std::queue<Nonce>();
     }
     
+    const std::string jobId = getCurrentJobId();
     for (uint32_t nonce : nonces) {
-        m_iaQueue.push({nonce, m_currentJob.jobId});
+        m_iaQueue.push({nonce, jobId});
     }
     m_iaContributed += nonces.size();
     
@@ -152,26 +225,23 @@ void JobManager::loadCheckpoint() {
         std::ifstream file("checkpoint.dat", std::ios::binary);
         if (!file) return;
 
-        // Read checkpoint data
-        std::vector<uint8_t> blob;
-        std::string jobId;
-        uint64_t target;
-        uint32_t height;
-
-        size_t blobSize;
-        file.read(reinterpret_cast<char*>(&blobSize), sizeof(blobSize));
-        blob.resize(blobSize);
-        file.read(reinterpret_cast<char*>(blob.data()), blobSize);
-
-        size_t jobIdSize;
-        file.read(reinterpret_cast<char*>(&jobIdSize), sizeof(jobIdSize));
-        jobId.resize(jobIdSize);
-        file.read(&jobId[0], jobIdSize);
-
-        file.read(reinterpret_cast<char*>(&target), sizeof(target));
-        file.read(reinterpret_cast<char*>(&height), sizeof(height));
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t epoch = 0;
+        uint64_t nextNonce = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        file.read(reinterpret_cast<char*>(&epoch), sizeof(epoch));
+        file.read(reinterpret_cast<char*>(&nextNonce), sizeof(nextNonce));
+        if (!file || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION) {
+            Logger::warn("Ignoring checkpoint with unknown format");
+            return;
+        }
 
-        setJob(blob, jobId, target, height);
+        // No se publica trabajo: los workers ven la época sin trabajo y esperan al del pool,
+        // que la continúa en epoch + 1
+        m_jobEpoch.store(epoch, std::memory_order_release);
+        SmartCache::getInstance().restoreNextNonce(nextNonce);
     }
     catch (const std::exception& e) {
         Logger::error("Error loading checkpoint: " + std::string(e.what()));
@@ -183,30 +253,35 @@ void JobManager::saveCheckpoint() {
         std::ofstream file("checkpoint.dat", std::ios::binary);
         if (!file) return;
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        // Write current job data
-        size_t blobSize = m_currentJob.blob.size();
-        file.write(reinterpret_cast<const char*>(&blobSize), sizeof(blobSize));
-        file.write(reinterpret_cast<const char*>(m_currentJob.blob.data()), blobSize);
-
-        size_t jobIdSize = m_currentJob.jobId.size();
-        file.write(reinterpret_cast<const char*>(&jobIdSize), sizeof(jobIdSize));
-        file.write(m_currentJob.jobId.c_str(), jobIdSize);
-
-        file.write(reinterpret_cast<const char*>(&m_currentJob.target), sizeof(m_currentJob.target));
-        file.write(reinterpret_cast<const char*>(&m_currentJob.height), sizeof(m_currentJob.height));
+        const uint64_t epoch = m_jobEpoch.load(std::memory_order_acquire);
+        const uint64_t nextNonce = SmartCache::getInstance().nextNonce();
+        file.write(reinterpret_cast<const char*>(&CHECKPOINT_MAGIC), sizeof(CHECKPOINT_MAGIC));
+        file.write(reinterpret_cast<const char*>(&CHECKPOINT_VERSION), sizeof(CHECKPOINT_VERSION));
+        file.write(reinterpret_cast<const char*>(&epoch), sizeof(epoch));
+        file.write(reinterpret_cast<const char*>(&nextNonce), sizeof(nextNonce));
     }
     catch (const std::exception& e) {
         Logger::error("Error saving checkpoint: " + std::string(e.what()));
     }
 }
 
-void JobManager::submitValidNonce(uint32_t nonce, const std::string& jobId) {
+void JobManager::submitValidNonce(uint64_t nonce, const std::string& jobId) {
     // Implement nonce submission logic here
     Logger::info("Valid nonce found: " + std::to_string(nonce) + " for job: " + jobId);
 }
 
+void JobManager::setSolutionHandler(SolutionHandler handler) {
+    m_solutionHandler = std::move(handler);
+}
+
+void JobManager::submitSolution(const Job& job, uint64_t nonce, const NonceValidator::hash_t& hash) {
+    if (m_solutionHandler) {
+        m_solutionHandler(job, nonce, hash);
+        return;
+    }
+    submitValidNonce(nonce, job.jobId);
+}
+
 void JobManager::fetchIANoncesBackground() {
     while (m_running) {
         if (!m_iaEndpoint.empty()) {
@@ -225,7 +300,8 @@ void JobManager::fetchIANoncesBackground() {
 void JobManager::submitNonce(uint32_t nonce) {
     if (!m_running) return;
 
+    const std::string jobId = getCurrentJobId();
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_cpuQueue.push({nonce, m_currentJob.jobId});
+    m_cpuQueue.push({nonce, jobId});
     m_cv.notify_one();
 }
\ No newline at end of file
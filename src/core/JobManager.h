@@ -1,23 +1,56 @@
 #pragma once
 
+#include <array>
+#include <span>
 #include <vector>
 #include <string>
 #include <mutex>
 #include <queue>
 #include <condition_variable>
 #include <atomic>
+#include <memory>
+#include <chrono>
+#include <functional>
 #include "utils/StatusExporter.h"
+#include "core/NonceAllocator.h"
+#include "core/NonceValidator.h"
+
+/**
+ * Notificación de trabajo del pool ya decodificada (StratumParser): blob y target llegan en
+ * binario, así que JobManager publica el trabajo sin volver a pasar por hex.
+ * StratumClient reutiliza la misma instancia en cada mensaje.
+ */
+struct MiningJob {
+    static constexpr size_t MAX_BLOB_SIZE = 256;       // igual que JobBlob::MAX_SIZE
+
+    alignas(64) std::array<uint8_t, MAX_BLOB_SIZE> blob{};
+    size_t blobSize = 0;
+    std::string id;
+    NonceValidator::ShareTarget target;
+    std::string targetHex;          // tal cual lo mandó el pool (el proxy lo reenvía a los rigs)
+    uint32_t height = 0;
+    // La semilla siguiente se anuncia antes de la frontera de época para preparar el dataset
+    std::string seedHash;
+    std::string nextSeedHash;
+
+    std::span<const uint8_t> blobBytes() const { return {blob.data(), blobSize}; }
+};
 
 class JobManager {
 public:
     static constexpr size_t MAX_QUEUE_SIZE = 1000;
     static constexpr size_t LOG_ROTATE_EVERY = 100;
 
+    // Instantánea inmutable de un trabajo: se publica una vez y nunca se modifica
     struct Job {
         std::vector<uint8_t> blob;
         std::string jobId;
         uint64_t target;
         uint32_t height;
+        NonceValidator::ShareTarget shareTarget;           // target decodificado una sola vez
+        std::vector<uint8_t> seedKey;                      // clave RandomX (vacía: la época actual)
+        uint64_t epoch = 0;                                // época de publicación (1, 2, ...)
+        std::chrono::steady_clock::time_point receivedAt;  // llegada de la notificación
     };
 
     struct Nonce {
@@ -31,6 +64,21 @@ public:
     void start();
     void stop();
 
+    // Publicación de trabajos sin locks: los workers leen la época con una carga
+    // relajada y sólo recargan la instantánea cuando cambia.
+    std::shared_ptr<const Job> getCurrentJob() const;
+    uint64_t jobEpoch() const { return m_jobEpoch.load(std::memory_order_relaxed); }
+    // Bloquea (futex/condvar, sin sondeo) hasta que la época difiera de knownEpoch,
+    // running pase a false o venza el timeout. Devuelve true si hay época nueva.
+    bool waitForJob(uint64_t knownEpoch, const std::atomic<bool>& running,
+                    std::chrono::milliseconds timeout) const;
+    // Despierta a los hilos bloqueados en waitForJob (p. ej. al detenerlos)
+    void wakeWaiters() const;
+
+    // Semilla de RandomX de los trabajos siguientes (seed_hash del pool). El next_seed_hash
+    // anunciado se prepara en segundo plano para cambiar de época sin detener el minado.
+    void setSeedHash(const std::string& seedHash, const std::string& nextSeedHash = std::string());
+
     // Getters
     std::vector<uint8_t> getCurrentBlob() const;
     uint64_t getCurrentTarget() const;
@@ -38,9 +86,26 @@ public:
     uint32_t getCurrentHeight() const;
 
     // Job management
+    // target: objetivo compacto del pool (4 u 8 bytes, ver ShareTarget::fromCompact)
     void setJob(const std::vector<uint8_t>& blob, const std::string& jobId, uint64_t target, uint32_t height);
+    // Variante con umbral ya decodificado (objetivos hex de 256 bits o de bloque en solo)
+    void setJob(const std::vector<uint8_t>& blob, const std::string& jobId,
+                const NonceValidator::ShareTarget& shareTarget, uint32_t height);
+    // Trabajo decodificado por StratumClient; la semilla se fija aparte con setSeedHash
+    void setJob(const MiningJob& job);
     void submitNonce(uint32_t nonce);
 
+    // Destino de los nonces que cumplen el objetivo del trabajo (envío al nodo en solitario).
+    // Se fija antes de arrancar los workers; sin destino sólo se registran en el log.
+    // El nonce llega completo (hasta 8 bytes, según el NonceLayout del worker).
+    using SolutionHandler = std::function<void(const Job& job, uint64_t nonce, const NonceValidator::hash_t& hash)>;
+    void setSolutionHandler(SolutionHandler handler);
+    // La llaman los workers al acertar; el destino debe volver enseguida (sólo encolar)
+    void submitSolution(const Job& job, uint64_t nonce, const NonceValidator::hash_t& hash);
+
+    // Reparto del espacio de nonces entre workers (bloques por hilo + región IA)
+    NonceAllocator& nonceAllocator() { return m_nonceAllocator; }
+
     // AI/IA related functions
     void setAIContribution(float contribution);
     float getAIContribution() const;
@@ -50,17 +115,25 @@ public:
     void processNonces();
 
 private:
+    void publishJob(std::span<const uint8_t> blob, const std::string& jobId, uint64_t target,
+                    const NonceValidator::ShareTarget& shareTarget, uint32_t height);
+    // Checkpoint de época y contador de nonces; nunca restaura un trabajo
     void loadCheckpoint();
     void saveCheckpoint();
-    void submitValidNonce(uint32_t nonce, const std::string& jobId);
+    void submitValidNonce(uint64_t nonce, const std::string& jobId);
     void fetchIANoncesBackground();
 
     mutable std::mutex m_mutex;
     std::condition_variable m_cv;
 
-    // Current job data
-    Job m_currentJob;
+    // Current job data: instantánea publicada atómicamente + época en su propia línea de caché
+    std::atomic<std::shared_ptr<const Job>> m_currentJob;
+    alignas(64) std::atomic<uint64_t> m_jobEpoch{0};
+    alignas(64) mutable std::mutex m_jobWaitMutex;   // sólo lo usan publicadores y hilos en espera
+    mutable std::condition_variable m_jobCv;
+    std::vector<uint8_t> m_seedKey;                  // protegido por m_jobWaitMutex
     std::atomic<bool> m_running{false};
+    SolutionHandler m_solutionHandler;
 
     // Queues and counters
     std::queue<Nonce> m_cpuQueue;
@@ -74,6 +147,8 @@ private:
     std::string m_iaEndpoint;
     float m_aiContribution{0.0f};
 
+    NonceAllocator m_nonceAllocator;
+
     // Status exporter
     StatusExporter m_statusExporter;
 };
\ No newline at end of file
@@ -5,11 +5,17 @@
 #include "utils/StatusExporter.h"
 #include "zarbackend/WebsocketBackend.h"  // Suponiendo módulo WebSocket para zarbackend
 #include "ia/IAReceiver.h"
+#include "memory/VirtualMemory.h"
+#include "memory/NumaTopology.h"
+#include "crypto/randomx/configuration.h"
 #include <fstream>
 #include <sstream>
 #include <csignal>
 #include <thread>
 #include <iomanip>
+#include <algorithm>
+#include <map>
+#include <fmt/format.h>
 #ifdef __linux__
 #include <pthread.h>
 #include <sched.h>
@@ -19,6 +25,20 @@ using namespace std::chrono;
 
 namespace {
     const std::string CHECKPOINT_FILE = "miner_checkpoint.json";
+
+    // Cada vía recibe el scratchpad máximo, alineado a página grande
+    constexpr size_t SCRATCHPAD_STRIDE = RANDOMX_SCRATCHPAD_L3_MAX_SIZE;
+    constexpr unsigned CANDIDATE_WAYS[] = {1, 2, 4};
+    constexpr auto WAYS_BENCHMARK_TIME = std::chrono::milliseconds(1500);
+
+    // Estimaciones para el planificador de memoria
+    constexpr size_t JIT_BYTES_PER_VM = 4 * 64 * 1024;          // CodeSize x4 con init AVX2
+    constexpr size_t THREAD_OVERHEAD = size_t(1) << 20;          // pila, métricas, colas del hilo
+    constexpr size_t PROCESS_OVERHEAD = size_t(128) << 20;       // IA, red, colas de shares, pool de VMs
+    constexpr double LIGHT_RELATIVE_SPEED = 0.15;                // H/s por hilo ligero frente a completo
+    constexpr unsigned PRESSURE_SAMPLES = 3;                     // muestras seguidas antes de degradar
+    constexpr unsigned LIGHT_MODE_ATTEMPTS = 2;                  // reconstrucciones en ligero antes de restaurar
+    constexpr unsigned MAX_DOWNGRADE_FAILURES = 3;               // después se deja de degradar automáticamente
 }
 
 MinerCore::MinerCore(std::shared_ptr<JobManager> jobManager, unsigned threadCount)
@@ -38,59 +58,374 @@ MinerCore::~MinerCore() {
     stopMining();
     cleanupWorkers();
     cleanupRandomX();
+    core::RandomXContext::getInstance().setProgressCallback(nullptr);
     saveCheckpoint();
 }
 
 void MinerCore::cleanupRandomX() {
-    for (auto vm : m_workerVMs) {
-        if (vm) randomx_destroy_vm(vm);
+    for (auto& vms : m_workerVMs) {
+        for (auto vm : vms) {
+            if (vm) randomx_destroy_vm(vm);
+        }
     }
     m_workerVMs.clear();
-    if (m_rxCache) {
-        randomx_release_cache(m_rxCache);
-        m_rxCache = nullptr;
+    for (auto& block : m_scratchpads) {
+        zartrux::VirtualMemory::release(block.memory);
+    }
+    m_scratchpads.clear();
+}
+
+bool MinerCore::createWorkerVMs(unsigned ways) {
+    cleanupRandomX();
+
+    auto& ctx = core::RandomXContext::getInstance();
+    const auto& rx = ctx.getConfig();
+    const randomx_flags vmFlags = rx.fullMemory
+        ? static_cast<randomx_flags>(rx.flags | RANDOMX_FLAG_FULL_MEM)
+        : rx.flags;
+    planThreadPlacement();
+
+    unsigned hugeBlocks = 0;
+    for (unsigned i = 0; i < m_numThreads; ++i) {
+        const uint32_t node = m_workerNodes[i];
+        randomx_dataset* dataset = rx.fullMemory ? ctx.dataset(node) : nullptr;
+
+        zartrux::VirtualMemory::AllocationOptions options;
+        options.label = "scratchpad";
+        options.lock = rx.lockMemory;
+        const auto allocation = zartrux::VirtualMemory::allocate(SCRATCHPAD_STRIDE * ways, options);
+        if (!allocation) {
+            cleanupRandomX();
+            return false;
+        }
+        ScratchpadBlock block;
+        block.memory = static_cast<uint8_t*>(allocation.ptr);
+        block.size = allocation.size;
+        block.hugePages = allocation.kind != zartrux::VirtualMemory::PageKind::Normal;
+        if (block.hugePages) ++hugeBlocks;
+        // El scratchpad lo toca primero el propio hilo, ya fijado a una CPU del nodo
+        zartrux::NumaTopology::bindMemory(block.memory, block.size, node);
+        m_scratchpads.push_back(block);
+
+        std::vector<randomx_vm*> vms;
+        for (unsigned w = 0; w < ways; ++w) {
+            randomx_vm* vm = randomx_create_vm(vmFlags, ctx.cache(), dataset,
+                                               block.memory + SCRATCHPAD_STRIDE * w, node);
+            if (!vm) {
+                Logger::error("MinerCore", fmt::format("Error al crear VM {} para hilo {}", w, i));
+                for (auto created : vms) randomx_destroy_vm(created);
+                cleanupRandomX();
+                return false;
+            }
+            vms.push_back(vm);
+        }
+        m_workerVMs.push_back(std::move(vms));
+    }
+    Logger::info("MinerCore", fmt::format("{} VMs creadas ({} por hilo), scratchpads en huge pages: {}/{}",
+                                          m_numThreads * ways, ways, hugeBlocks, m_numThreads.load()));
+    return true;
+}
+
+void MinerCore::planThreadPlacement() {
+    // Los hilos se reparten de forma uniforme sobre la lista de CPUs ordenada por nodo,
+    // de modo que cada nodo recibe hilos en proporción a sus CPUs.
+    const auto& topology = zartrux::NumaTopology::instance();
+    const auto cpus = topology.allCpus();
+    m_workerCpus.assign(m_numThreads, 0);
+    m_workerNodes.assign(m_numThreads, 0);
+    for (unsigned i = 0; i < m_numThreads; ++i) {
+        const unsigned cpu = cpus[(static_cast<size_t>(i) * cpus.size() / m_numThreads) % cpus.size()];
+        m_workerCpus[i] = cpu;
+        m_workerNodes[i] = m_config.randomx.numa ? topology.nodeOfCpu(cpu) : 0;
+    }
+}
+
+unsigned MinerCore::selectHashWays() {
+    // Todos los hilos a la vez: la ganancia depende de la L3 y del ancho de banda compartidos
+    unsigned bestWays = 1;
+    double bestRate = 0.0;
+    for (unsigned ways : CANDIDATE_WAYS) {
+        const auto request = makeMemoryRequest(ways);
+        if (ways > 1 && zartrux::MemoryBudget::required(request, m_memoryPlan.fullMemory, m_numThreads) >
+                        m_memoryPlan.budget && m_memoryPlan.budget) {
+            Logger::info("MinerCore", fmt::format("{}-vías no caben en el presupuesto de memoria", ways));
+            break;
+        }
+        if (!createWorkerVMs(ways)) break;
+
+        std::vector<uint64_t> hashes(m_numThreads, 0);
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < m_numThreads; ++i) {
+            threads.emplace_back([this, i, &hashes] {
+                setAffinity(i);
+                std::vector<void*> vms(m_workerVMs[i].begin(), m_workerVMs[i].end());
+                hashes[i] = WorkerThread::benchmarkWays(vms, WAYS_BENCHMARK_TIME);
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        uint64_t total = 0;
+        for (auto h : hashes) total += h;
+        const double rate = static_cast<double>(total) * 1000.0 / WAYS_BENCHMARK_TIME.count();
+        Logger::info("MinerCore", fmt::format("Benchmark {}-vías: {:.2f} H/s", ways, rate));
+        // Más vías sólo compensan si mejoran de forma apreciable (más memoria, más latencia por hash)
+        if (rate > bestRate * 1.02) {
+            bestRate = rate;
+            bestWays = ways;
+        }
+    }
+    Logger::info("MinerCore", fmt::format("Modo seleccionado: {}-vías", bestWays));
+    return bestWays;
+}
+
+WorkerThread::Config MinerCore::makeWorkerConfig(unsigned id) const {
+    WorkerThread::Config cfg;
+    cfg.vms.assign(m_workerVMs[id].begin(), m_workerVMs[id].end());
+    cfg.cpuAffinity = static_cast<int>(m_workerCpus[id]);
+    cfg.numaNode = m_workerNodes[id];
+    cfg.noncePosition = m_config.noncePosition;
+    cfg.nonceSize = m_config.nonceSize;
+    cfg.nonceEndianness = m_config.nonceEndianness == NonceValidator::Endianness::BIG;
+    cfg.benchmark = m_benchmark;
+    return cfg;
+}
+
+zartrux::MemoryBudget::Request MinerCore::makeMemoryRequest(unsigned ways) const {
+    zartrux::MemoryBudget::Request request;
+    request.threads = m_numThreads;
+    request.ways = ways;
+    request.datasetReplicas = m_config.randomx.numa
+        ? static_cast<unsigned>(zartrux::NumaTopology::instance().nodeCount())
+        : 1;
+    request.datasetBytes = static_cast<size_t>(randomx_dataset_item_count()) * RANDOMX_DATASET_ITEM_SIZE;
+    request.cacheBytes = static_cast<size_t>(RandomX_CurrentConfig.ArgonMemory) * 1024;
+    request.scratchpadBytes = SCRATCHPAD_STRIDE;
+    request.jitBytes = JIT_BYTES_PER_VM;
+    request.threadOverheadBytes = THREAD_OVERHEAD;
+    request.processOverheadBytes = PROCESS_OVERHEAD;
+    request.reserveBytes = m_config.memoryReserveMB << 20;
+    return request;
+}
+
+void MinerCore::planMemory() {
+    const auto request = makeMemoryRequest(m_config.hashWays ? m_config.hashWays : 1);
+    auto info = zartrux::MemoryBudget::query();
+
+    // Lo que ya ocupa el contexto de una inicialización anterior se libera al reconstruirlo
+    auto& ctx = core::RandomXContext::getInstance();
+    if (ctx.isInitialized()) {
+        const uint64_t held = request.cacheBytes + (ctx.getConfig().fullMemory
+            ? static_cast<uint64_t>(request.datasetBytes) * ctx.placement().size()
+            : 0);
+        info.available += held;
+        info.cgroupUsage = info.cgroupUsage > held ? info.cgroupUsage - held : 0;
+    }
+
+    m_memoryPlan = zartrux::MemoryBudget::plan(request, info, LIGHT_RELATIVE_SPEED);
+    if (m_config.memoryMode != MemoryMode::Auto) {
+        // Modo forzado: sólo se ajustan los hilos para que quepan
+        const bool fullMemory = m_config.memoryMode == MemoryMode::Full;
+        unsigned threads = m_numThreads;
+        while (threads > 1 && info.known() &&
+               zartrux::MemoryBudget::required(request, fullMemory, threads) > m_memoryPlan.budget) {
+            --threads;
+        }
+        m_memoryPlan.fullMemory = fullMemory;
+        m_memoryPlan.threads = threads;
+        m_memoryPlan.required = zartrux::MemoryBudget::required(request, fullMemory, threads);
+        m_memoryPlan.reason = "modo fijado en la configuración";
+    }
+
+    Logger::info("MinerCore", fmt::format("Memoria: necesita {} MB de {} MB disponibles -> modo {} con {} hilos ({})",
+                                          m_memoryPlan.required >> 20, m_memoryPlan.budget >> 20,
+                                          m_memoryPlan.fullMemory ? "completo" : "ligero", m_memoryPlan.threads,
+                                          m_memoryPlan.reason));
+    if (info.known() && m_memoryPlan.peakRequired > m_memoryPlan.budget) {
+        Logger::warn("MinerCore", fmt::format("El cambio de época necesita hasta {} MB: puede haber presión de memoria",
+                                              m_memoryPlan.peakRequired >> 20));
+    }
+    if (m_memoryPlan.threads < m_numThreads) {
+        Logger::warn("MinerCore", fmt::format("Hilos reducidos de {} a {} por memoria",
+                                              m_numThreads.load(), m_memoryPlan.threads));
+        m_numThreads = m_memoryPlan.threads;
+    }
+    m_config.randomx.fullMemory = m_memoryPlan.fullMemory;
+}
+
+void MinerCore::initializeRandomX(const std::vector<uint8_t>& key) {
+    auto& ctx = core::RandomXContext::getInstance();
+    ctx.setProgressCallback([this, lastDecile = std::make_shared<int>(-1)](const core::BuildProgress& p) {
+        using Phase = core::BuildProgress::Phase;
+        if (p.phase == Phase::CacheFill) *lastDecile = -1;
+        if (p.phase != Phase::Dataset || p.total == 0) return;
+        // Un aviso por cada 10%: las construcciones en segundo plano no deben llenar el log
+        const int decile = static_cast<int>(p.done * 10 / p.total);
+        if (decile == *lastDecile) return;
+        *lastDecile = decile;
+        Logger::info("MinerCore", fmt::format("Dataset{}: {}% ({} s)", p.background ? " (segundo plano)" : "",
+                                              decile * 10, p.elapsedMs / 1000));
+        broadcastEvent("dataset_progress", std::to_string(decile * 10));
+    });
+    try {
+        ctx.reinitialize(key, m_config.randomx);
+    } catch (const std::exception& ex) {
+        if (!m_config.randomx.fullMemory) throw;
+        // La estimación puede fallar (fragmentación, overcommit): en vez de abortar se mina en ligero
+        Logger::warn("MinerCore", fmt::format("No se pudo construir el dataset ({}); pasando a modo ligero", ex.what()));
+        m_config.randomx.fullMemory = false;
+        m_memoryPlan.fullMemory = false;
+        m_memoryPlan.reason = "fallo al reservar el dataset";
+        ctx.reinitialize(key, m_config.randomx);
+    }
+}
+
+bool MinerCore::downgradeToLightMode() {
+    auto& ctx = core::RandomXContext::getInstance();
+    std::vector<uint8_t> key;
+    {
+        // Sin retener la época: su dataset debe liberarse antes de reconstruir la cache
+        const auto epoch = ctx.currentEpoch();
+        if (!epoch || !ctx.getConfig().fullMemory) return false;
+        key = epoch->key();
+    }
+
+    Logger::warn("MinerCore", "Presión de memoria: liberando el dataset y pasando a modo ligero");
+    const bool wasMining = m_mining.load();
+    const auto previousPlan = m_memoryPlan;
+    stopMining();
+    cleanupWorkers();
+    cleanupRandomX();
+
+    m_config.randomx.fullMemory = false;
+    m_memoryPlan.fullMemory = false;
+    m_memoryPlan.reason = "presión de memoria en marcha";
+    bool light = false;
+    for (unsigned attempt = 1; attempt <= LIGHT_MODE_ATTEMPTS && !light; ++attempt) {
+        light = rebuildWorkers(key);
+        if (!light) {
+            Logger::error("MinerCore", fmt::format("Intento {}/{} de pasar a modo ligero fallido",
+                                                   attempt, LIGHT_MODE_ATTEMPTS));
+        }
+    }
+
+    // Sin modo ligero se vuelve al completo: mejor minar bajo presión que dejar el minero parado
+    bool restored = false;
+    if (!light) {
+        m_config.randomx.fullMemory = true;
+        m_memoryPlan = previousPlan;
+        restored = rebuildWorkers(key);
+        if (!restored) m_config.randomx.fullMemory = false;
+    }
+
+    if ((light || restored) && wasMining) startMining();
+    if (light) {
+        broadcastEvent("memory", "Modo ligero por presión de memoria");
+        return true;
+    }
+    const std::string message = restored
+        ? "No se pudo pasar a modo ligero; se sigue en modo completo"
+        : "No se pudo reconstruir RandomX tras la presión de memoria; minería detenida";
+    Logger::error("MinerCore", message);
+    broadcastEvent("error", message);
+    return false;
+}
+
+bool MinerCore::rebuildWorkers(const std::vector<uint8_t>& key) {
+    try {
+        core::RandomXContext::getInstance().reinitialize(key, m_config.randomx);
+        if (!createWorkerVMs(m_hashWays)) return false;
+        std::lock_guard<std::mutex> lock(m_workerMutex);
+        for (unsigned i = 0; i < m_numThreads; ++i) {
+            m_workers.emplace_back(std::make_unique<WorkerThread>(i, *m_jobManager, makeWorkerConfig(i)));
+        }
+        return true;
+    } catch (const std::exception& ex) {
+        Logger::error("MinerCore", fmt::format("Error al reconstruir RandomX ({}): {}",
+                                               m_config.randomx.fullMemory ? "completo" : "ligero", ex.what()));
+        cleanupWorkers();
+        cleanupRandomX();
+        return false;
+    }
+}
+
+void MinerCore::checkMemoryPressure() {
+    if (m_config.memoryMode != MemoryMode::Auto || !m_config.randomx.fullMemory) return;
+    if (m_downgradeFailures >= MAX_DOWNGRADE_FAILURES) return;
+    const auto info = zartrux::MemoryBudget::query();
+    // La mitad de la reserva: por encima de eso el sistema todavía tiene margen
+    if (!zartrux::MemoryBudget::underPressure(info, (m_config.memoryReserveMB << 20) / 2)) {
+        m_pressureSamples = 0;
+        return;
+    }
+    if (++m_pressureSamples < PRESSURE_SAMPLES) return;
+    m_pressureSamples = 0;
+    if (downgradeToLightMode()) {
+        m_downgradeFailures = 0;
+        return;
+    }
+    // Si se restauró el modo completo la presión sigue y se reintenta en la próxima racha
+    if (++m_downgradeFailures >= MAX_DOWNGRADE_FAILURES) {
+        Logger::error("MinerCore", fmt::format("Modo ligero fallido {} veces seguidas; se desactiva el cambio automático",
+                                               m_downgradeFailures));
     }
 }
 
 bool MinerCore::initialize(const MiningConfig& config) {
+    // Los layouts de nonce desplazan un uint64_t byte a byte: fuera de 1..8 no hay campo válido
+    if (config.nonceSize < 1 || config.nonceSize > 8) {
+        Logger::error("MinerCore", fmt::format("Tamaño de nonce no válido: {} bytes (se admite de 1 a 8)",
+                                               config.nonceSize));
+        return false;
+    }
     stopMining();
     cleanupWorkers();
     cleanupRandomX();
     m_config = config;
+    m_pressureSamples = 0;
+    m_downgradeFailures = 0;
 
     try {
-        if (config.seed) {
-            Logger::info("[MinerCore] Inicializando RandomX con semilla: {}", config.seed.value());
-            m_rxCache = randomx_alloc_cache(RANDOMX_FLAG_DEFAULT);
-            if (!m_rxCache) {
-                Logger::error("[MinerCore] Error al asignar cache de RandomX");
-                return false;
-            }
-            randomx_init_cache(m_rxCache, config.seed.value().data(), config.seed.value().size());
-            for (unsigned i = 0; i < m_numThreads; ++i) {
-                randomx_vm* vm = randomx_create_vm(RANDOMX_FLAG_DEFAULT, m_rxCache, nullptr);
-                if (!vm) {
-                    Logger::error("[MinerCore] Error al crear VM para hilo {}", i);
-                    cleanupRandomX();
-                    return false;
-                }
-                m_workerVMs.push_back(vm);
-            }
-        } else {
+        NonceAllocator::Config nonceCfg;
+        nonceCfg.nonceBits = static_cast<unsigned>(m_config.nonceSize * 8);
+        nonceCfg.noncePosition = m_config.noncePosition;
+        nonceCfg.nonceSize = m_config.nonceSize;
+        nonceCfg.nonceBigEndian = m_config.nonceEndianness == NonceValidator::Endianness::BIG;
+        nonceCfg.prefixFromBlob = m_config.niceHash;
+        nonceCfg.prefixBits = m_config.niceHash ? 8 : 0;
+        m_jobManager->nonceAllocator().configure(nonceCfg);
+
+        if (!config.seed) {
             Logger::warn("[MinerCore] Advertencia: No se proporcionó semilla para RandomX");
+            return false;
+        }
+
+        Logger::info("MinerCore", fmt::format("Inicializando RandomX con semilla: {}", config.seed.value()));
+        const std::vector<uint8_t> key = core::seedKeyFromString(*config.seed);
+        planMemory();
+        // El dataset se construye en las mismas CPUs (y nodos) que luego minan
+        planThreadPlacement();
+        m_config.randomx.builderCpus = m_workerCpus;
+        initializeRandomX(key);
+
+        unsigned ways = m_config.hashWays;
+        m_hashWaysAuto = ways == 0;
+        if (m_hashWaysAuto) {
+            ways = selectHashWays();
+        } else if (ways != 1 && ways != 2 && ways != 4) {
+            Logger::warn("MinerCore", fmt::format("{} vías no soportadas, usando 1", ways));
+            ways = 1;
+        }
+        if (!createWorkerVMs(ways)) {
+            return false;
         }
+        m_hashWays = ways;
+
         for (unsigned i = 0; i < m_numThreads; ++i) {
-            WorkerThread::Config cfg{
-                i,
-                m_workerVMs[i],
-                m_config.noncePosition,
-                m_config.nonceSize,
-                m_config.nonceEndianness
-            };
-            auto worker = std::make_unique<WorkerThread>(i, *m_jobManager, cfg);
+            auto worker = std::make_unique<WorkerThread>(i, *m_jobManager, makeWorkerConfig(i));
             m_workers.emplace_back(std::move(worker));
         }
-        Logger::info("[MinerCore] Inicialización completa con {} hilos. Modo: {}", m_numThreads, m_config.mode);
+        Logger::info("MinerCore", fmt::format("Inicialización completa con {} hilos x {} vías. Modo: {}",
+                                              m_numThreads.load(), ways, m_config.mode));
         broadcastEvent("init", "Miner inicializado");
         return true;
     }
@@ -110,8 +445,8 @@ void MinerCore::startMining() {
         m_miningStartTime = steady_clock::now();
         m_acceptedShares = 0;
 
+        // Cada worker se fija a su CPU (cpuAffinity en su Config) al arrancar
         for (unsigned i = 0; i < m_workers.size(); ++i) {
-            setAffinity(i);
             m_workers[i]->start();
         }
         Logger::info("[MinerCore] Minería iniciada en modo: {}", m_config.mode);
@@ -194,18 +529,32 @@ std::vector<MinerCore::WorkerStats> MinerCore::getWorkerStats() const {
         s.totalHashes = worker->getHashesProcessed();
         s.acceptedHashes = worker->getAcceptedHashes();
         s.iaNoncesUsed = worker->getMetrics().iaNoncesUsed.load();
+        s.loopAllocations = worker->getMetrics().loopAllocations.load();
+        s.jobSwitchLatencyUs = worker->getMetrics().jobSwitchLatencyUs.load();
+        s.hashesLostToEpochSwitch = worker->getMetrics().hashesLostToEpochSwitch.load();
         s.hashRate = worker->getMetrics().hashRate.load();
+        s.numaNode = worker->getId() < m_workerNodes.size() ? m_workerNodes[worker->getId()] : 0;
+        const unsigned ways = worker->getMetrics().ways.load();
+        for (unsigned w = 0; w < ways && w < WorkerThread::MAX_WAYS; ++w) {
+            s.wayHashRate.push_back(worker->getMetrics().wayHashRate[w].load());
+        }
         stats.push_back(s);
     }
     return stats;
 }
 
 void MinerCore::updateMetrics() {
+    checkMemoryPressure();
     auto stats = getWorkerStats();
-    uint64_t totalHashes = 0, acceptedHashes = 0, iaNoncesUsed = 0;
+    const auto epoch = core::RandomXContext::getInstance().currentEpoch();
+    const core::BuildTimings buildTimings = epoch ? epoch->timings() : core::BuildTimings{};
+    uint64_t totalHashes = 0, acceptedHashes = 0, iaNoncesUsed = 0, jobSwitchLatencyUs = 0, hashesLostToEpoch = 0;
     double totalHashRate = 0.0;
     for (const auto& s : stats) {
+        // El cambio de trabajo termina cuando el hilo más lento empieza a hashear el nuevo
+        jobSwitchLatencyUs = std::max(jobSwitchLatencyUs, s.jobSwitchLatencyUs);
         totalHashes += s.totalHashes;
+        hashesLostToEpoch += s.hashesLostToEpochSwitch;
         acceptedHashes += s.acceptedHashes;
         iaNoncesUsed += s.iaNoncesUsed;
         totalHashRate += s.hashRate;
@@ -215,10 +564,66 @@ void MinerCore::updateMetrics() {
         {"accepted_hashes", acceptedHashes},
         {"ia_nonces_used", iaNoncesUsed},
         {"total_hash_rate", static_cast<uint64_t>(totalHashRate)},
+        {"job_switch_latency_us", jobSwitchLatencyUs},
+        {"hashes_lost_epoch_switch", hashesLostToEpoch},
+        {"memory_budget_mb", m_memoryPlan.budget >> 20},
+        {"memory_required_mb", m_memoryPlan.required >> 20},
+        {"light_mode", m_memoryPlan.fullMemory ? 0u : 1u},
+        {"dataset_build_ms", buildTimings.totalMs},
         {"active_threads", static_cast<uint64_t>(getActiveThreads())}
     });
+    // H/s sumado por posición de vía en todos los hilos
+    std::vector<double> wayHashRate(m_hashWays.load(), 0.0);
+    for (const auto& s : stats) {
+        for (size_t w = 0; w < s.wayHashRate.size() && w < wayHashRate.size(); ++w) {
+            wayHashRate[w] += s.wayHashRate[w];
+        }
+    }
+    // Colocación por nodo: hilos asignados y residencia medida de su réplica del dataset
+    std::vector<std::map<std::string, double>> numaPlacement;
+    for (const auto& p : core::RandomXContext::getInstance().placement()) {
+        const auto threads = std::count_if(stats.begin(), stats.end(),
+                                           [&](const WorkerStats& s) { return s.numaNode == p.node; });
+        numaPlacement.push_back({
+            {"node", p.node},
+            {"threads", static_cast<double>(threads)},
+            {"dataset_mb", static_cast<double>(p.datasetBytes >> 20)},
+            {"local_fraction", p.localFraction},
+            {"huge_pages", p.hugePages ? 1.0 : 0.0},
+            {"init_ms", static_cast<double>(p.initMs)}
+        });
+    }
+    // Reservas grandes con su cobertura real de páginas grandes (smaps)
+    std::vector<std::map<std::string, std::string>> memoryCoverage;
+    for (const auto& r : zartrux::VirtualMemory::report()) {
+        if (r.allocation.size < (size_t(2) << 20)) continue;
+        memoryCoverage.push_back({
+            {"label", r.label},
+            {"size_mb", std::to_string(r.allocation.size >> 20)},
+            {"pages", zartrux::VirtualMemory::pageKindName(r.allocation.kind)},
+            {"locked", r.allocation.locked ? "true" : "false"},
+            {"huge_coverage", std::to_string(r.coverage.fraction())}
+        });
+    }
     StatusExporter::instance().exportJSON({
         {"hashrate", totalHashRate},
+        {"hash_ways", m_hashWays.load()},
+        {"hash_ways_mode", m_hashWaysAuto ? "auto" : "manual"},
+        {"way_hashrate", wayHashRate},
+        {"numa_placement", numaPlacement},
+        {"memory", memoryCoverage},
+        {"memory_mode", m_memoryPlan.fullMemory ? "full" : "light"},
+        {"memory_plan_reason", m_memoryPlan.reason},
+        {"dataset_build", std::map<std::string, uint64_t>{
+            {"argon2_ms", buildTimings.argonMs},
+            {"programs_ms", buildTimings.programsMs},
+            {"alloc_ms", buildTimings.allocMs},
+            {"prefault_ms", buildTimings.prefaultMs},
+            {"items_ms", buildTimings.itemsMs},
+            {"total_ms", buildTimings.totalMs},
+            {"threads", buildTimings.threads},
+            {"jit_init", buildTimings.jitInit ? 1u : 0u}
+        }},
         {"threads", m_numThreads},
         {"shares", acceptedHashes},
         {"temperature", getTemperature()},
@@ -234,29 +639,22 @@ void MinerCore::restartWorker(unsigned id) {
     if (id >= m_workers.size()) return;
     m_workers[id]->stop();
     if (m_workers[id]->joinable()) m_workers[id]->join();
-    WorkerThread::Config cfg{
-        id,
-        m_workerVMs[id],
-        m_config.noncePosition,
-        m_config.nonceSize,
-        m_config.nonceEndianness
-    };
+    WorkerThread::Config cfg = makeWorkerConfig(id);
     m_workers[id] = std::make_unique<WorkerThread>(id, *m_jobManager, cfg);
-    setAffinity(id);
     m_workers[id]->start();
     Logger::info("[MinerCore] Hilo {} reiniciado", id);
 }
 
 void MinerCore::setAffinity(unsigned threadId) {
-#ifdef __linux__
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    CPU_SET(threadId % std::thread::hardware_concurrency(), &cpuset);
-    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
-#endif
+    // Fija el hilo que llama a la CPU planificada para ese índice (su nodo NUMA)
+    if (threadId < m_workerCpus.size()) {
+        zartrux::NumaTopology::pinThreadToCpu(m_workerCpus[threadId]);
+    }
 }
 
 void MinerCore::saveCheckpoint() const {
+    // Un benchmark no debe pisar el checkpoint de la minería real
+    if (m_benchmark) return;
     try {
         std::ofstream out(CHECKPOINT_FILE);
         if (!out) return;
@@ -13,6 +13,8 @@
 #include "core/threads/WorkerThread.h"
 #include "core/JobManager.h"
 #include "core/NonceValidator.h"
+#include "core/hash.h"
+#include "memory/MemoryBudget.h"
 
 struct CheckpointState {
     uint64_t lastBlockHeight = 0;
@@ -28,16 +30,29 @@ public:
         uint64_t totalHashes;
         uint64_t acceptedHashes;
         uint64_t iaNoncesUsed;
+        uint64_t loopAllocations;
+        uint64_t jobSwitchLatencyUs;
+        uint64_t hashesLostToEpochSwitch;
         double hashRate;
+        std::vector<double> wayHashRate;    // H/s de cada VM entrelazada del hilo
+        uint32_t numaNode = 0;              // nodo de su CPU y de la réplica del dataset
     };
 
+    // Modo de memoria de RandomX: Auto deja decidir al planificador (y permite degradar en marcha)
+    enum class MemoryMode { Auto, Full, Light };
+
     struct MiningConfig {
         std::optional<std::string> seed;
         unsigned threadCount = std::thread::hardware_concurrency();
         std::string mode;
         size_t noncePosition = 39;
-        size_t nonceSize = 4;
+        size_t nonceSize = 4;           // bytes del campo nonce, de 1 a 8 (initialize rechaza el resto)
         NonceValidator::Endianness nonceEndianness = NonceValidator::Endianness::LITTLE;
+        bool niceHash = false;          // el pool fija el byte alto del nonce (se lee del blob)
+        core::RandomXConfig randomx;
+        unsigned hashWays = 0;          // VMs entrelazadas por hilo: 1, 2 o 4; 0 = autoselección
+        MemoryMode memoryMode = MemoryMode::Auto;
+        size_t memoryReserveMB = 256;   // memoria que se deja libre al sistema
     };
 
     MinerCore(std::shared_ptr<JobManager> jobManager, unsigned threadCount = 0);
@@ -60,6 +75,14 @@ public:
     float getTemperature() const;
     std::string getTempStatus() const;
     std::string getCurrentMode() const { return m_config.mode; }
+    unsigned getHashWays() const { return m_hashWays.load(); }
+    const zartrux::MemoryBudget::Plan& getMemoryPlan() const { return m_memoryPlan; }
+
+    // Modo benchmark (--bench): se aplica a los workers creados después; no guarda checkpoint
+    void setBenchmark(std::shared_ptr<WorkerThread::BenchmarkState> state) { m_benchmark = std::move(state); }
+
+    // Pasa a modo ligero si la memoria libre sigue por debajo de la reserva (modo Auto)
+    void checkMemoryPressure();
 
     std::vector<WorkerStats> getWorkerStats() const;
     void updateMetrics();
@@ -73,6 +96,17 @@ private:
     void cleanupRandomX();
     void restartWorker(unsigned id);
 
+    void planThreadPlacement();
+    bool createWorkerVMs(unsigned ways);
+    unsigned selectHashWays();
+    WorkerThread::Config makeWorkerConfig(unsigned id) const;
+    zartrux::MemoryBudget::Request makeMemoryRequest(unsigned ways) const;
+    void planMemory();
+    void initializeRandomX(const std::vector<uint8_t>& key);
+    // true si queda en modo ligero; si no, restaura el modo completo (o deja el minero detenido)
+    bool downgradeToLightMode();
+    bool rebuildWorkers(const std::vector<uint8_t>& key);
+
     void setAffinity(unsigned threadId);
 
     MiningConfig m_config;
@@ -82,8 +116,23 @@ private:
     std::atomic<std::chrono::steady_clock::time_point> m_miningStartTime;
     std::atomic<long> m_acceptedShares;
 
-    randomx_cache* m_rxCache = nullptr;
-    randomx_dataset* m_rxDataset = nullptr;
+    // Scratchpads de un hilo: un bloque contiguo en huge pages con una región por vía
+    struct ScratchpadBlock {
+        uint8_t* memory = nullptr;
+        size_t size = 0;
+        bool hugePages = false;
+    };
+
+    std::vector<std::vector<randomx_vm*>> m_workerVMs;   // [hilo][vía]
+    std::vector<ScratchpadBlock> m_scratchpads;           // uno por hilo
+    std::vector<unsigned> m_workerCpus;                   // CPU asignada a cada hilo
+    std::vector<uint32_t> m_workerNodes;                  // nodo NUMA de cada hilo
+    std::atomic<unsigned> m_hashWays{1};
+    bool m_hashWaysAuto = false;
+    zartrux::MemoryBudget::Plan m_memoryPlan;
+    unsigned m_pressureSamples = 0;
+    unsigned m_downgradeFailures = 0;
+    std::shared_ptr<WorkerThread::BenchmarkState> m_benchmark;
 
     std::vector<std::unique_ptr<WorkerThread>> m_workers;
     std::vector<std::thread> m_threads;
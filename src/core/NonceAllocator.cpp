@@ -0,0 +1,136 @@
+#include "NonceAllocator.h"
+#include "SmartCache.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <thread>
+
+#include <fmt/format.h>
+
+NonceAllocator::NonceAllocator() {
+    publish(m_config);
+}
+
+void NonceAllocator::configure(const Config& config) {
+    if (config.nonceBits == 0 || config.nonceBits > 64) {
+        throw std::invalid_argument("NonceAllocator: nonceBits debe estar entre 1 y 64");
+    }
+    if (config.prefixBits >= config.nonceBits) {
+        throw std::invalid_argument("NonceAllocator: el prefijo no deja espacio libre de nonces");
+    }
+    if (config.iaShareBits == 0 || config.iaShareBits >= config.nonceBits - config.prefixBits) {
+        throw std::invalid_argument("NonceAllocator: iaShareBits fuera de rango");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    publish(m_config);
+    Logger::info("NonceAllocator", fmt::format("Espacio de nonces: {} bits, prefijo {} bits, región IA 1/{}",
+                                               config.nonceBits, config.prefixBits, 1u << config.iaShareBits));
+}
+
+void NonceAllocator::setPrefix(uint64_t prefix, unsigned bits) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_config.prefix == prefix && m_config.prefixBits == bits) {
+        return;
+    }
+    if (bits >= m_config.nonceBits || m_config.iaShareBits >= m_config.nonceBits - bits) {
+        Logger::error("NonceAllocator", fmt::format("Prefijo de {} bits incompatible con el nonce de {} bits",
+                                                    bits, m_config.nonceBits));
+        return;
+    }
+    m_config.prefix = prefix;
+    m_config.prefixBits = bits;
+    publish(m_config);
+}
+
+void NonceAllocator::onNewJob(std::span<const uint8_t> blob) {
+    Config config;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        config = m_config;
+    }
+    if (!config.prefixFromBlob || config.prefixBits == 0) {
+        return;
+    }
+    if (config.noncePosition + config.nonceSize > blob.size()) {
+        return;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < config.nonceSize; ++i) {
+        const size_t index = config.nonceBigEndian ? i : config.nonceSize - 1 - i;
+        value = (value << 8) | blob[config.noncePosition + index];
+    }
+    setPrefix(value >> (config.nonceBits - config.prefixBits), config.prefixBits);
+}
+
+void NonceAllocator::publish(const Config& config) {
+    const unsigned freeBits = config.nonceBits - config.prefixBits;
+    // space == 0 representa 2^64; la aritmética sin signo mantiene cpuSize correcto
+    const uint64_t space = freeBits >= 64 ? 0 : (uint64_t(1) << freeBits);
+    const uint64_t iaSize = uint64_t(1) << (freeBits - config.iaShareBits);
+    const uint64_t prefixMask = config.prefixBits == 0 ? 0
+        : (config.prefix & ((uint64_t(1) << config.prefixBits) - 1)) << freeBits;
+
+    // Seqlock: generación impar mientras se escribe
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
+    m_prefixMask.store(prefixMask, std::memory_order_relaxed);
+    m_freeBits.store(freeBits, std::memory_order_relaxed);
+    m_cpuSize.store(space - iaSize, std::memory_order_relaxed);
+    m_iaSize.store(iaSize, std::memory_order_relaxed);
+    m_targetBlockSeconds.store(config.targetBlockSeconds, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+NonceAllocator::Layout NonceAllocator::readLayout(uint32_t& generation) const {
+    Layout layout;
+    while (true) {
+        generation = m_generation.load(std::memory_order_acquire);
+        if (generation & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        layout.prefixMask = m_prefixMask.load(std::memory_order_relaxed);
+        layout.freeBits = m_freeBits.load(std::memory_order_relaxed);
+        layout.cpuSize = m_cpuSize.load(std::memory_order_relaxed);
+        layout.iaSize = m_iaSize.load(std::memory_order_relaxed);
+        layout.targetBlockSeconds = m_targetBlockSeconds.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_generation.load(std::memory_order_relaxed) == generation) {
+            return layout;
+        }
+    }
+}
+
+void NonceAllocator::refill(Range& range, double hashRate) const {
+    uint32_t generation = 0;
+    const Layout layout = readLayout(generation);
+
+    // Bloque de ~targetBlockSeconds de trabajo, potencia de 2 entre MIN_BLOCK y MAX_BLOCK
+    uint64_t wanted = hashRate > 0.0 ? static_cast<uint64_t>(hashRate * layout.targetBlockSeconds) : MIN_BLOCK;
+    uint64_t size = std::bit_ceil(std::clamp(wanted, MIN_BLOCK, MAX_BLOCK));
+    if (layout.cpuSize != 0 && size > layout.cpuSize) {
+        size = layout.cpuSize;
+    }
+
+    // Única operación compartida: un fetch_add por bloque sobre el contador de SmartCache
+    uint64_t offset = SmartCache::getInstance().allocateNonceRange(size);
+    if (layout.cpuSize != 0) {
+        offset %= layout.cpuSize;
+        // Un bloque que cruzaría el final de la región CPU se recorta
+        size = std::min(size, layout.cpuSize - offset);
+    }
+
+    range.next = layout.prefixMask | offset;
+    range.end = range.next + size;
+    range.generation = generation;
+}
+
+uint64_t NonceAllocator::mapIANonce(uint64_t raw) const {
+    uint32_t generation = 0;
+    const Layout layout = readLayout(generation);
+    return layout.prefixMask | (layout.cpuSize + (raw & (layout.iaSize - 1)));
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <span>
+
+/**
+ * Reparto del espacio de nonces entre los workers.
+ *
+ * Cada worker reserva bloques contiguos y disjuntos (vía SmartCache::allocateNonceRange)
+ * cuyo tamaño se adapta a su hashrate, de forma que el contador compartido sólo se toca
+ * una vez por bloque y no una vez por hash.
+ *
+ * Distribución del campo nonce (de bits altos a bajos):
+ *   [ prefijo fijo del pool (prefixBits) | espacio libre ]
+ * El espacio libre se divide en una región CPU [0, cpuSize) y una región IA
+ * [cpuSize, space) de tamaño space >> iaShareBits, para que los nonces inyectados
+ * por la IA nunca coincidan con los generados por los workers.
+ */
+class NonceAllocator {
+public:
+    static constexpr uint64_t MIN_BLOCK = 256;
+    static constexpr uint64_t MAX_BLOCK = uint64_t(1) << 22;
+
+    struct Config {
+        unsigned nonceBits = 32;          ///< Ancho del campo nonce (nonceSize * 8, máx. 64)
+        unsigned prefixBits = 0;          ///< Bits altos fijados por el pool (NiceHash: 8)
+        uint64_t prefix = 0;              ///< Valor del prefijo fijo
+        bool prefixFromBlob = false;      ///< Tomar el prefijo de los bytes altos del nonce en cada blob
+        size_t noncePosition = 39;        ///< Usados con prefixFromBlob
+        size_t nonceSize = 4;
+        bool nonceBigEndian = false;
+        unsigned iaShareBits = 4;         ///< Región IA = 1/2^iaShareBits del espacio libre
+        double targetBlockSeconds = 2.0;  ///< Duración objetivo de cada bloque por hilo
+    };
+
+    /// Bloque reservado por un hilo; sólo lo toca su propietario.
+    struct Range {
+        uint64_t next = 0;
+        uint64_t end = 0;
+        uint32_t generation = 0;
+
+        bool exhausted() const { return next == end; }
+    };
+
+    NonceAllocator();
+
+    void configure(const Config& config);
+
+    /// Fija el prefijo impuesto por el pool; invalida los bloques en curso si cambia.
+    void setPrefix(uint64_t prefix, unsigned bits);
+
+    /// Aplica el prefijo de un trabajo nuevo cuando Config::prefixFromBlob está activo.
+    void onNewJob(std::span<const uint8_t> blob);
+
+    /// Cambia cada vez que se reconfigura el espacio; los hilos comparan con Range::generation.
+    uint32_t generation() const { return m_generation.load(std::memory_order_relaxed); }
+
+    /// Reserva un nuevo bloque para un hilo con el hashrate indicado.
+    void refill(Range& range, double hashRate) const;
+
+    /// Nonce siguiente del bloque del hilo, rellenándolo cuando se agota.
+    inline uint64_t next(Range& range, double hashRate) const {
+        if (range.exhausted()) {
+            refill(range, hashRate);
+        }
+        return range.next++;
+    }
+
+    /// Lleva un nonce propuesto por la IA a la región reservada para la IA.
+    uint64_t mapIANonce(uint64_t raw) const;
+
+private:
+    struct Layout {
+        uint64_t prefixMask = 0;   ///< prefijo ya desplazado a su posición
+        unsigned freeBits = 32;
+        uint64_t cpuSize = 0;      ///< tamaño de la región CPU (mod 2^64)
+        uint64_t iaSize = 0;
+        double targetBlockSeconds = 2.0;
+    };
+
+    Layout readLayout(uint32_t& generation) const;
+    void publish(const Config& config);
+
+    mutable std::mutex m_mutex;         // serializa escritores; los lectores usan m_generation como seqlock
+    Config m_config;
+
+    std::atomic<uint32_t> m_generation{0};
+    std::atomic<uint64_t> m_prefixMask{0};
+    std::atomic<unsigned> m_freeBits{32};
+    std::atomic<uint64_t> m_cpuSize{0};
+    std::atomic<uint64_t> m_iaSize{0};
+    std::atomic<double> m_targetBlockSeconds{2.0};
+};
@@ -1,4 +1,5 @@
 #include "NonceValidator.h"
+#include "utils/Hex.h"
 #include <algorithm>
 #include <atomic>
 #include <future>
@@ -11,6 +12,63 @@ bool NonceValidator::isValidFast(const hash_t& hash, const hash_t& target) {
     return std::memcmp(hash.data(), target.data(), HASH_SIZE) < 0;
 }
 
+NonceValidator::ShareTarget NonceValidator::ShareTarget::fromCompact(uint64_t raw) {
+    ShareTarget target;
+    if (raw == 0) return target;
+    if (raw <= 0xFFFFFFFFull) {
+        // Formato de 4 bytes: se expande a 64 bits igual que lo hacen los pools
+        target.high = 0xFFFFFFFFFFFFFFFFull / (0xFFFFFFFFull / raw);
+    } else {
+        target.high = raw;
+    }
+    // Un objetivo compacto no tiene bits bajos: en empate el hash nunca es menor
+    return target;
+}
+
+NonceValidator::ShareTarget NonceValidator::ShareTarget::fromHex(std::string_view hex) {
+    if (hex.size() != 8 && hex.size() != 16 && hex.size() != HASH_SIZE * 2) {
+        throw std::invalid_argument("Invalid target length");
+    }
+
+    // Los bytes llegan en little-endian
+    hash_t bytes{};
+    if (!zartrux::hex::decode(hex, bytes.data())) {
+        throw std::invalid_argument("Invalid hex character in target");
+    }
+    if (hex.size() == HASH_SIZE * 2) return fromHash(bytes);
+
+    uint64_t raw = 0;
+    for (size_t i = hex.size() / 2; i-- > 0;) {
+        raw = (raw << 8) | bytes[i];
+    }
+    return fromCompact(raw);
+}
+
+NonceValidator::ShareTarget NonceValidator::ShareTarget::fromDifficulty(uint64_t difficulty) {
+    if (difficulty == 0) throw std::invalid_argument("Difficulty must be non-zero");
+
+    // División larga bit a bit de 2^256 - 1 entre la dificultad; sólo ocurre una vez por trabajo
+    hash_t quotient{};
+    uint64_t remainder = 0;
+    for (size_t bit = HASH_SIZE * 8; bit-- > 0;) {
+        const bool carry = (remainder >> 63) != 0;
+        remainder = (remainder << 1) | 1;
+        if (carry || remainder >= difficulty) {
+            remainder -= difficulty;
+            quotient[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+        }
+    }
+    return fromHash(quotient);
+}
+
+NonceValidator::ShareTarget NonceValidator::ShareTarget::fromHash(const hash_t& full) {
+    ShareTarget target;
+    target.high = loadHigh64(full);
+    target.full = full;
+    target.fullOnTie = std::any_of(full.begin(), full.begin() + 24, [](uint8_t b) { return b != 0; });
+    return target;
+}
+
 // Validación configurable (enum + custom)
 bool NonceValidator::isValid(const hash_t& hash, const hash_t& target,
                              const ValidatorConfig& config) {
@@ -74,12 +132,12 @@ bool NonceValidator::validate(uint64_t nonce, const hash_t& target,
     }
 }
 
-// Validación secuencial (legacy)
-std::vector<bool> NonceValidator::validateBatch(randomx_vm* vm,
-                                              const std::vector<uint64_t>& nonces,
-                                              const hash_t& target,
-                                              std::span<const uint8_t> jobBlob,
-                                              const ValidatorConfig& config) {
+template <typename Predicate>
+std::vector<bool> NonceValidator::runBatch(randomx_vm* vm,
+                                           const std::vector<uint64_t>& nonces,
+                                           std::span<const uint8_t> jobBlob,
+                                           const ValidatorConfig& config,
+                                           Predicate&& meets) {
     std::vector<bool> results;
     results.reserve(nonces.size());
 
@@ -89,11 +147,11 @@ std::vector<bool> NonceValidator::validateBatch(randomx_vm* vm,
 
     for (auto nonce : nonces) {
         try {
-            auto tempBlob = baseBlob;
-            insertNonce(tempBlob, nonce, noncePos, nonceSize, config.nonceEndianness);
+            // Sólo cambian los bytes del nonce: se reescriben sobre el mismo blob
+            insertNonce(baseBlob, nonce, noncePos, nonceSize, config.nonceEndianness);
             hash_t hash;
-            randomx_calculate_hash(vm, tempBlob.data(), tempBlob.size(), hash.data());
-            results.push_back(isValid(hash, target, config));
+            randomx_calculate_hash(vm, baseBlob.data(), baseBlob.size(), hash.data());
+            results.push_back(meets(hash));
         } catch (...) {
             results.push_back(false);
         }
@@ -101,18 +159,19 @@ std::vector<bool> NonceValidator::validateBatch(randomx_vm* vm,
     return results;
 }
 
-// VALIDACIÓN PARALELA “master level” – super optimizado para CPUs multicore
-std::vector<bool> NonceValidator::validateBatchParallel(
+template <typename Predicate>
+std::vector<bool> NonceValidator::runBatchParallel(
     randomx_vm** vms,  // Array de VMs (uno por hilo)
     size_t num_vms,
     const std::vector<uint64_t>& nonces,
-    const hash_t& target,
     std::span<const uint8_t> jobBlob,
-    const ValidatorConfig& config) {
+    const ValidatorConfig& config,
+    Predicate&& meets) {
 
     const size_t totalNonces = nonces.size();
-    std::vector<bool> results(totalNonces, false);
-    if (totalNonces == 0) return results;
+    // vector<bool> no admite escrituras concurrentes en el mismo byte
+    std::vector<uint8_t> flags(totalNonces, 0);
+    if (totalNonces == 0) return {};
 
     const size_t threadsToUse = std::min({num_vms, config.batchThreads, totalNonces});
     const size_t noncesPerThread = (totalNonces + threadsToUse - 1) / threadsToUse;
@@ -124,22 +183,20 @@ std::vector<bool> NonceValidator::validateBatchParallel(
     std::atomic<size_t> nextIndex(0);
 
     auto worker = [&](randomx_vm* vm) {
+        std::vector<uint8_t> tempBlob = baseBlob;
         while (true) {
             const size_t start = nextIndex.fetch_add(noncesPerThread);
             if (start >= totalNonces) break;
             const size_t end = std::min(start + noncesPerThread, totalNonces);
 
-            std::vector<uint8_t> tempBlob;
             for (size_t i = start; i < end; ++i) {
                 try {
-                    tempBlob = baseBlob;
-                    const uint64_t nonce = nonces[i];
-                    insertNonce(tempBlob, nonce, noncePos, nonceSize, config.nonceEndianness);
+                    insertNonce(tempBlob, nonces[i], noncePos, nonceSize, config.nonceEndianness);
                     hash_t hash;
                     randomx_calculate_hash(vm, tempBlob.data(), tempBlob.size(), hash.data());
-                    results[i] = isValid(hash, target, config);
+                    flags[i] = meets(hash) ? 1 : 0;
                 } catch (...) {
-                    results[i] = false;
+                    flags[i] = 0;
                 }
             }
         }
@@ -153,5 +210,48 @@ std::vector<bool> NonceValidator::validateBatchParallel(
         fut.get();
     }
 
-    return results;
+    return std::vector<bool>(flags.begin(), flags.end());
+}
+
+// Validación secuencial (legacy)
+std::vector<bool> NonceValidator::validateBatch(randomx_vm* vm,
+                                              const std::vector<uint64_t>& nonces,
+                                              const hash_t& target,
+                                              std::span<const uint8_t> jobBlob,
+                                              const ValidatorConfig& config) {
+    return runBatch(vm, nonces, jobBlob, config,
+                    [&](const hash_t& hash) { return isValid(hash, target, config); });
+}
+
+// Validación secuencial con umbral precomputado
+std::vector<bool> NonceValidator::validateBatch(randomx_vm* vm,
+                                              const std::vector<uint64_t>& nonces,
+                                              const ShareTarget& target,
+                                              std::span<const uint8_t> jobBlob,
+                                              const ValidatorConfig& config) {
+    return runBatch(vm, nonces, jobBlob, config,
+                    [&](const hash_t& hash) { return meetsTarget(hash, target); });
+}
+
+// VALIDACIÓN PARALELA “master level” – super optimizado para CPUs multicore
+std::vector<bool> NonceValidator::validateBatchParallel(
+    randomx_vm** vms,
+    size_t num_vms,
+    const std::vector<uint64_t>& nonces,
+    const hash_t& target,
+    std::span<const uint8_t> jobBlob,
+    const ValidatorConfig& config) {
+    return runBatchParallel(vms, num_vms, nonces, jobBlob, config,
+                            [&](const hash_t& hash) { return isValid(hash, target, config); });
+}
+
+std::vector<bool> NonceValidator::validateBatchParallel(
+    randomx_vm** vms,
+    size_t num_vms,
+    const std::vector<uint64_t>& nonces,
+    const ShareTarget& target,
+    std::span<const uint8_t> jobBlob,
+    const ValidatorConfig& config) {
+    return runBatchParallel(vms, num_vms, nonces, jobBlob, config,
+                            [&](const hash_t& hash) { return meetsTarget(hash, target); });
 }
@@ -9,6 +9,9 @@
 #include <thread>
 #include <future>
 #include <mutex>
+#include <string_view>
+#include <cstring>
+#include <bit>
 
 #include "crypto/randomx/randomx.h"
 
@@ -38,6 +41,32 @@ public:
         std::optional<std::function<bool(const hash_t&, const hash_t&)>> customCompare;
     };
 
+    // Umbral de share decodificado una vez por trabajo. El hash RandomX se interpreta
+    // como entero little-endian de 256 bits; sus 64 bits altos son los bytes 24..31.
+    struct ShareTarget {
+        uint64_t high = 0;        // umbral sobre los 64 bits altos del hash
+        bool fullOnTie = false;   // el umbral tiene bits bajos: un empate exige comparar 256 bits
+        hash_t full{};            // umbral completo little-endian (sólo se usa si fullOnTie)
+
+        // Objetivo compacto del pool (Monero/xmrig): valores de hasta 32 bits son el formato
+        // de 4 bytes, el resto el de 8 bytes. Un objetivo 0 no acepta ningún hash.
+        static ShareTarget fromCompact(uint64_t raw);
+        // Cadena hex del pool: 8 o 16 caracteres (compacto) o 64 (objetivo completo LE)
+        static ShareTarget fromHex(std::string_view hex);
+        // Objetivo de bloque (minería solo): floor((2^256 - 1) / difficulty)
+        static ShareTarget fromDifficulty(uint64_t difficulty);
+        // Objetivo completo de 256 bits en little-endian
+        static ShareTarget fromHash(const hash_t& target);
+    };
+
+    // Camino por hash: una comparación entera en el caso habitual (hash por encima del umbral)
+    static bool meetsTarget(const hash_t& hash, const ShareTarget& target) {
+        const uint64_t high = loadHigh64(hash);
+        if (high > target.high) [[likely]] return false;
+        if (high < target.high) return true;
+        return target.fullOnTie && lessLittleEndian(hash, target.full);
+    }
+
     explicit NonceValidator(const ValidatorConfig& config = ValidatorConfig());
 
     static bool isValid(const hash_t& hash, const hash_t& target,
@@ -65,6 +94,54 @@ public:
         std::span<const uint8_t> jobBlob,
         const ValidatorConfig& config = ValidatorConfig());
 
+    // Variantes con umbral precomputado (meetsTarget en lugar de comparar 32 bytes)
+    static std::vector<bool> validateBatch(randomx_vm* vm,
+                                         const std::vector<uint64_t>& nonces,
+                                         const ShareTarget& target,
+                                         std::span<const uint8_t> jobBlob,
+                                         const ValidatorConfig& config = ValidatorConfig());
+
+    static std::vector<bool> validateBatchParallel(
+        randomx_vm** vms,
+        size_t num_vms,
+        const std::vector<uint64_t>& nonces,
+        const ShareTarget& target,
+        std::span<const uint8_t> jobBlob,
+        const ValidatorConfig& config = ValidatorConfig());
+
 private:
-    static void insertNonce(std::vector<uint8_t>& blob, uint64_t nonce, const ValidatorConfig& config);
+    static uint64_t loadHigh64(const hash_t& hash) {
+        uint64_t value;
+        std::memcpy(&value, hash.data() + 24, sizeof(value));
+        if constexpr (std::endian::native == std::endian::big) {
+            value = ((value & 0x00000000000000FFull) << 56) | ((value & 0x000000000000FF00ull) << 40) |
+                    ((value & 0x0000000000FF0000ull) << 24) | ((value & 0x00000000FF000000ull) << 8) |
+                    ((value & 0x000000FF00000000ull) >> 8) | ((value & 0x0000FF0000000000ull) >> 24) |
+                    ((value & 0x00FF000000000000ull) >> 40) | ((value & 0xFF00000000000000ull) >> 56);
+        }
+        return value;
+    }
+
+    static bool lessLittleEndian(const hash_t& a, const hash_t& b) {
+        for (size_t i = HASH_SIZE; i-- > 0;) {
+            if (a[i] != b[i]) return a[i] < b[i];
+        }
+        return false;
+    }
+
+    template <typename Predicate>
+    static std::vector<bool> runBatch(randomx_vm* vm, const std::vector<uint64_t>& nonces,
+                                      std::span<const uint8_t> jobBlob, const ValidatorConfig& config,
+                                      Predicate&& meets);
+
+    template <typename Predicate>
+    static std::vector<bool> runBatchParallel(randomx_vm** vms, size_t num_vms,
+                                              const std::vector<uint64_t>& nonces,
+                                              std::span<const uint8_t> jobBlob,
+                                              const ValidatorConfig& config, Predicate&& meets);
+
+    static void insertNonce(std::vector<uint8_t>& blob, uint64_t nonce,
+                            size_t position, size_t size, Endianness endian);
+
+    ValidatorConfig m_config;
 };
\ No newline at end of file
@@ -1,12 +1,57 @@
 #include "PoolDispatcher.h"
 #include "utils/Logger.h"
 #include <nlohmann/json.hpp>
-#include <random>
-#include <thread>
+#include <algorithm>
 #include <fmt/format.h>
 
 namespace zartrux::dispatcher {
     using json = nlohmann::json;
+
+    namespace {
+        enum class Verdict { Accepted, Rejected, Missing };
+
+        // Respuesta correspondiente a una share: por id en un lote JSON-RPC, por posición si
+        // el lote no lleva ids, o el propio objeto si la pool contesta una sola vez
+        const json* findReply(const json& response, uint64_t id, size_t index, size_t batchSize) {
+            if (response.is_object()) return &response;
+            if (!response.is_array()) return nullptr;
+
+            for (const auto& reply : response) {
+                if (reply.is_object() && reply.contains("id") && reply["id"].is_number_unsigned() &&
+                    reply["id"].get<uint64_t>() == id) {
+                    return &reply;
+                }
+            }
+            if (response.size() == batchSize && index < response.size() &&
+                response[index].value("id", json()).is_null()) {
+                return &response[index];
+            }
+            return nullptr;
+        }
+
+        Verdict judge(const json* reply) {
+            if (!reply) return Verdict::Missing;
+            if (reply->contains("error") && !(*reply)["error"].is_null()) return Verdict::Rejected;
+            if (reply->contains("result") && (*reply)["result"].is_boolean() && !(*reply)["result"].get<bool>()) {
+                return Verdict::Rejected;
+            }
+            return Verdict::Accepted;
+        }
+
+        double elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+            return std::chrono::duration<double, std::milli>(to - from).count();
+        }
+
+        int64_t steadyNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        struct RetryOrder {
+            template<typename T>
+            bool operator()(const T& a, const T& b) const { return a.dueAt > b.dueAt; }
+        };
+    } // namespace
     
     PoolDispatcher& PoolDispatcher::instance() {
         static PoolDispatcher instance;
@@ -17,6 +62,27 @@ namespace zartrux::dispatcher {
         // Valores por defecto
         m_iaEndpoint = {"http://localhost:8000/ia/submit", "", "", Protocol::STRATUM_V2};
         m_poolEndpoint = {"http://localhost:3333/submit", "", "", Protocol::STRATUM_V2};
+        m_iaEndpoint.health = std::make_shared<EndpointHealth>(m_iaEndpoint.url);
+        m_poolEndpoint.health = std::make_shared<EndpointHealth>(m_poolEndpoint.url);
+        m_ioThread = std::thread(&PoolDispatcher::ioLoop, this);
+    }
+
+    PoolDispatcher::~PoolDispatcher() {
+        shutdown();
+    }
+
+    void PoolDispatcher::shutdown() {
+        if (m_stopping.exchange(true)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            m_ioCv.notify_one();
+        }
+        if (m_ioThread.joinable()) {
+            m_ioThread.join();
+        }
+        logSubmissionStats();
     }
     
     void PoolDispatcher::setMode(::MiningMode mode) {
@@ -30,10 +96,18 @@ namespace zartrux::dispatcher {
                                      const std::string& poolUser,
                                      const std::string& poolPass) {
         std::lock_guard<std::mutex> lock(m_mutex);
+        // El historial de latencia y fallos pertenece a la URL: se reinicia si cambia
+        if (m_iaEndpoint.url != iaEndpoint) {
+            m_iaEndpoint.health = std::make_shared<EndpointHealth>(iaEndpoint);
+        }
+        if (m_poolEndpoint.url != poolEndpoint) {
+            m_poolEndpoint.health = std::make_shared<EndpointHealth>(poolEndpoint);
+        }
         m_iaEndpoint.url = iaEndpoint;
         m_poolEndpoint.url = poolEndpoint;
         m_poolEndpoint.user = poolUser;
         m_poolEndpoint.pass = poolPass;
+        m_endpointGeneration.fetch_add(1, std::memory_order_release);
         
         Logger::info("Endpoints configured - IA: {}, Pool: {}", iaEndpoint, poolEndpoint);
     }
@@ -68,121 +142,401 @@ namespace zartrux::dispatcher {
         Logger::info("Smart threshold set to: {:.2f}", threshold);
     }
     
+    void PoolDispatcher::setBatchSubmit(bool iaEndpoint, bool poolEndpoint, size_t maxBatch) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_iaEndpoint.batchSubmit = iaEndpoint;
+        m_poolEndpoint.batchSubmit = poolEndpoint;
+        m_maxBatch = std::max<size_t>(1, maxBatch);
+        Logger::info("PoolDispatcher", fmt::format("Envío por lotes - IA: {}, Pool: {}, máximo {} shares",
+                                                   iaEndpoint ? "sí" : "no", poolEndpoint ? "sí" : "no",
+                                                   m_maxBatch.load()));
+    }
+    
     void PoolDispatcher::registerDispatchCallback(DispatchCallback callback) {
         std::lock_guard<std::mutex> lock(m_mutex);
         m_callbacks.push_back(callback);
         Logger::info("Dispatch callback registered");
     }
     
-    bool PoolDispatcher::sendViaHttp(const PoolConfig& endpoint, 
-                                    const std::string& payload, 
-                                    double& outLatencyMs) {
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        try {
-            cpr::Session session;
-            session.SetUrl(cpr::Url{endpoint.url});
-            session.SetHeader({{"Content-Type", "application/json"}});
-            session.SetBody(cpr::Body{payload});
-            session.SetTimeout(std::chrono::milliseconds(m_timeoutMs));
-            
-            if (!endpoint.user.empty()) {
-                session.SetAuth(cpr::Authentication{endpoint.user, endpoint.pass});
+    bool PoolDispatcher::dispatchValidNonce(const std::string& jobId, uint64_t nonce,
+                                           const std::string& resultHash, 
+                                           const std::string& workerId) {
+        if (m_stopping.load(std::memory_order_relaxed)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (m_currentMode.load() == MiningMode::SOLO) {
+            // En solitario no hay shares: los bloques se envían al nodo con DaemonClient
+            if (m_dropped.fetch_add(1, std::memory_order_relaxed) == 0) {
+                Logger::warn("PoolDispatcher", "Modo solitario: las shares no se envían a ningún endpoint");
+            }
+            return false;
+        }
+
+        Submission share;
+        share.id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+        share.jobId = jobId;
+        share.nonce = nonce;
+        share.resultHash = resultHash;
+        share.workerId = workerId;
+        share.enqueuedAt = Clock::now();
+
+        if (!m_queue.tryPush(std::move(share))) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            Logger::warn("PoolDispatcher", fmt::format("Cola de envío llena ({}); share del job {} descartada",
+                                                       m_queue.capacity(), jobId));
+            return false;
+        }
+        m_queued.fetch_add(1, std::memory_order_relaxed);
+
+        // Sólo se toma el mutex si el hilo de E/S está dormido (pareja de la barrera de ioLoop)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_ioWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            m_ioCv.notify_one();
+        }
+        return true;
+    }
+
+    void PoolDispatcher::ioLoop() {
+        std::vector<Pending> ready;
+        ready.reserve(IO_DRAIN_LIMIT);
+        Submission share;
+
+        while (true) {
+            const bool stopping = m_stopping.load(std::memory_order_acquire);
+
+            while (ready.size() < IO_DRAIN_LIMIT && m_queue.tryPop(share)) {
+                Pending pending;
+                pending.share = std::move(share);
+                pending.target = selectTargetEndpoint();
+                ready.push_back(std::move(pending));
+            }
+
+            // Reintentos vencidos; al detenerse todos reciben su último intento ya
+            const auto now = Clock::now();
+            while (!m_retries.empty() && (stopping || m_retries.front().dueAt <= now)) {
+                std::pop_heap(m_retries.begin(), m_retries.end(), RetryOrder{});
+                Pending& pending = m_retries.back();
+                // Si su endpoint ha sido expulsado mientras esperaba, se elige otro
+                if (pending.target.health &&
+                    pending.target.health->state() != EndpointHealth::State::Healthy) {
+                    pending.target = selectTargetEndpoint();
+                }
+                ready.push_back(std::move(pending));
+                m_retries.pop_back();
+            }
+
+            if (now - m_lastStatsLog >= std::chrono::minutes(1)) {
+                logSubmissionStats();
+                m_lastStatsLog = now;
+            }
+
+            if (!ready.empty()) {
+                sendReady(ready);
+                ready.clear();
+                continue;
+            }
+            if (stopping) {
+                break;
+            }
+
+            auto deadline = now + std::chrono::seconds(1);
+            if (!m_retries.empty()) {
+                deadline = std::min(deadline, m_retries.front().dueAt);
             }
-            
-            auto response = session.Post();
-            outLatencyMs = std::chrono::duration<double, std::milli>(
-                std::chrono::high_resolution_clock::now() - start).count();
-            
-            bool success = (response.status_code >= 200 && response.status_code < 300);
-            if (!success) {
-                Logger::warn("HTTP error {} for endpoint: {}", response.status_code, endpoint.url);
+
+            std::unique_lock<std::mutex> lock(m_ioMutex);
+            m_ioWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_queue.sizeApprox() == 0 && !m_stopping.load(std::memory_order_relaxed)) {
+                m_ioCv.wait_until(lock, deadline);
+            }
+            m_ioWaiting.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void PoolDispatcher::sendReady(std::vector<Pending>& ready) {
+        const size_t maxBatch = m_maxBatch.load(std::memory_order_relaxed);
+        std::vector<bool> taken(ready.size(), false);
+        std::vector<Pending> chunk;
+
+        // Agrupa por endpoint conservando el orden de llegada
+        for (size_t i = 0; i < ready.size(); ++i) {
+            if (taken[i]) continue;
+
+            const std::string url = ready[i].target.url;
+            const size_t limit = ready[i].target.batchSubmit ? maxBatch : 1;
+            chunk.clear();
+            for (size_t j = i; j < ready.size() && chunk.size() < limit; ++j) {
+                if (!taken[j] && ready[j].target.url == url) {
+                    taken[j] = true;
+                    chunk.push_back(std::move(ready[j]));
+                }
+            }
+            sendChunk(chunk);
+        }
+    }
+
+    void PoolDispatcher::sendChunk(std::vector<Pending>& chunk) {
+        const PoolConfig target = chunk.front().target;
+        const auto sendAt = Clock::now();
+
+        json body = json::array();
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            for (auto& pending : chunk) {
+                ++pending.attempts;
+                if (!pending.sent) {
+                    pending.sent = true;
+                    m_submission.enqueueToSend.record(elapsedMs(pending.share.enqueuedAt, sendAt));
+                }
+                body.push_back(createPayload(target.protocol, pending.share.id, pending.share.jobId,
+                                             pending.share.nonce, pending.share.resultHash,
+                                             pending.share.workerId));
+            }
+            ++m_submission.requests;
+            if (chunk.size() > 1) ++m_submission.batches;
+        }
+
+        const HttpResult result = post(target, chunk.size() == 1 ? body[0].dump() : body.dump());
+        updateStats(target, result.delivered(), result.latencyMs);
+
+        if (!result.delivered()) {
+            Logger::warn("PoolDispatcher", result.error.empty()
+                ? fmt::format("HTTP {} de {} ({} shares)", result.status, target.url, chunk.size())
+                : fmt::format("Error de red con {}: {} ({} shares)", target.url, result.error, chunk.size()));
+            for (auto& pending : chunk) {
+                scheduleRetry(std::move(pending));
+            }
+            return;
+        }
+
+        // Un cuerpo que no es JSON con 2xx se considera aceptado, como hasta ahora
+        const json response = json::parse(result.body, nullptr, false);
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            Pending& pending = chunk[i];
+            const Verdict verdict = response.is_discarded()
+                ? Verdict::Accepted
+                : judge(findReply(response, pending.share.id, i, chunk.size()));
+
+            switch (verdict) {
+                case Verdict::Accepted:
+                    completeShare(pending, true, result.latencyMs);
+                    break;
+                case Verdict::Rejected: {
+                    const json* reply = findReply(response, pending.share.id, i, chunk.size());
+                    const json error = reply->value("error", json());
+                    Logger::warn("PoolDispatcher", fmt::format("Share del job {} rechazada por {}: {}",
+                                                               pending.share.jobId, target.url,
+                                                               error.is_null() ? "result=false" : error.dump()));
+                    completeShare(pending, false, result.latencyMs);
+                    break;
+                }
+                case Verdict::Missing:
+                    scheduleRetry(std::move(pending));
+                    break;
+            }
+        }
+    }
+
+    PoolDispatcher::HttpResult PoolDispatcher::post(const PoolConfig& endpoint, const std::string& body) {
+        HttpResult result;
+        const auto start = Clock::now();
+        try {
+            cpr::Session& session = sessionFor(endpoint);
+            session.SetBody(cpr::Body{body});
+            session.SetTimeout(std::chrono::milliseconds(m_timeoutMs.load()));
+
+            cpr::Response response = session.Post();
+            result.status = response.status_code;
+            result.body = std::move(response.text);
+            if (response.error) {
+                result.error = response.error.message;
             }
-            return success;
-            
         } catch (const std::exception& ex) {
-            Logger::error("HTTP exception for {}: {}", endpoint.url, ex.what());
-            outLatencyMs = 0;
-            return false;
+            result.error = ex.what();
+            m_sessions.erase(endpoint.url);     // el siguiente envío abre una sesión nueva
         }
+        result.latencyMs = elapsedMs(start, Clock::now());
+        return result;
     }
-    
-    std::pair<bool, double> PoolDispatcher::retrySend(const PoolConfig& endpoint, 
-                                                     const std::string& payload) {
-        for (uint8_t attempt = 0; attempt < m_maxRetries; ++attempt) {
-            double latencyMs = 0.0;
-            bool success = sendViaHttp(endpoint, payload, latencyMs);
-            
-            if (success) {
-                return {true, latencyMs};
+
+    cpr::Session& PoolDispatcher::sessionFor(const PoolConfig& endpoint) {
+        const uint64_t generation = m_endpointGeneration.load(std::memory_order_acquire);
+        if (generation != m_sessionGeneration) {
+            m_sessions.clear();
+            m_sessionGeneration = generation;
+        }
+
+        auto& session = m_sessions[endpoint.url];
+        if (!session) {
+            // La sesión conserva el handle de curl y con él la conexión keep-alive
+            session = std::make_unique<cpr::Session>();
+            session->SetUrl(cpr::Url{endpoint.url});
+            session->SetHeader({{"Content-Type", "application/json"}, {"Connection", "keep-alive"}});
+            if (!endpoint.user.empty()) {
+                session->SetAuth(cpr::Authentication{endpoint.user, endpoint.pass});
             }
-            
-            if (attempt < m_maxRetries - 1) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(m_retryDelayMs));
-                Logger::debug("Retry {} for endpoint {}", attempt + 1, endpoint.url);
+        }
+        return *session;
+    }
+
+    std::chrono::milliseconds PoolDispatcher::retryBackoff(uint8_t attempt) {
+        // retryDelay · 2^(intento-1) con jitter ×[0.5, 1.5) para no sincronizar reintentos
+        const uint32_t shift = std::min<uint32_t>(attempt > 0 ? attempt - 1 : 0, 16);
+        const uint32_t base = std::min<uint32_t>(static_cast<uint32_t>(m_retryDelayMs.load()) << shift, MAX_BACKOFF_MS);
+        std::uniform_real_distribution<double> jitter(0.5, 1.5);
+        return std::chrono::milliseconds(static_cast<int64_t>(base * jitter(m_jitterRng)));
+    }
+
+    void PoolDispatcher::scheduleRetry(Pending&& pending) {
+        if (m_stopping.load(std::memory_order_relaxed) || pending.attempts >= m_maxRetries.load()) {
+            {
+                std::lock_guard<std::mutex> lock(m_statsMutex);
+                ++m_submission.failed;
             }
+            Logger::warn("PoolDispatcher", fmt::format("Share del job {} sin entregar tras {} intentos",
+                                                       pending.share.jobId, pending.attempts));
+            notifyCallbacks(false, pending.target.url, 0.0);
+            return;
+        }
+
+        pending.dueAt = Clock::now() + retryBackoff(pending.attempts);
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            ++m_submission.retries;
         }
-        return {false, 0};
+        m_retries.push_back(std::move(pending));
+        std::push_heap(m_retries.begin(), m_retries.end(), RetryOrder{});
     }
-    
-    bool PoolDispatcher::dispatchValidNonce(const std::string& jobId, uint64_t nonce,
-                                           const std::string& resultHash, 
-                                           const std::string& workerId) {
-        const auto target = selectTargetEndpoint();
-        json payload = createPayload(target.protocol, jobId, nonce, resultHash, workerId);
-        
-        auto [success, latencyMs] = retrySend(target, payload.dump());
-        updateStats(target.url, success, latencyMs);
-        
-        // Notificar callbacks
+
+    void PoolDispatcher::completeShare(const Pending& pending, bool accepted, double ackMs) {
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            ++(accepted ? m_submission.accepted : m_submission.rejected);
+            m_submission.sendToAck.record(ackMs);
+            m_submission.enqueueToAck.record(elapsedMs(pending.share.enqueuedAt, Clock::now()));
+        }
+        notifyCallbacks(accepted, pending.target.url, ackMs);
+    }
+
+    void PoolDispatcher::notifyCallbacks(bool success, const std::string& endpoint, double latencyMs) {
         std::vector<DispatchCallback> callbacksCopy;
         {
             std::lock_guard<std::mutex> lock(m_mutex);
             callbacksCopy = m_callbacks;
         }
         for (const auto& callback : callbacksCopy) {
-            callback(success, target.url, latencyMs);
+            callback(success, endpoint, latencyMs);
         }
-        
-        return success;
+    }
+
+    SubmissionStats PoolDispatcher::getSubmissionStats() const {
+        SubmissionStats stats;
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            stats = m_submission;
+        }
+        stats.queued = m_queued.load(std::memory_order_relaxed);
+        stats.dropped = m_dropped.load(std::memory_order_relaxed);
+        stats.queueDepth = m_queue.sizeApprox();
+        return stats;
+    }
+
+    void PoolDispatcher::logSubmissionStats() {
+        const SubmissionStats stats = getSubmissionStats();
+        if (stats.queued == m_lastLogged.queued && stats.dropped == m_lastLogged.dropped) {
+            return;
+        }
+        m_lastLogged = stats;
+
+        Logger::info("PoolDispatcher", fmt::format(
+            "Shares: {} encoladas, {} aceptadas, {} rechazadas, {} fallidas, {} descartadas, {} reintentos, "
+            "{} en cola | cola→envío {:.1f}/{:.1f} ms, envío→ack {:.1f}/{:.1f} ms, total {:.1f}/{:.1f} ms (media/máx)",
+            stats.queued, stats.accepted, stats.rejected, stats.failed, stats.dropped, stats.retries,
+            stats.queueDepth,
+            stats.enqueueToSend.avgMs(), stats.enqueueToSend.maxMs,
+            stats.sendToAck.avgMs(), stats.sendToAck.maxMs,
+            stats.enqueueToAck.avgMs(), stats.enqueueToAck.maxMs));
     }
     
-    PoolDispatcher::PoolConfig PoolDispatcher::selectTargetEndpoint() const {
+    PoolConfig PoolDispatcher::selectTargetEndpoint() const {
+        PoolConfig iaEndpoint;
+        PoolConfig poolEndpoint;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            iaEndpoint = m_iaEndpoint;
+            poolEndpoint = m_poolEndpoint;
+        }
+
         switch (m_currentMode.load()) {
             case MiningMode::IA:
-                return m_iaEndpoint;
+                return iaEndpoint;
                 
             case MiningMode::SOLO:
-                return m_iaEndpoint; // Modo solo usa IA
+                // dispatchValidNonce no admite shares en solitario; sólo llegan aquí las
+                // encoladas antes del cambio de modo, que eran para la pool
+                return poolEndpoint;
                 
             case MiningMode::HYBRID: {
                 static thread_local std::mt19937 gen(std::random_device{}());
                 static std::uniform_real_distribution<> dis(0.0, 1.0);
-                return (dis(gen) < m_hybridRatio ? m_iaEndpoint : m_poolEndpoint;
+                return dis(gen) < m_hybridRatio ? iaEndpoint : poolEndpoint;
             }
                 
-            case MiningMode::SMART: {
-                double iaLatency = getCurrentLatency(m_iaEndpoint.url);
-                double poolLatency = getCurrentLatency(m_poolEndpoint.url);
-                
-                // Fallback si no hay datos
-                if (iaLatency == 0.0 && poolLatency == 0.0) {
-                    return m_iaEndpoint;
-                } else if (iaLatency == 0.0) {
-                    return m_poolEndpoint;
-                } else if (poolLatency == 0.0) {
-                    return m_iaEndpoint;
-                }
-                
-                return (iaLatency < poolLatency * m_smartThreshold) ? m_iaEndpoint : m_poolEndpoint;
-            }
+            case MiningMode::SMART:
+                return selectSmartEndpoint(iaEndpoint, poolEndpoint);
                 
             default: // POOL y otros
-                return m_poolEndpoint;
+                return poolEndpoint;
         }
     }
+
+    PoolConfig PoolDispatcher::selectSmartEndpoint(const PoolConfig& iaEndpoint,
+                                                   const PoolConfig& poolEndpoint) const {
+        EndpointHealth& ia = *iaEndpoint.health;
+        EndpointHealth& pool = *poolEndpoint.health;
+        const auto iaState = ia.state();
+        const auto poolState = pool.state();
+
+        // Un endpoint expulsado cuyo plazo venció recibe una única share de sonda
+        if (iaState == EndpointHealth::State::ProbeDue && ia.claimProbe()) {
+            return iaEndpoint;
+        }
+        if (poolState == EndpointHealth::State::ProbeDue && pool.claimProbe()) {
+            return poolEndpoint;
+        }
+
+        const bool iaUp = iaState == EndpointHealth::State::Healthy;
+        const bool poolUp = poolState == EndpointHealth::State::Healthy;
+        if (iaUp != poolUp) {
+            return iaUp ? iaEndpoint : poolEndpoint;
+        }
+        if (!iaUp) {
+            return poolEndpoint;    // ambos expulsados: la pool, como en modo POOL
+        }
+
+        const double iaLatency = ia.p95Ms();
+        const double poolLatency = pool.p95Ms();
+        
+        // Fallback si no hay datos
+        if (iaLatency == 0.0 && poolLatency == 0.0) {
+            return iaEndpoint;
+        } else if (iaLatency == 0.0) {
+            return poolEndpoint;
+        } else if (poolLatency == 0.0) {
+            return iaEndpoint;
+        }
+
+        // p95 por share entregada: un endpoint rápido que falla a menudo sale caro
+        const double iaCost = iaLatency / std::max(ia.successRate(), 0.05);
+        const double poolCost = poolLatency / std::max(pool.successRate(), 0.05);
+        return (iaCost < poolCost * m_smartThreshold) ? iaEndpoint : poolEndpoint;
+    }
     
     nlohmann::json PoolDispatcher::createPayload(Protocol protocol,
+                                               uint64_t requestId,
                                                const std::string& jobId, 
                                                uint64_t nonce, 
                                                const std::string& resultHash, 
@@ -197,7 +551,7 @@ namespace zartrux::dispatcher {
                         fmt::format("{:016x}", nonce),
                         resultHash
                     }},
-                    {"id", 1}
+                    {"id", requestId}
                 };
                 
             case Protocol::STRATUM_V2:
@@ -217,7 +571,7 @@ namespace zartrux::dispatcher {
                         resultHash,
                         jobId
                     }},
-                    {"id", 1}
+                    {"id", requestId}
                 };
                 
             default:
@@ -230,32 +584,129 @@ namespace zartrux::dispatcher {
         }
     }
     
-    void PoolDispatcher::updateStats(const std::string& endpoint, 
+    void PoolDispatcher::updateStats(const PoolConfig& endpoint, 
                                    bool success, 
                                    double latencyMs) {
-        std::lock_guard<std::mutex> lock(m_statsMutex);
-        DispatchStats& stats = m_stats[endpoint];
-        
-        if (success) {
-            stats.successCount++;
-            stats.avgResponseTimeMs = 
-                (stats.avgResponseTimeMs * (stats.successCount - 1) + latencyMs) / stats.successCount;
-        } else {
-            stats.failCount++;
+        if (endpoint.health) {
+            endpoint.health->record(success, latencyMs);
         }
-        
-        stats.successRate = static_cast<double>(stats.successCount) / 
-                          (stats.successCount + stats.failCount);
-        
-        Logger::debug("Endpoint {} stats: Success={}, Fail={}, AvgLatency={:.2f}ms", 
-                     endpoint, stats.successCount, stats.failCount, stats.avgResponseTimeMs);
     }
     
     double PoolDispatcher::getCurrentLatency(const std::string& endpoint) const noexcept {
-        std::lock_guard<std::mutex> lock(m_statsMutex);
-        if (auto it = m_stats.find(endpoint); it != m_stats.end()) {
-            return it->second.avgResponseTimeMs;
+        std::shared_ptr<EndpointHealth> health;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_iaEndpoint.url == endpoint) {
+                health = m_iaEndpoint.health;
+            } else if (m_poolEndpoint.url == endpoint) {
+                health = m_poolEndpoint.health;
+            }
+        }
+        return health ? health->p95Ms() : 0.0;
+    }
+
+    std::vector<DispatchStats> PoolDispatcher::getEndpointStats() const {
+        std::vector<std::shared_ptr<EndpointHealth>> endpoints;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            endpoints = {m_iaEndpoint.health, m_poolEndpoint.health};
+        }
+
+        std::vector<DispatchStats> result;
+        for (const auto& health : endpoints) {
+            if (health) {
+                result.push_back(health->snapshot());
+            }
+        }
+        return result;
+    }
+
+    void EndpointHealth::record(bool success, double latencyMs) {
+        if (success) {
+            m_successCount.fetch_add(1, std::memory_order_relaxed);
+            m_latency.record(latencyMs);
+            m_consecutiveFailures.store(0, std::memory_order_relaxed);
+        } else {
+            m_failCount.fetch_add(1, std::memory_order_relaxed);
+            m_consecutiveFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const double sample = success ? 0.0 : 1.0;
+        double ewma = m_failureEwma.load(std::memory_order_relaxed);
+        while (!m_failureEwma.compare_exchange_weak(ewma, ewma + EWMA_ALPHA * (sample - ewma),
+                                                    std::memory_order_relaxed)) {
+        }
+
+        if (m_ejectedUntilNs.load(std::memory_order_acquire) != 0) {
+            // Sólo cuenta la sonda; las respuestas tardías de envíos previos se ignoran
+            if (m_probeSinceNs.exchange(0) == 0) {
+                return;
+            }
+            if (success) {
+                m_ejectedUntilNs.store(0, std::memory_order_release);
+                m_ejectionMs.store(0, std::memory_order_relaxed);
+                m_failureEwma.store(EJECT_FAILURE_RATE / 2, std::memory_order_relaxed);
+                Logger::info("PoolDispatcher", fmt::format("{} responde de nuevo; vuelve a la rotación", m_url));
+            } else {
+                eject(std::min(m_ejectionMs.load(std::memory_order_relaxed) * 2, EJECT_MAX_MS));
+            }
+            return;
+        }
+
+        const uint64_t samples = m_successCount.load(std::memory_order_relaxed) +
+                                 m_failCount.load(std::memory_order_relaxed);
+        if (!success && (m_consecutiveFailures.load(std::memory_order_relaxed) >= EJECT_CONSECUTIVE ||
+                         (samples >= EJECT_MIN_SAMPLES &&
+                          m_failureEwma.load(std::memory_order_relaxed) >= EJECT_FAILURE_RATE))) {
+            eject(EJECT_BASE_MS);
         }
-        return 0.0;
+    }
+
+    void EndpointHealth::eject(int64_t durationMs) {
+        m_ejectionMs.store(durationMs, std::memory_order_relaxed);
+        m_ejectedUntilNs.store(steadyNs() + durationMs * 1000000, std::memory_order_release);
+        Logger::warn("PoolDispatcher", fmt::format("{} expulsado {} s (tasa de fallos {:.0f}%)", m_url,
+                                                   durationMs / 1000,
+                                                   m_failureEwma.load(std::memory_order_relaxed) * 100.0));
+    }
+
+    EndpointHealth::State EndpointHealth::state() const {
+        const int64_t until = m_ejectedUntilNs.load(std::memory_order_acquire);
+        if (until == 0) {
+            return State::Healthy;
+        }
+        const int64_t now = steadyNs();
+        const int64_t probeSince = m_probeSinceNs.load(std::memory_order_relaxed);
+        if (now < until || (probeSince != 0 && now - probeSince < PROBE_TIMEOUT_MS * 1000000)) {
+            return State::Ejected;
+        }
+        return State::ProbeDue;
+    }
+
+    bool EndpointHealth::claimProbe() {
+        // Una sonda que no volvió (reencaminada, caída del hilo...) caduca tras PROBE_TIMEOUT_MS
+        const int64_t now = steadyNs();
+        int64_t since = m_probeSinceNs.load(std::memory_order_relaxed);
+        if (since != 0 && now - since < PROBE_TIMEOUT_MS * 1000000) {
+            return false;
+        }
+        return m_probeSinceNs.compare_exchange_strong(since, now);
+    }
+
+    DispatchStats EndpointHealth::snapshot() const {
+        const auto latency = m_latency.snapshot();
+
+        DispatchStats stats;
+        stats.url = m_url;
+        stats.successCount = m_successCount.load(std::memory_order_relaxed);
+        stats.failCount = m_failCount.load(std::memory_order_relaxed);
+        stats.avgResponseTimeMs = latency.meanMs;
+        stats.successRate = successRate();
+        stats.p50Ms = latency.p50Ms;
+        stats.p95Ms = latency.p95Ms;
+        stats.p99Ms = latency.p99Ms;
+        stats.ejected = state() != State::Healthy;
+        stats.histogram = latency.buckets;
+        return stats;
     }
 } // namespace zartrux::dispatcher
\ No newline at end of file
@@ -4,23 +4,82 @@
 #include <string>
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <random>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include <cpr/cpr.h>
+#include <nlohmann/json.hpp>
 
 // Usar el MiningMode del sistema global
 #include "MiningModeManager.h"
+#include "utils/BoundedQueue.h"
+#include "utils/LatencyHistogram.h"
 
 namespace zartrux::dispatcher {
     enum class Protocol { STRATUM_V1, STRATUM_V2, ETHPROTOCOL_V1 };
 
     struct DispatchStats {
+        std::string url;
         uint64_t successCount{0};
         uint64_t failCount{0};
-        double avgResponseTimeMs{0.0};
-        double successRate{0.0};
+        double avgResponseTimeMs{0.0};      // media del histograma (con olvido)
+        double successRate{0.0};            // EWMA de las últimas peticiones
+        double p50Ms{0.0};
+        double p95Ms{0.0};
+        double p99Ms{0.0};
+        bool ejected{false};
+        std::vector<zartrux::LatencyHistogram::Bucket> histogram;
+    };
+
+    /**
+     * @class EndpointHealth
+     * @brief Latencia y tasa de fallos recientes de un endpoint, sin locks.
+     *
+     * Latencias en un histograma HDR con vida media de un minuto; fallos en una EWMA.
+     * Tras EJECT_CONSECUTIVE fallos seguidos, o con la EWMA por encima de EJECT_FAILURE_RATE,
+     * el endpoint queda expulsado: SMART deja de elegirlo y, al vencer el plazo, le envía
+     * una única share de sonda. Si la sonda falla el plazo se duplica (hasta EJECT_MAX_MS).
+     */
+    class EndpointHealth {
+    public:
+        enum class State { Healthy, Ejected, ProbeDue };
+
+        static constexpr double EWMA_ALPHA = 0.1;
+        static constexpr uint32_t EJECT_CONSECUTIVE = 3;
+        static constexpr double EJECT_FAILURE_RATE = 0.5;
+        static constexpr uint64_t EJECT_MIN_SAMPLES = 10;
+        static constexpr int64_t EJECT_BASE_MS = 5000;
+        static constexpr int64_t EJECT_MAX_MS = 300000;
+        static constexpr int64_t PROBE_TIMEOUT_MS = 30000;     // sonda sin respuesta: se permite otra
+
+        explicit EndpointHealth(std::string url) : m_url(std::move(url)) {}
+
+        void record(bool success, double latencyMs);
+        State state() const;
+        // Reserva la sonda de un endpoint en ProbeDue; false si otra ya está en curso
+        bool claimProbe();
+
+        double p95Ms() const { return m_latency.percentile(0.95); }
+        double successRate() const { return 1.0 - m_failureEwma.load(std::memory_order_relaxed); }
+        DispatchStats snapshot() const;
+
+    private:
+        void eject(int64_t durationMs);
+
+        const std::string m_url;
+        zartrux::LatencyHistogram m_latency;
+        std::atomic<uint64_t> m_successCount{0};
+        std::atomic<uint64_t> m_failCount{0};
+        std::atomic<double> m_failureEwma{0.0};
+        std::atomic<uint32_t> m_consecutiveFailures{0};
+        std::atomic<int64_t> m_ejectedUntilNs{0};      // 0 = activo
+        std::atomic<int64_t> m_ejectionMs{0};
+        std::atomic<int64_t> m_probeSinceNs{0};        // 0 = sin sonda en curso
     };
 
     struct PoolConfig {
@@ -28,6 +87,37 @@ namespace zartrux::dispatcher {
         std::string user;
         std::string pass;
         Protocol protocol{Protocol::STRATUM_V2};
+        bool batchSubmit{false};    // acepta varios envíos en un único array JSON
+        std::shared_ptr<EndpointHealth> health;     // compartida por todas las copias de este endpoint
+    };
+
+    struct StageLatency {
+        uint64_t count{0};
+        double sumMs{0.0};
+        double maxMs{0.0};
+
+        void record(double ms) {
+            ++count;
+            sumMs += ms;
+            if (ms > maxMs) maxMs = ms;
+        }
+        double avgMs() const { return count ? sumMs / count : 0.0; }
+    };
+
+    // Contadores de la cola de envío; las latencias siguen cada share enqueue → send → ack
+    struct SubmissionStats {
+        uint64_t queued{0};
+        uint64_t dropped{0};        // cola llena o dispatcher detenido
+        uint64_t requests{0};       // peticiones HTTP realizadas
+        uint64_t batches{0};        // peticiones con más de una share
+        uint64_t accepted{0};
+        uint64_t rejected{0};       // respuesta de la pool con error
+        uint64_t failed{0};         // reintentos agotados sin respuesta válida
+        uint64_t retries{0};
+        size_t queueDepth{0};
+        StageLatency enqueueToSend;
+        StageLatency sendToAck;
+        StageLatency enqueueToAck;
     };
 
     class PoolDispatcher {
@@ -40,6 +130,7 @@ namespace zartrux::dispatcher {
         // Eliminar copias
         PoolDispatcher(const PoolDispatcher&) = delete;
         PoolDispatcher& operator=(const PoolDispatcher&) = delete;
+        ~PoolDispatcher();
         
         // Gestión de modos
         void setMode(::MiningMode mode);
@@ -55,33 +146,88 @@ namespace zartrux::dispatcher {
         void setRetryPolicy(uint8_t maxRetries, uint16_t retryDelayMs);
         void setTimeout(uint16_t timeoutMs);
         void setSmartThreshold(double threshold);
+        void setBatchSubmit(bool iaEndpoint, bool poolEndpoint, size_t maxBatch = 16);
         
         // Callbacks y monitoreo
         void registerDispatchCallback(DispatchCallback callback);
+        // p95 reciente en ms del endpoint configurado con esa URL; 0 sin datos
         double getCurrentLatency(const std::string& endpoint) const noexcept;
+        std::vector<DispatchStats> getEndpointStats() const;
+        SubmissionStats getSubmissionStats() const;
         
-        // Operación principal
+        /**
+         * @brief Encola la share para el hilo de E/S y vuelve sin tocar la red.
+         * @return false si la cola está llena, el dispatcher se ha detenido o el modo es SOLO
+         *         (share descartada; en solitario los bloques van al nodo con DaemonClient).
+         *         El resultado del envío llega por DispatchCallback desde el hilo de E/S.
+         */
         bool dispatchValidNonce(const std::string& jobId, uint64_t nonce, 
                                 const std::string& resultHash, 
                                 const std::string& workerId = "");
 
+        /**
+         * @brief Detiene el hilo de E/S: lo ya encolado recibe un último intento y los
+         *        reintentos pendientes se resuelven ahora. Idempotente.
+         */
+        void shutdown();
+
     private:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t QUEUE_CAPACITY = 4096;
+        static constexpr size_t IO_DRAIN_LIMIT = 256;
+        static constexpr uint32_t MAX_BACKOFF_MS = 30000;
+
+        struct Submission {
+            uint64_t id{0};
+            std::string jobId;
+            uint64_t nonce{0};
+            std::string resultHash;
+            std::string workerId;
+            Clock::time_point enqueuedAt{};
+        };
+
+        // Share en manos del hilo de E/S
+        struct Pending {
+            Submission share;
+            PoolConfig target;
+            uint8_t attempts{0};
+            bool sent{false};
+            Clock::time_point dueAt{};
+        };
+
+        struct HttpResult {
+            long status{0};
+            std::string body;
+            std::string error;
+            double latencyMs{0.0};
+
+            bool delivered() const { return error.empty() && status >= 200 && status < 300; }
+        };
+
         PoolDispatcher();
         
-        // Métodos internos
-        bool sendViaHttp(const PoolConfig& endpoint, 
-                         const std::string& payload, 
-                         double& outLatencyMs);
-        std::pair<bool, double> retrySend(const PoolConfig& endpoint, 
-                                          const std::string& payload);
-        void updateStats(const std::string& endpoint, 
+        // Hilo de E/S
+        void ioLoop();
+        void sendReady(std::vector<Pending>& ready);
+        void sendChunk(std::vector<Pending>& chunk);
+        HttpResult post(const PoolConfig& endpoint, const std::string& body);
+        cpr::Session& sessionFor(const PoolConfig& endpoint);
+        void scheduleRetry(Pending&& pending);
+        void completeShare(const Pending& pending, bool accepted, double ackMs);
+        std::chrono::milliseconds retryBackoff(uint8_t attempt);
+        void logSubmissionStats();
+
+        void updateStats(const PoolConfig& endpoint, 
                          bool success, 
                          double latencyMs);
         void notifyCallbacks(bool success, 
                              const std::string& endpoint, 
                              double latencyMs);
         PoolConfig selectTargetEndpoint() const;
+        PoolConfig selectSmartEndpoint(const PoolConfig& iaEndpoint, const PoolConfig& poolEndpoint) const;
         nlohmann::json createPayload(Protocol protocol,
+                                     uint64_t requestId,
                                      const std::string& jobId, 
                                      uint64_t nonce, 
                                      const std::string& resultHash, 
@@ -104,7 +250,29 @@ namespace zartrux::dispatcher {
         
         // Estadísticas y métricas
         mutable std::mutex m_statsMutex;
-        std::unordered_map<std::string, DispatchStats> m_stats;
+        SubmissionStats m_submission;
+        std::atomic<uint64_t> m_queued{0};
+        std::atomic<uint64_t> m_dropped{0};
+
+        // Cola de envío: productores = workers, consumidor = hilo de E/S
+        BoundedQueue<Submission> m_queue{QUEUE_CAPACITY};
+        std::atomic<uint64_t> m_nextId{1};
+        std::atomic<size_t> m_maxBatch{16};
+        std::atomic<bool> m_stopping{false};
+        std::atomic<bool> m_ioWaiting{false};   // el hilo de E/S duerme: los productores deben despertarlo
+        std::mutex m_ioMutex;
+        std::condition_variable m_ioCv;
+        std::atomic<uint64_t> m_endpointGeneration{0};
+
+        // Sólo los toca el hilo de E/S
+        std::unordered_map<std::string, std::unique_ptr<cpr::Session>> m_sessions;   // keep-alive por URL
+        uint64_t m_sessionGeneration{0};
+        std::vector<Pending> m_retries;          // heap por dueAt
+        std::mt19937 m_jitterRng{std::random_device{}()};
+        SubmissionStats m_lastLogged;
+        Clock::time_point m_lastStatsLog{Clock::now()};
+
+        std::thread m_ioThread;
     };
 
 } // namespace zartrux::dispatcher
@@ -46,6 +46,14 @@ uint64_t SmartCache::allocateNonceRange(size_t count) {
     return m_nextNonce.fetch_add(count, std::memory_order_relaxed);
 }
 
+uint64_t SmartCache::nextNonce() const {
+    return m_nextNonce.load(std::memory_order_relaxed);
+}
+
+void SmartCache::restoreNextNonce(uint64_t nonce) {
+    m_nextNonce.store(nonce, std::memory_order_relaxed);
+}
+
 std::shared_ptr<const std::vector<uint8_t>> SmartCache::getDataset(const std::string& seed) {
     std::lock_guard<std::mutex> lock(m_mutex);
     
@@ -31,6 +31,12 @@ public:
      * @return Primer nonce del rango reservado
      */
     uint64_t allocateNonceRange(size_t count);
+
+    /**
+     * Posición del contador de nonces (checkpoint de JobManager)
+     */
+    uint64_t nextNonce() const;
+    void restoreNextNonce(uint64_t nonce);
     
     /**
      * Obtiene un dataset de RandomX para minería
@@ -74,8 +80,9 @@ private:
     };
     
     // Miembros
-    std::atomic<uint64_t> m_nextNonce;
-    mutable std::mutex m_mutex;
+    // En su propia línea de caché: los workers lo tocan una vez por bloque de nonces
+    alignas(64) std::atomic<uint64_t> m_nextNonce;
+    alignas(64) mutable std::mutex m_mutex;
     
     // Cache de datasets
     std::vector<DatasetHandle> m_datasetCache;
@@ -1,14 +1,119 @@
 #include "hash.h"
 #include "utils/Logger.h" // Se asume que Logger está en utils
+#include "memory/VirtualMemory.h"
+#include "memory/NumaTopology.h"
+#include "memory/DatasetStore.h"
 #include <stdexcept>
 #include <cstring>
 #include <thread>
 #include <mutex>
 #include <vector>
 #include <chrono>
+#include <algorithm>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace core {
 
+namespace {
+
+// Los hilos de construcción en segundo plano ceden la CPU a los de minado
+void lowerCurrentThreadPriority() {
+#if defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+}
+
+std::string keyPrefix(const std::vector<uint8_t>& key) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    std::string out;
+    for (size_t i = 0; i < key.size() && i < 4; ++i) {
+        out += HEX[key[i] >> 4];
+        out += HEX[key[i] & 0x0F];
+    }
+    return out;
+}
+
+// Huella de los parámetros del algoritmo: una entrada del almacén sólo vale para la misma variante
+uint64_t storeConfigTag() {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash ^= p[i];
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    const auto& cfg = RandomX_CurrentConfig;
+    const uint64_t params[] = {cfg.ArgonMemory, cfg.ArgonIterations, cfg.ArgonLanes,
+                               cfg.DatasetBaseSize, cfg.DatasetExtraSize, cfg.CacheAccesses};
+    mix(params, sizeof(params));
+    mix(cfg.ArgonSalt, std::strlen(cfg.ArgonSalt));
+    return hash;
+}
+
+} // namespace
+
+std::vector<uint8_t> seedKeyFromString(const std::string& seed) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    const bool hex = seed.size() == 64 &&
+        std::all_of(seed.begin(), seed.end(), [&](char c) { return nibble(c) >= 0; });
+    if (!hex) return std::vector<uint8_t>(seed.begin(), seed.end());
+
+    std::vector<uint8_t> key(32);
+    for (size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<uint8_t>((nibble(seed[2 * i]) << 4) | nibble(seed[2 * i + 1]));
+    }
+    return key;
+}
+
+// --- RandomXEpoch ----
+
+RandomXEpoch::~RandomXEpoch() {
+    for (auto& replica : m_replicas) {
+        if (replica.dataset) randomx_release_dataset(replica.dataset);
+        freeBuffer(replica.memory);
+    }
+    if (m_cache) randomx_release_cache(m_cache);
+    freeBuffer(m_cacheMemory);
+}
+
+void RandomXEpoch::freeBuffer(Buffer& buffer) {
+    if (buffer.mappedBytes) {
+        zartrux::DatasetStore::unmap(buffer.memory, buffer.mappedBytes);
+    } else {
+        zartrux::VirtualMemory::release(buffer.memory);
+    }
+    buffer = {};
+}
+
+randomx_dataset* RandomXEpoch::dataset(uint32_t node) const {
+    for (const auto& replica : m_replicas) {
+        if (replica.node == node) return replica.dataset;
+    }
+    return m_replicas.empty() ? nullptr : m_replicas.front().dataset;
+}
+
+std::vector<NodePlacement> RandomXEpoch::placement() const {
+    std::vector<NodePlacement> result;
+    for (const auto& replica : m_replicas) result.push_back(replica.placement);
+    return result;
+}
+
 // --- RandomXContext ----
 
 RandomXContext& RandomXContext::getInstance() {
@@ -19,80 +124,501 @@ RandomXContext& RandomXContext::getInstance() {
 RandomXContext::RandomXContext() = default;
 RandomXContext::~RandomXContext() { destroy(); }
 
+RandomXEpoch::Buffer RandomXContext::allocateBuffer(size_t bytes, const char* label, bool allow1GB) const {
+    zartrux::VirtualMemory::AllocationOptions options;
+    options.label = label;
+    options.allow1GB = allow1GB && m_config.oneGbPages;
+    options.lock = m_config.lockMemory;
+    const auto allocation = zartrux::VirtualMemory::allocate(bytes, options);
+
+    RandomXEpoch::Buffer buffer;
+    buffer.memory = static_cast<uint8_t*>(allocation.ptr);
+    buffer.size = allocation.size;
+    buffer.hugePages = allocation.kind != zartrux::VirtualMemory::PageKind::Normal;
+    return buffer;
+}
+
 void RandomXContext::initialize(const std::vector<uint8_t>& key, const RandomXConfig& config) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (m_initialized) return;
+    std::shared_ptr<const RandomXEpoch> built;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_initialized) return;
+
+        m_config = config;
+        m_store = config.storeDirectory.empty()
+            ? nullptr
+            : std::make_unique<zartrux::DatasetStore>(config.storeDirectory);
+        if (m_store && !m_store->enabled()) m_store.reset();
+        m_current = buildEpoch(key, false);
+        m_initialized = true;
+        built = m_current;
+    }
+    // Fuera del lock: persistEpoch lo toma para decidir qué épocas conservar
+    persistEpoch(built);
+}
 
-    auto start_time = std::chrono::high_resolution_clock::now();
+std::shared_ptr<RandomXEpoch> RandomXContext::buildEpoch(const std::vector<uint8_t>& key, bool background) const {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto elapsedMs = [](Clock::time_point from) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - from).count());
+    };
 
-    m_config = config;
+    // El destructor de la época libera lo ya reservado si algo falla a mitad
+    std::shared_ptr<RandomXEpoch> epoch(new RandomXEpoch());
+    epoch->m_key = key;
+    auto& timings = epoch->m_timings;
 
-    m_cache = randomx_create_cache(m_config.flags, nullptr);
-    if (!m_cache) {
+    // La cache con JIT genera el código de inicialización del dataset (varias veces más rápido
+    // que el intérprete); si no se fuerza, la variante AVX2 la elige el compilador según la CPU.
+    const randomx_flags cacheFlags = randomx_have_jit()
+        ? static_cast<randomx_flags>(m_config.flags | RANDOMX_FLAG_JIT)
+        : m_config.flags;
+    randomx_set_optimized_dataset_init(m_config.optimizedDatasetInit);
+    randomx_set_dual_mapped_jit(m_config.jitDualMapping);
+
+    const size_t cacheBytes = static_cast<size_t>(RandomX_CurrentConfig.ArgonMemory) * 1024;
+    epoch->m_cacheMemory = allocateBuffer(cacheBytes, "cache", false);
+    randomx_flags createdFlags = cacheFlags;
+    epoch->m_cache = randomx_create_cache(createdFlags, epoch->m_cacheMemory.memory);
+    if (!epoch->m_cache && cacheFlags != m_config.flags) {
+        // Sin memoria ejecutable (W^X) el JIT no arranca: se inicializa con los flags
+        // configurados, como si no se hubiera pedido el JIT
+        Logger::warn("RandomXContext", "No se pudo crear la caché con JIT; se usa el intérprete para el dataset");
+        createdFlags = m_config.flags;
+        epoch->m_cache = randomx_create_cache(createdFlags, epoch->m_cacheMemory.memory);
+    }
+    if (!epoch->m_cache) {
         throw std::runtime_error("Fallo al reservar la caché de RandomX");
     }
+    timings.jitInit = (createdFlags & RANDOMX_FLAG_JIT) != 0;
 
-    randomx_init_cache(m_cache, key.data(), key.size());
+    // Con el relleno Argon2 en el almacén sólo quedan por generar los programas superescalares
+    reportProgress({BuildProgress::Phase::CacheFill, 0, 0, elapsedMs(start), background});
+    auto phase = Clock::now();
+    if (m_store) {
+        auto stored = m_store->load(zartrux::DatasetStore::Kind::Cache, key, cacheBytes, storeConfigTag());
+        if (stored) {
+            std::memcpy(epoch->m_cacheMemory.memory, stored.data, cacheBytes);
+            zartrux::DatasetStore::unmap(stored);
+            epoch->m_cacheFromStore = true;
+        }
+    }
+    if (!epoch->m_cacheFromStore) {
+        randomx_fill_cache(epoch->m_cache, key.data(), key.size());
+    }
+    timings.argonMs = elapsedMs(phase);
+
+    reportProgress({BuildProgress::Phase::Programs, 0, 0, elapsedMs(start), background});
+    phase = Clock::now();
+    randomx_init_cache_programs(epoch->m_cache, key.data(), key.size());
+    timings.programsMs = elapsedMs(phase);
+    Logger::info("RandomXContext", "Cache: %.1f%% en huge pages",
+                 zartrux::VirtualMemory::measureCoverage(epoch->m_cacheMemory.memory, epoch->m_cacheMemory.size).fraction() * 100.0);
 
     if (m_config.fullMemory) {
-        m_dataset = randomx_create_dataset(nullptr);
-        if (!m_dataset) {
-            randomx_release_cache(m_cache);
-            m_cache = nullptr;
+        buildReplicas(*epoch, background, start);
+    }
+
+    timings.totalMs = elapsedMs(start);
+    reportProgress({BuildProgress::Phase::Done, 0, 0, timings.totalMs, background});
+    // --- MEJORA (Punto 5): Métrica de rendimiento ---
+    Logger::info("RandomXContext", "Época %s preparada en %llu ms%s%s (argon2 %llu, programas %llu, reserva %llu, "
+                 "prefault %llu, items %llu ms; %u hilos, init %s).", keyPrefix(key).c_str(),
+                 static_cast<unsigned long long>(timings.totalMs), background ? " (segundo plano)" : "",
+                 epoch->loadedFromStore() ? " desde el almacén" : "",
+                 static_cast<unsigned long long>(timings.argonMs), static_cast<unsigned long long>(timings.programsMs),
+                 static_cast<unsigned long long>(timings.allocMs), static_cast<unsigned long long>(timings.prefaultMs),
+                 static_cast<unsigned long long>(timings.itemsMs), timings.threads, timings.jitInit ? "JIT" : "intérprete");
+    return epoch;
+}
+
+void RandomXContext::buildReplicas(RandomXEpoch& epoch, bool background,
+                                   std::chrono::steady_clock::time_point start) const {
+    using Clock = std::chrono::steady_clock;
+    auto msSince = [](Clock::time_point from, Clock::time_point to) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count());
+    };
+    const auto& topology = zartrux::NumaTopology::instance();
+    const size_t datasetBytes = static_cast<size_t>(randomx_dataset_item_count()) * RANDOMX_DATASET_ITEM_SIZE;
+    auto& timings = epoch.m_timings;
+    const auto allocStart = Clock::now();
+
+    // Una réplica por nodo; sin NUMA (o desactivado) una sola réplica sobre todas las CPUs
+    std::vector<zartrux::NumaTopology::Node> nodes = topology.nodes();
+    if (!m_config.numa || nodes.size() == 1) {
+        nodes = {{0, topology.allCpus()}};
+    }
+    // Se construye en las CPUs que van a minar: la réplica queda en su nodo y en sus cachés
+    if (!m_config.builderCpus.empty()) {
+        for (auto& node : nodes) {
+            std::vector<unsigned> mining;
+            for (unsigned cpu : node.cpus) {
+                if (std::find(m_config.builderCpus.begin(), m_config.builderCpus.end(), cpu) !=
+                    m_config.builderCpus.end()) {
+                    mining.push_back(cpu);
+                }
+            }
+            // Un nodo sin hilos de minado conserva todas sus CPUs
+            if (!mining.empty()) node.cpus = std::move(mining);
+        }
+    }
+
+    // Dataset guardado: las réplicas se copian de él en vez de calcularse. En hugetlbfs y con
+    // una sola réplica el propio fichero mapeado hace de dataset, sin copia.
+    zartrux::DatasetStore::Mapping stored;
+    if (m_store) {
+        stored = m_store->load(zartrux::DatasetStore::Kind::Dataset, epoch.m_key, datasetBytes, storeConfigTag());
+    }
+    const bool adoptStored = stored && stored.hugetlbfs && nodes.size() == 1;
+    epoch.m_datasetFromStore = static_cast<bool>(stored);
+
+    for (const auto& node : nodes) {
+        RandomXEpoch::Replica replica;
+        replica.node = node.id;
+        if (adoptStored) {
+            replica.memory.memory = stored.data;
+            replica.memory.size = stored.size;
+            replica.memory.hugePages = true;
+            replica.memory.mappedBytes = stored.mappedBytes;
+            stored = {};
+            replica.dataset = randomx_create_dataset(replica.memory.memory);
+            replica.placement.node = node.id;
+            replica.placement.datasetBytes = datasetBytes;
+            replica.placement.hugePages = true;
+            epoch.m_replicas.push_back(std::move(replica));
+            continue;
+        }
+        const std::string label = "dataset[nodo " + std::to_string(node.id) + "]";
+        replica.memory = allocateBuffer(datasetBytes, label.c_str(), true);
+        if (!replica.memory.memory) {
+            zartrux::DatasetStore::unmap(stored);
+            throw std::runtime_error("Fallo al reservar el dataset de RandomX");
+        }
+        // La política se fija antes de tocar la memoria; el primer acceso lo hacen hilos del nodo
+        replica.placement.policyApplied = topology.isNuma() && m_config.numa &&
+            zartrux::NumaTopology::bindMemory(replica.memory.memory, datasetBytes, node.id);
+        replica.dataset = randomx_create_dataset(replica.memory.memory);
+        if (!replica.dataset) {
+            RandomXEpoch::freeBuffer(replica.memory);
+            zartrux::DatasetStore::unmap(stored);
             throw std::runtime_error("Fallo al reservar el dataset de RandomX");
         }
+        replica.placement.node = node.id;
+        replica.placement.datasetBytes = datasetBytes;
+        replica.placement.hugePages = replica.memory.hugePages;
+        epoch.m_replicas.push_back(std::move(replica));
+    }
+    timings.allocMs = msSince(allocStart, Clock::now());
+
+    // Todas las réplicas se construyen a la vez, cada una con hilos fijados a CPUs de su nodo,
+    // en dos fases: primer acceso a las páginas (en paralelo, así los fallos de página de
+    // 2 MB no se serializan) y generación de items en trozos para poder informar del progreso.
+    const unsigned long items_count = randomx_dataset_item_count();
+    const uint64_t totalItems = static_cast<uint64_t>(items_count) * (adoptStored ? 0 : epoch.m_replicas.size());
+    unsigned totalThreads = 0;
+    if (!adoptStored) {
+        for (const auto& node : nodes) totalThreads += std::max<unsigned>(1, static_cast<unsigned>(node.cpus.size()));
+    }
+    timings.threads = totalThreads;
+
+    std::vector<std::thread> threads;
+    std::vector<Clock::time_point> finished(epoch.m_replicas.size(), Clock::now());
+    std::vector<std::atomic<unsigned>> pending(epoch.m_replicas.size());
+    std::atomic<unsigned> prefaulting{totalThreads};
+    std::atomic<unsigned> running{totalThreads};
+    std::atomic<uint64_t> itemsDone{0};
+    std::atomic<int64_t> prefaultEndNs{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    const auto build_start = Clock::now();
+    constexpr unsigned long CHUNK_ITEMS = 1ul << 14;   // 1 MB por trozo
+
+    for (size_t r = 0; r < epoch.m_replicas.size() && !adoptStored; ++r) {
+        const auto& cpus = nodes[r].cpus;
+        const unsigned thread_count = std::max<unsigned>(1, static_cast<unsigned>(cpus.size()));
+        const unsigned long items_per_thread = items_count / thread_count;
+        pending[r] = thread_count;
 
-        // --- MEJORA (Punto 4a): Inicialización del dataset en paralelo ---
-        unsigned thread_count = std::thread::hardware_concurrency();
-        if (thread_count == 0) thread_count = 1;
-        
-        unsigned long items_count = randomx_dataset_item_count();
-        unsigned long items_per_thread = items_count / thread_count;
-        
-        std::vector<std::thread> threads;
         for (unsigned i = 0; i < thread_count; ++i) {
-            unsigned long start_item = i * items_per_thread;
-            unsigned long count = (i == thread_count - 1) 
-                                ? (items_count - start_item) 
-                                : items_per_thread;
-            
-            threads.emplace_back(randomx_init_dataset, m_dataset, m_cache, start_item, count);
+            const unsigned long start_item = i * items_per_thread;
+            const unsigned long count = (i == thread_count - 1)
+                                      ? (items_count - start_item)
+                                      : items_per_thread;
+            const bool pin = !cpus.empty();
+            const unsigned cpu = cpus.empty() ? 0 : cpus[i];
+            const uint8_t* source = stored.data;
+            threads.emplace_back([&, r, start_item, count, pin, cpu, source] {
+                if (pin) zartrux::NumaTopology::pinThreadToCpu(cpu);
+                if (background) lowerCurrentThreadPriority();
+                uint8_t* memory = epoch.m_replicas[r].memory.memory;
+
+                // Fase 1: primer acceso desde el propio nodo, una escritura por página de 4 KB
+                volatile uint8_t* page = memory + start_item * RANDOMX_DATASET_ITEM_SIZE;
+                const size_t bytes = count * RANDOMX_DATASET_ITEM_SIZE;
+                for (size_t offset = 0; offset < bytes; offset += 4096) page[offset] = 0;
+                if (prefaulting.fetch_sub(1) == 1) {
+                    prefaultEndNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now().time_since_epoch()).count();
+                }
+                // Sin barrera: cada hilo sólo toca su rango, así que puede empezar a generar ya
+
+                // Fase 2: items (o copia desde el almacén) en trozos
+                for (unsigned long done = 0; done < count; done += CHUNK_ITEMS) {
+                    const unsigned long n = std::min(CHUNK_ITEMS, count - done);
+                    const unsigned long item = start_item + done;
+                    if (source) {
+                        std::memcpy(memory + item * RANDOMX_DATASET_ITEM_SIZE,
+                                    source + item * RANDOMX_DATASET_ITEM_SIZE, n * RANDOMX_DATASET_ITEM_SIZE);
+                    } else {
+                        randomx_init_dataset(epoch.m_replicas[r].dataset, epoch.m_cache, item, n);
+                    }
+                    itemsDone.fetch_add(n, std::memory_order_relaxed);
+                }
+                if (pending[r].fetch_sub(1) == 1) {
+                    finished[r] = Clock::now();
+                }
+                if (running.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    doneCv.notify_all();
+                }
+            });
+        }
+    }
+
+    // El hilo que construye informa del progreso mientras espera
+    reportProgress({BuildProgress::Phase::Prefault, 0, totalItems, msSince(start, Clock::now()), background});
+    bool prefaultReported = false;
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        while (!doneCv.wait_for(lock, std::chrono::milliseconds(250), [&] { return running.load() == 0; })) {
+            if (!prefaultReported && prefaulting.load() != 0) continue;
+            prefaultReported = true;
+            reportProgress({BuildProgress::Phase::Dataset, itemsDone.load(std::memory_order_relaxed), totalItems,
+                            msSince(start, Clock::now()), background});
+        }
+    }
+    for (auto& t : threads) {
+        if (t.joinable()) {
+            t.join();
         }
+    }
+    zartrux::DatasetStore::unmap(stored);
+    reportProgress({BuildProgress::Phase::Dataset, totalItems, totalItems, msSince(start, Clock::now()), background});
+
+    const auto build_end = Clock::now();
+    if (totalThreads) {
+        // El primer acceso de los hilos más lentos se solapa con la generación de los rápidos;
+        // se atribuye a prefault hasta que termina el último
+        const auto prefaultEnd = Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::nanoseconds(prefaultEndNs.load())));
+        timings.prefaultMs = msSince(build_start, prefaultEnd);
+        timings.itemsMs = msSince(prefaultEnd, build_end);
+    }
+
+    for (size_t r = 0; r < epoch.m_replicas.size(); ++r) {
+        auto& replica = epoch.m_replicas[r];
+        replica.placement.initMs = adoptStored ? 0 : msSince(build_start, finished[r]);
+
+        const auto resident = topology.residentPagesPerNode(replica.memory.memory, datasetBytes);
+        size_t total = 0;
+        for (auto pages : resident) total += pages;
+        const size_t local = replica.node < resident.size() ? resident[replica.node] : 0;
+        replica.placement.localFraction = total ? static_cast<double>(local) / total : 0.0;
+        // Cobertura real tras el primer acceso: con THP el núcleo puede no haber dado páginas grandes
+        replica.placement.hugeCoverage =
+            zartrux::VirtualMemory::measureCoverage(replica.memory.memory, replica.memory.size).fraction();
+
+        Logger::info("RandomXContext", "Nodo %u: dataset %zu MB, %.1f%% local, huge pages: %.1f%%, mbind: %s, init %llu ms",
+                     replica.node, datasetBytes >> 20, replica.placement.localFraction * 100.0,
+                     replica.placement.hugeCoverage * 100.0, replica.placement.policyApplied ? "si" : "no",
+                     static_cast<unsigned long long>(replica.placement.initMs));
+    }
+}
 
-        for (auto& t : threads) {
-            if (t.joinable()) {
-                t.join();
+void RandomXContext::setProgressCallback(BuildProgressCallback callback) {
+    std::lock_guard<std::mutex> lock(m_progressMutex);
+    m_progress = std::move(callback);
+}
+
+void RandomXContext::reportProgress(const BuildProgress& progress) const {
+    BuildProgressCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        callback = m_progress;
+    }
+    if (callback) callback(progress);
+}
+
+void RandomXContext::prepare(const std::vector<uint8_t>& key) {
+    // El hilo anterior se recoge fuera de m_mutex: aún puede estar en persistEpoch esperando
+    // al escritor del almacén, y epochFor() no debe quedarse bloqueado detrás
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_initialized || key.empty()) return;
+        if ((m_current && m_current->key() == key) || (m_next && m_next->key() == key) || m_buildingKey == key) return;
+        if (!m_buildingKey.empty()) {
+            // Sólo una construcción a la vez (cada época ocupa cache + dataset completos); quien
+            // espera la época la vuelve a pedir al terminar la actual
+            if (m_deferredKey != key) {
+                m_deferredKey = key;
+                Logger::warn("RandomXContext", "Construcción de época en curso; la petición de %s queda pendiente",
+                             keyPrefix(key).c_str());
             }
+            return;
         }
+
+        // El hilo anterior ya publicó su época (m_buildingKey vacío): sólo queda recogerlo
+        finished = std::move(m_builder);
+        m_next.reset();   // una época preparada que nunca se activó se descarta
+        m_buildingKey = key;
+        m_deferredKey.clear();
+        Logger::info("RandomXContext", "Preparando época %s en segundo plano", keyPrefix(key).c_str());
+        m_builder = std::thread([this, key] {
+            std::shared_ptr<RandomXEpoch> epoch;
+            try {
+                epoch = buildEpoch(key, true);
+            } catch (const std::exception& e) {
+                Logger::error("RandomXContext", "Fallo preparando la época %s: %s", keyPrefix(key).c_str(), e.what());
+            }
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_next = epoch;
+                m_buildingKey.clear();
+            }
+            m_buildCv.notify_all();
+            if (epoch) persistEpoch(epoch);
+        });
     }
+    if (finished.joinable()) finished.join();
+}
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-    // --- MEJORA (Punto 5): Métrica de rendimiento ---
-    Logger::info("RandomXContext", "Contexto RandomX inicializado en %lld ms.", duration);
-    
-    m_initialized = true;
+std::shared_ptr<const RandomXEpoch> RandomXContext::epochFor(const std::vector<uint8_t>& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_current && m_current->key() == key) return m_current;
+    if (m_next && m_next->key() == key) {
+        // Frontera de época: la preparada pasa a ser la actual. La anterior sigue viva
+        // mientras alguna VM la use.
+        m_current = std::move(m_next);
+        Logger::info("RandomXContext", "Época %s activada", keyPrefix(key).c_str());
+        return m_current;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const RandomXEpoch> RandomXContext::waitForEpoch(const std::vector<uint8_t>& key,
+                                                                 std::chrono::milliseconds timeout) {
+    if (auto epoch = epochFor(key)) return epoch;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto building = m_buildingKey;
+        m_buildCv.wait_for(lock, timeout, [&] {
+            return m_buildingKey != building || (m_next && m_next->key() == key);
+        });
+    }
+    return epochFor(key);
+}
+
+std::shared_ptr<const RandomXEpoch> RandomXContext::currentEpoch() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_current;
 }
 
 void RandomXContext::reinitialize(const std::vector<uint8_t>& key, const RandomXConfig& config) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const bool sameConfig = m_config.flags == config.flags && m_config.fullMemory == config.fullMemory &&
+                                m_config.numa == config.numa;
+        if (m_initialized && sameConfig) {
+            // Si la época ya se está preparando se espera a ella en lugar de construir otra
+            m_buildCv.wait(lock, [&] { return m_buildingKey != key; });
+            if (m_next && m_next->key() == key) {
+                m_current = std::move(m_next);
+                return;
+            }
+            if (m_current && m_current->key() == key) return;
+        }
+    }
     destroy();
     initialize(key, config);
 }
 
+void RandomXContext::joinBuilder() {
+    if (m_builder.joinable()) m_builder.join();
+}
+
+void RandomXContext::persistEpoch(std::shared_ptr<const RandomXEpoch> epoch) {
+    if (!m_store || !epoch) return;
+
+    // Se conservan la época que se va a guardar y las que están en uso o preparadas. Se toman
+    // ahora: el escritor no debe tocar m_mutex (prepare() puede estar esperando a este hilo)
+    std::vector<std::vector<uint8_t>> keep{epoch->key()};
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_current) keep.push_back(m_current->key());
+        if (m_next) keep.push_back(m_next->key());
+    }
+
+    std::lock_guard<std::mutex> lock(m_storeMutex);
+    if (m_storeWriter.joinable()) m_storeWriter.join();
+
+    // Escribir 2 GB no debe retrasar el primer hash: se hace en segundo plano y el hilo
+    // mantiene viva la época mientras tanto
+    m_storeWriter = std::thread([this, epoch = std::move(epoch), keep = std::move(keep)] {
+        lowerCurrentThreadPriority();
+        const uint64_t tag = storeConfigTag();
+        if (!epoch->m_cacheFromStore) {
+            m_store->save(zartrux::DatasetStore::Kind::Cache, epoch->key(), epoch->m_cacheMemory.memory,
+                          static_cast<size_t>(RandomX_CurrentConfig.ArgonMemory) * 1024, tag);
+        }
+        if (!epoch->m_replicas.empty() && !epoch->m_datasetFromStore) {
+            const auto& replica = epoch->m_replicas.front();
+            m_store->save(zartrux::DatasetStore::Kind::Dataset, epoch->key(), replica.memory.memory,
+                          replica.placement.datasetBytes, tag);
+        }
+
+        if (const size_t removed = m_store->evict(keep)) {
+            Logger::info("RandomXContext", "Almacén: %zu ficheros de épocas antiguas eliminados", removed);
+        }
+    });
+}
+
+void RandomXContext::joinStoreWriter() {
+    std::lock_guard<std::mutex> lock(m_storeMutex);
+    if (m_storeWriter.joinable()) m_storeWriter.join();
+}
+
 void RandomXContext::destroy() {
+    joinBuilder();
+    joinStoreWriter();
     std::lock_guard<std::mutex> lock(m_mutex);
     if (!m_initialized) return;
-    
-    if (m_dataset) { randomx_release_dataset(m_dataset); m_dataset = nullptr; }
-    if (m_cache)   { randomx_release_cache(m_cache); m_cache = nullptr; }
+
+    m_next.reset();
+    m_current.reset();
+    m_store.reset();
     m_initialized = false;
 }
 
-randomx_dataset* RandomXContext::dataset() { return m_dataset; }
-randomx_cache* RandomXContext::cache() { return m_cache; }
+randomx_dataset* RandomXContext::dataset(uint32_t node) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_current ? m_current->dataset(node) : nullptr;
+}
+
+randomx_cache* RandomXContext::cache() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_current ? m_current->cache() : nullptr;
+}
+
 const RandomXConfig& RandomXContext::getConfig() const { return m_config; }
 bool RandomXContext::isInitialized() const { return m_initialized.load(); }
 
+std::vector<NodePlacement> RandomXContext::placement() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_current ? m_current->placement() : std::vector<NodePlacement>{};
+}
+
 // --- RandomXVM ----
 
 RandomXVM::RandomXVM(const RandomXConfig& config) {
@@ -7,14 +7,114 @@
 #include <span>
 #include <string>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <thread>
 
 #include "crypto/randomx/randomx.h"
 
+namespace zartrux { class DatasetStore; }
+
 namespace core {
 
 struct RandomXConfig {
     randomx_flags flags = randomx_flags::RANDOMX_FLAG_DEFAULT;
     bool fullMemory = true;
+    bool numa = true;       // una réplica del dataset por nodo NUMA (si hay más de uno)
+    bool oneGbPages = false;    // intentar páginas de 1 GB para el dataset
+    bool lockMemory = false;    // mlock de cache y dataset
+    std::string storeDirectory; // almacén en disco de cache/dataset por semilla; vacío = desactivado
+    int optimizedDatasetInit = -1;      // init del dataset con JIT AVX2: -1 auto (según CPU), 0 no, 1 sí
+    bool jitDualMapping = false;        // endurecimiento W^X: buffer JIT con vistas RW y RX separadas
+    std::vector<unsigned> builderCpus;  // CPUs que minarán; el dataset se construye en ellas (vacío = todas)
+};
+
+// Progreso de la construcción de una época, notificado desde el hilo que la construye
+struct BuildProgress {
+    enum class Phase { CacheFill, Programs, Prefault, Dataset, Done };
+    Phase phase = Phase::CacheFill;
+    uint64_t done = 0;          // items del dataset completados (fase Dataset)
+    uint64_t total = 0;
+    uint64_t elapsedMs = 0;     // desde el inicio de la construcción
+    bool background = false;
+};
+
+// Desglose del tiempo de construcción de una época
+struct BuildTimings {
+    uint64_t argonMs = 0;       // relleno Argon2 de la cache
+    uint64_t programsMs = 0;    // programas superescalares (+ JIT de la init)
+    uint64_t allocMs = 0;       // reserva y mbind de las réplicas
+    uint64_t prefaultMs = 0;    // primer acceso a las páginas, en paralelo
+    uint64_t itemsMs = 0;       // generación (o copia desde el almacén) de los items
+    uint64_t totalMs = 0;
+    unsigned threads = 0;       // hilos de construcción del dataset
+    bool jitInit = false;       // items generados con el código JIT de la cache
+};
+
+using BuildProgressCallback = std::function<void(const BuildProgress&)>;
+
+// Colocación real de la réplica del dataset de un nodo, medida tras inicializarla
+struct NodePlacement {
+    uint32_t node = 0;
+    size_t datasetBytes = 0;
+    bool hugePages = false;
+    double hugeCoverage = 0.0;      // fracción en páginas grandes según /proc/self/smaps
+    bool policyApplied = false;     // mbind aceptado para la región
+    double localFraction = 0.0;     // páginas residentes en el propio nodo (muestreo)
+    uint64_t initMs = 0;
+};
+
+// Convierte la semilla tal y como llega del pool (hex de 64 caracteres) en la clave de RandomX.
+// Cualquier otro formato se usa tal cual, byte a byte.
+std::vector<uint8_t> seedKeyFromString(const std::string& seed);
+
+// Cache + réplicas del dataset construidas para una clave (una época de RandomX).
+// Es inmutable una vez construida; los hilos que la usan mantienen un shared_ptr, así
+// que la época anterior se libera cuando la última VM se ha pasado a la nueva.
+class RandomXEpoch {
+public:
+    ~RandomXEpoch();
+    RandomXEpoch(const RandomXEpoch&) = delete;
+    RandomXEpoch& operator=(const RandomXEpoch&) = delete;
+
+    const std::vector<uint8_t>& key() const { return m_key; }
+    randomx_cache* cache() const { return m_cache; }
+    // Réplica del dataset local al nodo indicado (la primera si el nodo no tiene réplica)
+    randomx_dataset* dataset(uint32_t node = 0) const;
+    std::vector<NodePlacement> placement() const;
+    uint64_t buildMs() const { return m_timings.totalMs; }
+    const BuildTimings& timings() const { return m_timings; }
+    bool loadedFromStore() const { return m_cacheFromStore && (m_replicas.empty() || m_datasetFromStore); }
+
+private:
+    friend class RandomXContext;
+    RandomXEpoch() = default;
+
+    struct Buffer {
+        uint8_t* memory = nullptr;
+        size_t size = 0;
+        bool hugePages = false;
+        size_t mappedBytes = 0;     // != 0: fichero del almacén mapeado (hugetlbfs), no reserva propia
+    };
+
+    struct Replica {
+        uint32_t node = 0;
+        Buffer memory;
+        randomx_dataset* dataset = nullptr;
+        NodePlacement placement;
+    };
+
+    static void freeBuffer(Buffer& buffer);
+
+    std::vector<uint8_t> m_key;
+    randomx_cache* m_cache = nullptr;
+    Buffer m_cacheMemory;
+    std::vector<Replica> m_replicas;
+    BuildTimings m_timings;
+    bool m_cacheFromStore = false;
+    bool m_datasetFromStore = false;
 };
 
 class RandomXContext {
@@ -24,21 +124,60 @@ public:
     RandomXContext& operator=(const RandomXContext&) = delete;
 
     void initialize(const std::vector<uint8_t>& key, const RandomXConfig& config = {});
+    // Cambia a la clave indicada: usa la época preparada en segundo plano si coincide,
+    // si no la construye en primer plano.
     void reinitialize(const std::vector<uint8_t>& key, const RandomXConfig& config = {});
     bool isInitialized() const;
 
-    randomx_dataset* dataset();
+    // Doble buffer: construye la época de `key` en segundo plano (prioridad reducida)
+    // mientras se sigue minando con la actual. No hace nada si ya existe o está en curso;
+    // si se construye otra, la petición se descarta y hay que repetirla cuando termine.
+    void prepare(const std::vector<uint8_t>& key);
+    // Época lista para `key` (la actual o la preparada, que pasa a ser la actual);
+    // nullptr si todavía se está construyendo o no se ha pedido.
+    std::shared_ptr<const RandomXEpoch> epochFor(const std::vector<uint8_t>& key);
+    // Igual que epochFor, pero espera hasta `timeout` a que termine la construcción en curso
+    // (la de `key` o cualquier otra, para que el llamante pueda volver a pedir la suya)
+    std::shared_ptr<const RandomXEpoch> waitForEpoch(const std::vector<uint8_t>& key,
+                                                     std::chrono::milliseconds timeout);
+    std::shared_ptr<const RandomXEpoch> currentEpoch() const;
+
+    // Progreso de las construcciones siguientes (fases y items del dataset)
+    void setProgressCallback(BuildProgressCallback callback);
+
+    // Accesos a la época actual
+    randomx_dataset* dataset(uint32_t node = 0);
     randomx_cache* cache();
     const RandomXConfig& getConfig() const;
+    std::vector<NodePlacement> placement() const;
 
 private:
     RandomXContext();
     ~RandomXContext();
     void destroy();
+    void joinBuilder();
+    // Guarda en el almacén lo que no se cargó de él y elimina épocas antiguas (en segundo plano)
+    void persistEpoch(std::shared_ptr<const RandomXEpoch> epoch);
+    void joinStoreWriter();
 
-    std::mutex m_mutex;
-    randomx_cache* m_cache = nullptr;
-    randomx_dataset* m_dataset = nullptr;
+    std::shared_ptr<RandomXEpoch> buildEpoch(const std::vector<uint8_t>& key, bool background) const;
+    void buildReplicas(RandomXEpoch& epoch, bool background,
+                       std::chrono::steady_clock::time_point start) const;
+    void reportProgress(const BuildProgress& progress) const;
+    RandomXEpoch::Buffer allocateBuffer(size_t bytes, const char* label, bool allow1GB) const;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_buildCv;
+    std::shared_ptr<RandomXEpoch> m_current;
+    std::shared_ptr<RandomXEpoch> m_next;         // época preparada, aún sin activar
+    std::vector<uint8_t> m_buildingKey;           // clave en construcción en segundo plano
+    std::vector<uint8_t> m_deferredKey;           // última petición descartada (sólo para no repetir el aviso)
+    std::thread m_builder;
+    std::unique_ptr<zartrux::DatasetStore> m_store;
+    std::mutex m_storeMutex;                      // protege m_storeWriter
+    std::thread m_storeWriter;
+    mutable std::mutex m_progressMutex;           // protege m_progress (se construye con m_mutex tomado)
+    BuildProgressCallback m_progress;
     RandomXConfig m_config;
     std::atomic<bool> m_initialized{false};
 };
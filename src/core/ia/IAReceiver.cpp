@@ -1,6 +1,7 @@
 #include "core/ia/IAReceiver.h"
 #include "core/JobManager.h" // Se incluye para la definición de MiningJob
 #include "utils/Logger.h"
+#include "utils/Hex.h"
 
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
@@ -65,7 +66,7 @@ std::vector<uint64_t> IAReceiver::requestNonces(const MiningJob& job) {
     try {
         json payload = {
             {"job_id", job.id},
-            {"blob", job.blob}
+            {"blob", zartrux::hex::encode(job.blob.data(), job.blobSize)}
         };
         
         // --- CORRECCIÓN: Se construye la URL completa y se pasa a Post ---
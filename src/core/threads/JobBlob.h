@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+/**
+ * Plantilla del blob de trabajo de un worker.
+ *
+ * Se copia una sola vez por trabajo en un buffer fijo alineado a 64 bytes; a
+ * partir de ahí sólo se reescriben in situ los bytes del nonce, de modo que el
+ * bucle de hash no toca el heap.
+ */
+class alignas(64) JobBlob {
+public:
+    // Los blobs de hashing de Monero rondan los 76 bytes; el margen cubre forks con blobs largos
+    static constexpr size_t MAX_SIZE = 256;
+
+    bool assign(const uint8_t* data, size_t size) {
+        if (size > MAX_SIZE) {
+            m_size = 0;
+            return false;
+        }
+        std::memcpy(m_data, data, size);
+        m_size = size;
+        return true;
+    }
+
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    uint8_t m_data[MAX_SIZE]{};
+    size_t m_size = 0;
+};
+
+/**
+ * Escritura del nonce con posición, tamaño y endianness fijados en compilación.
+ * Para los formatos conocidos el compilador reduce write() a un único store.
+ */
+template <size_t Position, size_t Size, bool BigEndian>
+struct FixedNonceLayout {
+    static_assert(Size >= 1 && Size <= 8, "El nonce ocupa entre 1 y 8 bytes");
+
+    static constexpr size_t end() { return Position + Size; }
+
+    static inline void write(uint8_t* blob, uint64_t nonce) {
+        if constexpr (BigEndian == (std::endian::native == std::endian::big)) {
+            if constexpr (std::endian::native == std::endian::little) {
+                std::memcpy(blob + Position, &nonce, Size);
+            } else {
+                std::memcpy(blob + Position, reinterpret_cast<const uint8_t*>(&nonce) + (8 - Size), Size);
+            }
+        } else {
+            for (size_t i = 0; i < Size; ++i) {
+                const size_t shift = BigEndian ? (Size - 1 - i) * 8 : i * 8;
+                blob[Position + i] = static_cast<uint8_t>(nonce >> shift);
+            }
+        }
+    }
+};
+
+/// Variante genérica para formatos de nonce no previstos en compilación.
+/// size debe estar en 1..8 (MinerCore::initialize rechaza el resto).
+struct DynamicNonceLayout {
+    size_t position;
+    size_t size;
+    bool bigEndian;
+
+    size_t end() const { return position + size; }
+
+    inline void write(uint8_t* blob, uint64_t nonce) const {
+        for (size_t i = 0; i < size; ++i) {
+            const size_t shift = bigEndian ? (size - 1 - i) * 8 : i * 8;
+            blob[position + i] = static_cast<uint8_t>(nonce >> shift);
+        }
+    }
+};
+
+/// Layout estándar de Monero: nonce de 4 bytes little-endian en el byte 39.
+using MoneroNonceLayout = FixedNonceLayout<39, 4, false>;
+/// Layout por defecto de WorkerThread::Config: 8 bytes little-endian en el byte 39.
+using WideNonceLayout = FixedNonceLayout<39, 8, false>;
@@ -1,14 +1,24 @@
 #include "core/threads/WorkerThread.h"
 #include "utils/Logger.h"
+#include "utils/AllocCounter.h"
 #include "core/ia/IAReceiver.h"
+#include "core/threads/JobBlob.h"
+#include "memory/NumaTopology.h"
+#include "core/hash.h"
 #include <randomx.h>
 #include <fmt/format.h>
-#include <sstream>
-#include <iomanip>
 #include <chrono>
+#include <algorithm>
+#include <array>
 
 using namespace std::chrono;
 
+namespace {
+    // Nonces que toma cada hilo del contador del benchmark de una vez: pequeño para que
+    // con N bajo el trabajo quede repartido entre todos los hilos
+    constexpr uint64_t BENCH_NONCE_BLOCK = 16;
+}
+
 WorkerThread::WorkerThread(unsigned id, JobManager& jobManager, const Config& config)
     : m_id(id)
     , m_jobManager(jobManager)
@@ -30,14 +40,13 @@ void WorkerThread::start() {
         return; // Ya está corriendo
     }
     m_thread = std::thread(&WorkerThread::run, this);
-    if (m_config.cpuAffinity >= 0) {
-        setCPUAffinity(m_config.cpuAffinity);
-    }
     Logger::debug("WorkerThread", "Hilo {} iniciado", m_id);
 }
 
 void WorkerThread::stop() {
     m_running.store(false);
+    // Sacar al hilo de la espera de trabajo si estaba bloqueado
+    m_jobManager.wakeWaiters();
 }
 
 void WorkerThread::restart() {
@@ -49,115 +58,333 @@ void WorkerThread::restart() {
     start();
 }
 
-bool WorkerThread::setCPUAffinity(int core) {
-#ifdef _WIN32
-    HANDLE thread = m_thread.native_handle();
-    DWORD_PTR mask = (static_cast<DWORD_PTR>(1) << core);
-    if (!SetThreadAffinityMask(thread, mask)) {
-        Logger::error("WorkerThread", "Error al establecer afinidad de CPU para hilo {}", m_id);
-        return false;
-    }
-#elif defined(__linux__)
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    CPU_SET(core, &cpuset);
-    int rc = pthread_setaffinity_np(m_thread.native_handle(), sizeof(cpu_set_t), &cpuset);
-    if (rc != 0) {
-        Logger::error("WorkerThread", "Error al establecer afinidad de CPU para hilo {}", m_id);
-        return false;
+uint64_t WorkerThread::nextNonce() {
+    if (m_config.benchmark) {
+        // Benchmark: nonces consecutivos desde 0, sin IA, para que el checksum sea reproducible
+        if (m_benchNext == m_benchEnd) {
+            m_benchNext = m_config.benchmark->nextNonce.fetch_add(BENCH_NONCE_BLOCK, std::memory_order_relaxed);
+            m_benchEnd = m_benchNext + BENCH_NONCE_BLOCK;
+        }
+        return m_benchNext++;
     }
-#endif
-    return true;
+
+    auto& allocator = m_jobManager.nonceAllocator();
+
+    // Modo híbrido: alternar entre IA y CPU
+    if (m_hybridToggle.load(std::memory_order_relaxed)) {
+        m_hybridToggle.store(false, std::memory_order_relaxed);
+        auto iaNonce = IAReceiver::getInstance().requestNonce();
+        if (iaNonce) {
+            m_metrics.iaNoncesUsed++;
+            // Los nonces de IA van a su propia subregión y no chocan con los de CPU
+            return allocator.mapIANonce(*iaNonce);
+        }
+    } else {
+        m_hybridToggle.store(true, std::memory_order_relaxed);
+    }
+
+    // Bloque contiguo propio del hilo; sólo se toca el contador compartido al agotarlo
+    return allocator.next(m_nonceRange, m_metrics.hashRate.load(std::memory_order_relaxed));
 }
 
 void WorkerThread::run() {
+    // El propio hilo se fija a su CPU antes de tocar el scratchpad, para que sus
+    // páginas se coloquen en el nodo NUMA de esa CPU.
+    if (m_config.cpuAffinity >= 0 &&
+        !zartrux::NumaTopology::pinThreadToCpu(static_cast<unsigned>(m_config.cpuAffinity))) {
+        Logger::error("WorkerThread", "Error al establecer afinidad de CPU para hilo {}", m_id);
+    }
+    m_benchStart = steady_clock::now();
+
     try {
-        auto& iaReceiver = IAReceiver::getInstance();
+        // Selección única de la variante especializada del bucle según el formato del nonce
+        const bool bigEndian = m_config.nonceEndianness;
+        if (m_config.noncePosition == 39 && m_config.nonceSize == 4 && !bigEndian) {
+            hashLoop(MoneroNonceLayout{});
+        } else if (m_config.noncePosition == 39 && m_config.nonceSize == 8 && !bigEndian) {
+            hashLoop(WideNonceLayout{});
+        } else {
+            Logger::debug("WorkerThread", "Hilo {} - formato de nonce no estándar, usando variante genérica", m_id);
+            hashLoop(DynamicNonceLayout{m_config.noncePosition, m_config.nonceSize, bigEndian});
+        }
+    }
+    catch (const std::exception& ex) {
+        m_metrics.hasCriticalError = true;
+        Logger::error("WorkerThread", "Error en hilo {}: {}", m_id, ex.what());
+    }
+    // El benchmark espera a todos los hilos: también se informa si el bucle terminó por error
+    if (m_config.benchmark) finishBenchmark();
+}
+
+template <typename NonceLayout>
+void WorkerThread::hashLoop(const NonceLayout& layout) {
+    const size_t ways = std::min(m_config.vms.size(), MAX_WAYS);
+    if (ways == 0) {
+        Logger::error("WorkerThread", "Hilo {} sin VM de RandomX asignada", m_id);
+        return;
+    }
+    m_metrics.ways.store(static_cast<unsigned>(ways));
+
+    uint64_t hashCount = 0;
+    uint64_t loopAllocations = 0;
+    auto lastHashTime = steady_clock::now();
+
+    // Plantilla del blob del trabajo activo: se copia una vez por trabajo y
+    // después sólo se reescriben los bytes del nonce.
+    JobBlob blob;
+    std::shared_ptr<const JobManager::Job> job;
+    uint64_t knownEpoch = 0;
+    bool loadedJobUsable = false;
+    bool pendingSwitchLatency = false;
+
+    // Estado del pipeline RandomX por vía: el hash de `inFlightNonce` (trabajo `inFlightJob`)
+    // ya está en marcha dentro de la VM y su resultado sale en la siguiente llamada
+    // a randomx_calculate_hash_next, que a la vez arranca el Blake2b del nonce siguiente.
+    // Las vías avanzan en bloque: cada ronda completa un hash en cada VM.
+    struct Way {
+        randomx_vm* vm = nullptr;
+        alignas(16) uint64_t tempHash[8];
+        std::shared_ptr<const JobManager::Job> inFlightJob;
+        uint64_t inFlightNonce = 0;
         uint64_t hashCount = 0;
-        auto lastHashTime = steady_clock::now();
-        std::vector<uint8_t> data;
-        NonceValidator validator;
-
-        while (m_running) {
-            // Obtener trabajo actual
-            auto job = m_jobManager.getCurrentJob();
-            if (!job) {
-                std::this_thread::sleep_for(milliseconds(100));
-                continue;
-            }
+    };
+    std::array<Way, MAX_WAYS> way;
+    for (size_t w = 0; w < ways; ++w) {
+        way[w].vm = static_cast<randomx_vm*>(m_config.vms[w]);
+    }
+    // Las VMs se crearon sobre la época actual del contexto
+    m_rxEpoch = core::RandomXContext::getInstance().currentEpoch();
+    BenchmarkState* const bench = m_config.benchmark.get();
+    bool benchDrained = false;
 
-            // Preparar datos para hash
-            data = job->getData();
-            uint64_t nonce;
-
-            // Modo híbrido: alternar entre IA y CPU
-            if (m_hybridToggle.load()) {
-                // Intentar obtener nonce de IA
-                auto iaNonce = iaReceiver.requestNonce();
-                if (iaNonce) {
-                    nonce = *iaNonce;
-                    m_metrics.iaNoncesUsed++;
-                } else {
-                    // Si no hay nonce de IA, generar uno
-                    nonce = m_jobManager.generateNonce();
+    while (m_running) {
+        // Una sola carga relajada por lote: la instantánea sólo se recarga si cambió la época
+        const uint64_t epoch = m_jobManager.jobEpoch();
+        if (epoch != knownEpoch) {
+            knownEpoch = epoch;
+            job = m_jobManager.getCurrentJob();
+            loadedJobUsable = false;
+            if (job && !job->seedKey.empty() && (!m_rxEpoch || m_rxEpoch->key() != job->seedKey)) {
+                // Frontera de época de RandomX: las VMs pasan a la cache/dataset nuevos sin
+                // reiniciar el hilo. Los hashes en curso se calcularían con el dataset nuevo
+                // para un trabajo viejo, así que se descartan.
+                if (!switchEpoch(job->seedKey, knownEpoch)) {
+                    knownEpoch = 0;   // llegó otro trabajo (o se detuvo el hilo): recargar
+                    continue;
+                }
+                for (size_t w = 0; w < ways; ++w) {
+                    if (way[w].inFlightJob) {
+                        way[w].inFlightJob = nullptr;
+                        m_metrics.hashesLostToEpochSwitch++;
+                    }
                 }
-                m_hybridToggle.store(false);
-            } else {
-                nonce = m_jobManager.generateNonce();
-                m_hybridToggle.store(true);
             }
+            if (job) {
+                // Un cambio de prefijo del pool invalida el bloque de nonces en curso
+                if (m_nonceRange.generation != m_jobManager.nonceAllocator().generation()) {
+                    m_nonceRange = {};
+                }
+                loadedJobUsable = blob.assign(job->blob.data(), job->blob.size()) && layout.end() <= blob.size();
+                if (!loadedJobUsable) {
+                    Logger::error("WorkerThread", "Hilo {} - blob de {} bytes incompatible con el nonce configurado",
+                                  m_id, job->blob.size());
+                }
+                pendingSwitchLatency = loadedJobUsable;
+            }
+        }
+        if (!job || !loadedJobUsable) {
+            // Sin trabajo no hay nada que vaciar: los hashes en curso se descartan.
+            // Se duerme hasta que se publique una época nueva en lugar de sondear.
+            for (size_t w = 0; w < ways; ++w) way[w].inFlightJob = nullptr;
+            m_jobManager.waitForJob(knownEpoch, m_running, seconds(1));
+            continue;
+        }
 
-            // Insertar nonce en datos
-            validator.insertNonce(data, nonce, m_config.noncePosition, 
-                               m_config.nonceSize, 
-                               m_config.nonceEndianness ? NonceValidator::Endianness::BIG 
-                                                      : NonceValidator::Endianness::LITTLE);
+        if (pendingSwitchLatency) {
+            // El hash que se arranca a continuación es el primero del trabajo nuevo
+            pendingSwitchLatency = false;
+            m_metrics.jobSwitchLatencyUs.store(static_cast<uint64_t>(
+                duration_cast<microseconds>(steady_clock::now() - job->receivedAt).count()),
+                std::memory_order_relaxed);
+            if (way[0].inFlightJob && way[0].inFlightJob != job) {
+                Logger::debug("WorkerThread", "Hilo {} - cambio de trabajo, pipeline vaciado", m_id);
+            }
+        }
+
+        for (size_t w = 0; w < ways; ++w) {
+            Way& s = way[w];
+            const uint64_t allocationsBefore = zartrux::AllocCounter::threadAllocations();
+
+            // Preparar la entrada del siguiente hash antes de recoger el anterior.
+            // La VM consume el blob dentro de la llamada, así que todas las vías comparten plantilla.
+            const uint64_t nonce = nextNonce();
+            if (bench && nonce >= bench->hashLimit) [[unlikely]] {
+                // Fin del benchmark: la vía no arranca más hashes; el que lleva en curso se recoge abajo
+                benchDrained = true;
+                continue;
+            }
+            layout.write(blob.data(), nonce);
 
-            // Calcular hash
+            if (!s.inFlightJob) {
+                // Pipeline vacío: cebar con el primer nonce del trabajo
+                randomx_calculate_hash_first(s.vm, s.tempHash, blob.data(), blob.size());
+                s.inFlightJob = job;
+                s.inFlightNonce = nonce;
+                continue;
+            }
+
+            // Termina el hash en curso y arranca el del nonce recién preparado.
+            // Si el trabajo cambió, esta misma llamada vacía el pipeline: el resultado
+            // pertenece aún al trabajo anterior y la VM queda cebada con el nuevo.
             NonceValidator::hash_t hash;
-            randomx_calculate_hash(static_cast<randomx_vm*>(m_config.vm),
-                                 data.data(), data.size(), hash.data());
+            randomx_calculate_hash_next(s.vm, s.tempHash, blob.data(), blob.size(), hash.data());
+            if (bench) accumulateBenchmark(s.inFlightNonce, hash);
+
+            const bool found = NonceValidator::meetsTarget(hash, s.inFlightJob->shareTarget);
+            loopAllocations += zartrux::AllocCounter::threadAllocations() - allocationsBefore;
 
-            // Verificar hash
-            if (validator.isValidFast(hash, job->getDifficulty())) {
-                std::string hashHex = toHexString(hash);
-                m_jobManager.submitValidNonce(nonce, hashHex);
+            // Verificar el resultado del nonce anterior (el siguiente ya está en marcha).
+            // El envío de shares queda fuera de la medición: sólo ocurre en un acierto.
+            if (found) {
+                m_jobManager.submitSolution(*s.inFlightJob, s.inFlightNonce, hash);
                 m_metrics.acceptedHashes++;
             }
+            s.inFlightJob = job;
+            s.inFlightNonce = nonce;
+            s.hashCount++;
 
             // Actualizar métricas
             hashCount++;
             m_metrics.totalHashes++;
+        }
 
-            // Calcular tasa de hash cada segundo
-            auto now = steady_clock::now();
-            auto elapsed = duration_cast<seconds>(now - lastHashTime).count();
-            if (elapsed >= 1) {
-                double hashRate = static_cast<double>(hashCount) / elapsed;
-                m_metrics.hashRate.store(hashRate);
-                hashCount = 0;
-                lastHashTime = now;
-                Logger::debug("WorkerThread", "Hilo {} - Hash rate: {:.2f} H/s", m_id, hashRate);
+        if (benchDrained) [[unlikely]] {
+            // Los nonces del contador crecen: si una vía pasó del límite, todas las siguientes
+            // también. Se vacían los pipelines (la entrada que arranca cada llamada se descarta).
+            for (size_t w = 0; w < ways; ++w) {
+                if (!way[w].inFlightJob) continue;
+                NonceValidator::hash_t hash;
+                randomx_calculate_hash_next(way[w].vm, way[w].tempHash, blob.data(), blob.size(), hash.data());
+                accumulateBenchmark(way[w].inFlightNonce, hash);
+                way[w].inFlightJob = nullptr;
+                m_metrics.totalHashes++;
             }
+            m_running = false;
+            break;
+        }
 
-            // Throttling si está configurado
-            if (m_config.throttle < 1.0) {
-                std::this_thread::sleep_for(microseconds(
-                    static_cast<int64_t>((1.0 - m_config.throttle) * 1000)));
+        // Calcular tasa de hash cada segundo (total y por vía)
+        auto now = steady_clock::now();
+        auto elapsed = duration_cast<seconds>(now - lastHashTime).count();
+        if (elapsed >= 1) {
+            double hashRate = static_cast<double>(hashCount) / elapsed;
+            m_metrics.hashRate.store(hashRate);
+            for (size_t w = 0; w < ways; ++w) {
+                m_metrics.wayHashRate[w].store(static_cast<double>(way[w].hashCount) / elapsed);
+                way[w].hashCount = 0;
             }
+            m_metrics.loopAllocations.fetch_add(loopAllocations, std::memory_order_relaxed);
+            hashCount = 0;
+            loopAllocations = 0;
+            lastHashTime = now;
+            Logger::debug("WorkerThread", "Hilo {} - Hash rate: {:.2f} H/s ({} vías)", m_id, hashRate, ways);
+        }
+
+        // Throttling si está configurado
+        if (m_config.throttle < 1.0) {
+            std::this_thread::sleep_for(microseconds(
+                static_cast<int64_t>((1.0 - m_config.throttle) * 1000)));
         }
     }
-    catch (const std::exception& ex) {
-        m_metrics.hasCriticalError = true;
-        Logger::error("WorkerThread", "Error en hilo {}: {}", m_id, ex.what());
+}
+
+bool WorkerThread::switchEpoch(const std::vector<uint8_t>& key, uint64_t jobEpoch) {
+    auto& ctx = core::RandomXContext::getInstance();
+    auto next = ctx.epochFor(key);
+    if (!next) {
+        // La época no estaba preparada (semilla no anunciada a tiempo): el hilo no puede
+        // hashear hasta que termine. Ese tiempo se contabiliza como hashes perdidos.
+        const auto waitStart = steady_clock::now();
+        Logger::info("WorkerThread", "Hilo {} - esperando a la época RandomX del trabajo", m_id);
+        while (m_running && !next && m_jobManager.jobEpoch() == jobEpoch) {
+            // Se repite en cada vuelta: si había otra época en construcción la petición se
+            // descartó, y waitForEpoch vuelve en cuanto esa termina
+            ctx.prepare(key);
+            next = ctx.waitForEpoch(key, milliseconds(50));
+        }
+        const double waited = duration<double>(steady_clock::now() - waitStart).count();
+        m_metrics.hashesLostToEpochSwitch += static_cast<uint64_t>(
+            waited * m_metrics.hashRate.load(std::memory_order_relaxed));
+        if (!next) return false;
+    }
+
+    const bool fullMemory = ctx.getConfig().fullMemory;
+    for (void* vm : m_config.vms) {
+        auto* machine = static_cast<randomx_vm*>(vm);
+        if (fullMemory) {
+            randomx_vm_set_dataset(machine, next->dataset(m_config.numaNode));
+        } else {
+            randomx_vm_set_cache(machine, next->cache());
+        }
+    }
+    m_rxEpoch = std::move(next);
+    Logger::debug("WorkerThread", "Hilo {} - VMs cambiadas a la nueva época RandomX", m_id);
+    return true;
+}
+
+void WorkerThread::accumulateBenchmark(uint64_t nonce, const NonceValidator::hash_t& hash) {
+    for (size_t i = 0; i < hash.size(); ++i) m_benchChecksum[i] ^= hash[i];
+    if (nonce < m_config.benchmark->sampleLimit) {
+        for (size_t i = 0; i < hash.size(); ++i) m_benchSampleChecksum[i] ^= hash[i];
+    }
+}
+
+void WorkerThread::finishBenchmark() {
+    BenchmarkState& bench = *m_config.benchmark;
+    BenchmarkState::ThreadResult result;
+    result.id = m_id;
+    result.hashes = m_metrics.totalHashes.load();
+    result.seconds = duration<double>(steady_clock::now() - m_benchStart).count();
+    result.failed = m_metrics.hasCriticalError.load();
+    {
+        std::lock_guard<std::mutex> lock(bench.mutex);
+        for (size_t i = 0; i < bench.checksum.size(); ++i) {
+            bench.checksum[i] ^= m_benchChecksum[i];
+            bench.sampleChecksum[i] ^= m_benchSampleChecksum[i];
+        }
+        bench.threads.push_back(result);
     }
+    bench.finished.fetch_add(1, std::memory_order_release);
+    Logger::debug("WorkerThread", "Hilo {} - benchmark terminado: {} hashes en {:.2f} s",
+                  m_id, result.hashes, result.seconds);
 }
 
-std::string WorkerThread::toHexString(const NonceValidator::hash_t& hash) const {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (const auto& byte : hash) {
-        ss << std::setw(2) << static_cast<int>(byte);
+uint64_t WorkerThread::benchmarkWays(const std::vector<void*>& vms, milliseconds duration) {
+    const size_t ways = std::min(vms.size(), MAX_WAYS);
+    if (ways == 0) return 0;
+
+    // Blob de referencia (cabecera Monero de 76 bytes) con el nonce en la posición estándar
+    JobBlob blob;
+    const std::array<uint8_t, 76> reference{};
+    blob.assign(reference.data(), reference.size());
+
+    alignas(16) uint64_t tempHash[MAX_WAYS][8];
+    NonceValidator::hash_t hash;
+    uint32_t nonce = 0;
+    for (size_t w = 0; w < ways; ++w) {
+        MoneroNonceLayout::write(blob.data(), nonce++);
+        randomx_calculate_hash_first(static_cast<randomx_vm*>(vms[w]), tempHash[w], blob.data(), blob.size());
     }
-    return ss.str();
-}
\ No newline at end of file
+
+    uint64_t hashes = 0;
+    const auto deadline = steady_clock::now() + duration;
+    while (steady_clock::now() < deadline) {
+        for (size_t w = 0; w < ways; ++w) {
+            MoneroNonceLayout::write(blob.data(), nonce++);
+            randomx_calculate_hash_next(static_cast<randomx_vm*>(vms[w]), tempHash[w],
+                                        blob.data(), blob.size(), hash.data());
+        }
+        hashes += ways;
+    }
+    return hashes;
+}
@@ -4,29 +4,66 @@
 #include <thread>
 #include <string>
 #include <vector>
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 
 #include "core/JobManager.h"
+#include "core/NonceValidator.h"
+#include "core/hash.h"
 
 class WorkerThread {
 public:
+    // Máximo de VMs entrelazadas que puede llevar un hilo (modo N-vías)
+    static constexpr size_t MAX_WAYS = 4;
+
     struct Metrics {
         std::atomic<double> hashRate{0};
         std::atomic<double> cpuUsage{0};
         std::atomic<uint64_t> totalHashes{0};
         std::atomic<uint64_t> acceptedHashes{0};
         std::atomic<uint64_t> iaNoncesUsed{0};
+        std::atomic<uint64_t> loopAllocations{0};   // reservas de heap en el camino por hash (debe ser 0)
+        std::atomic<uint64_t> jobSwitchLatencyUs{0}; // notificación del trabajo -> primer hash con él
+        std::atomic<unsigned> ways{1};
+        std::array<std::atomic<double>, MAX_WAYS> wayHashRate{};
+        std::atomic<uint64_t> hashesLostToEpochSwitch{0};  // pipeline descartado + espera a la época
         std::atomic<bool> hasCriticalError{false};
         Metrics() = default;
     };
 
+    // Estado compartido del benchmark offline (--bench): los hilos toman los nonces [0, hashLimit)
+    // de un contador común y acumulan el XOR de los hashes, que no depende del reparto entre
+    // hilos y vías. Los nonces < sampleLimit se acumulan además aparte para verificarlos.
+    struct BenchmarkState {
+        struct ThreadResult {
+            unsigned id = 0;
+            uint64_t hashes = 0;
+            double seconds = 0.0;
+            bool failed = false;
+        };
+
+        uint64_t hashLimit = 0;
+        uint64_t sampleLimit = 0;
+        std::atomic<uint64_t> nextNonce{0};
+        std::atomic<unsigned> finished{0};
+        std::mutex mutex;
+        NonceValidator::hash_t checksum{};
+        NonceValidator::hash_t sampleChecksum{};
+        std::vector<ThreadResult> threads;
+    };
+
     struct Config {
-        void* vm;
+        std::vector<void*> vms;        // una randomx_vm por vía, cada una con su scratchpad
         int cpuAffinity = -1;
+        uint32_t numaNode = 0;         // réplica del dataset que usan las VMs
         double throttle = 1.0;
         size_t noncePosition = 39;
         size_t nonceSize = 8;
         bool nonceEndianness = false;
+        std::shared_ptr<BenchmarkState> benchmark;   // no nulo: modo benchmark (sin IA ni shares)
     };
 
     WorkerThread(unsigned id, JobManager& jobManager, const Config& config);
@@ -38,10 +75,20 @@ public:
     Metrics getMetrics() const;
     unsigned getId() const { return m_id; }
     void setAffinity(int core) { m_config.cpuAffinity = core; }
+    void restart();
+
+    // Hashea un blob fijo en rondas N-vías durante `duration` con las VMs dadas
+    // (autoselección de vías al arrancar). Devuelve el número de hashes completados.
+    static uint64_t benchmarkWays(const std::vector<void*>& vms, std::chrono::milliseconds duration);
 
 private:
     void run();
-    std::string toHexString(const std::vector<uint8_t>& hash) const;
+    template <typename NonceLayout>
+    void hashLoop(const NonceLayout& layout);
+    uint64_t nextNonce();
+    bool switchEpoch(const std::vector<uint8_t>& key, uint64_t jobEpoch);
+    void accumulateBenchmark(uint64_t nonce, const NonceValidator::hash_t& hash);
+    void finishBenchmark();
 
     unsigned m_id;
     JobManager& m_jobManager;
@@ -50,4 +97,13 @@ private:
     std::atomic<bool> m_running{false};
     mutable Metrics m_metrics;
     std::atomic<bool> m_hybridToggle{false};
+    NonceAllocator::Range m_nonceRange;   // bloque de nonces propio del hilo
+    std::shared_ptr<const core::RandomXEpoch> m_rxEpoch;   // época en uso: la mantiene viva
+
+    // Modo benchmark: bloque de nonces propio y XOR parcial del hilo
+    uint64_t m_benchNext = 0;
+    uint64_t m_benchEnd = 0;
+    NonceValidator::hash_t m_benchChecksum{};
+    NonceValidator::hash_t m_benchSampleChecksum{};
+    std::chrono::steady_clock::time_point m_benchStart;
 };
@@ -7,6 +7,36 @@ namespace randomx {
 
 	const int_reg_t BytecodeMachine::zero = 0;
 
+#define RANDOMX_EXE_INSTRUCTIONS(X) \
+	X(IADD_RS) \
+	X(IADD_M) \
+	X(ISUB_R) \
+	X(ISUB_M) \
+	X(IMUL_R) \
+	X(IMUL_M) \
+	X(IMULH_R) \
+	X(IMULH_M) \
+	X(ISMULH_R) \
+	X(ISMULH_M) \
+	X(INEG_R) \
+	X(IXOR_R) \
+	X(IXOR_M) \
+	X(IROR_R) \
+	X(IROL_R) \
+	X(ISWAP_R) \
+	X(FSWAP_R) \
+	X(FADD_R) \
+	X(FADD_M) \
+	X(FSUB_R) \
+	X(FSUB_M) \
+	X(FSCAL_R) \
+	X(FMUL_R) \
+	X(FDIV_M) \
+	X(FSQRT_R) \
+	X(CBRANCH) \
+	X(CFROUND) \
+	X(ISTORE)
+
 #define INSTR_CASE(x) case InstructionType::x: \
 	exe_ ## x(ibc, pc, scratchpad, config); \
 	break;
@@ -14,34 +44,7 @@ namespace randomx {
 	void BytecodeMachine::executeInstruction(RANDOMX_EXE_ARGS) {
 		switch (ibc.type)
 		{
-			INSTR_CASE(IADD_RS)
-			INSTR_CASE(IADD_M)
-			INSTR_CASE(ISUB_R)
-			INSTR_CASE(ISUB_M)
-			INSTR_CASE(IMUL_R)
-			INSTR_CASE(IMUL_M)
-			INSTR_CASE(IMULH_R)
-			INSTR_CASE(IMULH_M)
-			INSTR_CASE(ISMULH_R)
-			INSTR_CASE(ISMULH_M)
-			INSTR_CASE(INEG_R)
-			INSTR_CASE(IXOR_R)
-			INSTR_CASE(IXOR_M)
-			INSTR_CASE(IROR_R)
-			INSTR_CASE(IROL_R)
-			INSTR_CASE(ISWAP_R)
-			INSTR_CASE(FSWAP_R)
-			INSTR_CASE(FADD_R)
-			INSTR_CASE(FADD_M)
-			INSTR_CASE(FSUB_R)
-			INSTR_CASE(FSUB_M)
-			INSTR_CASE(FSCAL_R)
-			INSTR_CASE(FMUL_R)
-			INSTR_CASE(FDIV_M)
-			INSTR_CASE(FSQRT_R)
-			INSTR_CASE(CBRANCH)
-			INSTR_CASE(CFROUND)
-			INSTR_CASE(ISTORE)
+			RANDOMX_EXE_INSTRUCTIONS(INSTR_CASE)
 
 		case InstructionType::NOP:
 			break;
@@ -52,6 +55,104 @@ namespace randomx {
 		}
 	}
 
+#ifdef RANDOMX_THREADED_DISPATCH
+	//labels as values are a GNU extension
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+#define RANDOMX_DISPATCH() goto *labels[static_cast<uint16_t>(bytecode[++pc].type)]
+
+#define INSTR_LABEL(x) op_ ## x: \
+	exe_ ## x(bytecode[pc], pc, scratchpad, config); \
+	RANDOMX_DISPATCH();
+
+	//a taken CBRANCH always jumps backwards, so pc != first means the second
+	//instruction of the pair must not run
+#define FUSED_LABEL(a, b) op_ ## a ## _ ## b: { \
+		const int first = pc; \
+		exe_ ## a(bytecode[pc], pc, scratchpad, config); \
+		if (pc == first) { \
+			++pc; \
+			exe_ ## b(bytecode[pc], pc, scratchpad, config); \
+		} \
+		RANDOMX_DISPATCH(); \
+	}
+
+#define FUSED_ADDRESS(a, b) &&op_ ## a ## _ ## b,
+
+	void BytecodeMachine::executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config) {
+		//indexed by InstructionType, then BytecodeOp
+		static const void* const labels[] = {
+			&&op_IADD_RS, &&op_IADD_M, &&op_ISUB_R, &&op_ISUB_M, &&op_IMUL_R, &&op_IMUL_M,
+			&&op_IMULH_R, &&op_IMULH_M, &&op_ISMULH_R, &&op_ISMULH_M, &&op_invalid /* IMUL_RCP */,
+			&&op_INEG_R, &&op_IXOR_R, &&op_IXOR_M, &&op_IROR_R, &&op_IROL_R, &&op_ISWAP_R,
+			&&op_FSWAP_R, &&op_FADD_R, &&op_FADD_M, &&op_FSUB_R, &&op_FSUB_M, &&op_FSCAL_R,
+			&&op_FMUL_R, &&op_FDIV_M, &&op_FSQRT_R, &&op_CBRANCH, &&op_CFROUND, &&op_ISTORE,
+			&&op_NOP, &&op_END,
+			RANDOMX_FUSED_PAIRS(FUSED_ADDRESS)
+		};
+		static_assert(sizeof(labels) / sizeof(labels[0]) == static_cast<size_t>(BytecodeOp::COUNT), "dispatch table out of sync with BytecodeOp");
+
+		int pc = 0;
+		goto *labels[static_cast<uint16_t>(bytecode[pc].type)];
+
+		RANDOMX_EXE_INSTRUCTIONS(INSTR_LABEL)
+		RANDOMX_FUSED_PAIRS(FUSED_LABEL)
+
+	op_NOP:
+		RANDOMX_DISPATCH();
+
+	op_invalid:
+		UNREACHABLE;
+
+	op_END:
+		return;
+	}
+
+#pragma GCC diagnostic pop
+
+	void BytecodeMachine::fuseInstructions(InstructionByteCode* bytecode, unsigned size) {
+		struct FusedPair {
+			InstructionType first;
+			InstructionType second;
+			BytecodeOp op;
+		};
+#define FUSED_ENTRY(a, b) { InstructionType::a, InstructionType::b, BytecodeOp::a ## _ ## b },
+		static const FusedPair pairs[] = {
+			RANDOMX_FUSED_PAIRS(FUSED_ENTRY)
+		};
+#undef FUSED_ENTRY
+
+		//a taken CBRANCH resumes at target + 1; that slot must start a dispatch
+		bool landing[BytecodeMaxSize] = {};
+		for (unsigned i = 0; i < size; ++i) {
+			if (bytecode[i].type == InstructionType::CBRANCH) {
+				landing[bytecode[i].target + 1] = true;
+			}
+		}
+
+		for (unsigned i = 0; i + 1 < size; ++i) {
+			if (landing[i + 1]) {
+				continue;
+			}
+			for (const FusedPair& pair : pairs) {
+				if (bytecode[i].type == pair.first && bytecode[i + 1].type == pair.second) {
+					bytecode[i].type = static_cast<InstructionType>(pair.op);
+					++i;
+					break;
+				}
+			}
+		}
+	}
+#else
+	void BytecodeMachine::executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config) {
+		for (int pc = 0; pc < static_cast<int>(RandomX_CurrentConfig.ProgramSize); ++pc) {
+			auto& ibc = bytecode[pc];
+			executeInstruction(ibc, pc, scratchpad, config);
+		}
+	}
+#endif
+
 	void BytecodeMachine::compileInstruction(RANDOMX_GEN_ARGS) {
 		uint32_t opcode = instr.opcode;
 
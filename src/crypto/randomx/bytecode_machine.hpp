@@ -37,6 +37,43 @@ namespace randomx {
 		uint32_t memMask;
 	};
 
+#if defined(__GNUC__)
+#define RANDOMX_THREADED_DISPATCH 1
+#endif
+
+	//instruction pairs executed with a single dispatch (most frequent adjacent pairs
+	//with the default instruction frequencies); the second instruction keeps its
+	//operands in the following bytecode slot
+#define RANDOMX_FUSED_PAIRS(X) \
+	X(FMUL_R, FMUL_R) \
+	X(FMUL_R, CBRANCH) \
+	X(CBRANCH, FMUL_R) \
+	X(IMUL_R, FMUL_R) \
+	X(FMUL_R, IMUL_R) \
+	X(CBRANCH, CBRANCH) \
+	X(IMUL_R, CBRANCH) \
+	X(CBRANCH, IMUL_R) \
+	X(IMUL_R, IMUL_R) \
+	X(FMUL_R, FADD_R) \
+	X(FMUL_R, FSUB_R) \
+	X(FADD_R, FMUL_R) \
+	X(FSUB_R, FMUL_R) \
+	X(IADD_RS, FMUL_R) \
+	X(ISUB_R, FMUL_R) \
+	X(ISTORE, FMUL_R)
+
+	//opcodes that only exist in the bytecode, numbered after InstructionType::NOP
+	enum class BytecodeOp : uint16_t {
+		END = static_cast<uint16_t>(InstructionType::NOP) + 1,
+#define RANDOMX_FUSED_ENUM(a, b) a ## _ ## b,
+		RANDOMX_FUSED_PAIRS(RANDOMX_FUSED_ENUM)
+#undef RANDOMX_FUSED_ENUM
+		COUNT
+	};
+
+	//program plus the END terminator
+	constexpr int BytecodeMaxSize = RANDOMX_PROGRAM_MAX_SIZE + 1;
+
 #define RANDOMX_EXE_ARGS InstructionByteCode& ibc, int& pc, uint8_t* scratchpad, ProgramConfiguration& config
 #define RANDOMX_GEN_ARGS Instruction& instr, int i, InstructionByteCode& ibc
 
@@ -53,6 +90,7 @@ namespace randomx {
 			nreg = &regFile;
 		}
 
+		//bytecode must hold BytecodeMaxSize entries
 		void compileProgram(Program& program, InstructionByteCode* bytecode, NativeRegisterFile& regFile) {
 			beginCompilation(regFile);
 			for (unsigned i = 0; i < RandomX_CurrentConfig.ProgramSize; ++i) {
@@ -60,14 +98,13 @@ namespace randomx {
 				auto& ibc = bytecode[i];
 				compileInstruction(instr, i, ibc);
 			}
+			bytecode[RandomX_CurrentConfig.ProgramSize].type = static_cast<InstructionType>(BytecodeOp::END);
+#ifdef RANDOMX_THREADED_DISPATCH
+			fuseInstructions(bytecode, RandomX_CurrentConfig.ProgramSize);
+#endif
 		}
 
-		static void executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config) {
-			for (int pc = 0; pc < static_cast<int>(RandomX_CurrentConfig.ProgramSize); ++pc) {
-				auto& ibc = bytecode[pc];
-				executeInstruction(ibc, pc, scratchpad, config);
-			}
-		}
+		static void executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config);
 
 		void compileInstruction(RANDOMX_GEN_ARGS)
 #ifdef RANDOMX_GEN_TABLE
@@ -230,6 +267,10 @@ namespace randomx {
 			return scratchpad + addr;
 		}
 
+#ifdef RANDOMX_THREADED_DISPATCH
+		static void fuseInstructions(InstructionByteCode* bytecode, unsigned size);
+#endif
+
 #ifdef RANDOMX_GEN_TABLE
 		static InstructionGenBytecode genTable[256];
 
@@ -38,6 +38,11 @@ namespace randomx {
 	template void deallocCache<LargePageAllocator>(randomx_cache* cache);
 
 	void initCache(randomx_cache* cache, const void* key, size_t keySize) {
+		fillCache(cache, key, keySize);
+		initCachePrograms(cache, key, keySize);
+	}
+
+	void fillCache(randomx_cache* cache, const void* key, size_t keySize) {
 		argon2_context context;
 
 		context.out = nullptr;
@@ -60,7 +65,9 @@ namespace randomx {
 		context.version = ARGON2_VERSION_NUMBER;
 
 		argon2_ctx_mem(&context, Argon2_d, cache->memory, RandomX_CurrentConfig.ArgonMemory * 1024);
+	}
 
+	void initCachePrograms(randomx_cache* cache, const void* key, size_t keySize) {
 		randomx::Blake2Generator gen(key, keySize);
 		for (uint32_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
 			randomx::generateSuperscalar(cache->programs[i], gen);
@@ -69,7 +76,10 @@ namespace randomx {
 
 	void initCacheCompile(randomx_cache* cache, const void* key, size_t keySize) {
 		initCache(cache, key, keySize);
+		compileCache(cache);
+	}
 
+	void compileCache(randomx_cache* cache) {
 #		ifdef XMRIG_SECURE_JIT
 		cache->jit->enableWriting();
 #		endif
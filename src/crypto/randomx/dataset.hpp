@@ -45,6 +45,9 @@ namespace randomx {
 
 	void initCache(randomx_cache*, const void*, size_t);
 	void initCacheCompile(randomx_cache*, const void*, size_t);
+	void fillCache(randomx_cache*, const void*, size_t);
+	void initCachePrograms(randomx_cache*, const void*, size_t);
+	void compileCache(randomx_cache*);
 	void initDatasetItem(randomx_cache* cache, uint8_t* out, uint64_t blockNumber);
 	void initDataset(randomx_cache* cache, uint8_t* dataset, uint32_t startBlock, uint32_t endBlock);
 }
\ No newline at end of file
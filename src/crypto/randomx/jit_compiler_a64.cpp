@@ -15,6 +15,10 @@ void randomx_set_huge_pages_jit(bool hugePages)
 	hugePagesJIT = hugePages;
 }
 
+void randomx_set_dual_mapped_jit(bool)
+{
+}
+
 void randomx_set_optimized_dataset_init(int value)
 {
 	optimizedDatasetInit = value;
@@ -6,6 +6,11 @@ void randomx_set_huge_pages_jit(bool)
 }
 
 
+void randomx_set_dual_mapped_jit(bool)
+{
+}
+
+
 void randomx_set_optimized_dataset_init(int)
 {
 }
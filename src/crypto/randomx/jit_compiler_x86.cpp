@@ -3,13 +3,14 @@
 #include <climits>
 #include <atomic>
 #include "crypto/randomx/jit_compiler_x86.hpp"
-#include "crypto/common/VirtualMemory.h"
+#include "memory/VirtualMemory.h"
 #include "crypto/randomx/jit_compiler_x86_static.hpp"
 #include "crypto/randomx/program.hpp"
 #include "crypto/randomx/reciprocal.h"
 #include "crypto/randomx/superscalar.hpp"
 #include "crypto/randomx/virtual_memory.hpp"
 #include "runtime/Profiler.h"
+#include "runtime/JitSymbols.h"
 
 // Cabeceras para la detección de CPU
 #if defined(_MSC_VER)
@@ -19,12 +20,17 @@
 #endif
 
 static bool hugePagesJIT = false;
+static bool dualMappedJIT = false;
 static int optimizedDatasetInit = -1;
 
 void randomx_set_huge_pages_jit(bool hugePages){
     hugePagesJIT = hugePages;
 }
 
+void randomx_set_dual_mapped_jit(bool enable){
+    dualMappedJIT = enable;
+}
+
 void randomx_set_optimized_dataset_init(int value){
     optimizedDatasetInit = value;
 }
@@ -127,12 +133,18 @@ namespace randomx {
     }
 
     void JitCompilerX86::enableWriting() const {
+        if (dualMapped) {
+            return;
+        }
         uint8_t* p1 = alignToPage(code, 4096);
         uint8_t* p2 = code + CodeSize;
         zartrux::VirtualMemory::protectRW(p1, p2 - p1);
     }
 
     void JitCompilerX86::enableExecution() const {
+        if (dualMapped) {
+            return;
+        }
         uint8_t* p1 = alignToPage(code, 4096);
         uint8_t* p2 = code + CodeSize;
         zartrux::VirtualMemory::protectRX(p1, p2 - p1);
@@ -288,16 +300,35 @@ namespace randomx {
         // --- FIN DEL CÓDIGO ADAPTADO ---
 
         allocatedSize = this->initDatasetAVX2 ? (CodeSize * 4) : (CodeSize * 2);
-        allocatedCode = static_cast<uint8_t*>(allocExecutableMemory(allocatedSize,
-#           ifdef XMRIG_SECURE_JIT
-            false
-#           else
-            hugePagesJIT && hugePagesEnable
-#           endif
-        ));
+
+        // Doble mapeo: se emite por la vista RW y se ejecuta por la RX, sin mprotect por
+        // programa y sin páginas W+X. Todo el código generado es relativo a RIP, así que
+        // es válido en cualquiera de las dos direcciones.
+        zartrux::VirtualMemory::DualMapping mapping;
+        if (dualMappedJIT) {
+            mapping = zartrux::VirtualMemory::allocateDualMapping(allocatedSize, hugePagesJIT && hugePagesEnable);
+        }
+        if (mapping) {
+            dualMapped = true;
+            allocatedCode = mapping.write;
+            allocatedCodeExec = mapping.exec;
+            allocatedSize = mapping.size;
+        }
+        else {
+            allocatedCode = static_cast<uint8_t*>(allocExecutableMemory(allocatedSize,
+#               ifdef XMRIG_SECURE_JIT
+                false
+#               else
+                hugePagesJIT && hugePagesEnable
+#               endif
+            ));
+            allocatedCodeExec = allocatedCode;
+        }
 
         // Shift code base address to improve caching - all threads will use different L2/L3 cache sets
-        code = allocatedCode + (codeOffset.fetch_add(codeOffsetIncrement) % CodeSize);
+        const size_t offset = codeOffset.fetch_add(codeOffsetIncrement) % CodeSize;
+        code = allocatedCode + offset;
+        codeExec = allocatedCodeExec + offset;
 
         memcpy(code, codePrologue, prologueSize);
         if (this->hasXOP) {
@@ -310,14 +341,23 @@ namespace randomx {
 
         codePosFirst = prologueSize + (this->hasXOP ? loopLoadXOPSize : loopLoadSize);
 #       ifdef XMRIG_FIX_RYZEN
-        mainLoopBounds.first = code + prologueSize;
-        mainLoopBounds.second = code + epilogueOffset;
+        mainLoopBounds.first = codeExec + prologueSize;
+        mainLoopBounds.second = codeExec + epilogueOffset;
 #       endif
     }
 
     JitCompilerX86::~JitCompilerX86() {
         codeOffset.fetch_sub(codeOffsetIncrement);
-        freePagedMemory(allocatedCode, allocatedSize);
+        if (dualMapped) {
+            zartrux::VirtualMemory::DualMapping mapping;
+            mapping.write = allocatedCode;
+            mapping.exec = allocatedCodeExec;
+            mapping.size = allocatedSize;
+            zartrux::VirtualMemory::freeDualMapping(mapping);
+        }
+        else {
+            freePagedMemory(allocatedCode, allocatedSize);
+        }
     }
 
     template<size_t N>
@@ -346,6 +386,7 @@ namespace randomx {
         generateProgramPrologue(prog, pcfg);
         emit(codeReadDataset, readDatasetSize, code, codePos);
         generateProgramEpilogue(prog, pcfg);
+        registerProgramSymbols();
     }
 
     void JitCompilerX86::generateProgramLight(Program& prog, ProgramConfiguration& pcfg, uint32_t datasetOffset) {
@@ -358,6 +399,18 @@ namespace randomx {
         emit32(superScalarHashOffset - (codePos + 4), code, codePos);
         emit(codeReadDatasetLightSshFin, readDatasetLightFinSize, code, codePos);
         generateProgramEpilogue(prog, pcfg);
+        registerProgramSymbols();
+    }
+
+    void JitCompilerX86::registerProgramSymbols() {
+        using zartrux::runtime::JitSymbols;
+        if (!JitSymbols::enabled()) {
+            return;
+        }
+        // Prólogo y epílogo no se mueven; sólo el cuerpo cambia en cada programa
+        JitSymbols::region(codeExec, codePosFirst, "randomx_program_prologue");
+        JitSymbols::region(codeExec + epilogueOffset, epilogueSize, "randomx_program_epilogue");
+        JitSymbols::program(codeExec + codePosFirst, codePos - codePosFirst, "randomx_program");
     }
 
     template<size_t N>
@@ -393,6 +446,7 @@ namespace randomx {
             *(int32_t*)(code + codePos - 4) = prologue_size - codePos;
 
             emit(codeDatasetInitAVX2Epilogue, datasetInitAVX2EpilogueSize, code, codePos);
+            zartrux::runtime::JitSymbols::region(codeExec, codePos, "randomx_dataset_init_avx2");
             return;
         }
 
@@ -413,6 +467,7 @@ namespace randomx {
             }
         }
         emitByte(0xc3, code, codePos);
+        zartrux::runtime::JitSymbols::region(codeExec + superScalarHashOffset, codePos - superScalarHashOffset, "randomx_sshash");
     }
 
     template
@@ -422,6 +477,7 @@ namespace randomx {
         // AVX2 code is generated in generateSuperscalarHash()
         if (!initDatasetAVX2) {
             memcpy(code, codeDatasetInit, datasetInitSize);
+            zartrux::runtime::JitSymbols::region(codeExec, datasetInitSize, "randomx_dataset_init");
         }
     }
 
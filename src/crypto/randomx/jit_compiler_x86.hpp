@@ -35,7 +35,7 @@ namespace randomx {
 			enableExecution();
 #			endif
 
-			return reinterpret_cast<ProgramFunc*>(code);
+			return reinterpret_cast<ProgramFunc*>(codeExec);
 		}
 
 		inline DatasetInitFunc *getDatasetInitFunc() const {
@@ -43,12 +43,14 @@ namespace randomx {
 			enableExecution();
 #			endif
 
-			return (DatasetInitFunc*)code;
+			return (DatasetInitFunc*)codeExec;
 		}
 
+		//write view; with a dual-mapped buffer the code runs from getProgramFunc()
 		uint8_t* getCode() {
 			return code;
 		}
+		bool isDualMapped() const { return dualMapped; }
 		size_t getCodeSize();
 		void enableWriting() const;
 		void enableExecution() const;
@@ -57,7 +59,8 @@ namespace randomx {
 
 	private:
 		int registerUsage[RegistersCount] = {};
-		uint8_t* code = nullptr;
+		uint8_t* code = nullptr;       //RW view, all emission goes through it
+		uint8_t* codeExec = nullptr;   //RX view (same as code without dual mapping)
 		uint32_t codePos = 0;
 		uint32_t codePosFirst = 0;
 		uint32_t vm_flags = 0;
@@ -75,13 +78,16 @@ namespace randomx {
 		bool hasXOP;
 
 		uint8_t* allocatedCode = nullptr;
+		uint8_t* allocatedCodeExec = nullptr;
 		size_t allocatedSize = 0;
+		bool dualMapped = false;
 
 		uint8_t* imul_rcp_storage = nullptr;
 		uint32_t imul_rcp_storage_used = 0;
 
 		void generateProgramPrologue(Program&, ProgramConfiguration&);
 		void generateProgramEpilogue(Program&, ProgramConfiguration&);
+		void registerProgramSymbols();
 		template<bool rax>
 		static void genAddressReg(const Instruction&, const uint32_t src, uint8_t* code, uint32_t& codePos);
 		static void genAddressRegDst(const Instruction&, uint8_t* code, uint32_t& codePos);
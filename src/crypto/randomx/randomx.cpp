@@ -269,6 +269,23 @@ extern "C" {
 		cache->initialize(cache, key, keySize);
 	}
 
+	int randomx_have_jit(void) {
+		return RANDOMX_HAVE_COMPILER;
+	}
+
+	void randomx_fill_cache(randomx_cache *cache, const void *key, size_t keySize) {
+		assert(cache != nullptr && (keySize == 0 || key != nullptr));
+		randomx::fillCache(cache, key, keySize);
+	}
+
+	void randomx_init_cache_programs(randomx_cache *cache, const void *key, size_t keySize) {
+		assert(cache != nullptr && (keySize == 0 || key != nullptr));
+		randomx::initCachePrograms(cache, key, keySize);
+		if (cache->jit) {
+			randomx::compileCache(cache);
+		}
+	}
+
 	void randomx_release_cache(randomx_cache* cache) {
 		delete cache->jit;
 		delete cache;
@@ -155,14 +155,23 @@ void randomx_apply_config(const T& config)
 
 void randomx_set_scratchpad_prefetch_mode(int mode);
 void randomx_set_huge_pages_jit(bool hugePages);
+void randomx_set_dual_mapped_jit(bool enable);
 void randomx_set_optimized_dataset_init(int value);
 
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
+/* 1 if this build has a JIT compiler for the host (RANDOMX_FLAG_JIT is usable), 0 otherwise */
+RANDOMX_EXPORT int randomx_have_jit(void);
 RANDOMX_EXPORT randomx_cache *randomx_create_cache(randomx_flags flags, uint8_t *memory);
 RANDOMX_EXPORT void randomx_init_cache(randomx_cache *cache, const void *key, size_t keySize);
+/* The two halves of randomx_init_cache, so callers can time them separately:
+ * randomx_fill_cache runs the Argon2 fill, randomx_init_cache_programs the rest. */
+RANDOMX_EXPORT void randomx_fill_cache(randomx_cache *cache, const void *key, size_t keySize);
+/* Like randomx_init_cache, but assumes the cache memory already holds the Argon2 fill for `key`
+ * (e.g. loaded from disk): only the superscalar programs (and JIT code) are generated. */
+RANDOMX_EXPORT void randomx_init_cache_programs(randomx_cache *cache, const void *key, size_t keySize);
 RANDOMX_EXPORT void randomx_release_cache(randomx_cache* cache);
 RANDOMX_EXPORT randomx_dataset *randomx_create_dataset(uint8_t *memory);
 RANDOMX_EXPORT unsigned long randomx_dataset_item_count(void);
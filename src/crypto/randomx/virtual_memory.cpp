@@ -27,6 +27,5 @@ void* allocLargePagesMemory(std::size_t bytes) {
 
 
 void freePagedMemory(void* ptr, std::size_t bytes) {
-    void *mem = zartrux::VirtualMemory::allocateLargePagesMemory(bytes);
     zartrux::VirtualMemory::freeLargePagesMemory(ptr, bytes);
 }
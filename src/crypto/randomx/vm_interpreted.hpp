@@ -36,7 +36,7 @@ namespace randomx {
 	private:
 		void execute();
 
-		InstructionByteCode bytecode[RANDOMX_PROGRAM_MAX_SIZE];
+		InstructionByteCode bytecode[BytecodeMaxSize];
 	};
 
 	using InterpretedVmDefault = InterpretedVm<1>;
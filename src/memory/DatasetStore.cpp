@@ -0,0 +1,299 @@
+#include "DatasetStore.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#endif
+
+namespace zartrux {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char MAGIC[8] = {'Z', 'R', 'X', 'S', 'T', 'O', 'R', 'E'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_BLOCK = 4096;
+constexpr size_t MAX_KEY = 64;
+constexpr size_t SAMPLE_STRIDE = size_t(1) << 20;
+constexpr size_t SAMPLE_BYTES = 64;
+
+// Cabecera al final del fichero: el contenido queda en el offset 0, alineado a página
+struct StoreHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint64_t payloadBytes;
+    uint64_t configTag;
+    uint32_t keySize;
+    uint8_t key[MAX_KEY];
+    uint64_t sampleDigest;      // huella de 64 bytes por cada MB de contenido
+    uint64_t createdAt;
+    uint64_t checksum;          // FNV-1a de todos los campos anteriores
+};
+static_assert(sizeof(StoreHeader) <= HEADER_BLOCK, "La cabecera debe caber en un bloque");
+
+uint64_t fnv1a(const void* data, size_t bytes, uint64_t hash = 0xcbf29ce484222325ULL) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Muestreo en lugar de checksum completo: recorrer 2 GB costaría tanto como leerlos.
+// Detecta ficheros truncados o a medio escribir, que es el fallo realista.
+uint64_t sampleDigest(const uint8_t* data, size_t bytes) {
+    uint64_t hash = fnv1a(&bytes, sizeof(bytes));
+    for (size_t offset = 0; offset < bytes; offset += SAMPLE_STRIDE) {
+        hash = fnv1a(data + offset, std::min(SAMPLE_BYTES, bytes - offset), hash);
+    }
+    if (bytes >= SAMPLE_BYTES) hash = fnv1a(data + bytes - SAMPLE_BYTES, SAMPLE_BYTES, hash);
+    return hash;
+}
+
+uint64_t headerChecksum(const StoreHeader& header) {
+    return fnv1a(&header, offsetof(StoreHeader, checksum));
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+const char* kindName(DatasetStore::Kind kind) {
+    return kind == DatasetStore::Kind::Cache ? "cache" : "dataset";
+}
+
+std::string toHex(const std::vector<uint8_t>& key) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(key.size() * 2);
+    for (uint8_t byte : key) {
+        out += HEX[byte >> 4];
+        out += HEX[byte & 0x0F];
+    }
+    return out;
+}
+
+#if defined(__linux__)
+constexpr long HUGETLBFS_MAGIC_NUMBER = 0x958458f6;
+
+// Tamaño de página del sistema de ficheros: en hugetlbfs la longitud debe ser múltiplo
+size_t filePageSize(const std::string& directory) {
+    struct statfs info{};
+    if (statfs(directory.c_str(), &info) == 0 && info.f_type == HUGETLBFS_MAGIC_NUMBER) {
+        return static_cast<size_t>(info.f_bsize);
+    }
+    return HEADER_BLOCK;
+}
+#endif
+
+} // namespace
+
+DatasetStore::DatasetStore(std::string directory) : m_directory(std::move(directory)) {
+    if (m_directory.empty()) return;
+#if defined(__linux__)
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+    if (ec || !fs::is_directory(m_directory)) {
+        Logger::warn("DatasetStore", "No se puede usar el directorio " + m_directory + ": " + ec.message());
+        m_directory.clear();
+        return;
+    }
+    m_hugetlbfs = filePageSize(m_directory) > HEADER_BLOCK;
+    Logger::info("DatasetStore", "Almacén de datasets en " + m_directory +
+                 (m_hugetlbfs ? " (hugetlbfs)" : ""));
+#else
+    Logger::warn("DatasetStore", "El almacén de datasets sólo está disponible en Linux");
+    m_directory.clear();
+#endif
+}
+
+std::string DatasetStore::path(Kind kind, const std::vector<uint8_t>& key) const {
+    return (fs::path(m_directory) / (std::string(kindName(kind)) + "-" + toHex(key) + ".bin")).string();
+}
+
+DatasetStore::Mapping DatasetStore::load(Kind kind, const std::vector<uint8_t>& key, size_t bytes,
+                                         uint64_t configTag) const {
+    Mapping mapping;
+#if defined(__linux__)
+    if (!enabled() || key.empty() || key.size() > MAX_KEY || bytes == 0) return mapping;
+
+    const std::string file = path(kind, key);
+    const int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return mapping;
+
+    const size_t headerOffset = alignUp(bytes, HEADER_BLOCK);
+    const size_t fileBytes = alignUp(headerOffset + HEADER_BLOCK, filePageSize(m_directory));
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != fileBytes) {
+        ::close(fd);
+        Logger::warn("DatasetStore", file + ": tamaño inesperado, se descarta");
+        ::unlink(file.c_str());
+        return mapping;
+    }
+
+    // En hugetlbfs el mapeo compartido es la propia memoria del fichero; en disco se usa
+    // una copia privada de sólo lectura que MAP_POPULATE lee por adelantado.
+    const int flags = (m_hugetlbfs ? MAP_SHARED : MAP_PRIVATE) | MAP_POPULATE;
+    void* base = mmap(nullptr, fileBytes, PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        Logger::warn("DatasetStore", file + ": mmap falló: " + std::strerror(errno));
+        return mapping;
+    }
+
+    auto* data = static_cast<uint8_t*>(base);
+    StoreHeader header{};
+    std::memcpy(&header, data + headerOffset, sizeof(header));
+    const bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+        header.checksum == headerChecksum(header) &&
+        header.version == VERSION &&
+        header.kind == static_cast<uint32_t>(kind) &&
+        header.payloadBytes == bytes &&
+        header.configTag == configTag &&
+        header.keySize == key.size() &&
+        std::memcmp(header.key, key.data(), key.size()) == 0 &&
+        header.sampleDigest == sampleDigest(data, bytes);
+    if (!valid) {
+        munmap(base, fileBytes);
+        Logger::warn("DatasetStore", file + ": cabecera no válida o contenido corrupto, se descarta");
+        ::unlink(file.c_str());
+        return mapping;
+    }
+
+    mapping.data = data;
+    mapping.size = bytes;
+    mapping.mappedBytes = fileBytes;
+    mapping.hugetlbfs = m_hugetlbfs;
+#else
+    (void)kind; (void)key; (void)bytes; (void)configTag;
+#endif
+    return mapping;
+}
+
+bool DatasetStore::save(Kind kind, const std::vector<uint8_t>& key, const void* data, size_t bytes,
+                        uint64_t configTag) const {
+#if defined(__linux__)
+    if (!enabled() || key.empty() || key.size() > MAX_KEY || !data || bytes == 0) return false;
+
+    const std::string file = path(kind, key);
+    const std::string temp = file + ".tmp";
+    const size_t headerOffset = alignUp(bytes, HEADER_BLOCK);
+    const size_t fileBytes = alignUp(headerOffset + HEADER_BLOCK, filePageSize(m_directory));
+
+    struct statvfs space{};
+    if (statvfs(m_directory.c_str(), &space) == 0 &&
+        static_cast<uint64_t>(space.f_bavail) * space.f_frsize < fileBytes) {
+        Logger::warn("DatasetStore", std::string("Sin espacio para guardar ") + kindName(kind) + " en " + m_directory);
+        return false;
+    }
+
+    const int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Logger::warn("DatasetStore", temp + ": " + std::strerror(errno));
+        return false;
+    }
+
+    // hugetlbfs no admite write(): se escribe siempre a través de un mapeo compartido
+    bool ok = ftruncate(fd, static_cast<off_t>(fileBytes)) == 0;
+    void* base = ok ? mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ok = base != MAP_FAILED;
+    if (ok) {
+        auto* out = static_cast<uint8_t*>(base);
+        std::memcpy(out, data, bytes);
+
+        StoreHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.kind = static_cast<uint32_t>(kind);
+        header.payloadBytes = bytes;
+        header.configTag = configTag;
+        header.keySize = static_cast<uint32_t>(key.size());
+        std::memcpy(header.key, key.data(), key.size());
+        header.sampleDigest = sampleDigest(out, bytes);
+        header.createdAt = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        header.checksum = headerChecksum(header);
+        std::memcpy(out + headerOffset, &header, sizeof(header));
+
+        // El contenido debe estar en disco antes del rename para no publicar un fichero a medias
+        if (!m_hugetlbfs) ok = msync(base, fileBytes, MS_SYNC) == 0;
+        munmap(base, fileBytes);
+    }
+    ::close(fd);
+
+    if (!ok || std::rename(temp.c_str(), file.c_str()) != 0) {
+        Logger::warn("DatasetStore", std::string("No se pudo guardar ") + kindName(kind) + " en " + file);
+        ::unlink(temp.c_str());
+        return false;
+    }
+    Logger::info("DatasetStore", std::string(kindName(kind)) + " guardado en " + file + " (" +
+                 std::to_string(fileBytes >> 20) + " MB)");
+    return true;
+#else
+    (void)kind; (void)key; (void)data; (void)bytes; (void)configTag;
+    return false;
+#endif
+}
+
+size_t DatasetStore::evict(const std::vector<std::vector<uint8_t>>& keep) const {
+    if (!enabled()) return 0;
+
+    std::vector<std::string> keepHex;
+    for (const auto& key : keep) keepHex.push_back(toHex(key));
+
+    size_t removed = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(m_directory, ec)) {
+        const std::string name = entry.path().filename().string();
+        const bool temp = name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0;
+        const std::string base = temp ? name.substr(0, name.size() - 4) : name;
+
+        std::string seed;
+        for (const char* prefix : {"cache-", "dataset-"}) {
+            const size_t length = std::strlen(prefix);
+            if (base.compare(0, length, prefix) == 0 && base.size() > length + 4 &&
+                base.compare(base.size() - 4, 4, ".bin") == 0) {
+                seed = base.substr(length, base.size() - length - 4);
+            }
+        }
+        if (seed.empty()) continue;   // ficheros ajenos al almacén: no se tocan
+        if (!temp && std::find(keepHex.begin(), keepHex.end(), seed) != keepHex.end()) continue;
+
+        std::error_code removeEc;
+        if (fs::remove(entry.path(), removeEc)) {
+            ++removed;
+            Logger::debug("DatasetStore", "Eliminado " + name);
+        }
+    }
+    return removed;
+}
+
+void DatasetStore::unmap(void* data, size_t mappedBytes) {
+#if defined(__linux__)
+    if (data && mappedBytes) munmap(data, mappedBytes);
+#else
+    (void)data; (void)mappedBytes;
+#endif
+}
+
+void DatasetStore::unmap(Mapping& mapping) {
+    unmap(mapping.data, mapping.mappedBytes);
+    mapping = {};
+}
+
+} // namespace zartrux
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zartrux {
+
+/**
+ * @class DatasetStore
+ * @brief Almacén en disco de la cache y el dataset de RandomX, indexado por semilla.
+ *
+ * Cada época se guarda como `cache-<semilla>.bin` y `dataset-<semilla>.bin` dentro de un
+ * directorio. El contenido va al principio del fichero (así queda alineado a página para
+ * mapearlo directamente) y una cabecera con checksum al final. Si el directorio está en
+ * hugetlbfs los ficheros viven en páginas grandes y sobreviven al reinicio del proceso sin
+ * volver a leerse de disco. Sólo disponible en Linux; en el resto de plataformas está
+ * siempre deshabilitado.
+ */
+class DatasetStore {
+public:
+    enum class Kind : uint32_t {
+        Cache = 1,
+        Dataset = 2
+    };
+
+    /**
+     * @brief Fichero mapeado en memoria. `data` apunta al contenido validado.
+     */
+    struct Mapping {
+        uint8_t* data = nullptr;
+        size_t size = 0;            // bytes de contenido
+        size_t mappedBytes = 0;     // tamaño real del mapeo (para unmap)
+        bool hugetlbfs = false;     // respaldado por páginas grandes (se puede usar sin copiar)
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    /**
+     * @param directory Directorio del almacén; vacío deshabilita el almacén.
+     */
+    explicit DatasetStore(std::string directory);
+
+    bool enabled() const { return !m_directory.empty(); }
+    const std::string& directory() const { return m_directory; }
+    bool onHugetlbfs() const { return m_hugetlbfs; }
+
+    /**
+     * @brief Mapea (MAP_POPULATE) la entrada de una semilla y valida su cabecera.
+     * @param configTag Huella de la configuración de RandomX con la que se generó.
+     * @return Mapping vacío si no existe, no coincide o está corrupta (en ese caso se borra).
+     */
+    Mapping load(Kind kind, const std::vector<uint8_t>& key, size_t bytes, uint64_t configTag) const;
+
+    /**
+     * @brief Escribe una entrada en un fichero temporal y lo renombra al terminar,
+     *        de modo que un lector nunca ve un fichero a medias.
+     */
+    bool save(Kind kind, const std::vector<uint8_t>& key, const void* data, size_t bytes, uint64_t configTag) const;
+
+    /**
+     * @brief Borra las entradas de cualquier semilla que no esté en `keep`, y los temporales.
+     * @return Número de ficheros borrados.
+     */
+    size_t evict(const std::vector<std::vector<uint8_t>>& keep) const;
+
+    std::string path(Kind kind, const std::vector<uint8_t>& key) const;
+
+    static void unmap(void* data, size_t mappedBytes);
+    static void unmap(Mapping& mapping);
+
+private:
+    std::string m_directory;
+    bool m_hugetlbfs = false;
+};
+
+} // namespace zartrux
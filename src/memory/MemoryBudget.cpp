@@ -0,0 +1,139 @@
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace zartrux {
+
+namespace {
+
+#if defined(__linux__)
+// "max" (sin límite) o un valor no numérico devuelven 0
+uint64_t readValue(const std::string& path) {
+    std::ifstream in(path);
+    std::string text;
+    if (!(in >> text) || text.empty() || text[0] < '0' || text[0] > '9') return 0;
+    return std::stoull(text);
+}
+
+// Ruta del cgroup del proceso según /proc/self/cgroup ("0::/ruta" en v2)
+std::string cgroupPath(const std::string& controller) {
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto first = line.find(':');
+        const auto second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) continue;
+        const std::string controllers = line.substr(first + 1, second - first - 1);
+        if (controllers == controller ||
+            (!controller.empty() && ("," + controllers + ",").find("," + controller + ",") != std::string::npos)) {
+            return line.substr(second + 1);
+        }
+    }
+    return "/";
+}
+#endif
+
+} // namespace
+
+uint64_t MemoryBudget::MemoryInfo::usable() const {
+    uint64_t bytes = available + hugePagesFree;
+    if (cgroupLimit) {
+        const uint64_t cgroupFree = cgroupLimit > cgroupUsage ? cgroupLimit - cgroupUsage : 0;
+        bytes = std::min(bytes, cgroupFree);
+    }
+    return bytes;
+}
+
+MemoryBudget::MemoryInfo MemoryBudget::query() {
+    MemoryInfo info;
+#if defined(__linux__)
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    uint64_t hugeFree = 0, hugeSize = 0;
+    while (std::getline(meminfo, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        uint64_t value = 0;
+        fields >> key >> value;
+        if (key == "MemTotal:") info.total = value * 1024;
+        else if (key == "MemAvailable:") info.available = value * 1024;
+        else if (key == "HugePages_Free:") hugeFree = value;
+        else if (key == "Hugepagesize:") hugeSize = value * 1024;
+    }
+    info.hugePagesFree = hugeFree * hugeSize;
+
+    // cgroup v2 y, si no, v1
+    const std::string v2 = "/sys/fs/cgroup" + cgroupPath("");
+    info.cgroupLimit = readValue(v2 + "/memory.max");
+    if (info.cgroupLimit) {
+        info.cgroupUsage = readValue(v2 + "/memory.current");
+    } else {
+        const std::string v1 = "/sys/fs/cgroup/memory" + cgroupPath("memory");
+        info.cgroupLimit = readValue(v1 + "/memory.limit_in_bytes");
+        // v1 expresa "sin límite" como un valor enorme
+        if (info.cgroupLimit >= info.total && info.total) info.cgroupLimit = 0;
+        if (info.cgroupLimit) info.cgroupUsage = readValue(v1 + "/memory.usage_in_bytes");
+    }
+#endif
+    return info;
+}
+
+uint64_t MemoryBudget::required(const Request& request, bool fullMemory, unsigned threads) {
+    const uint64_t vms = static_cast<uint64_t>(threads) * request.ways;
+    uint64_t bytes = request.cacheBytes + request.processOverheadBytes + request.reserveBytes +
+                     static_cast<uint64_t>(threads) * request.threadOverheadBytes +
+                     vms * (request.scratchpadBytes + request.jitBytes);
+    if (fullMemory) bytes += static_cast<uint64_t>(request.datasetBytes) * request.datasetReplicas;
+    return bytes;
+}
+
+MemoryBudget::Plan MemoryBudget::plan(const Request& request, const MemoryInfo& info, double lightRelativeSpeed) {
+    Plan plan;
+    plan.budget = info.usable();
+    const unsigned requested = std::max(1u, request.threads);
+
+    auto finish = [&](bool fullMemory, unsigned threads, std::string reason) {
+        plan.fullMemory = fullMemory;
+        plan.threads = threads;
+        plan.required = required(request, fullMemory, threads);
+        // Al cambiar de época conviven dos caches (y dos juegos de datasets en modo completo)
+        plan.peakRequired = plan.required + request.cacheBytes +
+            (fullMemory ? static_cast<uint64_t>(request.datasetBytes) * request.datasetReplicas : 0);
+        plan.reason = std::move(reason);
+        return plan;
+    };
+
+    if (!info.known()) return finish(true, requested, "memoria del sistema desconocida");
+
+    // Máximo de hilos que caben en cada modo (0 si ni uno cabe)
+    auto fit = [&](bool fullMemory) -> unsigned {
+        for (unsigned threads = requested; threads > 0; --threads) {
+            if (required(request, fullMemory, threads) <= plan.budget) return threads;
+        }
+        return 0;
+    };
+    const unsigned fullThreads = fit(true);
+    const unsigned lightThreads = fit(false);
+
+    // Se compara el hashrate estimado: pocos hilos en modo completo suelen ganar a muchos en ligero
+    if (fullThreads && fullThreads >= lightThreads * lightRelativeSpeed) {
+        return finish(true, fullThreads, fullThreads == requested
+            ? "el dataset cabe en memoria"
+            : "dataset en memoria con menos hilos");
+    }
+    if (lightThreads) {
+        return finish(false, lightThreads, fullThreads
+            ? "modo ligero rinde más con la memoria disponible"
+            : "el dataset no cabe en memoria");
+    }
+    return finish(false, 1, "memoria insuficiente incluso en modo ligero");
+}
+
+bool MemoryBudget::underPressure(const MemoryInfo& info, uint64_t reserveBytes) {
+    return info.known() && info.usable() < reserveBytes;
+}
+
+} // namespace zartrux
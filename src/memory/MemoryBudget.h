@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace zartrux {
+
+/**
+ * @class MemoryBudget
+ * @brief Planificador de memoria: decide entre modo completo (dataset de 2 GB) y modo
+ *        ligero (sólo cache) y cuántos hilos caben en la memoria disponible.
+ *
+ * La memoria disponible se lee de /proc/meminfo y se limita con el cgroup del proceso
+ * (v2 o v1), que es lo que aplica el OOM killer dentro de contenedores.
+ */
+class MemoryBudget {
+public:
+    /**
+     * @brief Memoria del sistema vista por el proceso. 0 = desconocido.
+     */
+    struct MemoryInfo {
+        uint64_t total = 0;
+        uint64_t available = 0;         // MemAvailable
+        uint64_t hugePagesFree = 0;     // hugetlb reservadas y libres (fuera de MemAvailable)
+        uint64_t cgroupLimit = 0;       // 0 = sin límite
+        uint64_t cgroupUsage = 0;
+
+        /**
+         * @brief Bytes que el proceso puede reservar todavía.
+         */
+        uint64_t usable() const;
+        bool known() const { return total != 0; }
+    };
+
+    /**
+     * @brief Lo que el minero necesita reservar, por componente.
+     */
+    struct Request {
+        unsigned threads = 1;
+        unsigned ways = 1;              // VMs por hilo
+        unsigned datasetReplicas = 1;   // una por nodo NUMA
+        size_t datasetBytes = 0;
+        size_t cacheBytes = 0;
+        size_t scratchpadBytes = 0;     // por VM
+        size_t jitBytes = 0;            // por VM
+        size_t threadOverheadBytes = 0; // pila, colas y buffers por hilo
+        size_t processOverheadBytes = 0;
+        size_t reserveBytes = 0;        // margen que se deja libre al sistema
+    };
+
+    struct Plan {
+        bool fullMemory = true;
+        unsigned threads = 1;
+        uint64_t required = 0;          // bytes que necesita el plan elegido
+        uint64_t budget = 0;            // bytes disponibles según MemoryInfo
+        uint64_t peakRequired = 0;      // con la siguiente época preparada en paralelo
+        std::string reason;
+    };
+
+    static MemoryInfo query();
+
+    /**
+     * @brief Bytes que necesita `request` en modo completo o ligero con `threads` hilos.
+     */
+    static uint64_t required(const Request& request, bool fullMemory, unsigned threads);
+
+    /**
+     * @brief Elige modo y número de hilos. Con memoria desconocida se respeta la petición.
+     * @param lightRelativeSpeed Hashrate por hilo en modo ligero respecto al completo.
+     */
+    static Plan plan(const Request& request, const MemoryInfo& info, double lightRelativeSpeed);
+
+    /**
+     * @brief true si la memoria libre ha caído por debajo de `reserveBytes`.
+     */
+    static bool underPressure(const MemoryInfo& info, uint64_t reserveBytes);
+};
+
+} // namespace zartrux
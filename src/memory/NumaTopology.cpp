@@ -0,0 +1,166 @@
+#include "NumaTopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace zartrux {
+
+namespace {
+
+#if defined(__linux__)
+// Valores de <linux/mempolicy.h>; se definen aquí para no depender de las cabeceras del kernel
+constexpr int MPOL_PREFERRED_MODE = 1;
+constexpr unsigned long MAX_NODES = 1024;
+constexpr size_t BITS_PER_WORD = sizeof(unsigned long) * 8;
+
+// Formato de listas de sysfs: "0-3,8-11"
+std::vector<unsigned> parseCpuList(const std::string& text) {
+    std::vector<unsigned> result;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        const auto dash = range.find('-');
+        try {
+            const unsigned first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+            const unsigned last = dash == std::string::npos
+                ? first
+                : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+            for (unsigned cpu = first; cpu <= last; ++cpu) result.push_back(cpu);
+        } catch (...) {
+            // Entrada mal formada: se ignora
+        }
+    }
+    return result;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    std::string content;
+    std::getline(in, content);
+    return content;
+}
+#endif
+
+} // namespace
+
+const NumaTopology& NumaTopology::instance() {
+    static NumaTopology topology;
+    return topology;
+}
+
+NumaTopology::NumaTopology() {
+#if defined(__linux__)
+    for (unsigned id : parseCpuList(readFile("/sys/devices/system/node/online"))) {
+        Node node{id, parseCpuList(readFile("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist"))};
+        if (!node.cpus.empty()) m_nodes.push_back(std::move(node));
+    }
+#endif
+    if (m_nodes.empty()) {
+        Node node{0, {}};
+        const unsigned count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < count; ++cpu) node.cpus.push_back(cpu);
+        m_nodes.push_back(std::move(node));
+    }
+}
+
+uint32_t NumaTopology::nodeOfCpu(unsigned cpu) const {
+    for (const auto& node : m_nodes) {
+        if (std::find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end()) return node.id;
+    }
+    return 0;
+}
+
+std::vector<unsigned> NumaTopology::allCpus() const {
+    std::vector<unsigned> cpus;
+    for (const auto& node : m_nodes) cpus.insert(cpus.end(), node.cpus.begin(), node.cpus.end());
+    return cpus;
+}
+
+bool NumaTopology::bindMemory(void* ptr, size_t bytes, uint32_t node) {
+#if defined(__linux__)
+    if (!ptr || bytes == 0 || node >= MAX_NODES) return false;
+    unsigned long mask[MAX_NODES / BITS_PER_WORD] = {};
+    mask[node / BITS_PER_WORD] = 1UL << (node % BITS_PER_WORD);
+    // Preferente y no estricta: si el nodo se queda sin memoria se usa otro en vez de fallar
+    return syscall(SYS_mbind, ptr, bytes, MPOL_PREFERRED_MODE, mask, MAX_NODES, 0) == 0;
+#else
+    (void)ptr; (void)bytes; (void)node;
+    return false;
+#endif
+}
+
+bool NumaTopology::pinThreadToNode(uint32_t node) const {
+#if defined(__linux__)
+    for (const auto& n : m_nodes) {
+        if (n.id != node) continue;
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (unsigned cpu : n.cpus) CPU_SET(cpu, &cpuset);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+    }
+    return false;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+bool NumaTopology::pinThreadToCpu(unsigned cpu) {
+#if defined(__linux__)
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#elif defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+std::vector<size_t> NumaTopology::residentPagesPerNode(const void* ptr, size_t bytes, size_t maxSamples) const {
+    std::vector<size_t> counts;
+#if defined(__linux__)
+    if (!ptr || bytes == 0 || maxSamples == 0) return counts;
+    constexpr size_t PAGE = 4096;
+    const size_t pages = (bytes + PAGE - 1) / PAGE;
+    const size_t stride = std::max<size_t>(1, pages / maxSamples);
+
+    std::vector<void*> addresses;
+    for (size_t page = 0; page < pages; page += stride) {
+        addresses.push_back(const_cast<uint8_t*>(static_cast<const uint8_t*>(ptr)) + page * PAGE);
+    }
+    std::vector<int> status(addresses.size(), -1);
+    // Con nodes == NULL, move_pages sólo informa del nodo de cada página
+    if (syscall(SYS_move_pages, 0, addresses.size(), addresses.data(), nullptr, status.data(), 0) != 0) {
+        return counts;
+    }
+
+    uint32_t maxNode = 0;
+    for (const auto& node : m_nodes) maxNode = std::max(maxNode, node.id);
+    counts.assign(maxNode + 1, 0);
+    for (int node : status) {
+        // Valores negativos: página no residente o error (-ENOENT, -EFAULT)
+        if (node >= 0 && static_cast<size_t>(node) < counts.size()) counts[node] += stride;
+    }
+#else
+    (void)ptr; (void)bytes; (void)maxSamples;
+#endif
+    return counts;
+}
+
+} // namespace zartrux
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zartrux {
+
+/**
+ * @class NumaTopology
+ * @brief Topología NUMA del sistema y utilidades de colocación de memoria e hilos.
+ *
+ * En Linux se lee de /sys/devices/system/node y la política de memoria se aplica con
+ * las llamadas al sistema mbind/move_pages, sin depender de libnuma. En el resto de
+ * plataformas (o si sysfs no está disponible) se expone un único nodo con todas las CPUs.
+ */
+class NumaTopology {
+public:
+    struct Node {
+        uint32_t id;
+        std::vector<unsigned> cpus;
+    };
+
+    /**
+     * @brief Topología detectada una única vez al primer uso.
+     */
+    static const NumaTopology& instance();
+
+    const std::vector<Node>& nodes() const { return m_nodes; }
+    size_t nodeCount() const { return m_nodes.size(); }
+    bool isNuma() const { return m_nodes.size() > 1; }
+
+    /**
+     * @brief Nodo al que pertenece una CPU (0 si no se conoce).
+     */
+    uint32_t nodeOfCpu(unsigned cpu) const;
+
+    /**
+     * @brief Lista de CPUs ordenada por nodo, para repartir hilos entre nodos.
+     */
+    std::vector<unsigned> allCpus() const;
+
+    /**
+     * @brief Fija la política de memoria de una región a un nodo. Debe llamarse antes
+     *        del primer acceso: las páginas se colocan al tocarse por primera vez.
+     * @return true si la política se aplicó.
+     */
+    static bool bindMemory(void* ptr, size_t bytes, uint32_t node);
+
+    /**
+     * @brief Restringe el hilo actual a las CPUs de un nodo.
+     */
+    bool pinThreadToNode(uint32_t node) const;
+
+    /**
+     * @brief Restringe el hilo actual a una CPU concreta.
+     */
+    static bool pinThreadToCpu(unsigned cpu);
+
+    /**
+     * @brief Cuenta, por nodo, las páginas residentes de una región (muestreo de hasta
+     *        maxSamples páginas). El índice del vector es el id del nodo; vacío si no
+     *        se puede consultar.
+     */
+    std::vector<size_t> residentPagesPerNode(const void* ptr, size_t bytes, size_t maxSamples = 4096) const;
+
+private:
+    NumaTopology();
+
+    std::vector<Node> m_nodes;
+};
+
+} // namespace zartrux
@@ -1,5 +1,13 @@
 #include "VirtualMemory.h"
+#include "utils/Logger.h"
 #include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
 
 // Incluye las cabeceras específicas de cada sistema operativo
 #if defined(_WIN32)
@@ -11,74 +19,401 @@
 
 namespace zartrux {
 
-#if defined(_WIN32)
-// --- Implementación para Windows ---
+namespace {
 
-void* VirtualMemory::allocateExecutableMemory(size_t bytes, bool hugePages) {
-    // En Windows, la memoria ejecutable y las páginas grandes se manejan de forma similar.
-    // Para simplificar, aquí usamos la protección estándar para memoria ejecutable.
-    return VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+constexpr size_t PAGE_2M = size_t(2) << 20;
+constexpr size_t PAGE_1G = size_t(1) << 30;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
 }
 
-void* VirtualMemory::allocateLargePagesMemory(size_t bytes) {
+// Registro de reservas vivas: tamaño real (necesario para liberar hugetlb) y etiqueta
+struct Registry {
+    std::mutex mutex;
+    std::map<void*, VirtualMemory::AllocationReport> entries;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+void logAllocation(const VirtualMemory::AllocationOptions& options, const VirtualMemory::Allocation& allocation) {
+    // Las reservas pequeñas (pool de VMs, buffers JIT) sólo se registran en debug
+    const char* label = options.label && *options.label ? options.label : "memoria";
+    const std::string message = std::string(label) + ": " + std::to_string(allocation.size >> 10) + " KB en " +
+        VirtualMemory::pageKindName(allocation.kind) + (allocation.locked ? " (bloqueada)" : "");
+    if (allocation.size >= PAGE_2M) {
+        Logger::info("VirtualMemory", message);
+    } else {
+        Logger::debug("VirtualMemory", message);
+    }
+}
+
+#if defined(_WIN32)
+
+VirtualMemory::Allocation platformAllocate(size_t bytes, const VirtualMemory::AllocationOptions& options) {
+    VirtualMemory::Allocation result;
+    const DWORD protect = options.executable ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
+
     // Para usar páginas grandes en Windows, el usuario necesita el privilegio "Bloquear páginas en la memoria".
-    size_t largePageSize = GetLargePageMinimum();
-    if (largePageSize > 0 && bytes >= largePageSize) {
-        size_t alignedBytes = (bytes + largePageSize - 1) / largePageSize * largePageSize;
-        void* mem = VirtualAlloc(nullptr, alignedBytes, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
-        if (mem) return mem;
+    const size_t largePageSize = GetLargePageMinimum();
+    if (options.allowHugeTlb && largePageSize > 0 && bytes >= largePageSize) {
+        const size_t alignedBytes = alignUp(bytes, largePageSize);
+        void* mem = VirtualAlloc(nullptr, alignedBytes, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, protect);
+        if (mem) {
+            result.ptr = mem;
+            result.size = alignedBytes;
+            result.kind = VirtualMemory::PageKind::Huge2M;
+            return result;
+        }
     }
     // Si falla o no está disponible, se usa memoria normal.
-    return VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    result.ptr = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, protect);
+    result.size = bytes;
+    result.kind = VirtualMemory::PageKind::Normal;
+    return result;
 }
 
-void VirtualMemory::freeLargePagesMemory(void* ptr, size_t bytes) {
-    if (ptr) {
-        VirtualFree(ptr, 0, MEM_RELEASE);
+void platformFree(void* ptr, size_t) {
+    VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+bool platformLock(void* ptr, size_t bytes) {
+    return VirtualLock(ptr, bytes) != 0;
+}
+
+#else
+
+void* mapAnonymous(size_t bytes, int prot, int extraFlags) {
+    void* mem = mmap(nullptr, bytes, prot, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+    return mem == MAP_FAILED ? nullptr : mem;
+}
+
+VirtualMemory::Allocation platformAllocate(size_t bytes, const VirtualMemory::AllocationOptions& options) {
+    VirtualMemory::Allocation result;
+    const int prot = PROT_READ | PROT_WRITE | (options.executable ? PROT_EXEC : 0);
+
+#ifdef MAP_HUGETLB
+    // 1) Páginas de 1 GB (requieren hugepagesz=1G reservadas en el arranque)
+#   ifdef MAP_HUGE_SHIFT
+    if (options.allow1GB && options.allowHugeTlb) {
+        const size_t size = alignUp(bytes, PAGE_1G);
+        if (void* mem = mapAnonymous(size, prot, MAP_HUGETLB | (30 << MAP_HUGE_SHIFT))) {
+            return {mem, size, VirtualMemory::PageKind::Gigantic1G, false};
+        }
+    }
+#   endif
+
+    // 2) hugetlb de 2 MB (vm.nr_hugepages); la longitud debe ser múltiplo de la página
+    if (options.allowHugeTlb) {
+        const size_t size = alignUp(bytes, PAGE_2M);
+        if (void* mem = mapAnonymous(size, prot, MAP_HUGETLB)) {
+            return {mem, size, VirtualMemory::PageKind::Huge2M, false};
+        }
+    }
+#endif
+
+#ifdef MADV_HUGEPAGE
+    // 3) THP: se mapea con margen para alinear a 2 MB y se recortan los sobrantes,
+    //    así el núcleo puede respaldar la región completa con páginas de 2 MB.
+    if (options.allowTHP && bytes >= PAGE_2M) {
+        const size_t size = alignUp(bytes, PAGE_2M);
+        if (auto* raw = static_cast<uint8_t*>(mapAnonymous(size + PAGE_2M, prot, 0))) {
+            const auto address = reinterpret_cast<uintptr_t>(raw);
+            auto* aligned = reinterpret_cast<uint8_t*>(alignUp(address, PAGE_2M));
+            const size_t head = static_cast<size_t>(aligned - raw);
+            if (head) munmap(raw, head);
+            const size_t tail = PAGE_2M - head;
+            if (tail) munmap(aligned + size, tail);
+            madvise(aligned, size, MADV_HUGEPAGE);
+            return {aligned, size, VirtualMemory::PageKind::TransparentHuge, false};
+        }
+    }
+#endif
+
+    // 4) Páginas normales
+    const size_t size = alignUp(bytes, 4096);
+    if (void* mem = mapAnonymous(size, prot, 0)) {
+        return {mem, size, VirtualMemory::PageKind::Normal, false};
     }
+    return result;
 }
 
-void VirtualMemory::protectRX(void* ptr, size_t bytes) {
-    DWORD oldProtect;
-    VirtualProtect(ptr, bytes, PAGE_EXECUTE_READ, &oldProtect);
+void platformFree(void* ptr, size_t bytes) {
+    munmap(ptr, bytes);
 }
 
-void VirtualMemory::protectRW(void* ptr, size_t bytes) {
-    DWORD oldProtect;
-    VirtualProtect(ptr, bytes, PAGE_READWRITE, &oldProtect);
+bool platformLock(void* ptr, size_t bytes) {
+    return mlock(ptr, bytes) == 0;
+}
+
+#endif
+
+#if defined(__linux__)
+
+// Recorre /proc/self/smaps una sola vez y suma los campos de cada mapeo a todas las regiones
+// [inicio, fin) que lo solapan. Las regiones no se solapan entre sí (son reservas distintas).
+bool scanSmaps(const std::vector<std::pair<uintptr_t, uintptr_t>>& regions,
+               std::vector<VirtualMemory::Coverage>& coverages) {
+    std::ifstream smaps("/proc/self/smaps");
+    if (!smaps) return false;
+
+    std::vector<size_t> order(regions.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return regions[a].first < regions[b].first; });
+
+    std::vector<size_t> inside;     // regiones que solapan el mapeo actual
+    std::string line;
+    while (std::getline(smaps, line)) {
+        // Cabecera de mapeo: "inicio-fin perms ..."; los campos "Clave:  N kB" van debajo
+        unsigned long long from = 0, to = 0;
+        if (std::sscanf(line.c_str(), "%llx-%llx ", &from, &to) == 2 && line.find(':') > line.find(' ')) {
+            inside.clear();
+            auto it = std::partition_point(order.begin(), order.end(),
+                                           [&](size_t i) { return regions[i].second <= from; });
+            for (; it != order.end() && regions[*it].first < to; ++it) inside.push_back(*it);
+            continue;
+        }
+        if (inside.empty()) continue;
+
+        const auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        const std::string key = line.substr(0, colon);
+        const bool rss = key == "Rss";
+        const bool thp = key == "AnonHugePages";
+        // hugetlb no cuenta en Rss
+        const bool hugetlb = key == "Private_Hugetlb" || key == "Shared_Hugetlb";
+        if (!rss && !thp && !hugetlb) continue;
+        const size_t value = static_cast<size_t>(std::strtoull(line.c_str() + colon + 1, nullptr, 10)) * 1024;
+        for (size_t i : inside) {
+            if (rss || hugetlb) coverages[i].resident += value;
+            if (thp || hugetlb) coverages[i].huge += value;
+        }
+    }
+    for (auto& coverage : coverages) coverage.measured = true;
+    return true;
+}
+
+#endif
+
+} // namespace
+
+VirtualMemory::Allocation VirtualMemory::allocate(size_t bytes, const AllocationOptions& options) {
+    if (bytes == 0) return {};
+
+    Allocation allocation = platformAllocate(bytes, options);
+    if (!allocation) {
+        Logger::error("VirtualMemory", std::string("No se pudo reservar ") + std::to_string(bytes) +
+                      " bytes para " + (options.label ? options.label : ""));
+        return allocation;
+    }
+    if (options.lock) {
+        allocation.locked = platformLock(allocation.ptr, allocation.size);
+        if (!allocation.locked) {
+            Logger::warn("VirtualMemory", std::string("mlock falló para ") + (options.label ? options.label : "") +
+                         " (revisa ulimit -l)");
+        }
+    }
+
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.entries[allocation.ptr] = {options.label ? options.label : "", allocation, {}};
+    }
+    logAllocation(options, allocation);
+    return allocation;
 }
 
+void VirtualMemory::release(void* ptr) {
+    if (!ptr) return;
+    size_t size = 0;
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto it = reg.entries.find(ptr);
+        if (it == reg.entries.end()) {
+            Logger::warn("VirtualMemory", "Liberación de una reserva no registrada (ignorada)");
+            return;
+        }
+        size = it->second.allocation.size;
+        reg.entries.erase(it);
+    }
+    platformFree(ptr, size);
+}
+
+VirtualMemory::Coverage VirtualMemory::measureCoverage(const void* ptr, size_t bytes) {
+    std::vector<Coverage> coverages(1);
+    coverages[0].bytes = bytes;
+#if defined(__linux__)
+    const auto begin = reinterpret_cast<uintptr_t>(ptr);
+    scanSmaps({{begin, begin + bytes}}, coverages);
 #else
-// --- Implementación para Linux/macOS ---
+    (void)ptr;
+#endif
+    return coverages[0];
+}
 
-void* VirtualMemory::allocateExecutableMemory(size_t bytes, bool hugePages) {
-    int prot = PROT_READ | PROT_WRITE | PROT_EXEC;
-    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
-    #ifdef MAP_HUGETLB
-    if (hugePages) {
-        flags |= MAP_HUGETLB;
+std::vector<VirtualMemory::AllocationReport> VirtualMemory::report() {
+    std::vector<AllocationReport> result;
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto& [ptr, entry] : reg.entries) result.push_back(entry);
+    }
+    // smaps se lee una vez para todas las reservas y fuera del lock: puede tardar con muchas regiones
+    std::vector<Coverage> coverages(result.size());
+    for (size_t i = 0; i < result.size(); ++i) coverages[i].bytes = result[i].allocation.size;
+#if defined(__linux__)
+    std::vector<std::pair<uintptr_t, uintptr_t>> regions;
+    regions.reserve(result.size());
+    for (const auto& entry : result) {
+        const auto begin = reinterpret_cast<uintptr_t>(entry.allocation.ptr);
+        regions.emplace_back(begin, begin + entry.allocation.size);
     }
-    #endif
-    void* mem = mmap(nullptr, bytes, prot, flags, -1, 0);
-    return (mem == MAP_FAILED) ? nullptr : mem;
+    scanSmaps(regions, coverages);
+#endif
+    for (size_t i = 0; i < result.size(); ++i) result[i].coverage = coverages[i];
+    return result;
+}
+
+const char* VirtualMemory::pageKindName(PageKind kind) {
+    switch (kind) {
+        case PageKind::Gigantic1G:      return "páginas de 1 GB";
+        case PageKind::Huge2M:          return "huge pages de 2 MB";
+        case PageKind::TransparentHuge: return "THP (madvise)";
+        case PageKind::Normal:          return "páginas normales";
+    }
+    return "desconocido";
+}
+
+void* VirtualMemory::allocateExecutableMemory(size_t bytes, bool hugePages) {
+    AllocationOptions options;
+    options.label = "jit";
+    options.executable = true;
+    options.allowHugeTlb = hugePages;
+    options.allowTHP = hugePages;
+    return allocate(bytes, options).ptr;
 }
 
 void* VirtualMemory::allocateLargePagesMemory(size_t bytes) {
-    int prot = PROT_READ | PROT_WRITE;
-    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
-    #ifdef MAP_HUGETLB
-    flags |= MAP_HUGETLB;
-    #endif
-    void* mem = mmap(nullptr, bytes, prot, flags, -1, 0);
-    return (mem == MAP_FAILED) ? nullptr : mem;
+    return allocate(bytes, AllocationOptions{}).ptr;
+}
+
+#if defined(_WIN32)
+
+VirtualMemory::DualMapping VirtualMemory::allocateDualMapping(size_t bytes, bool) {
+    DualMapping result;
+    const size_t size = alignUp(bytes, 4096);
+    HANDLE section = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_EXECUTE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                        static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    if (!section) return result;
+
+    void* write = MapViewOfFile(section, FILE_MAP_WRITE, 0, 0, size);
+    void* exec = write ? MapViewOfFile(section, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, size) : nullptr;
+    // Las vistas mantienen viva la sección
+    CloseHandle(section);
+    if (!exec) {
+        if (write) UnmapViewOfFile(write);
+        return result;
+    }
+
+    result.write = static_cast<uint8_t*>(write);
+    result.exec = static_cast<uint8_t*>(exec);
+    result.size = size;
+    return result;
+}
+
+void VirtualMemory::freeDualMapping(const DualMapping& mapping) {
+    if (mapping.write) UnmapViewOfFile(mapping.write);
+    if (mapping.exec) UnmapViewOfFile(mapping.exec);
+}
+
+#else
+
+VirtualMemory::DualMapping VirtualMemory::allocateDualMapping(size_t bytes, bool hugePages) {
+    DualMapping result;
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    auto tryMap = [&result](unsigned int flags, size_t size, PageKind kind) {
+        const int fd = memfd_create("zartrux-jit", MFD_CLOEXEC | flags);
+        if (fd < 0) return false;
+
+        void* write = MAP_FAILED;
+        void* exec = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            write = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (write != MAP_FAILED) {
+                exec = mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+            }
+        }
+        // Los mapeos mantienen vivo el memfd
+        close(fd);
+        if (exec == MAP_FAILED) {
+            if (write != MAP_FAILED) munmap(write, size);
+            return false;
+        }
+
+        result.write = static_cast<uint8_t*>(write);
+        result.exec = static_cast<uint8_t*>(exec);
+        result.size = size;
+        result.kind = kind;
+        return true;
+    };
+
+#   ifdef MFD_HUGETLB
+    if (hugePages && tryMap(MFD_HUGETLB, alignUp(bytes, PAGE_2M), PageKind::Huge2M)) {
+        return result;
+    }
+#   endif
+    tryMap(0, alignUp(bytes, 4096), PageKind::Normal);
+#else
+    (void)bytes;
+    (void)hugePages;
+#endif
+    if (result) {
+        Logger::debug("VirtualMemory", "jit: " + std::to_string(result.size >> 10) + " KB de doble mapeo RW/RX en " +
+                      pageKindName(result.kind));
+    }
+    return result;
+}
+
+void VirtualMemory::freeDualMapping(const DualMapping& mapping) {
+    if (mapping.write) munmap(mapping.write, mapping.size);
+    if (mapping.exec) munmap(mapping.exec, mapping.size);
 }
 
+#endif
+
 void VirtualMemory::freeLargePagesMemory(void* ptr, size_t bytes) {
-    if (ptr) {
-        munmap(ptr, bytes);
+    if (!ptr) return;
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (reg.entries.find(ptr) == reg.entries.end()) {
+            // Reserva ajena al registro: se libera con el tamaño que indica el llamador
+            platformFree(ptr, bytes);
+            return;
+        }
     }
+    release(ptr);
 }
 
+#if defined(_WIN32)
+
+void VirtualMemory::protectRX(void* ptr, size_t bytes) {
+    DWORD oldProtect;
+    VirtualProtect(ptr, bytes, PAGE_EXECUTE_READ, &oldProtect);
+}
+
+void VirtualMemory::protectRW(void* ptr, size_t bytes) {
+    DWORD oldProtect;
+    VirtualProtect(ptr, bytes, PAGE_READWRITE, &oldProtect);
+}
+
+#else
+
 void VirtualMemory::protectRX(void* ptr, size_t bytes) {
     if (ptr) mprotect(ptr, bytes, PROT_READ | PROT_EXEC);
 }
@@ -89,4 +424,4 @@ void VirtualMemory::protectRW(void* ptr, size_t bytes) {
 
 #endif
 
-} // namespace zartrux
\ No newline at end of file
+} // namespace zartrux
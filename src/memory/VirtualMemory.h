@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace zartrux {
 
@@ -13,6 +16,93 @@ namespace zartrux {
  */
 class VirtualMemory {
 public:
+    /**
+     * @brief Tipo de página con el que se obtuvo una reserva, de mayor a menor preferencia.
+     */
+    enum class PageKind : uint8_t {
+        Gigantic1G,       // hugetlb de 1 GB
+        Huge2M,           // hugetlb de 2 MB (o páginas grandes de Windows)
+        TransparentHuge,  // memoria normal con madvise(MADV_HUGEPAGE)
+        Normal            // páginas de 4 KB
+    };
+
+    /**
+     * @brief Opciones de la cadena de reserva 1 GB -> 2 MB -> THP -> normal.
+     */
+    struct AllocationOptions {
+        const char* label = "";     // nombre para logs y estadísticas (dataset, cache, ...)
+        bool allow1GB = false;      // sólo compensa en reservas grandes (dataset)
+        bool allowHugeTlb = true;
+        bool allowTHP = true;
+        bool lock = false;          // mlock/VirtualLock tras reservar
+        bool executable = false;    // RWX para buffers JIT
+    };
+
+    /**
+     * @brief Resultado de una reserva. `size` es el tamaño realmente mapeado
+     *        (redondeado al tamaño de página obtenido).
+     */
+    struct Allocation {
+        void* ptr = nullptr;
+        size_t size = 0;
+        PageKind kind = PageKind::Normal;
+        bool locked = false;
+        explicit operator bool() const { return ptr != nullptr; }
+    };
+
+    /**
+     * @brief Cobertura de páginas grandes medida en /proc/self/smaps.
+     */
+    struct Coverage {
+        size_t bytes = 0;       // tamaño de la reserva
+        size_t resident = 0;    // bytes residentes (Rss + hugetlb)
+        size_t huge = 0;        // bytes en páginas grandes (AnonHugePages + hugetlb)
+        bool measured = false;  // false si smaps no está disponible
+        double fraction() const { return bytes ? static_cast<double>(huge) / bytes : 0.0; }
+    };
+
+    struct AllocationReport {
+        std::string label;
+        Allocation allocation;
+        Coverage coverage;
+    };
+
+    /**
+     * @brief Memoria compartida mapeada dos veces: `write` (RW) para emitir código y
+     *        `exec` (RX) para ejecutarlo. Ninguna vista es W+X y no hace falta mprotect.
+     */
+    struct DualMapping {
+        uint8_t* write = nullptr;
+        uint8_t* exec = nullptr;
+        size_t size = 0;
+        PageKind kind = PageKind::Normal;
+        explicit operator bool() const { return write != nullptr; }
+    };
+
+    /**
+     * @brief Reserva memoria recorriendo la cadena de tipos de página permitidos.
+     *        La reserva queda registrada para liberarla y para report().
+     * @return Allocation vacía (ptr == nullptr) si fallan todos los intentos.
+     */
+    static Allocation allocate(size_t bytes, const AllocationOptions& options);
+
+    /**
+     * @brief Libera una reserva hecha con allocate() o con las funciones de compatibilidad.
+     */
+    static void release(void* ptr);
+
+    /**
+     * @brief Mide la cobertura de páginas grandes de una región en /proc/self/smaps.
+     */
+    static Coverage measureCoverage(const void* ptr, size_t bytes);
+
+    /**
+     * @brief Estado de todas las reservas vivas, con su cobertura medida ahora.
+     */
+    static std::vector<AllocationReport> report();
+
+    static const char* pageKindName(PageKind kind);
+
     /**
      * @brief Reserva memoria que puede ser marcada como ejecutable (para JIT).
      * @param bytes El tamaño en bytes a reservar.
@@ -23,15 +113,26 @@ public:
 
     /**
      * @brief Reserva memoria utilizando páginas grandes para mejorar el rendimiento.
+     *        Recorre la cadena completa, así que sólo falla si tampoco hay páginas normales.
      * @param bytes El tamaño en bytes a reservar.
      * @return Un puntero a la memoria reservada, o nullptr si falla.
      */
     static void* allocateLargePagesMemory(size_t bytes);
 
+    /**
+     * @brief Reserva un buffer JIT de doble mapeo (memfd en Linux, sección anónima en Windows).
+     * @param hugePages Si se intenta respaldar con hugetlb de 2 MB.
+     * @return DualMapping vacío si el sistema no lo soporta; el llamador usa entonces
+     *         allocateExecutableMemory() con protectRW/protectRX.
+     */
+    static DualMapping allocateDualMapping(size_t bytes, bool hugePages);
+
+    static void freeDualMapping(const DualMapping& mapping);
+
     /**
      * @brief Libera la memoria previamente reservada.
      * @param ptr Puntero a la memoria a liberar.
-     * @param bytes El tamaño que fue reservado (necesario en sistemas POSIX).
+     * @param bytes El tamaño que fue reservado (sólo se usa si la reserva no está registrada).
      */
     static void freeLargePagesMemory(void* ptr, size_t bytes);
 
@@ -50,4 +151,4 @@ public:
     static void protectRW(void* ptr, size_t bytes);
 };
 
-} // namespace zartrux
\ No newline at end of file
+} // namespace zartrux
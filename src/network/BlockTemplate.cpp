@@ -0,0 +1,211 @@
+#include "BlockTemplate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace zartrux::network {
+
+namespace {
+
+constexpr uint8_t TXIN_GEN = 0xff;
+constexpr uint8_t TXOUT_TO_KEY = 0x02;
+constexpr uint8_t TXOUT_TO_TAGGED_KEY = 0x03;   // clave + view tag (desde HF15)
+constexpr uint8_t RCT_TYPE_NULL = 0x00;
+
+// Lectura secuencial con comprobación de límites; cualquier desbordamiento invalida la plantilla
+class Reader {
+public:
+    explicit Reader(const std::vector<uint8_t>& data) : m_data(data) {}
+
+    size_t pos() const { return m_pos; }
+    bool atEnd() const { return m_pos == m_data.size(); }
+    size_t remaining() const { return m_data.size() - m_pos; }
+
+    uint8_t byte() {
+        need(1);
+        return m_data[m_pos++];
+    }
+
+    void skip(size_t bytes) {
+        need(bytes);
+        m_pos += bytes;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        throw std::invalid_argument("Varint demasiado largo en la plantilla");
+    }
+
+private:
+    void need(size_t bytes) const {
+        if (bytes > remaining()) throw std::invalid_argument("Plantilla de bloque truncada");
+    }
+
+    const std::vector<uint8_t>& m_data;
+    size_t m_pos = 0;
+};
+
+void appendVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+BlockTemplate::hash_t hashPair(const BlockTemplate::hash_t& a, const BlockTemplate::hash_t& b) {
+    uint8_t pair[64];
+    std::memcpy(pair, a.data(), 32);
+    std::memcpy(pair + 32, b.data(), 32);
+    return zartrux::keccak::hash256(pair, sizeof(pair));
+}
+
+} // namespace
+
+BlockTemplate::BlockTemplate(std::vector<uint8_t> blob, size_t reservedOffset, size_t reservedSize)
+    : m_blob(std::move(blob))
+    , m_reservedOffset(reservedOffset)
+    , m_reservedSize(reservedSize) {
+    Reader reader(m_blob);
+
+    // Cabecera: versiones, timestamp, bloque anterior y nonce
+    reader.varint();
+    reader.varint();
+    reader.varint();
+    reader.skip(32);
+    m_nonceOffset = reader.pos();
+    reader.skip(4);
+
+    // Coinbase: una entrada generadora, salidas a clave y el campo extra con la zona reservada
+    m_minerTxOffset = reader.pos();
+    m_minerTxVersion = reader.varint();
+    if (m_minerTxVersion != 1 && m_minerTxVersion != 2) {
+        throw std::invalid_argument("Versión de coinbase no soportada: " + std::to_string(m_minerTxVersion));
+    }
+    reader.varint();    // unlock_time
+    if (reader.varint() != 1 || reader.byte() != TXIN_GEN) {
+        throw std::invalid_argument("La coinbase debe tener una única entrada generadora");
+    }
+    reader.varint();    // altura
+
+    const uint64_t outputs = reader.varint();
+    for (uint64_t i = 0; i < outputs; ++i) {
+        reader.varint();    // cantidad
+        const uint8_t type = reader.byte();
+        if (type == TXOUT_TO_KEY) reader.skip(32);
+        else if (type == TXOUT_TO_TAGGED_KEY) reader.skip(33);
+        else throw std::invalid_argument("Tipo de salida de coinbase desconocido");
+    }
+
+    const uint64_t extraSize = reader.varint();
+    const size_t extraOffset = reader.pos();
+    reader.skip(extraSize);
+    m_minerTxPrefixEnd = reader.pos();
+    if (m_minerTxVersion == 2 && reader.byte() != RCT_TYPE_NULL) {
+        throw std::invalid_argument("La coinbase v2 debe tener RingCT nulo");
+    }
+    m_minerTxEnd = reader.pos();
+
+    const uint64_t txCount = reader.varint();
+    if (txCount > reader.remaining() / 32) throw std::invalid_argument("Plantilla de bloque truncada");
+    m_txHashes.resize(txCount + 1);
+    for (uint64_t i = 1; i <= txCount; ++i) {
+        std::memcpy(m_txHashes[i].data(), m_blob.data() + reader.pos(), 32);
+        reader.skip(32);
+    }
+    if (!reader.atEnd()) throw std::invalid_argument("Bytes sobrantes al final de la plantilla");
+
+    if (m_reservedSize > 0 &&
+        (m_reservedOffset < extraOffset || m_reservedOffset + m_reservedSize > extraOffset + extraSize)) {
+        throw std::invalid_argument("La zona reservada no está dentro del extra de la coinbase");
+    }
+
+    hashMinerTx();
+}
+
+uint32_t BlockTemplate::nonce() const {
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) value |= static_cast<uint32_t>(m_blob[m_nonceOffset + i]) << (8 * i);
+    return value;
+}
+
+void BlockTemplate::setExtraNonce(std::span<const uint8_t> bytes, size_t offset) {
+    if (offset > m_reservedSize || bytes.size() > m_reservedSize - offset) {
+        throw std::invalid_argument("El extra nonce no cabe en la zona reservada");
+    }
+    std::copy(bytes.begin(), bytes.end(), m_blob.begin() + static_cast<ptrdiff_t>(m_reservedOffset + offset));
+    hashMinerTx();
+}
+
+void BlockTemplate::hashMinerTx() {
+    const uint8_t* tx = m_blob.data() + m_minerTxOffset;
+    if (m_minerTxVersion == 1) {
+        m_txHashes[0] = zartrux::keccak::hash256(tx, m_minerTxEnd - m_minerTxOffset);
+        return;
+    }
+
+    // v2: hash(prefijo) || hash(base RingCT) || hash(parte podable), que es cero con RingCT nulo
+    uint8_t parts[96] = {};
+    const auto prefix = zartrux::keccak::hash256(tx, m_minerTxPrefixEnd - m_minerTxOffset);
+    const auto base = zartrux::keccak::hash256(m_blob.data() + m_minerTxPrefixEnd, m_minerTxEnd - m_minerTxPrefixEnd);
+    std::memcpy(parts, prefix.data(), 32);
+    std::memcpy(parts + 32, base.data(), 32);
+    m_txHashes[0] = zartrux::keccak::hash256(parts, sizeof(parts));
+}
+
+std::vector<uint8_t> BlockTemplate::hashingBlob() const {
+    std::vector<uint8_t> out;
+    out.reserve(m_minerTxOffset + 32 + 10);
+    out.insert(out.end(), m_blob.begin(), m_blob.begin() + static_cast<ptrdiff_t>(m_minerTxOffset));
+    const auto root = treeHash(m_txHashes);
+    out.insert(out.end(), root.begin(), root.end());
+    appendVarint(out, m_txHashes.size());
+    return out;
+}
+
+std::vector<uint8_t> BlockTemplate::blockBlob(uint32_t nonce) const {
+    std::vector<uint8_t> out = m_blob;
+    for (size_t i = 0; i < 4; ++i) out[m_nonceOffset + i] = static_cast<uint8_t>(nonce >> (8 * i));
+    return out;
+}
+
+BlockTemplate::hash_t BlockTemplate::blockId(uint32_t nonce) const {
+    auto blob = hashingBlob();
+    for (size_t i = 0; i < 4; ++i) blob[m_nonceOffset + i] = static_cast<uint8_t>(nonce >> (8 * i));
+    std::vector<uint8_t> data;
+    data.reserve(blob.size() + 10);
+    appendVarint(data, blob.size());
+    data.insert(data.end(), blob.begin(), blob.end());
+    return zartrux::keccak::hash256(data.data(), data.size());
+}
+
+BlockTemplate::hash_t BlockTemplate::treeHash(const std::vector<hash_t>& hashes) {
+    if (hashes.empty()) throw std::invalid_argument("Árbol de Merkle sin hojas");
+    if (hashes.size() == 1) return hashes[0];
+    if (hashes.size() == 2) return hashPair(hashes[0], hashes[1]);
+
+    // Se reduce a la mayor potencia de dos menor que el total emparejando las últimas hojas
+    const size_t count = hashes.size();
+    size_t width = 1;
+    while (width * 2 < count) width *= 2;
+
+    std::vector<hash_t> level(hashes.begin(), hashes.begin() + static_cast<ptrdiff_t>(2 * width - count));
+    level.resize(width);
+    for (size_t i = 2 * width - count, j = i; j < width; i += 2, ++j) {
+        level[j] = hashPair(hashes[i], hashes[i + 1]);
+    }
+    while (width > 2) {
+        width /= 2;
+        for (size_t j = 0; j < width; ++j) level[j] = hashPair(level[2 * j], level[2 * j + 1]);
+    }
+    return hashPair(level[0], level[1]);
+}
+
+} // namespace zartrux::network
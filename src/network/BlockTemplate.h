@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "utils/Keccak.h"
+
+namespace zartrux::network {
+
+/**
+ * @class BlockTemplate
+ * @brief Plantilla de bloque de Monero tal cual la devuelve `get_block_template`.
+ *
+ * Recorre el blob (cabecera, transacción coinbase y hashes de las demás transacciones) para
+ * poder escribir un extra nonce propio en la zona reservada de la coinbase y rehacer aquí el
+ * blob de hashing (cabecera + raíz de Merkle + nº de transacciones), sin volver a pedir la
+ * plantilla al nodo. El nonce ocupa la misma posición en los dos blobs.
+ */
+class BlockTemplate {
+public:
+    using hash_t = zartrux::keccak::hash_t;
+
+    /**
+     * @param blob           blocktemplate_blob decodificado
+     * @param reservedOffset reserved_offset de la respuesta (dentro de blob)
+     * @param reservedSize   reserve_size pedido
+     * @throws std::invalid_argument si el blob no se puede recorrer o la zona reservada no cae
+     *         dentro del campo extra de la coinbase
+     */
+    BlockTemplate(std::vector<uint8_t> blob, size_t reservedOffset, size_t reservedSize);
+
+    size_t nonceOffset() const { return m_nonceOffset; }
+    uint32_t nonce() const;
+    size_t reservedSize() const { return m_reservedSize; }
+    std::span<const uint8_t> prevId() const { return {m_blob.data() + m_nonceOffset - 32, 32}; }
+    size_t transactionCount() const { return m_txHashes.size(); }
+
+    /// Escribe `bytes` en la zona reservada a partir de `offset` y recalcula el hash de la coinbase.
+    void setExtraNonce(std::span<const uint8_t> bytes, size_t offset = 0);
+
+    std::vector<uint8_t> hashingBlob() const;
+    /// Bloque completo con el nonce encontrado, listo para `submit_block`.
+    std::vector<uint8_t> blockBlob(uint32_t nonce) const;
+    /// Id del bloque (hash de longitud + blob de hashing) con ese nonce.
+    hash_t blockId(uint32_t nonce) const;
+
+    /// Raíz de Merkle de Monero (tree_hash) sobre los hashes de las transacciones.
+    static hash_t treeHash(const std::vector<hash_t>& hashes);
+
+private:
+    void hashMinerTx();
+
+    std::vector<uint8_t> m_blob;
+    size_t m_nonceOffset = 0;
+    size_t m_minerTxOffset = 0;
+    size_t m_minerTxPrefixEnd = 0;      // fin del prefijo (tras el campo extra)
+    size_t m_minerTxEnd = 0;
+    uint64_t m_minerTxVersion = 0;
+    size_t m_reservedOffset = 0;
+    size_t m_reservedSize = 0;
+    std::vector<hash_t> m_txHashes;     // [0] = coinbase
+};
+
+} // namespace zartrux::network
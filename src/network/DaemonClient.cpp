@@ -0,0 +1,513 @@
+#include "DaemonClient.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <boost/asio.hpp>
+#include <fmt/format.h>
+
+#include "utils/Hex.h"
+#include "utils/Logger.h"
+
+namespace zartrux::network {
+
+using json = nlohmann::json;
+namespace asio = boost::asio;
+
+namespace {
+
+constexpr size_t NONCE_OFFSET = 39;    // posición del nonce en los workers (NonceAllocator)
+constexpr const char* ZMQ_TOPIC = "json-minimal-chain_main";
+constexpr auto MAX_ERROR_BACKOFF = std::chrono::milliseconds(30000);
+constexpr auto STATS_LOG_INTERVAL = std::chrono::seconds(60);
+constexpr int SUBMIT_ATTEMPTS = 4;      // un bloque no se pierde por un corte breve con el nodo
+constexpr auto SUBMIT_RETRY_DELAY = std::chrono::milliseconds(500);
+
+double elapsedMs(DaemonClient::Clock::time_point from, DaemonClient::Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+int64_t steadyNs(DaemonClient::Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+} // namespace
+
+/**
+ * Suscriptor ZMQ mínimo (ZMTP 3.0, mecanismo NULL) para las notificaciones de cadena de
+ * monerod; basta con saber que ha llegado un mensaje del tema, así que no se decodifica el JSON
+ * ni se enlaza libzmq. Va en su propio io_context y reconecta con espera creciente.
+ */
+class DaemonClient::ZmqSubscriber {
+public:
+    ZmqSubscriber(std::string endpoint, std::function<void()> onNotify)
+        : m_endpoint(std::move(endpoint))
+        , m_onNotify(std::move(onNotify))
+        , m_socket(m_io)
+        , m_resolver(m_io)
+        , m_retryTimer(m_io) {
+        const std::string prefix = "tcp://";
+        const auto colon = m_endpoint.rfind(':');
+        if (m_endpoint.rfind(prefix, 0) != 0 || colon == std::string::npos || colon < prefix.size()) {
+            throw std::invalid_argument("Endpoint ZMQ no válido (tcp://host:puerto): " + m_endpoint);
+        }
+        m_host = m_endpoint.substr(prefix.size(), colon - prefix.size());
+        m_port = m_endpoint.substr(colon + 1);
+    }
+
+    ~ZmqSubscriber() { stop(); }
+
+    void start() {
+        connect();
+        m_thread = std::thread([this] { m_io.run(); });
+    }
+
+    void stop() {
+        m_io.stop();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    bool connected() const { return m_connected.load(std::memory_order_relaxed); }
+
+private:
+    void connect() {
+        m_resolver.async_resolve(m_host, m_port, [this](const boost::system::error_code& ec,
+                                                        const asio::ip::tcp::resolver::results_type& results) {
+            if (ec) return retry("resolución: " + ec.message());
+            asio::async_connect(m_socket, results, [this](const boost::system::error_code& ec, const auto&) {
+                if (ec) return retry("conexión: " + ec.message());
+                handshake();
+            });
+        });
+    }
+
+    void handshake() {
+        // Saludo (64 bytes) + READY con Socket-Type=SUB + suscripción al tema, todo de una vez
+        m_out.assign(64, 0);
+        m_out[0] = 0xff;
+        m_out[9] = 0x7f;
+        m_out[10] = 3;      // ZMTP 3.0
+        std::copy_n("NULL", 4, m_out.begin() + 12);
+
+        const std::string ready = std::string("\x05READY", 6) + "\x0bSocket-Type" + std::string("\0\0\0\x03", 4) + "SUB";
+        m_out.push_back(0x04);
+        m_out.push_back(static_cast<uint8_t>(ready.size()));
+        m_out.insert(m_out.end(), ready.begin(), ready.end());
+
+        const std::string topic = ZMQ_TOPIC;
+        m_out.push_back(0x00);
+        m_out.push_back(static_cast<uint8_t>(topic.size() + 1));
+        m_out.push_back(0x01);
+        m_out.insert(m_out.end(), topic.begin(), topic.end());
+
+        asio::async_write(m_socket, asio::buffer(m_out), [this](const boost::system::error_code& ec, size_t) {
+            if (ec) return retry("envío del saludo: " + ec.message());
+            m_in.resize(64);
+            asio::async_read(m_socket, asio::buffer(m_in), [this](const boost::system::error_code& ec, size_t) {
+                if (ec) return retry("saludo: " + ec.message());
+                if (m_in[0] != 0xff || m_in[9] != 0x7f || m_in[10] < 3) return retry("el par no habla ZMTP 3");
+                m_connected = true;
+                m_backoff = std::chrono::seconds(1);
+                Logger::info("DaemonClient", "Suscrito a " + m_endpoint + " (" + ZMQ_TOPIC + ")");
+                readHeader();
+            });
+        });
+    }
+
+    void readHeader() {
+        m_in.resize(2);
+        asio::async_read(m_socket, asio::buffer(m_in), [this](const boost::system::error_code& ec, size_t) {
+            if (ec) return retry("lectura: " + ec.message());
+            const uint8_t flags = m_in[0];
+            if (!(flags & 0x02)) return readBody(flags, m_in[1]);
+
+            // Trama larga: tamaño de 8 bytes big-endian, del que ya se leyó el primero
+            const uint8_t first = m_in[1];
+            m_in.resize(7);
+            asio::async_read(m_socket, asio::buffer(m_in), [this, flags, first](const boost::system::error_code& ec, size_t) {
+                if (ec) return retry("lectura: " + ec.message());
+                uint64_t size = first;
+                for (uint8_t b : m_in) size = (size << 8) | b;
+                if (size > MAX_FRAME) return retry("trama demasiado grande");
+                readBody(flags, size);
+            });
+        });
+    }
+
+    void readBody(uint8_t flags, uint64_t size) {
+        m_in.resize(size);
+        asio::async_read(m_socket, asio::buffer(m_in), [this, flags](const boost::system::error_code& ec, size_t) {
+            if (ec) return retry("lectura: " + ec.message());
+            // Comandos (0x04) y tramas intermedias (0x01) se ignoran: cuenta el mensaje completo
+            if (!(flags & 0x05) && m_onNotify) m_onNotify();
+            readHeader();
+        });
+    }
+
+    void retry(const std::string& reason) {
+        if (m_connected.exchange(false) || !m_warned) {
+            Logger::warn("DaemonClient", "ZMQ " + m_endpoint + " sin conexión (" + reason + "), se sigue sondeando");
+            m_warned = true;
+        }
+        boost::system::error_code ignored;
+        m_socket.close(ignored);
+        m_retryTimer.expires_after(m_backoff);
+        m_retryTimer.async_wait([this](const boost::system::error_code& ec) {
+            if (!ec) connect();
+        });
+        m_backoff = std::min<std::chrono::milliseconds>(m_backoff * 2, MAX_ERROR_BACKOFF);
+    }
+
+    static constexpr uint64_t MAX_FRAME = 16 * 1024 * 1024;
+
+    const std::string m_endpoint;
+    std::string m_host;
+    std::string m_port;
+    std::function<void()> m_onNotify;
+    asio::io_context m_io;
+    asio::ip::tcp::socket m_socket;
+    asio::ip::tcp::resolver m_resolver;
+    asio::steady_timer m_retryTimer;
+    std::thread m_thread;
+    std::vector<uint8_t> m_out;
+    std::vector<uint8_t> m_in;
+    std::chrono::milliseconds m_backoff{1000};
+    std::atomic<bool> m_connected{false};
+    bool m_warned = false;
+};
+
+DaemonClient::DaemonClient(JobManager& jobManager, Options options)
+    : m_jobManager(jobManager)
+    , m_options(std::move(options)) {
+    if (m_options.wallet.empty()) {
+        throw std::invalid_argument("La minería en solitario necesita una dirección de cartera");
+    }
+}
+
+DaemonClient::~DaemonClient() {
+    stop();
+}
+
+void DaemonClient::start() {
+    if (m_running.exchange(true)) return;
+
+    m_instanceId = m_options.instanceId;
+    if (m_instanceId == 0) {
+        std::random_device rd;
+        m_instanceId = static_cast<uint32_t>(rd()) | 1u;
+    }
+    Logger::info("DaemonClient", fmt::format("Minería en solitario contra {} (instancia {:08x}, {})",
+                                             m_options.url, m_instanceId,
+                                             !m_options.zmqEndpoint.empty()
+                                                 ? "ZMQ " + m_options.zmqEndpoint
+                                                 : fmt::format("sondeo cada {} ms", m_options.pollInterval.count())));
+    if (!m_options.zmqEndpoint.empty()) {
+        m_zmq = std::make_unique<ZmqSubscriber>(m_options.zmqEndpoint, [this] { onZmqNotification(); });
+        m_zmq->start();
+    }
+    m_ioThread = std::thread(&DaemonClient::ioLoop, this);
+}
+
+void DaemonClient::stop() {
+    if (!m_running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        m_ioCv.notify_one();
+    }
+    if (m_ioThread.joinable()) m_ioThread.join();
+    if (m_zmq) m_zmq->stop();
+    logStats();
+}
+
+void DaemonClient::submit(const std::string& jobId, uint64_t nonce) {
+    m_blocksFound.fetch_add(1, std::memory_order_relaxed);
+    if (nonce > UINT32_MAX) {
+        m_blocksRejected.fetch_add(1, std::memory_order_relaxed);
+        Logger::error("DaemonClient", fmt::format("Nonce {:016x} del trabajo {} no cabe en los 4 bytes de la cabecera "
+                                                  "(¿nonce_size = 8 en minería en solitario?)", nonce, jobId));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    m_solutions.push_back({jobId, static_cast<uint32_t>(nonce)});
+    m_ioCv.notify_one();
+}
+
+void DaemonClient::onZmqNotification() {
+    m_zmqNotifications.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    if (!m_zmqNotifiedAt) m_zmqNotifiedAt = Clock::now();
+    m_ioCv.notify_one();
+}
+
+void DaemonClient::ioLoop() {
+    m_session = std::make_unique<cpr::Session>();
+    m_session->SetHeader({{"Content-Type", "application/json"}, {"Connection", "keep-alive"}});
+    m_session->SetTimeout(cpr::Timeout{m_options.timeout});
+    if (!m_options.user.empty()) {
+        m_session->SetAuth(cpr::Authentication{m_options.user, m_options.pass, cpr::AuthMode::DIGEST});
+    }
+
+    m_startedAt = Clock::now();
+    m_nextPoll = m_startedAt;
+    m_nextStatsLog = m_startedAt + STATS_LOG_INTERVAL;
+    refreshTemplate("inicio", std::nullopt);
+
+    while (m_running) {
+        std::deque<Solution> solutions;
+        std::optional<Clock::time_point> notifiedAt;
+        {
+            std::unique_lock<std::mutex> lock(m_ioMutex);
+            const auto wakeAt = std::min({m_nextPoll, m_nextRefresh, m_nextStatsLog});
+            m_ioCv.wait_until(lock, wakeAt, [this] {
+                return !m_running || !m_solutions.empty() || m_zmqNotifiedAt.has_value();
+            });
+            solutions.swap(m_solutions);
+            std::swap(notifiedAt, m_zmqNotifiedAt);
+        }
+        if (!m_running) break;
+
+        // Un bloque encontrado va antes que cualquier otra cosa
+        for (const auto& solution : solutions) submitSolution(solution);
+
+        auto now = Clock::now();
+        if (notifiedAt) {
+            refreshTemplate("notificación ZMQ", notifiedAt);
+        } else if (now >= m_nextPoll) {
+            pollTip(now);
+        }
+
+        now = Clock::now();
+        if (now >= m_nextRefresh) refreshTemplate("renovación periódica", std::nullopt);
+        if (now >= m_nextStatsLog) {
+            logStats();
+            m_nextStatsLog = now + STATS_LOG_INTERVAL;
+        }
+    }
+    m_session.reset();
+}
+
+void DaemonClient::pollTip(Clock::time_point now) {
+    const bool zmqUp = m_zmq && m_zmq->connected();
+    m_nextPoll = now + (zmqUp ? m_options.zmqPollInterval : m_options.pollInterval);
+
+    auto response = request("/get_height", nullptr);
+    if (!response.error.empty()) return;
+
+    // monerod devuelve la altura de la cadena y el hash de la punta, que es el prev_hash de la
+    // plantilla siguiente; sin hash se compara la altura (la de la plantilla es la de la cadena)
+    const std::string hash = response.result.value("hash", std::string());
+    const auto height = response.result.value("height", uint64_t{0});
+    const bool changed = !hash.empty() ? hash != m_tipHash
+                                       : height != m_height.load(std::memory_order_relaxed);
+    if (changed && !m_tipHash.empty()) refreshTemplate("bloque nuevo", now);
+}
+
+bool DaemonClient::refreshTemplate(const char* reason, std::optional<Clock::time_point> detectedAt) {
+    const auto requestedAt = Clock::now();
+    auto response = call("get_block_template", {{"wallet_address", m_options.wallet},
+                                                {"reserve_size", EXTRA_NONCE_SIZE}});
+    if (response.error.empty()) m_rpcLatency.record(response.latencyMs);
+
+    auto fail = [&](const std::string& what) {
+        if (response.error.empty()) m_rpcErrors.fetch_add(1, std::memory_order_relaxed);
+        m_errorBackoff = std::clamp(m_errorBackoff * 2, std::chrono::milliseconds(1000), MAX_ERROR_BACKOFF);
+        m_nextRefresh = Clock::now() + m_errorBackoff;
+        Logger::warn("DaemonClient", fmt::format("Plantilla no disponible ({}): {}; reintento en {} ms",
+                                                 reason, what, m_errorBackoff.count()));
+        return false;
+    };
+    if (!response.error.empty()) return fail(response.error);
+
+    const json& result = response.result;
+    std::optional<Template> fresh;
+    std::string seedHash;
+    std::string nextSeedHash;
+    try {
+        const auto blobHex = result.at("blocktemplate_blob").get<std::string>();
+        std::vector<uint8_t> blob(blobHex.size() / 2);
+        if (!zartrux::hex::decode(blobHex, blob.data())) return fail("blocktemplate_blob no es hex");
+
+        BlockTemplate block(std::move(blob), result.at("reserved_offset").get<size_t>(), EXTRA_NONCE_SIZE);
+        if (block.nonceOffset() != NONCE_OFFSET) {
+            return fail(fmt::format("nonce en el byte {} (los workers lo escriben en el {})",
+                                    block.nonceOffset(), NONCE_OFFSET));
+        }
+
+        // Extra nonce propio: instancia + contador, distinto en cada plantilla publicada
+        const uint32_t counter = ++m_templateCounter;
+        std::array<uint8_t, EXTRA_NONCE_SIZE> extraNonce{};
+        for (size_t i = 0; i < 4; ++i) {
+            extraNonce[i] = static_cast<uint8_t>(m_instanceId >> (8 * i));
+            extraNonce[4 + i] = static_cast<uint8_t>(counter >> (8 * i));
+        }
+        block.setExtraNonce(extraNonce);
+
+        const auto height = result.at("height").get<uint32_t>();
+        fresh.emplace(Template{fmt::format("solo-{}-{}", height, counter), std::move(block), height,
+                               result.at("difficulty").get<uint64_t>(), result.at("prev_hash").get<std::string>()});
+        seedHash = result.value("seed_hash", std::string());
+        nextSeedHash = result.value("next_seed_hash", std::string());
+    } catch (const std::exception& e) {
+        return fail(std::string("respuesta no válida: ") + e.what());
+    }
+    m_errorBackoff = std::chrono::milliseconds(0);
+
+    const bool newTip = fresh->prevHash != m_tipHash;
+    const bool firstTemplate = m_tipHash.empty();
+    m_tipHash = fresh->prevHash;
+
+    if (!seedHash.empty()) m_jobManager.setSeedHash(seedHash, nextSeedHash);
+    m_jobManager.setJob(fresh->block.hashingBlob(), fresh->jobId,
+                        NonceValidator::ShareTarget::fromDifficulty(fresh->difficulty), fresh->height);
+    const auto publishedAt = Clock::now();
+
+    m_templatesPublished.fetch_add(1, std::memory_order_relaxed);
+    m_height.store(fresh->height, std::memory_order_relaxed);
+    m_difficulty.store(fresh->difficulty, std::memory_order_relaxed);
+    int64_t expected = 0;
+    m_miningSinceNs.compare_exchange_strong(expected, steadyNs(publishedAt), std::memory_order_relaxed);
+    m_nextRefresh = publishedAt + m_options.templateRefresh;
+
+    if (newTip && !firstTemplate) {
+        // Desde que se supo del bloque hasta aquí, los workers minaban sobre un padre viejo
+        const double lagMs = elapsedMs(detectedAt.value_or(requestedAt), publishedAt);
+        m_newBlocks.fetch_add(1, std::memory_order_relaxed);
+        m_refreshLatency.record(lagMs);
+        m_staleMs.store(m_staleMs.load(std::memory_order_relaxed) + lagMs, std::memory_order_relaxed);
+        Logger::info("DaemonClient", fmt::format("Bloque nuevo en altura {} ({}): trabajo {} publicado en {:.1f} ms, "
+                                                 "dificultad {}, {} transacciones",
+                                                 fresh->height, reason, fresh->jobId, lagMs,
+                                                 fresh->difficulty, fresh->block.transactionCount()));
+    } else if (firstTemplate) {
+        Logger::info("DaemonClient", fmt::format("Plantilla de altura {}: dificultad {}, {} transacciones",
+                                                 fresh->height, fresh->difficulty, fresh->block.transactionCount()));
+    }
+
+    m_templates.push_back(std::move(*fresh));
+    while (m_templates.size() > MAX_TEMPLATES) m_templates.pop_front();
+    return true;
+}
+
+void DaemonClient::submitSolution(const Solution& solution) {
+    const auto it = std::find_if(m_templates.begin(), m_templates.end(),
+                                 [&](const Template& t) { return t.jobId == solution.jobId; });
+    if (it == m_templates.end()) {
+        m_staleSolutions.fetch_add(1, std::memory_order_relaxed);
+        Logger::warn("DaemonClient", "Solución para un trabajo desconocido o ya descartado: " + solution.jobId);
+        return;
+    }
+    if (it->prevHash != m_tipHash) {
+        // Otro bloque ganó la carrera: el nuestro sería huérfano
+        m_staleSolutions.fetch_add(1, std::memory_order_relaxed);
+        Logger::warn("DaemonClient", fmt::format("Solución obsoleta en altura {} (la cadena ya avanzó)", it->height));
+        return;
+    }
+
+    const auto blob = it->block.blockBlob(solution.nonce);
+    const auto id = it->block.blockId(solution.nonce);
+    const auto blockHash = zartrux::hex::encode(id.data(), id.size());
+    const json params = json::array({zartrux::hex::encode(blob.data(), blob.size())});
+    auto response = call("submit_block", params);
+    for (int attempt = 1; response.unreachable && attempt < SUBMIT_ATTEMPTS && m_running; ++attempt) {
+        Logger::warn("DaemonClient", fmt::format("Nodo inaccesible al enviar el bloque {} ({}); reintento {}/{}",
+                                                 blockHash, response.error, attempt, SUBMIT_ATTEMPTS - 1));
+        std::unique_lock<std::mutex> lock(m_ioMutex);
+        m_ioCv.wait_for(lock, SUBMIT_RETRY_DELAY, [this] { return !m_running; });
+        lock.unlock();
+        response = call("submit_block", params);
+    }
+    if (!response.error.empty()) {
+        m_blocksRejected.fetch_add(1, std::memory_order_relaxed);
+        Logger::error("DaemonClient", fmt::format("Bloque {} en altura {} rechazado: {}",
+                                                  blockHash, it->height, response.error));
+        return;
+    }
+
+    m_blocksAccepted.fetch_add(1, std::memory_order_relaxed);
+    Logger::info("DaemonClient", fmt::format("¡Bloque {} aceptado en altura {}! (nonce {:08x}, {:.1f} ms)",
+                                             blockHash, it->height, solution.nonce, response.latencyMs));
+    // La punta es ahora nuestro bloque: no hay que esperar a la notificación
+    refreshTemplate("bloque propio", Clock::now());
+}
+
+DaemonClient::RpcResult DaemonClient::call(const std::string& method, const json& params) {
+    const std::string body = json{{"jsonrpc", "2.0"}, {"id", "0"}, {"method", method}, {"params", params}}.dump();
+    auto response = request("/json_rpc", &body);
+    if (!response.error.empty()) return response;
+
+    if (response.result.contains("error") && !response.result["error"].is_null()) {
+        const auto& error = response.result["error"];
+        response.error = error.is_object() ? error.value("message", error.dump()) : error.dump();
+        m_rpcErrors.fetch_add(1, std::memory_order_relaxed);
+        return response;
+    }
+    if (!response.result.contains("result")) {
+        response.error = method + ": respuesta sin resultado";
+        m_rpcErrors.fetch_add(1, std::memory_order_relaxed);
+        return response;
+    }
+    response.result = std::move(response.result["result"]);
+    return response;
+}
+
+DaemonClient::RpcResult DaemonClient::request(const std::string& path, const std::string* body) {
+    RpcResult out;
+    const auto sentAt = Clock::now();
+    m_session->SetUrl(cpr::Url{m_options.url + path});
+    m_session->SetBody(cpr::Body{body ? *body : std::string("{}")});
+    const cpr::Response response = m_session->Post();
+    out.latencyMs = elapsedMs(sentAt, Clock::now());
+
+    if (response.error.code != cpr::ErrorCode::OK) {
+        out.error = path + ": " + response.error.message;
+        out.unreachable = true;
+    } else if (response.status_code != 200) {
+        out.error = fmt::format("{}: HTTP {}", path, response.status_code);
+    } else {
+        try {
+            out.result = json::parse(response.text);
+        } catch (const json::parse_error& e) {
+            out.error = path + ": JSON no válido (" + e.what() + ")";
+        }
+    }
+    if (!out.error.empty()) m_rpcErrors.fetch_add(1, std::memory_order_relaxed);
+    return out;
+}
+
+DaemonClient::Stats DaemonClient::getStats() const {
+    Stats stats;
+    stats.templates = m_templatesPublished.load(std::memory_order_relaxed);
+    stats.newBlocks = m_newBlocks.load(std::memory_order_relaxed);
+    stats.zmqNotifications = m_zmqNotifications.load(std::memory_order_relaxed);
+    stats.blocksFound = m_blocksFound.load(std::memory_order_relaxed);
+    stats.blocksAccepted = m_blocksAccepted.load(std::memory_order_relaxed);
+    stats.blocksRejected = m_blocksRejected.load(std::memory_order_relaxed);
+    stats.staleSolutions = m_staleSolutions.load(std::memory_order_relaxed);
+    stats.rpcErrors = m_rpcErrors.load(std::memory_order_relaxed);
+    stats.height = m_height.load(std::memory_order_relaxed);
+    stats.difficulty = m_difficulty.load(std::memory_order_relaxed);
+    stats.zmqConnected = m_zmq && m_zmq->connected();
+    stats.staleMs = m_staleMs.load(std::memory_order_relaxed);
+
+    const int64_t since = m_miningSinceNs.load(std::memory_order_relaxed);
+    const double miningMs = since ? (steadyNs(Clock::now()) - since) / 1e6 : 0.0;
+    stats.staleFraction = miningMs > 0.0 ? stats.staleMs / miningMs : 0.0;
+    stats.refresh = m_refreshLatency.snapshot();
+    stats.rpc = m_rpcLatency.snapshot();
+    return stats;
+}
+
+void DaemonClient::logStats() {
+    const auto s = getStats();
+    Logger::info("DaemonClient", fmt::format(
+        "Solo: altura {}, {} plantillas, {} bloques nuevos ({} avisos ZMQ{}), refresco p50 {:.1f} ms / p99 {:.1f} ms, "
+        "trabajo desperdiciado {:.3f}%, bloques {} encontrados / {} aceptados / {} rechazados / {} obsoletos, "
+        "RPC p50 {:.1f} ms, {} errores",
+        s.height, s.templates, s.newBlocks, s.zmqNotifications, m_zmq ? (s.zmqConnected ? ", conectado" : ", caído") : "",
+        s.refresh.p50Ms, s.refresh.p99Ms, s.staleFraction * 100.0, s.blocksFound, s.blocksAccepted,
+        s.blocksRejected, s.staleSolutions, s.rpc.p50Ms, s.rpcErrors));
+}
+
+} // namespace zartrux::network
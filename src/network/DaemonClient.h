@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cpr/cpr.h>
+#include <nlohmann/json.hpp>
+
+#include "core/JobManager.h"
+#include "network/BlockTemplate.h"
+#include "utils/LatencyHistogram.h"
+
+namespace zartrux::network {
+
+/**
+ * @class DaemonClient
+ * @brief Minería en solitario contra el RPC de un nodo compatible con monerod.
+ *
+ * Pide plantillas con `get_block_template`, escribe en la zona reservada de la coinbase un
+ * extra nonce propio [instancia (4 bytes) | nº de plantilla (4 bytes)], rehace el blob de
+ * hashing y lo publica en JobManager con el objetivo de bloque. Los hilos se reparten el nonce
+ * de 32 bits con NonceAllocator; la instancia separa a varios equipos que minan contra el
+ * mismo nodo y la misma cartera, que recibirían plantillas idénticas.
+ *
+ * Un bloque nuevo se detecta por la notificación ZMQ de monerod (`--zmq-pub`,
+ * json-minimal-chain_main) si se configura, y si no sondeando `/get_height` (sólo altura y hash,
+ * respuesta mínima). Además la plantilla se renueva cada `templateRefresh` para recoger las
+ * transacciones nuevas del mempool.
+ *
+ * Todo el RPC va en un hilo de E/S propio; submit() sólo encola y lo pueden llamar los workers.
+ */
+class DaemonClient {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t EXTRA_NONCE_SIZE = 8;
+    static constexpr size_t MAX_TEMPLATES = 8;      // plantillas recientes que aún admiten soluciones
+
+    struct Options {
+        std::string url = "http://127.0.0.1:18081";     // RPC del nodo, sin /json_rpc
+        std::string wallet;
+        std::string user;                               // --rpc-login (digest)
+        std::string pass;
+        std::string zmqEndpoint;                        // "tcp://127.0.0.1:18083"; vacío = sólo sondeo
+        std::chrono::milliseconds pollInterval{500};
+        std::chrono::milliseconds zmqPollInterval{10000};   // sondeo de respaldo con ZMQ conectado
+        std::chrono::seconds templateRefresh{30};
+        std::chrono::milliseconds timeout{5000};
+        uint32_t instanceId = 0;                        // 0 = aleatoria al arrancar
+    };
+
+    struct Stats {
+        uint64_t templates{0};
+        uint64_t newBlocks{0};          // cambios de punta detectados
+        uint64_t zmqNotifications{0};
+        uint64_t blocksFound{0};
+        uint64_t blocksAccepted{0};
+        uint64_t blocksRejected{0};
+        uint64_t staleSolutions{0};     // soluciones de una plantilla ya superada por otro bloque
+        uint64_t rpcErrors{0};
+        uint32_t height{0};
+        uint64_t difficulty{0};
+        bool zmqConnected{false};
+        // Trabajo desperdiciado: tiempo minando una plantilla cuyo bloque anterior ya no es la
+        // punta, desde que se detecta el bloque nuevo hasta publicar la plantilla siguiente
+        double staleMs{0.0};
+        double staleFraction{0.0};      // staleMs / tiempo minando
+        zartrux::LatencyHistogram::Snapshot refresh;    // bloque nuevo detectado -> trabajo publicado
+        zartrux::LatencyHistogram::Snapshot rpc;        // ida y vuelta de get_block_template
+    };
+
+    DaemonClient(JobManager& jobManager, Options options);
+    ~DaemonClient();
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    void start();
+    void stop();
+
+    // Solución para un trabajo publicado por este cliente; se envía desde el hilo de E/S.
+    // El nonce de Monero ocupa 4 bytes: uno mayor (layout de 8 bytes) se descarta.
+    void submit(const std::string& jobId, uint64_t nonce);
+
+    Stats getStats() const;
+
+private:
+    class ZmqSubscriber;
+
+    struct Template {
+        std::string jobId;
+        BlockTemplate block;
+        uint32_t height;
+        uint64_t difficulty;
+        std::string prevHash;
+    };
+
+    struct Solution {
+        std::string jobId;
+        uint32_t nonce;
+    };
+
+    struct RpcResult {
+        nlohmann::json result;
+        std::string error;      // vacío si hubo respuesta sin error
+        bool unreachable{false};    // sin respuesta HTTP (conexión rechazada, timeout...)
+        double latencyMs{0.0};
+    };
+
+    void ioLoop();
+    void pollTip(Clock::time_point now);
+    bool refreshTemplate(const char* reason, std::optional<Clock::time_point> detectedAt);
+    void submitSolution(const Solution& solution);
+    void onZmqNotification();
+    void logStats();
+
+    RpcResult call(const std::string& method, const nlohmann::json& params);
+    RpcResult request(const std::string& path, const std::string* body);
+
+    JobManager& m_jobManager;
+    const Options m_options;
+    uint32_t m_instanceId = 0;
+
+    std::thread m_ioThread;
+    std::atomic<bool> m_running{false};
+    std::mutex m_ioMutex;           // cola de soluciones y avisos de ZMQ
+    std::condition_variable m_ioCv;
+    std::deque<Solution> m_solutions;
+    std::optional<Clock::time_point> m_zmqNotifiedAt;
+    std::unique_ptr<ZmqSubscriber> m_zmq;
+
+    // Sólo los toca el hilo de E/S
+    std::unique_ptr<cpr::Session> m_session;
+    std::deque<Template> m_templates;           // la última es la que se está minando
+    std::string m_tipHash;                      // prev_hash de la plantilla actual
+    uint32_t m_templateCounter = 0;
+    Clock::time_point m_nextPoll;
+    Clock::time_point m_nextRefresh;
+    Clock::time_point m_nextStatsLog;
+    Clock::time_point m_startedAt;
+    std::chrono::milliseconds m_errorBackoff{0};
+
+    zartrux::LatencyHistogram m_refreshLatency{std::chrono::hours(24)};
+    zartrux::LatencyHistogram m_rpcLatency;
+    std::atomic<uint64_t> m_templatesPublished{0};
+    std::atomic<uint64_t> m_newBlocks{0};
+    std::atomic<uint64_t> m_zmqNotifications{0};
+    std::atomic<uint64_t> m_blocksFound{0};
+    std::atomic<uint64_t> m_blocksAccepted{0};
+    std::atomic<uint64_t> m_blocksRejected{0};
+    std::atomic<uint64_t> m_staleSolutions{0};
+    std::atomic<uint64_t> m_rpcErrors{0};
+    std::atomic<uint32_t> m_height{0};
+    std::atomic<uint64_t> m_difficulty{0};
+    std::atomic<double> m_staleMs{0.0};
+    std::atomic<int64_t> m_miningSinceNs{0};    // primer trabajo publicado (0 = aún ninguno)
+};
+
+} // namespace zartrux::network
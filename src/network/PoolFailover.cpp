@@ -1,88 +1,285 @@
 #include "PoolFailover.h"
 #include "StratumClient.h"
 #include "utils/Logger.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <utility>
 
-PoolFailover::PoolFailover(asio::io_context& io_context, 
+namespace {
+
+constexpr int MAX_RETRIES = 5;
+constexpr int MAX_MISSED_PROBES = 3;
+
+// Penalizaciones de la clasificación, en ms equivalentes de latencia
+constexpr double UNKNOWN_RTT_MS = 250.0;        // pool sin medir: detrás de cualquier pool razonable medida
+constexpr double FAILURE_PENALTY_MS = 1000.0;   // por cada fallo seguido
+constexpr double LAGGING_PENALTY_MS = 5000.0;   // trabajo de una altura anterior o sin trabajos recientes
+constexpr auto STALE_FEED = std::chrono::minutes(3);
+
+double toMs(PoolFailover::Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // namespace
+
+PoolFailover::PoolFailover(asio::io_context& io_context,
                           std::vector<PoolInfo> pools)
-    : m_io_context(io_context), 
-      m_pools(std::move(pools)), 
-      m_retryTimer(io_context) {}
+    : m_io_context(io_context),
+      m_pools(std::move(pools)),
+      m_state(m_pools.size()),
+      m_retryTimer(io_context),
+      m_resolver(io_context),
+      m_probeTimer(io_context),
+      m_standbyTimer(io_context),
+      m_lost(std::chrono::hours(24)) {}
 
 PoolFailover::~PoolFailover() {
     stop();
 }
 
+void PoolFailover::setHotStandby(const StandbyConfig& config) {
+    m_standbyConfig = config;
+}
+
 void PoolFailover::start() {
     if (m_pools.empty()) {
         Logger::error("PoolFailover", "No pools configured");
         return;
     }
-    
+
     m_active = true;
-    tryNextPool();
+    if (m_standbyConfig.enabled) {
+        for (size_t i = 0; i < m_pools.size(); ++i) {
+            resolvePool(i);
+        }
+        armProbeTimer();
+    }
+    // Sin medidas todas puntúan igual y se respeta el orden de la lista
+    connectPrimary(*bestPool(std::nullopt));
 }
 
 void PoolFailover::stop() {
     m_active = false;
     m_retryTimer.cancel();
-    if (m_client) {
-        m_client->disconnect();
+    m_probeTimer.cancel();
+    m_standbyTimer.cancel();
+    m_resolver.cancel();
+
+    std::shared_ptr<StratumClient> client;
+    std::shared_ptr<StratumClient> standby;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        client = m_client;
+        standby = std::move(m_standby);
+    }
+    if (client) {
+        client->disconnect();
+    }
+    if (standby) {
+        standby->disconnect();
     }
 }
 
-void PoolFailover::submit(const std::string& job_id, 
-                        const std::string& nonce_hex, 
+void PoolFailover::submit(const std::string& job_id,
+                        const std::string& nonce_hex,
                         const std::string& result_hash) {
+    std::shared_ptr<StratumClient> client;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        client = m_client;
+    }
+    if (client) {
+        client->submit(job_id, nonce_hex, result_hash);
+    }
+}
+
+void PoolFailover::setSubmitPolicy(const StratumClient::SubmitPolicy& policy) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_submitPolicy = policy;
     if (m_client) {
-        m_client->submit(job_id, nonce_hex, result_hash);
+        m_client->setSubmitPolicy(policy);
+    }
+    if (m_standby) {
+        m_standby->setSubmitPolicy(policy);
+    }
+}
+
+StratumClient::SubmitStats PoolFailover::getSubmitStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_client ? m_client->getSubmitStats() : StratumClient::SubmitStats{};
+}
+
+PoolFailover::FailoverStats PoolFailover::getFailoverStats() const {
+    FailoverStats stats;
+    stats.failovers = m_failovers.load(std::memory_order_relaxed);
+    stats.hotPromotions = m_hotPromotions.load(std::memory_order_relaxed);
+    stats.lastLostMs = m_lastLostMs.load(std::memory_order_relaxed);
+    stats.totalLostMs = m_totalLostMs.load(std::memory_order_relaxed);
+    stats.lost = m_lost.snapshot();
+    return stats;
+}
+
+std::vector<PoolFailover::PoolStats> PoolFailover::getPoolStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto now = Clock::now();
+
+    std::vector<PoolStats> stats;
+    stats.reserve(m_pools.size());
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+        const auto& state = m_state[i];
+        stats.push_back(PoolStats{
+            m_pools[i].host, m_pools[i].port, state.rttMs, score(i, now), state.height, state.failures,
+            m_client && i == m_currentIndex, m_standby && i == m_standbyIndex
+        });
     }
+    return stats;
 }
 
 void PoolFailover::tryNextPool() {
     if (!m_active || m_pools.empty()) return;
-    
-    m_currentIndex = (m_currentIndex + 1) % m_pools.size();
-    const auto& pool = m_pools[m_currentIndex];
-    
-    Logger::info("PoolFailover", "Connecting to pool #%zu: %s:%d", 
-                m_currentIndex, pool.host.c_str(), pool.port);
-    
-    m_client = std::make_shared<StratumClient>(m_io_context);
-    
-    // Configure client callbacks
-    m_client->onConnected = [this, pool]() {
-        Logger::info("PoolFailover", "Connected to %s", pool.host.c_str());
-        m_retryCount = 0;
+
+    const auto next = bestPool(m_pools.size() > 1 ? std::optional<size_t>(m_currentIndex) : std::nullopt);
+    connectPrimary(*next);
+}
+
+void PoolFailover::connectPrimary(size_t index) {
+    const auto& pool = m_pools[index];
+    Logger::info("PoolFailover", fmt::format("Conectando a la pool #{}: {}:{}", index, pool.host, pool.port));
+
+    // Si la mejor candidata es la reserva (aún sin trabajo, o no se habría promocionado) se
+    // abre de nuevo como principal y se busca otra reserva
+    if (m_standby && m_standbyIndex == index) {
+        releaseStandby();
+    }
+
+    auto client = createClient(index);
+    std::shared_ptr<StratumClient> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_currentIndex = index;
+        previous = std::exchange(m_client, client);
+    }
+    // Sus callbacks ya no corresponden a la principal y se ignoran
+    if (previous) {
+        previous->disconnect();
+    }
+    connectClient(*client, index);
+    openStandby();
+}
+
+std::shared_ptr<StratumClient> PoolFailover::createClient(size_t index) {
+    auto client = std::make_shared<StratumClient>(m_io_context);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        client->setSubmitPolicy(m_submitPolicy);
+    }
+
+    // Los callbacks comparan con la principal y la reserva actuales: un cliente sustituido
+    // puede seguir avisando hasta que se cierran sus operaciones pendientes
+    StratumClient* raw = client.get();
+    const PoolInfo& pool = m_pools[index];
+
+    client->onConnected = [this, raw, &pool]() {
+        Logger::info("PoolFailover", "Conectado a " + pool.host);
+        if (raw == m_client.get()) {
+            m_retryCount = 0;
+        }
     };
-    
-    m_client->onNewJob = [this](const MiningJob& job) {
-        if (onNewJob) onNewJob(job);
+
+    client->onNewJob = [this, raw, index](const MiningJob& job) {
+        handleJob(raw, index, job);
     };
-    
-    m_client->onShareAccepted = [this](bool accepted, const std::string& reason) {
+
+    client->onLatencySample = [this, raw, index](double ms) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& state = m_state[index];
+        state.rttMs = state.rttMs < 0.0 ? ms : 0.8 * state.rttMs + 0.2 * ms;
+        if (raw == m_standby.get()) {
+            m_standbyMissedProbes = 0;
+        }
+    };
+
+    // La reserva no recibe submits; los resultados de una principal ya sustituida siguen valiendo
+    client->onShareAccepted = [this](bool accepted, const std::string& reason) {
         if (onShareAccepted) onShareAccepted(accepted, reason);
     };
-    
-    m_client->onError = [this](const std::string& error) {
-        handlePoolError(error);
+
+    client->onShareResult = [this](const StratumClient::ShareResult& result) {
+        if (onShareResult) onShareResult(result);
     };
-    
-    m_client->onDisconnected = [this]() {
-        handlePoolError("Connection lost");
+
+    client->onError = [this, raw](const std::string& error) {
+        if (!m_active) return;
+        if (raw == m_client.get()) {
+            handlePoolError(error);
+        } else if (raw == m_standby.get()) {
+            dropStandby(error);
+        }
     };
-    
-    m_client->connectToPool(pool.host, pool.port, pool.user, pool.pass);
+
+    client->onDisconnected = [this, raw]() {
+        if (!m_active) return;
+        if (raw == m_client.get()) {
+            handlePoolError("Connection lost");
+        } else if (raw == m_standby.get()) {
+            dropStandby("conexión cerrada");
+        }
+    };
+
+    return client;
+}
+
+void PoolFailover::connectClient(StratumClient& client, size_t index) {
+    const auto& pool = m_pools[index];
+    const auto& state = m_state[index];
+
+    if (state.endpoints && Clock::now() - state.resolvedAt < m_standbyConfig.resolveTtl) {
+        client.connectToPool(*state.endpoints, pool.host, pool.port, pool.user, pool.pass);
+    } else {
+        client.connectToPool(pool.host, pool.port, pool.user, pool.pass);
+    }
+}
+
+void PoolFailover::handleJob(StratumClient* client, size_t index, const MiningJob& job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& state = m_state[index];
+        state.height = job.height;
+        state.lastJobAt = Clock::now();
+        state.failures = 0;
+    }
+
+    if (client == m_client.get()) {
+        recordLostTime();
+        if (onNewJob) onNewJob(job);
+    } else if (client == m_standby.get()) {
+        m_standbyJob = job;
+        // La principal está caída y esperando reintento: no hace falta esperar
+        if (m_failedAt) {
+            promoteStandby();
+        }
+    }
 }
 
 void PoolFailover::handlePoolError(const std::string& error) {
     if (!m_active) return;
-    
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_state[m_currentIndex].failures++;
+    }
+    if (!m_failedAt) {
+        m_failedAt = Clock::now();
+    }
+
+    if (promoteStandby()) return;
+
     m_retryCount++;
-    Logger::warn("PoolFailover", "Pool error (%d/%d): %s", 
-                m_retryCount, 5, error.c_str());
-    
-    if (m_retryCount >= 5) {
+    Logger::warn("PoolFailover", fmt::format("Pool error ({}/{}): {}", m_retryCount.load(), MAX_RETRIES, error));
+
+    if (m_retryCount >= MAX_RETRIES) {
         Logger::info("PoolFailover", "Max retries reached, trying next pool");
+        m_retryCount = 0;
         tryNextPool();
     } else {
         scheduleNextTry();
@@ -90,13 +287,219 @@ void PoolFailover::handlePoolError(const std::string& error) {
 }
 
 void PoolFailover::scheduleNextTry() {
-    const int delay_seconds = std::min(5 * m_retryCount, 30);
-    Logger::info("PoolFailover", "Retrying in %d seconds", delay_seconds);
-    
+    const int delay_seconds = std::min(5 * m_retryCount.load(), 30);
+    Logger::info("PoolFailover", fmt::format("Retrying in {} seconds", delay_seconds));
+
     m_retryTimer.expires_after(std::chrono::seconds(delay_seconds));
     m_retryTimer.async_wait([this](const boost::system::error_code& ec) {
         if (!ec && m_active) {
-            tryNextPool();
+            connectPrimary(m_currentIndex);
+        }
+    });
+}
+
+void PoolFailover::openStandby() {
+    if (!m_standbyConfig.enabled || !m_active || m_standby || m_pools.size() < 2) return;
+
+    const size_t index = *bestPool(m_currentIndex);
+    const auto& pool = m_pools[index];
+    Logger::info("PoolFailover", fmt::format("Abriendo conexión de reserva con {}:{}", pool.host, pool.port));
+
+    auto client = createClient(index);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_standby = client;
+        m_standbyIndex = index;
+        m_standbyMissedProbes = 0;
+    }
+    m_standbyJob.reset();
+    connectClient(*client, index);
+}
+
+void PoolFailover::releaseStandby() {
+    std::shared_ptr<StratumClient> standby;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        standby = std::move(m_standby);
+        m_standby.reset();
+    }
+    m_standbyJob.reset();
+    if (standby) {
+        standby->disconnect();
+    }
+}
+
+void PoolFailover::dropStandby(const std::string& reason) {
+    if (!m_standby) return;
+
+    const auto& pool = m_pools[m_standbyIndex];
+    Logger::warn("PoolFailover", fmt::format("Reserva {}:{} descartada: {}", pool.host, pool.port, reason));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_state[m_standbyIndex].failures++;
+    }
+    releaseStandby();
+
+    m_standbyTimer.expires_after(m_standbyConfig.reopenDelay);
+    m_standbyTimer.async_wait([this](const boost::system::error_code& ec) {
+        if (!ec && m_active) {
+            openStandby();
+        }
+    });
+}
+
+bool PoolFailover::promoteStandby() {
+    if (!m_standby || !m_standby->isReady() || !m_standbyJob) return false;
+
+    const auto& pool = m_pools[m_standbyIndex];
+    Logger::warn("PoolFailover", fmt::format("Pool principal caída; pasa a principal la reserva {}:{}",
+                                             pool.host, pool.port));
+
+    std::shared_ptr<StratumClient> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        previous = std::exchange(m_client, std::move(m_standby));
+        m_standby.reset();
+        m_currentIndex = m_standbyIndex;
+    }
+    m_retryCount = 0;
+    m_retryTimer.cancel();
+    m_standbyTimer.cancel();
+    m_hotPromotions.fetch_add(1, std::memory_order_relaxed);
+    if (previous) {
+        previous->disconnect();
+    }
+
+    // El minero sigue con el último trabajo de la reserva hasta que la pool mande otro
+    recordLostTime();
+    if (onNewJob) onNewJob(*m_standbyJob);
+    m_standbyJob.reset();
+
+    openStandby();
+    return true;
+}
+
+void PoolFailover::recordLostTime() {
+    if (!m_failedAt) return;
+
+    const double lostMs = toMs(Clock::now() - *m_failedAt);
+    m_failedAt.reset();
+
+    m_lost.record(lostMs);
+    m_failovers.fetch_add(1, std::memory_order_relaxed);
+    m_lastLostMs.store(lostMs, std::memory_order_relaxed);
+    m_totalLostMs.store(m_totalLostMs.load(std::memory_order_relaxed) + lostMs, std::memory_order_relaxed);
+    Logger::info("PoolFailover", fmt::format("Trabajo recuperado tras {:.1f} ms sin minar", lostMs));
+}
+
+void PoolFailover::resolvePool(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_state[index].resolving = true;
+    }
+
+    const auto& pool = m_pools[index];
+    m_resolver.async_resolve(pool.host, std::to_string(pool.port),
+        [this, index](const boost::system::error_code& ec, tcp::resolver::results_type results) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& state = m_state[index];
+            state.resolving = false;
+            if (ec) {
+                // Se sigue usando la caché anterior, si la hay
+                if (ec != asio::error::operation_aborted) {
+                    Logger::warn("PoolFailover", fmt::format("No se pudo resolver {}: {}",
+                                                             m_pools[index].host, ec.message()));
+                }
+                return;
+            }
+            state.endpoints = std::move(results);
+            state.resolvedAt = Clock::now();
+        });
+}
+
+void PoolFailover::armProbeTimer() {
+    m_probeTimer.expires_after(m_standbyConfig.probeInterval);
+    m_probeTimer.async_wait([this](const boost::system::error_code& ec) {
+        if (!ec && m_active) {
+            onProbeTick();
+            armProbeTimer();
         }
     });
-}
\ No newline at end of file
+}
+
+void PoolFailover::onProbeTick() {
+    if (m_client) {
+        m_client->probe();
+    }
+
+    // Una reserva que no contesta no sirve para promocionarla
+    if (m_standby && m_standby->isReady() && !m_standby->probe() &&
+        ++m_standbyMissedProbes >= MAX_MISSED_PROBES) {
+        dropStandby("no responde a keepalived");
+    }
+
+    // Una reserva claramente peor que otra candidata se sustituye; el factor 2 evita el vaivén
+    if (m_standby) {
+        const auto now = Clock::now();
+        const size_t best = *bestPool(m_currentIndex);
+        if (best != m_standbyIndex && 2.0 * score(best, now) < score(m_standbyIndex, now)) {
+            Logger::info("PoolFailover", fmt::format("Reserva {}:{} sustituida por {}:{}",
+                                                     m_pools[m_standbyIndex].host, m_pools[m_standbyIndex].port,
+                                                     m_pools[best].host, m_pools[best].port));
+            releaseStandby();
+            openStandby();
+        }
+    }
+
+    const auto now = Clock::now();
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+        const auto& state = m_state[i];
+        if (!state.resolving && (!state.endpoints || now - state.resolvedAt >= m_standbyConfig.resolveTtl)) {
+            resolvePool(i);
+        }
+    }
+}
+
+double PoolFailover::score(size_t index, Clock::time_point now) const {
+    const auto& state = m_state[index];
+    double value = state.rttMs >= 0.0 ? state.rttMs : UNKNOWN_RTT_MS;
+    value += FAILURE_PENALTY_MS * state.failures;
+
+    // Frescura: sólo cuentan los trabajos recientes; una pool desconectada hace tiempo no se juzga
+    if (state.lastJobAt == Clock::time_point{}) {
+        return value;
+    }
+    const bool recent = now - state.lastJobAt <= STALE_FEED;
+    const bool live = (m_client && index == m_currentIndex) || (m_standby && index == m_standbyIndex);
+    if (live && !recent) {
+        return value + LAGGING_PENALTY_MS;
+    }
+    if (recent) {
+        uint32_t bestHeight = 0;
+        for (const auto& other : m_state) {
+            if (now - other.lastJobAt <= STALE_FEED) {
+                bestHeight = std::max(bestHeight, other.height);
+            }
+        }
+        if (state.height < bestHeight) {
+            value += LAGGING_PENALTY_MS;
+        }
+    }
+    return value;
+}
+
+std::optional<size_t> PoolFailover::bestPool(std::optional<size_t> exclude) const {
+    const auto now = Clock::now();
+    std::optional<size_t> best;
+    double bestScore = 0.0;
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+        if (exclude && i == *exclude) continue;
+        const double value = score(i, now);
+        if (!best || value < bestScore) {
+            best = i;
+            bestScore = value;
+        }
+    }
+    return best;
+}
@@ -6,13 +6,18 @@
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
 #include <boost/asio.hpp>
 #include "core/JobManager.h"
-
-class StratumClient;
+#include "network/StratumClient.h"
+#include "utils/LatencyHistogram.h"
 
 class PoolFailover {
 public:
+    using Clock = std::chrono::steady_clock;
+
     struct PoolInfo {
         std::string host;
         uint16_t port;
@@ -20,29 +25,120 @@ public:
         std::string pass;
     };
 
+    /**
+     * Conexión de reserva: se mantiene autenticada la mejor pool después de la actual
+     * y, si la actual cae, pasa a ser la principal sin DNS, conexión ni login.
+     */
+    struct StandbyConfig {
+        bool enabled = false;
+        std::chrono::milliseconds probeInterval{5000};   // keepalived a la principal y a la reserva
+        std::chrono::seconds resolveTtl{300};             // validez de las direcciones resueltas
+        std::chrono::seconds reopenDelay{5};              // espera antes de reabrir una reserva caída
+    };
+
+    struct PoolStats {
+        std::string host;
+        uint16_t port;
+        double rttMs;           // media móvil de login y keepalived; -1 sin medidas
+        double score;           // menor es mejor
+        uint32_t height;        // altura del último trabajo recibido
+        uint32_t failures;      // fallos seguidos
+        bool primary;
+        bool standby;
+    };
+
+    struct FailoverStats {
+        uint64_t failovers{0};
+        uint64_t hotPromotions{0};     // resueltas con la reserva ya autenticada
+        double lastLostMs{0.0};        // del fallo al primer trabajo de la nueva pool
+        double totalLostMs{0.0};
+        zartrux::LatencyHistogram::Snapshot lost;
+    };
+
     explicit PoolFailover(asio::io_context& io_context, 
                          std::vector<PoolInfo> pools);
     ~PoolFailover();
 
+    // Antes de start()
+    void setHotStandby(const StandbyConfig& config);
+
     void start();
     void stop();
     void submit(const std::string& job_id, 
                const std::string& nonce_hex, 
                const std::string& result_hash);
 
+    // Se aplica a la conexión actual y a las siguientes
+    void setSubmitPolicy(const StratumClient::SubmitPolicy& policy);
+    // Métricas de submit de la conexión actual (cada reconexión empieza de cero)
+    StratumClient::SubmitStats getSubmitStats() const;
+
+    FailoverStats getFailoverStats() const;
+    std::vector<PoolStats> getPoolStats() const;
+
     std::function<void(const MiningJob&)> onNewJob;
     std::function<void(bool, const std::string&)> onShareAccepted;
+    std::function<void(const StratumClient::ShareResult&)> onShareResult;
 
 private:
+    // Estado por pool; lo escribe sólo el hilo de asio, con m_mutex para los lectores de fuera
+    struct PoolState {
+        std::optional<tcp::resolver::results_type> endpoints;
+        Clock::time_point resolvedAt;
+        bool resolving = false;
+        double rttMs = -1.0;
+        uint32_t height = 0;
+        Clock::time_point lastJobAt;
+        uint32_t failures = 0;
+    };
+
     void tryNextPool();
+    void connectPrimary(size_t index);
     void handlePoolError(const std::string& error);
     void scheduleNextTry();
 
+    std::shared_ptr<StratumClient> createClient(size_t index);
+    void connectClient(StratumClient& client, size_t index);
+    void handleJob(StratumClient* client, size_t index, const MiningJob& job);
+    void openStandby();
+    void releaseStandby();
+    void dropStandby(const std::string& reason);
+    bool promoteStandby();
+    void recordLostTime();
+
+    void resolvePool(size_t index);
+    void armProbeTimer();
+    void onProbeTick();
+
+    double score(size_t index, Clock::time_point now) const;
+    std::optional<size_t> bestPool(std::optional<size_t> exclude) const;
+
     asio::io_context& m_io_context;
     std::vector<PoolInfo> m_pools;
+    std::vector<PoolState> m_state;
     size_t m_currentIndex = 0;
     std::shared_ptr<StratumClient> m_client;
     asio::steady_timer m_retryTimer;
     std::atomic<bool> m_active{false};
     std::atomic<int> m_retryCount{0};
+    StratumClient::SubmitPolicy m_submitPolicy;
+    mutable std::mutex m_mutex;     // m_client, m_standby y m_state frente a otros hilos
+
+    // Reserva en caliente
+    StandbyConfig m_standbyConfig;
+    std::shared_ptr<StratumClient> m_standby;
+    size_t m_standbyIndex = 0;
+    std::optional<MiningJob> m_standbyJob;     // último trabajo de la reserva, para publicarlo al promocionarla
+    int m_standbyMissedProbes = 0;
+    tcp::resolver m_resolver;
+    asio::steady_timer m_probeTimer;
+    asio::steady_timer m_standbyTimer;
+
+    // Tiempo sin trabajo por cada cambio de pool
+    std::optional<Clock::time_point> m_failedAt;
+    zartrux::LatencyHistogram m_lost;
+    std::atomic<uint64_t> m_failovers{0};
+    std::atomic<uint64_t> m_hotPromotions{0};
+    std::atomic<double> m_lastLostMs{0.0};
+    std::atomic<double> m_totalLostMs{0.0};
 };
\ No newline at end of file
@@ -1,12 +1,34 @@
 #include "StratumClient.h"
 #include "utils/Logger.h"
 #include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cctype>
 #include <functional>
 
 using json = nlohmann::json;
 
+namespace {
+
+// Las pools no tienen un código común para "trabajo caducado"; se reconoce por el mensaje
+bool isStaleReason(std::string_view reason) {
+    std::string lower(reason);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (std::string_view marker : {"stale", "expired", "outdated", "job not found", "unknown job", "block expired"}) {
+        if (lower.find(marker) != std::string::npos) return true;
+    }
+    return false;
+}
+
+double toMs(StratumClient::Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // namespace
+
 StratumClient::StratumClient(asio::io_context& io_context)
-    : m_io_context(io_context), m_socket(io_context), m_resolver(io_context) {}
+    : m_io_context(io_context), m_socket(io_context), m_resolver(io_context), m_submitTimer(io_context) {}
 
 StratumClient::~StratumClient() {
     disconnect();
@@ -28,50 +50,91 @@ void StratumClient::connectToPool(const std::string& host, uint16_t port,
         });
 }
 
+void StratumClient::connectToPool(const tcp::resolver::results_type& endpoints, const std::string& host,
+                                  uint16_t port, const std::string& user, const std::string& pass) {
+    if (m_connected) disconnect();
+
+    m_host = host;
+    m_port = port;
+    m_user = user;
+    m_pass = pass;
+    start_connect(endpoints);
+}
+
 void StratumClient::disconnect() {
-    if (!m_connected) return;
-    
     boost::system::error_code ec;
+    if (!m_connected) {
+        // Aborta una resolución o conexión en curso; su handler recibe operation_aborted
+        m_resolver.cancel();
+        m_socket.close(ec);
+        return;
+    }
+    
     m_socket.shutdown(tcp::socket::shutdown_both, ec);
     m_socket.close(ec);
     m_connected = false;
+    m_loggedIn = false;
+    m_probeId = 0;
+    m_submitTimer.cancel();
+    m_outgoing.clear();
+
+    // Lo que quedaba en vuelo ya no tendrá respuesta por esta conexión
+    if (!m_inFlight.empty()) {
+        Logger::warn("StratumClient", fmt::format("Conexión cerrada con {} submits sin respuesta", m_inFlight.size()));
+        std::vector<uint64_t> pending;
+        pending.reserve(m_inFlight.size());
+        for (const auto& entry : m_inFlight) pending.push_back(entry.first);
+        for (uint64_t id : pending) complete_submit(id, ShareOutcome::TimedOut, "conexión cerrada");
+    }
     
     if (onDisconnected) onDisconnected();
 }
 
 void StratumClient::handle_resolve(const boost::system::error_code& ec, 
                                  tcp::resolver::results_type results) {
+    if (ec == asio::error::operation_aborted) return;   // disconnect() durante la conexión
     if (ec) {
         if (onError) onError("DNS resolution failed: " + ec.message());
         return;
     }
-    
+    start_connect(results);
+}
+
+void StratumClient::start_connect(const tcp::resolver::results_type& endpoints) {
     Logger::info("StratumClient", "Conectando a " + m_host);
-    asio::async_connect(m_socket, results,
+    asio::async_connect(m_socket, endpoints,
         [self = shared_from_this()](auto ec, auto) {
             self->handle_connect(ec);
         });
 }
 
 void StratumClient::handle_connect(const boost::system::error_code& ec) {
+    if (ec == asio::error::operation_aborted) return;   // disconnect() durante la conexión
     if (ec) {
         if (onError) onError("Connection failed: " + ec.message());
         return;
     }
     
     m_connected = true;
+    m_recv.clear();
+    m_sessionId.clear();
+    m_loggedIn = false;
+    m_probeId = 0;
     Logger::info("StratumClient", "Conexión establecida con " + m_host);
     
     if (onConnected) onConnected();
     read_loop();
+    arm_submit_timer();
 
     json login_params = {
         {"login", m_user},
         {"pass", m_pass},
         {"agent", "zartrux-miner/1.0"}
     };
+    m_loginId = m_message_id++;
+    m_loginSentAt = Clock::now();
     json request = {
-        {"id", m_message_id++},
+        {"id", m_loginId},
         {"method", "login"},
         {"params", login_params}
     };
@@ -84,23 +147,164 @@ void StratumClient::submit(const std::string& job_id, const std::string& nonce_h
         Logger::warn("StratumClient", "Intento de submit sin conexión");
         return;
     }
-    
+
+    // El estado de la conexión vive en el hilo de asio; el minero no espera a la respuesta
+    asio::post(m_io_context, [self = shared_from_this(), job_id, nonce_hex, result_hash] {
+        self->send_submit(job_id, nonce_hex, result_hash);
+    });
+}
+
+bool StratumClient::probe() {
+    if (!m_connected || !m_loggedIn || m_probeId != 0) return false;
+
+    m_probeId = m_message_id++;
+    m_probeSentAt = Clock::now();
+    json request = {
+        {"id", m_probeId},
+        {"method", "keepalived"},
+        {"params", {{"id", m_sessionId}}}
+    };
+    write(request.dump() + "\n");
+    return true;
+}
+
+void StratumClient::send_submit(const std::string& job_id, const std::string& nonce_hex,
+                                const std::string& result_hash) {
+    if (!m_connected) {
+        Logger::warn("StratumClient", "Submit descartado: la conexión se cerró antes de enviarlo");
+        return;
+    }
+
+    const uint64_t id = m_message_id++;
     json params = {
-        {"id", "1"},
+        {"id", m_sessionId.empty() ? std::string("1") : m_sessionId},
         {"job_id", job_id},
         {"nonce", nonce_hex},
         {"result", result_hash}
     };
     json request = {
-        {"id", m_message_id++},
+        {"id", id},
         {"method", "submit"},
         {"params", params}
     };
+
+    m_inFlight.emplace(id, PendingSubmit{job_id, nonce_hex, Clock::now(), job_age_ms(job_id)});
+    m_inFlightCount.store(m_inFlight.size(), std::memory_order_relaxed);
+    m_sent.fetch_add(1, std::memory_order_relaxed);
     write(request.dump() + "\n");
 }
 
+void StratumClient::complete_submit(uint64_t id, ShareOutcome outcome, std::string reason) {
+    auto it = m_inFlight.find(id);
+    if (it == m_inFlight.end()) return;
+
+    PendingSubmit pending = std::move(it->second);
+    m_inFlight.erase(it);
+    m_inFlightCount.store(m_inFlight.size(), std::memory_order_relaxed);
+
+    double rttMs = 0.0;
+    if (outcome != ShareOutcome::TimedOut) {
+        rttMs = toMs(Clock::now() - pending.sentAt);
+        m_rtt.record(rttMs);
+    }
+
+    // Trabajos que ya no están entre los recientes cuentan en el último tramo
+    size_t ageBucket = JOB_AGE_BUCKETS - 1;
+    if (pending.jobAgeMs >= 0.0) {
+        ageBucket = static_cast<size_t>(std::upper_bound(JOB_AGE_LIMITS_MS.begin(), JOB_AGE_LIMITS_MS.end(),
+                                                         pending.jobAgeMs) - JOB_AGE_LIMITS_MS.begin());
+    }
+    m_outcomes[ageBucket][static_cast<size_t>(outcome)].fetch_add(1, std::memory_order_relaxed);
+
+    if (outcome == ShareOutcome::Stale) {
+        Logger::warn("StratumClient", fmt::format("Share caducada (trabajo {}, {:.0f} ms de antigüedad): {}",
+                                                  pending.jobId, pending.jobAgeMs, reason));
+    } else if (outcome == ShareOutcome::Rejected) {
+        Logger::warn("StratumClient", fmt::format("Share rechazada (trabajo {}): {}", pending.jobId, reason));
+    }
+
+    if (onShareAccepted) onShareAccepted(outcome == ShareOutcome::Accepted, reason);
+    if (onShareResult) {
+        onShareResult(ShareResult{outcome, std::move(pending.jobId), std::move(pending.nonceHex),
+                                  std::move(reason), rttMs, pending.jobAgeMs});
+    }
+}
+
+void StratumClient::arm_submit_timer() {
+    m_submitTimer.expires_after(std::chrono::seconds(1));
+    m_submitTimer.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+        if (ec || !self->m_connected) return;
+        self->check_submit_timeouts();
+        if (self->m_connected) self->arm_submit_timer();
+    });
+}
+
+void StratumClient::check_submit_timeouts() {
+    if (m_inFlight.empty()) return;
+
+    const auto deadline = Clock::now() - std::chrono::milliseconds(m_submitTimeoutMs.load(std::memory_order_relaxed));
+    std::vector<uint64_t> expired;
+    for (const auto& [id, pending] : m_inFlight) {
+        if (pending.sentAt <= deadline) expired.push_back(id);
+    }
+    if (expired.empty()) return;
+
+    Logger::warn("StratumClient", fmt::format("{} submits sin respuesta tras {} ms",
+                                              expired.size(), m_submitTimeoutMs.load(std::memory_order_relaxed)));
+    for (uint64_t id : expired) complete_submit(id, ShareOutcome::TimedOut, "sin respuesta de la pool");
+
+    if (m_timeoutAction.load(std::memory_order_relaxed) == TimeoutAction::Reconnect) {
+        Logger::warn("StratumClient", "Se cierra la conexión por submits sin respuesta");
+        disconnect();
+    }
+}
+
+void StratumClient::remember_job(const MiningJob& job) {
+    auto& slot = m_recentJobs[m_recentJobsNext];
+    slot.first.assign(job.id);
+    slot.second = Clock::now();
+    m_recentJobsNext = (m_recentJobsNext + 1) % m_recentJobs.size();
+}
+
+double StratumClient::job_age_ms(const std::string& job_id) const {
+    for (const auto& [id, receivedAt] : m_recentJobs) {
+        if (!id.empty() && id == job_id) return toMs(Clock::now() - receivedAt);
+    }
+    return -1.0;
+}
+
+void StratumClient::setSubmitPolicy(const SubmitPolicy& policy) {
+    m_submitTimeoutMs.store(std::max<int64_t>(policy.timeout.count(), 1), std::memory_order_relaxed);
+    m_timeoutAction.store(policy.action, std::memory_order_relaxed);
+}
+
+StratumClient::SubmitStats StratumClient::getSubmitStats() const {
+    SubmitStats stats;
+    stats.sent = m_sent.load(std::memory_order_relaxed);
+    stats.inFlight = m_inFlightCount.load(std::memory_order_relaxed);
+    stats.rtt = m_rtt.snapshot();
+
+    for (size_t age = 0; age < JOB_AGE_BUCKETS; ++age) {
+        for (size_t outcome = 0; outcome < OUTCOMES; ++outcome) {
+            stats.byJobAge[age][outcome] = m_outcomes[age][outcome].load(std::memory_order_relaxed);
+        }
+        stats.accepted += stats.byJobAge[age][static_cast<size_t>(ShareOutcome::Accepted)];
+        stats.rejected += stats.byJobAge[age][static_cast<size_t>(ShareOutcome::Rejected)];
+        stats.stale += stats.byJobAge[age][static_cast<size_t>(ShareOutcome::Stale)];
+        stats.timedOut += stats.byJobAge[age][static_cast<size_t>(ShareOutcome::TimedOut)];
+    }
+    return stats;
+}
+
 void StratumClient::read_loop() {
-    asio::async_read_until(m_socket, m_buffer, '\n',
+    auto buffer = m_recv.prepare();
+    if (buffer.empty()) {
+        Logger::error("StratumClient", "Línea recibida demasiado larga; se cierra la conexión");
+        disconnect();
+        return;
+    }
+
+    m_socket.async_read_some(asio::buffer(buffer.data(), buffer.size()),
         [self = shared_from_this()](auto ec, auto size) {
             self->handle_read(ec, size);
         });
@@ -115,63 +319,113 @@ void StratumClient::handle_read(const boost::system::error_code& ec, size_t byte
         return;
     }
     
-    std::istream is(&m_buffer);
-    std::string line;
-    std::getline(is, line);
-    
-    if (!line.empty()) {
-        Logger::debug("StratumClient", "Recibido: " + line);
-        parse_line(line);
+    // Todas las líneas completas de la lectura, sin copiarlas fuera del buffer
+    m_recv.commit(bytes);
+    while (m_connected) {
+        auto line = m_recv.nextLine();
+        if (!line) break;
+        if (!line->empty()) parse_line(*line);
     }
     
-    read_loop();
+    if (m_connected) read_loop();
 }
 
-void StratumClient::parse_line(const std::string& line) {
-    try {
-        json rpc = json::parse(line);
-        
-        // Handle new jobs
-        if (rpc.contains("method") && rpc["method"] == "job") {
-            MiningJob job;
-            job.id = rpc["params"].value("job_id", "");
-            job.blob = rpc["params"].value("blob", "");
-            job.target = rpc["params"].value("target", "");
-            
-            if (onNewJob) onNewJob(job);
-        } 
-        // Handle share responses
-        else if (rpc.contains("id")) {
-            bool accepted = false;
-            std::string reason = "Unknown response";
-            
-            if (rpc.contains("result")) {
-                const auto& result = rpc["result"];
-                if (result.is_boolean()) {
-                    accepted = result.get<bool>();
-                } else if (result.is_object()) {
-                    accepted = result.value("status", "") == "OK";
-                    reason = result.value("reason", "");
+void StratumClient::parse_line(std::string_view line) {
+    using zartrux::network::StratumMessage;
+    using zartrux::network::StratumParser;
+
+    switch (StratumParser::parse(line, m_message, m_job)) {
+        case StratumParser::Result::Malformed:
+            Logger::warn("StratumClient", "JSON no válido: " + std::string(line.substr(0, 256)));
+            return;
+        case StratumParser::Result::BadJob:
+            Logger::warn("StratumClient", "Trabajo con blob o target no válidos: " + std::string(line.substr(0, 256)));
+            return;
+        case StratumParser::Result::Ok:
+            break;
+    }
+
+    switch (m_message.kind) {
+        case StratumMessage::Kind::Job:
+            remember_job(m_job);
+            if (onNewJob) onNewJob(m_job);
+            break;
+
+        case StratumMessage::Kind::Response:
+            // La respuesta al login trae la sesión y el primer trabajo
+            if (m_message.hasId && m_message.id == m_loginId) {
+                if (!m_message.ok) {
+                    if (onError) onError("Login rechazado: " + std::string(m_message.error));
+                    return;
+                }
+                m_sessionId.assign(m_message.sessionId);
+                m_loggedIn = true;
+                if (onLatencySample) onLatencySample(toMs(Clock::now() - m_loginSentAt));
+                if (m_message.hasJob) {
+                    remember_job(m_job);
+                    if (onNewJob) onNewJob(m_job);
                 }
+                break;
             }
-            
-            if (onShareAccepted) onShareAccepted(accepted, reason);
-        }
-    } catch(const json::parse_error& e) {
-        Logger::warn("StratumClient", "JSON parse error: " + std::string(e.what()));
+            // Basta con que conteste: algunas pools no conocen keepalived y responden con error
+            if (m_message.hasId && m_message.id == m_probeId) {
+                m_probeId = 0;
+                if (onLatencySample) onLatencySample(toMs(Clock::now() - m_probeSentAt));
+                break;
+            }
+            // Con varios submits en vuelo las respuestas se emparejan por id, no por orden
+            if (m_message.hasId && m_inFlight.count(m_message.id)) {
+                ShareOutcome outcome = ShareOutcome::Accepted;
+                if (!m_message.ok) {
+                    outcome = isStaleReason(m_message.error) ? ShareOutcome::Stale : ShareOutcome::Rejected;
+                }
+                complete_submit(m_message.id, outcome,
+                                std::string(m_message.ok ? m_message.status : m_message.error));
+                break;
+            }
+            Logger::debug("StratumClient", "Respuesta sin petición pendiente (tardía o desconocida): " +
+                                           std::string(line.substr(0, 256)));
+            break;
+
+        case StratumMessage::Kind::Unknown:
+            Logger::debug("StratumClient", "Mensaje ignorado: " + std::string(line));
+            break;
     }
 }
 
-void StratumClient::write(const std::string& message) {
-    asio::async_write(m_socket, asio::buffer(message),
+void StratumClient::write(std::string_view message) {
+    m_outgoing.append(message);
+    if (m_writeInFlight || m_flushScheduled) return;
+
+    // Lo que se encole antes de que corra el flush sale en el mismo async_write
+    m_flushScheduled = true;
+    asio::post(m_io_context, [self = shared_from_this()] {
+        self->m_flushScheduled = false;
+        self->flush_writes();
+    });
+}
+
+void StratumClient::flush_writes() {
+    if (m_writeInFlight || m_outgoing.empty() || !m_connected) return;
+
+    // m_writing debe seguir vivo hasta que termine el async_write
+    m_writing.clear();
+    m_writing.swap(m_outgoing);
+    m_writeInFlight = true;
+    asio::async_write(m_socket, asio::buffer(m_writing),
         [self = shared_from_this()](auto ec, auto size) {
             self->handle_write(ec, size);
         });
 }
 
 void StratumClient::handle_write(const boost::system::error_code& ec, size_t) {
+    m_writeInFlight = false;
     if (ec) {
-        Logger::error("StratumClient", "Write error: " + ec.message());
-        disconnect();
+        if (m_connected) {
+            Logger::error("StratumClient", "Write error: " + ec.message());
+            disconnect();
+        }
+        return;
     }
+    flush_writes();
 }
\ No newline at end of file
@@ -1,18 +1,64 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <array>
+#include <chrono>
+#include <unordered_map>
 #include <boost/asio.hpp>
 #include "core/JobManager.h"
+#include "network/StratumParser.h"
+#include "utils/LatencyHistogram.h"
 
 namespace asio = boost::asio;
 using tcp = asio::ip::tcp;
 
 class StratumClient : public std::enable_shared_from_this<StratumClient> {
 public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class ShareOutcome { Accepted, Rejected, Stale, TimedOut };
+
+    struct ShareResult {
+        ShareOutcome outcome;
+        std::string jobId;
+        std::string nonceHex;
+        std::string reason;
+        double rttMs;       // 0 si no hubo respuesta
+        double jobAgeMs;    // antigüedad del trabajo al enviar la share (-1 si ya no se conocía)
+    };
+
+    // Qué hacer con un submit que no recibe respuesta en `timeout`
+    enum class TimeoutAction {
+        Report,         // se da por perdido y se notifica como TimedOut
+        Reconnect       // además se cierra la conexión (PoolFailover reconecta o cambia de pool)
+    };
+
+    struct SubmitPolicy {
+        std::chrono::milliseconds timeout{10000};
+        TimeoutAction action = TimeoutAction::Report;
+    };
+
+    // Resultados por antigüedad del trabajo al enviar: < 5 s, < 30 s, < 2 min y el resto
+    static constexpr std::array<double, 3> JOB_AGE_LIMITS_MS{5000.0, 30000.0, 120000.0};
+    static constexpr size_t JOB_AGE_BUCKETS = JOB_AGE_LIMITS_MS.size() + 1;
+    static constexpr size_t OUTCOMES = 4;
+
+    struct SubmitStats {
+        uint64_t sent{0};
+        uint64_t accepted{0};
+        uint64_t rejected{0};
+        uint64_t stale{0};
+        uint64_t timedOut{0};
+        size_t inFlight{0};
+        zartrux::LatencyHistogram::Snapshot rtt;                          // envío → respuesta
+        std::array<std::array<uint64_t, OUTCOMES>, JOB_AGE_BUCKETS> byJobAge{};   // [edad][ShareOutcome]
+    };
+
     explicit StratumClient(asio::io_context& io_context);
     ~StratumClient();
 
@@ -22,30 +68,74 @@ public:
     std::function<void()> onDisconnected;
     std::function<void(const MiningJob&)> onNewJob;
     std::function<void(bool, const std::string&)> onShareAccepted;
+    std::function<void(const ShareResult&)> onShareResult;
+    // Ida y vuelta medida en el login y en cada probe() (ms)
+    std::function<void(double)> onLatencySample;
 
     void connectToPool(const std::string& host, uint16_t port, 
                      const std::string& user, const std::string& pass);
+    // Igual, con direcciones ya resueltas (se ahorra el DNS)
+    void connectToPool(const tcp::resolver::results_type& endpoints, const std::string& host, uint16_t port,
+                     const std::string& user, const std::string& pass);
     void disconnect();
+
+    // Login aceptado y conexión abierta
+    bool isReady() const { return m_loggedIn; }
+
+    /**
+     * @brief Envía un keepalived para medir la ida y vuelta (hilo de asio).
+     * @return false si no hay sesión o la sonda anterior sigue sin respuesta.
+     */
+    bool probe();
+    // Se puede llamar desde cualquier hilo; no espera la respuesta del anterior
     void submit(const std::string& job_id, const std::string& nonce_hex, 
                const std::string& result_hash);
 
+    void setSubmitPolicy(const SubmitPolicy& policy);
+    SubmitStats getSubmitStats() const;
+
 private:
     void resolve();
     void handle_resolve(const boost::system::error_code& ec, 
                        tcp::resolver::results_type results);
     void handle_connect(const boost::system::error_code& ec);
+    void start_connect(const tcp::resolver::results_type& endpoints);
     
     void read_loop();
     void handle_read(const boost::system::error_code& ec, size_t bytes_transferred);
-    void parse_line(const std::string& line);
+    void parse_line(std::string_view line);
 
-    void write(const std::string& message);
+    // Envíos en el hilo de asio: los mensajes del mismo ciclo salen en un solo async_write
+    void write(std::string_view message);
+    void flush_writes();
     void handle_write(const boost::system::error_code& ec, size_t bytes_transferred);
 
+    struct PendingSubmit {
+        std::string jobId;
+        std::string nonceHex;
+        Clock::time_point sentAt;
+        double jobAgeMs;
+    };
+
+    void send_submit(const std::string& job_id, const std::string& nonce_hex, const std::string& result_hash);
+    void complete_submit(uint64_t id, ShareOutcome outcome, std::string reason);
+    void arm_submit_timer();
+    void check_submit_timeouts();
+    void remember_job(const MiningJob& job);
+    double job_age_ms(const std::string& job_id) const;
+
     asio::io_context& m_io_context;
     tcp::socket m_socket;
     tcp::resolver m_resolver;
-    asio::streambuf m_buffer;
+    zartrux::network::LineBuffer m_recv;
+    zartrux::network::StratumMessage m_message;
+    MiningJob m_job;                // se reutiliza en cada notificación
+    std::string m_sessionId;        // result.id del login; lo exige submit
+    uint64_t m_loginId = 0;
+    std::atomic<bool> m_loggedIn{false};
+    Clock::time_point m_loginSentAt;
+    uint64_t m_probeId = 0;         // 0: ninguna sonda pendiente
+    Clock::time_point m_probeSentAt;
     
     std::string m_host;
     uint16_t m_port;
@@ -54,4 +144,24 @@ private:
 
     std::atomic<uint64_t> m_message_id{1};
     std::atomic<bool> m_connected{false};
+
+    // Escritura agrupada (sólo hilo de asio)
+    std::string m_outgoing;         // mensajes pendientes del ciclo actual
+    std::string m_writing;          // buffer del async_write en curso
+    bool m_flushScheduled = false;
+    bool m_writeInFlight = false;
+
+    // Submits en vuelo por id de petición (sólo hilo de asio)
+    std::unordered_map<uint64_t, PendingSubmit> m_inFlight;
+    std::array<std::pair<std::string, Clock::time_point>, 16> m_recentJobs;
+    size_t m_recentJobsNext = 0;
+    asio::steady_timer m_submitTimer;
+    std::atomic<int64_t> m_submitTimeoutMs{10000};
+    std::atomic<TimeoutAction> m_timeoutAction{TimeoutAction::Report};
+
+    // Métricas legibles desde cualquier hilo
+    zartrux::LatencyHistogram m_rtt;
+    std::atomic<uint64_t> m_sent{0};
+    std::atomic<size_t> m_inFlightCount{0};
+    std::array<std::array<std::atomic<uint64_t>, OUTCOMES>, JOB_AGE_BUCKETS> m_outcomes{};
 };
\ No newline at end of file
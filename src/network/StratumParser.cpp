@@ -0,0 +1,314 @@
+#include "StratumParser.h"
+#include "utils/Hex.h"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace zartrux::network {
+
+LineBuffer::LineBuffer(size_t capacity, size_t maxLine)
+    : m_data(capacity), m_maxLine(maxLine) {}
+
+std::span<char> LineBuffer::prepare(size_t minimum) {
+    if (m_data.size() - m_end < minimum) {
+        const size_t pending = m_end - m_begin;
+        if (pending > m_maxLine) {
+            return {};
+        }
+        if (m_begin > 0) {
+            std::memmove(m_data.data(), m_data.data() + m_begin, pending);
+            m_scanned -= m_begin;
+            m_begin = 0;
+            m_end = pending;
+        }
+        if (m_data.size() - m_end < minimum) {
+            m_data.resize(m_end + minimum);
+        }
+    }
+    return {m_data.data() + m_end, m_data.size() - m_end};
+}
+
+void LineBuffer::commit(size_t bytes) {
+    m_end += bytes;
+}
+
+std::optional<std::string_view> LineBuffer::nextLine() {
+    const char* base = m_data.data();
+    const void* newline = std::memchr(base + m_scanned, '\n', m_end - m_scanned);
+    if (!newline) {
+        m_scanned = m_end;
+        return std::nullopt;
+    }
+
+    const size_t lineEnd = static_cast<const char*>(newline) - base;
+    std::string_view line(base + m_begin, lineEnd - m_begin);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    m_begin = lineEnd + 1;
+    m_scanned = m_begin;
+    if (m_begin == m_end) {
+        m_begin = m_end = m_scanned = 0;
+    }
+    return line;
+}
+
+void LineBuffer::clear() {
+    m_begin = m_end = m_scanned = 0;
+}
+
+namespace {
+
+// Recorrido de un valor JSON sin construir nada; las cadenas se devuelven sin comillas y con
+// los escapes tal cual (ids, hex y mensajes de las pools no los llevan)
+struct Cursor {
+    const char* p;
+    const char* end;
+
+    explicit Cursor(std::string_view text) : p(text.data()), end(text.data() + text.size()) {}
+
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+    }
+
+    bool eat(char c) {
+        skipWhitespace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool string(std::string_view& out) {
+        skipWhitespace();
+        if (p >= end || *p != '"') return false;
+        const char* start = ++p;
+        // memchr recorre los blobs hex a la velocidad de la libc; sólo se miran las barras
+        // inversas justo delante de cada comilla encontrada
+        for (;;) {
+            const auto* quote = static_cast<const char*>(std::memchr(p, '"', static_cast<size_t>(end - p)));
+            if (!quote) return false;
+            size_t backslashes = 0;
+            for (const char* c = quote; c > start && c[-1] == '\\'; --c) ++backslashes;
+            p = quote + 1;
+            if (backslashes % 2 == 0) {
+                out = std::string_view(start, static_cast<size_t>(quote - start));
+                return true;
+            }
+        }
+    }
+
+    bool skipValue() {
+        skipWhitespace();
+        if (p >= end) return false;
+
+        std::string_view ignored;
+        if (*p == '"') return string(ignored);
+
+        if (*p == '{' || *p == '[') {
+            int depth = 0;
+            while (p < end) {
+                if (*p == '"') {
+                    if (!string(ignored)) return false;
+                    continue;
+                }
+                if (*p == '{' || *p == '[') {
+                    ++depth;
+                } else if (*p == '}' || *p == ']') {
+                    if (--depth == 0) {
+                        ++p;
+                        return true;
+                    }
+                }
+                ++p;
+            }
+            return false;
+        }
+
+        // Número, true, false o null
+        const char* start = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+               *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+            ++p;
+        }
+        return p > start;
+    }
+
+    bool value(std::string_view& raw) {
+        skipWhitespace();
+        const char* start = p;
+        if (!skipValue()) return false;
+        raw = std::string_view(start, static_cast<size_t>(p - start));
+        return true;
+    }
+};
+
+template<typename OnMember>
+bool forEachMember(std::string_view object, OnMember&& onMember) {
+    Cursor cursor(object);
+    if (!cursor.eat('{')) return false;
+    if (cursor.eat('}')) return true;
+
+    do {
+        std::string_view key;
+        std::string_view raw;
+        if (!cursor.string(key) || !cursor.eat(':') || !cursor.value(raw)) return false;
+        onMember(key, raw);
+    } while (cursor.eat(','));
+
+    return cursor.eat('}');
+}
+
+bool isNull(std::string_view raw) {
+    return raw.empty() || raw == "null";
+}
+
+std::string_view unquote(std::string_view raw) {
+    if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"') {
+        return raw.substr(1, raw.size() - 2);
+    }
+    return {};
+}
+
+// Algunas pools mandan los ids como cadena
+bool toUint(std::string_view raw, uint64_t& out) {
+    if (!raw.empty() && raw.front() == '"') raw = unquote(raw);
+    const auto [ptr, ec] = std::from_chars(raw.data(), raw.data() + raw.size(), out);
+    return ec == std::errc() && ptr == raw.data() + raw.size();
+}
+
+bool decodeJob(std::string_view object, MiningJob& job) {
+    std::string_view jobId;
+    std::string_view blob;
+    std::string_view target;
+    std::string_view seedHash;
+    std::string_view nextSeedHash;
+    uint64_t height = 0;
+
+    const bool wellFormed = forEachMember(object, [&](std::string_view key, std::string_view raw) {
+        if (key == "job_id") jobId = unquote(raw);
+        else if (key == "blob") blob = unquote(raw);
+        else if (key == "target") target = unquote(raw);
+        else if (key == "height") toUint(raw, height);
+        else if (key == "seed_hash") seedHash = unquote(raw);
+        else if (key == "next_seed_hash") nextSeedHash = unquote(raw);
+    });
+    if (!wellFormed || jobId.empty() || blob.empty() || target.empty()) return false;
+
+    // `job` es el trabajo en curso del cliente: sólo se toca cuando todo el mensaje es válido
+    NonceValidator::ShareTarget shareTarget;
+    try {
+        shareTarget = NonceValidator::ShareTarget::fromHex(target);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    const size_t blobSize = blob.size() / 2;
+    alignas(64) std::array<uint8_t, MiningJob::MAX_BLOB_SIZE> bytes;
+    if (blobSize > bytes.size() || !zartrux::hex::decode(blob, bytes.data())) {
+        return false;
+    }
+
+    std::memcpy(job.blob.data(), bytes.data(), blobSize);
+    job.blobSize = blobSize;
+    job.target = shareTarget;
+    job.id.assign(jobId);
+    job.targetHex.assign(target);
+    job.height = static_cast<uint32_t>(height);
+    job.seedHash.assign(seedHash);
+    job.nextSeedHash.assign(nextSeedHash);
+    return true;
+}
+
+} // namespace
+
+StratumParser::Result StratumParser::parse(std::string_view line, StratumMessage& message, MiningJob& job) {
+    message = StratumMessage{};
+
+    std::string_view method;
+    std::string_view params;
+    std::string_view result;
+    std::string_view error;
+    const bool wellFormed = forEachMember(line, [&](std::string_view key, std::string_view raw) {
+        if (key == "id") message.hasId = toUint(raw, message.id);
+        else if (key == "method") method = unquote(raw);
+        else if (key == "params") params = raw;
+        else if (key == "result") result = raw;
+        else if (key == "error") error = raw;
+    });
+    if (!wellFormed) return Result::Malformed;
+
+    if (method == "job") {
+        message.kind = StratumMessage::Kind::Job;
+        return decodeJob(params, job) ? Result::Ok : Result::BadJob;
+    }
+    if (!method.empty() || (!message.hasId && result.empty() && error.empty())) {
+        return Result::Ok;   // Unknown
+    }
+
+    message.kind = StratumMessage::Kind::Response;
+    if (!isNull(error)) {
+        message.error = error;
+        forEachMember(error, [&](std::string_view key, std::string_view raw) {
+            if (key == "message") message.error = unquote(raw);
+        });
+        return Result::Ok;
+    }
+
+    if (result == "true") {
+        message.ok = true;
+        return Result::Ok;
+    }
+
+    std::string_view jobObject;
+    if (!forEachMember(result, [&](std::string_view key, std::string_view raw) {
+            if (key == "status") message.status = unquote(raw);
+            else if (key == "id") message.sessionId = unquote(raw);
+            else if (key == "job") jobObject = raw;
+        })) {
+        return Result::Ok;   // result false, null o de otro tipo: no aceptado
+    }
+    // Hay pools que no mandan status en el login: basta con la sesión
+    message.ok = message.status == "OK" || (message.status.empty() && !message.sessionId.empty());
+
+    if (!isNull(jobObject)) {
+        message.hasJob = true;
+        if (!decodeJob(jobObject, job)) return Result::BadJob;
+    }
+    return Result::Ok;
+}
+
+bool StratumParser::parseRequest(std::string_view line, StratumRequest& request) {
+    request = StratumRequest{};
+
+    std::string_view method;
+    std::string_view params;
+    const bool wellFormed = forEachMember(line, [&](std::string_view key, std::string_view raw) {
+        if (key == "id") request.id = raw;
+        else if (key == "method") method = unquote(raw);
+        else if (key == "params") params = raw;
+    });
+    if (!wellFormed) return false;
+
+    if (method == "login") request.method = StratumRequest::Method::Login;
+    else if (method == "submit") request.method = StratumRequest::Method::Submit;
+    else if (method == "keepalived") request.method = StratumRequest::Method::Keepalived;
+
+    if (!isNull(params)) {
+        forEachMember(params, [&](std::string_view key, std::string_view raw) {
+            if (key == "login") request.login = unquote(raw);
+            else if (key == "pass") request.pass = unquote(raw);
+            else if (key == "agent") request.agent = unquote(raw);
+            else if (key == "id") request.sessionId = unquote(raw);
+            else if (key == "job_id") request.jobId = unquote(raw);
+            else if (key == "nonce") request.nonce = unquote(raw);
+            else if (key == "result") request.result = unquote(raw);
+        });
+    }
+    return true;
+}
+
+} // namespace zartrux::network
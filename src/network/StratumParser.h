@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "core/JobManager.h"
+
+namespace zartrux::network {
+
+/**
+ * @class LineBuffer
+ * @brief Buffer de recepción contiguo y reutilizable para protocolos por líneas.
+ *
+ * El socket escribe al final (prepare/commit) y nextLine() devuelve cada línea completa como
+ * string_view sobre el propio buffer, sin copiarla. El resto parcial se desplaza al principio
+ * sólo cuando falta hueco, así que en régimen estable no hay reservas ni copias por mensaje.
+ */
+class LineBuffer {
+public:
+    explicit LineBuffer(size_t capacity = 16 * 1024, size_t maxLine = 256 * 1024);
+
+    /**
+     * @brief Hueco para la siguiente lectura (al menos `minimum` bytes).
+     * @return Vacío si hay una línea sin terminar de más de maxLine bytes.
+     */
+    std::span<char> prepare(size_t minimum = 4096);
+    void commit(size_t bytes);
+
+    /**
+     * @brief Siguiente línea completa, sin '\n' ni '\r' final.
+     *        La vista es válida hasta la siguiente llamada a prepare() o clear().
+     */
+    std::optional<std::string_view> nextLine();
+
+    void clear();
+
+private:
+    std::vector<char> m_data;
+    size_t m_begin = 0;     // primer byte sin consumir
+    size_t m_end = 0;       // fin de los datos recibidos
+    size_t m_scanned = 0;   // hasta aquí ya se buscó '\n'
+    const size_t m_maxLine;
+};
+
+/**
+ * Mensaje Stratum reconocido. Las vistas apuntan a la línea de entrada.
+ */
+struct StratumMessage {
+    enum class Kind { Job, Response, Unknown };
+
+    Kind kind = Kind::Unknown;
+    bool hasId = false;
+    uint64_t id = 0;
+    bool ok = false;                // result true o status "OK", sin error
+    bool hasJob = false;            // respuesta de login con trabajo (decodificado en el MiningJob)
+    std::string_view status;
+    std::string_view sessionId;     // result.id del login
+    std::string_view error;         // error.message (o el error tal cual si no es un objeto)
+};
+
+/**
+ * Petición de un minero (modo proxy). Las vistas apuntan a la línea de entrada.
+ */
+struct StratumRequest {
+    enum class Method { Login, Submit, Keepalived, Unknown };
+
+    Method method = Method::Unknown;
+    std::string_view id;            // id tal cual (número o cadena con comillas) para repetirlo en la respuesta
+    std::string_view login;
+    std::string_view pass;
+    std::string_view agent;
+    std::string_view sessionId;     // params.id de submit y keepalived
+    std::string_view jobId;
+    std::string_view nonce;
+    std::string_view result;
+};
+
+/**
+ * @class StratumParser
+ * @brief Parser incremental para los mensajes Stratum (Monero) que usa el cliente:
+ *        notificación `job`, respuesta de `login` y respuesta de `submit`.
+ *
+ * Recorre el JSON una vez sin construir un DOM; los campos que no se usan se saltan.
+ * El blob y el target se decodifican (utils/Hex, SIMD) directamente en el MiningJob
+ * alineado que publica JobManager. Sólo reservan memoria las cadenas del MiningJob
+ * (id y semillas), que reutilizan su capacidad entre mensajes.
+ */
+class StratumParser {
+public:
+    enum class Result { Ok, Malformed, BadJob };
+
+    static Result parse(std::string_view line, StratumMessage& message, MiningJob& job);
+
+    /// Lado servidor: petición de un minero. false si no es un objeto JSON válido.
+    static bool parseRequest(std::string_view line, StratumRequest& request);
+};
+
+} // namespace zartrux::network
@@ -0,0 +1,437 @@
+#include "StratumProxy.h"
+#include "utils/Hex.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+namespace zartrux::network {
+
+namespace {
+
+constexpr size_t MAX_RECENT_JOBS = 4;
+constexpr auto SWEEP_INTERVAL = std::chrono::seconds(5);
+constexpr auto STATS_INTERVAL = std::chrono::seconds(60);
+constexpr size_t MAX_WORKER_NAME = 64;
+
+constexpr std::string_view NOTIFY_HEADER = R"({"jsonrpc":"2.0","method":"job","params":)";
+constexpr std::string_view BLOB_HEADER = R"({"blob":")";
+// Posición del prefijo dentro del objeto params: dos caracteres hex por byte
+constexpr size_t BLOB_PREFIX_OFFSET = BLOB_HEADER.size() + 2 * StratumProxy::PREFIX_BYTE;
+
+void patchPrefix(char* at, uint8_t prefix) {
+    static constexpr char digits[] = "0123456789abcdef";
+    at[0] = digits[prefix >> 4];
+    at[1] = digits[prefix & 0x0F];
+}
+
+std::string shareKey(std::string_view jobId, std::string_view nonce) {
+    std::string key;
+    key.reserve(jobId.size() + 1 + nonce.size());
+    key.append(jobId).append(1, ':').append(nonce);
+    return key;
+}
+
+} // namespace
+
+struct StratumProxy::Session {
+    explicit Session(asio::io_context& io_context) : socket(io_context) {}
+
+    tcp::socket socket;
+    LineBuffer recv{2048, 16 * 1024};
+    std::string outgoing;           // respuestas y trabajos pendientes de este ciclo
+    std::string writing;            // buffer del async_write en curso
+    bool flushScheduled = false;
+    bool writeInFlight = false;
+    bool open = false;
+    bool loggedIn = false;
+    uint8_t prefix = 0;
+    std::string id;                 // id de sesión que se le da al rig
+    std::string worker;
+    std::string remote;
+    Clock::time_point connectedAt;
+    Clock::time_point lastActivity;
+};
+
+StratumProxy::StratumProxy(asio::io_context& io_context, PoolFailover& upstream, Options options)
+    : m_io_context(io_context)
+    , m_upstream(upstream)
+    , m_options(std::move(options))
+    , m_acceptor(io_context)
+    , m_sweepTimer(io_context) {}
+
+StratumProxy::~StratumProxy() {
+    stop();
+}
+
+void StratumProxy::start() {
+    const tcp::endpoint endpoint(asio::ip::make_address(m_options.bindAddress), m_options.port);
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.set_option(tcp::acceptor::reuse_address(true));
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen(asio::socket_base::max_listen_connections);
+
+    m_running = true;
+    m_upstream.onNewJob = [this](const MiningJob& job) { onUpstreamJob(job); };
+    m_upstream.onShareResult = [this](const StratumClient::ShareResult& result) { onShareResult(result); };
+
+    Logger::info("StratumProxy", fmt::format("Proxy Stratum escuchando en {}:{} (hasta {} rigs)",
+                                             m_options.bindAddress, m_options.port,
+                                             std::min(m_options.maxConnections, MAX_SLOTS)));
+    m_nextStatsLog = Clock::now() + STATS_INTERVAL;
+    accept();
+    armSweep();
+}
+
+void StratumProxy::stop() {
+    if (!m_running) return;
+    m_running = false;
+
+    boost::system::error_code ec;
+    m_acceptor.close(ec);
+    m_sweepTimer.cancel();
+    for (auto& slot : m_slots) {
+        if (auto session = slot) {
+            close(session, "proxy detenido");
+        }
+    }
+    m_pending.clear();
+}
+
+StratumProxy::Stats StratumProxy::getStats() const {
+    Stats stats;
+    stats.connections = m_connections.load(std::memory_order_relaxed);
+    stats.miners = m_miners.load(std::memory_order_relaxed);
+    stats.jobs = m_jobsBroadcast.load(std::memory_order_relaxed);
+    stats.sharesForwarded = m_sharesForwarded.load(std::memory_order_relaxed);
+    stats.sharesAccepted = m_sharesAccepted.load(std::memory_order_relaxed);
+    stats.sharesRejected = m_sharesRejected.load(std::memory_order_relaxed);
+    stats.sharesInvalid = m_sharesInvalid.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StratumProxy::accept() {
+    auto session = std::make_shared<Session>(m_io_context);
+    m_acceptor.async_accept(session->socket, [this, session](const boost::system::error_code& ec) {
+        if (!m_running || ec == asio::error::operation_aborted) return;
+
+        if (ec) {
+            Logger::warn("StratumProxy", "Error al aceptar conexión: " + ec.message());
+        } else if (m_connections.load(std::memory_order_relaxed) >= std::min(m_options.maxConnections, MAX_SLOTS)) {
+            Logger::warn("StratumProxy", "Proxy lleno: no quedan prefijos de nonce libres");
+            boost::system::error_code ignored;
+            session->socket.close(ignored);
+        } else {
+            // Prefijo libre a partir del último asignado: uno recién liberado tarda en reutilizarse
+            size_t slot = m_nextSlot;
+            while (m_slots[slot]) {
+                slot = (slot + 1) % MAX_SLOTS;
+            }
+            m_nextSlot = (slot + 1) % MAX_SLOTS;
+            m_slots[slot] = session;
+            m_connections.fetch_add(1, std::memory_order_relaxed);
+
+            boost::system::error_code ignored;
+            session->socket.set_option(tcp::no_delay(true), ignored);
+            const auto remote = session->socket.remote_endpoint(ignored);
+            session->remote = ignored ? std::string("?") : fmt::format("{}:{}", remote.address().to_string(), remote.port());
+            session->prefix = static_cast<uint8_t>(slot);
+            session->open = true;
+            session->connectedAt = session->lastActivity = Clock::now();
+            read(session);
+        }
+        accept();
+    });
+}
+
+void StratumProxy::read(const std::shared_ptr<Session>& session) {
+    auto buffer = session->recv.prepare(1024);
+    if (buffer.empty()) {
+        close(session, "línea demasiado larga");
+        return;
+    }
+
+    session->socket.async_read_some(asio::buffer(buffer.data(), buffer.size()),
+        [this, session](const boost::system::error_code& ec, size_t bytes) {
+            if (ec || bytes == 0) {
+                close(session, ec == asio::error::eof ? "conexión cerrada" : ec.message());
+                return;
+            }
+
+            session->recv.commit(bytes);
+            session->lastActivity = Clock::now();
+            while (session->open) {
+                auto line = session->recv.nextLine();
+                if (!line) break;
+                if (!line->empty()) handleLine(session, *line);
+            }
+            if (session->open) read(session);
+        });
+}
+
+void StratumProxy::handleLine(const std::shared_ptr<Session>& session, std::string_view line) {
+    StratumRequest request;
+    if (!StratumParser::parseRequest(line, request)) {
+        close(session, "JSON no válido");
+        return;
+    }
+
+    switch (request.method) {
+        case StratumRequest::Method::Login:
+            handleLogin(session, request);
+            break;
+        case StratumRequest::Method::Submit:
+            handleSubmit(session, request);
+            break;
+        case StratumRequest::Method::Keepalived:
+            reply(session, request.id, R"({"status":"KEEPALIVED"})");
+            break;
+        case StratumRequest::Method::Unknown:
+            replyError(session, request.id, "Método no soportado");
+            break;
+    }
+}
+
+void StratumProxy::handleLogin(const std::shared_ptr<Session>& session, const StratumRequest& request) {
+    if (m_jobParams.empty()) {
+        replyError(session, request.id, "El proxy aún no tiene trabajo de la pool");
+        return;
+    }
+
+    if (!session->loggedIn) {
+        session->loggedIn = true;
+        m_miners.fetch_add(1, std::memory_order_relaxed);
+    }
+    session->worker.assign(request.login.substr(0, MAX_WORKER_NAME));
+    session->id = fmt::format("{:x}-{:02x}", ++m_sessionCounter, session->prefix);
+
+    // El rig tiene que mantener el byte del prefijo: se anuncia la extensión "nicehash"
+    std::string result;
+    result.reserve(m_jobParams.size() + 96);
+    result.append(R"({"id":")").append(session->id).append(R"(","job":)");
+    const size_t paramsAt = result.size();
+    result.append(m_jobParams);
+    patchPrefix(result.data() + paramsAt + BLOB_PREFIX_OFFSET, session->prefix);
+    result.append(R"(,"extensions":["nicehash","keepalive"],"status":"OK"})");
+    reply(session, request.id, result);
+
+    Logger::info("StratumProxy", fmt::format("Rig {} conectado desde {} (prefijo {:02x})",
+                                             session->worker, session->remote, session->prefix));
+}
+
+void StratumProxy::handleSubmit(const std::shared_ptr<Session>& session, const StratumRequest& request) {
+    if (!session->loggedIn || request.sessionId != session->id) {
+        replyError(session, request.id, "Unauthenticated");
+        return;
+    }
+
+    uint8_t nonce[4];
+    if (request.nonce.size() != 8 || !zartrux::hex::decode(request.nonce, nonce) || request.result.size() != 64) {
+        m_sharesInvalid.fetch_add(1, std::memory_order_relaxed);
+        replyError(session, request.id, "Nonce o resultado no válidos");
+        return;
+    }
+    if (nonce[3] != session->prefix) {
+        m_sharesInvalid.fetch_add(1, std::memory_order_relaxed);
+        replyError(session, request.id, "Nonce fuera del rango asignado (falta el modo nicehash)");
+        return;
+    }
+
+    auto job = std::find_if(m_jobs.begin(), m_jobs.end(),
+                            [&](const UpstreamJob& candidate) { return candidate.id == request.jobId; });
+    if (job == m_jobs.end()) {
+        m_sharesInvalid.fetch_add(1, std::memory_order_relaxed);
+        replyError(session, request.id, "Block expired");
+        return;
+    }
+    const uint32_t value = static_cast<uint32_t>(nonce[0]) | (static_cast<uint32_t>(nonce[1]) << 8) |
+                           (static_cast<uint32_t>(nonce[2]) << 16) | (static_cast<uint32_t>(nonce[3]) << 24);
+    if (!job->nonces.insert(value).second) {
+        m_sharesInvalid.fetch_add(1, std::memory_order_relaxed);
+        replyError(session, request.id, "Duplicate share");
+        return;
+    }
+
+    // La respuesta al rig sale cuando la pool conteste (onShareResult)
+    m_pending.insert_or_assign(shareKey(request.jobId, request.nonce),
+                               PendingShare{session, std::string(request.id), Clock::now()});
+    m_sharesForwarded.fetch_add(1, std::memory_order_relaxed);
+    m_upstream.submit(std::string(request.jobId), std::string(request.nonce), std::string(request.result));
+}
+
+void StratumProxy::close(const std::shared_ptr<Session>& session, std::string_view reason) {
+    if (!session->open) return;
+    session->open = false;
+
+    boost::system::error_code ignored;
+    session->socket.shutdown(tcp::socket::shutdown_both, ignored);
+    session->socket.close(ignored);
+    if (m_slots[session->prefix] == session) {
+        m_slots[session->prefix].reset();
+    }
+    m_connections.fetch_sub(1, std::memory_order_relaxed);
+    if (session->loggedIn) {
+        m_miners.fetch_sub(1, std::memory_order_relaxed);
+        Logger::info("StratumProxy", fmt::format("Rig {} ({}) desconectado: {}",
+                                                 session->worker, session->remote, reason));
+    }
+}
+
+void StratumProxy::reply(const std::shared_ptr<Session>& session, std::string_view id, std::string_view result) {
+    std::string message;
+    message.reserve(result.size() + id.size() + 48);
+    message.append(R"({"id":)").append(id.empty() ? std::string_view("null") : id);
+    message.append(R"(,"jsonrpc":"2.0","error":null,"result":)").append(result).append("}\n");
+    write(session, message);
+}
+
+void StratumProxy::replyError(const std::shared_ptr<Session>& session, std::string_view id, std::string_view message) {
+    // El texto puede venir de la pool: se escapa con nlohmann
+    write(session, fmt::format(R"({{"id":{},"jsonrpc":"2.0","error":{{"code":-1,"message":{}}},"result":null}})" "\n",
+                               id.empty() ? std::string_view("null") : id,
+                               nlohmann::json(std::string(message)).dump()));
+}
+
+void StratumProxy::write(const std::shared_ptr<Session>& session, std::string_view message) {
+    if (!session->open) return;
+    if (session->outgoing.size() + message.size() > m_options.maxOutgoingBytes) {
+        close(session, "no lee lo que se le envía");
+        return;
+    }
+
+    session->outgoing.append(message);
+    if (session->writeInFlight || session->flushScheduled) return;
+
+    // Lo que se encole en este ciclo (respuestas y trabajo nuevo) sale en un solo async_write
+    session->flushScheduled = true;
+    asio::post(m_io_context, [this, session] {
+        session->flushScheduled = false;
+        flush(session);
+    });
+}
+
+void StratumProxy::flush(const std::shared_ptr<Session>& session) {
+    if (!session->open || session->writeInFlight || session->outgoing.empty()) return;
+
+    session->writing.clear();
+    session->writing.swap(session->outgoing);
+    session->writeInFlight = true;
+    asio::async_write(session->socket, asio::buffer(session->writing),
+        [this, session](const boost::system::error_code& ec, size_t) {
+            session->writeInFlight = false;
+            if (ec) {
+                close(session, ec.message());
+                return;
+            }
+            flush(session);
+        });
+}
+
+void StratumProxy::onUpstreamJob(const MiningJob& job) {
+    if (job.blobSize <= PREFIX_BYTE) {
+        Logger::warn("StratumProxy", "Trabajo con un blob demasiado corto para repartir nonces: " + job.id);
+        return;
+    }
+
+    const std::string blob = zartrux::hex::encode(job.blob.data(), job.blobSize);
+    m_jobParams = fmt::format(R"({}{}","job_id":"{}","target":"{}","height":{},"seed_hash":"{}")",
+                              BLOB_HEADER, blob, job.id, job.targetHex, job.height, job.seedHash);
+    if (!job.nextSeedHash.empty()) {
+        m_jobParams += fmt::format(R"(,"next_seed_hash":"{}")", job.nextSeedHash);
+    }
+    m_jobParams += '}';
+
+    m_jobNotify.assign(NOTIFY_HEADER).append(m_jobParams).append("}\n");
+    m_notifyPrefixOffset = NOTIFY_HEADER.size() + BLOB_PREFIX_OFFSET;
+
+    if (m_jobs.empty() || m_jobs.back().id != job.id) {
+        m_jobs.push_back(UpstreamJob{job.id, {}});
+        if (m_jobs.size() > MAX_RECENT_JOBS) {
+            m_jobs.pop_front();
+        }
+    }
+
+    m_jobsBroadcast.fetch_add(1, std::memory_order_relaxed);
+    for (const auto& session : m_slots) {
+        if (session && session->loggedIn) {
+            sendJob(session);
+        }
+    }
+}
+
+void StratumProxy::sendJob(const std::shared_ptr<Session>& session) {
+    // Se copia la notificación común y se parchea el prefijo en el propio buffer de salida
+    const size_t start = session->outgoing.size();
+    write(session, m_jobNotify);
+    if (session->open && session->outgoing.size() >= start + m_jobNotify.size()) {
+        patchPrefix(session->outgoing.data() + start + m_notifyPrefixOffset, session->prefix);
+    }
+}
+
+void StratumProxy::onShareResult(const StratumClient::ShareResult& result) {
+    auto it = m_pending.find(shareKey(result.jobId, result.nonceHex));
+    if (it == m_pending.end()) return;
+
+    auto session = it->second.session.lock();
+    const std::string requestId = std::move(it->second.requestId);
+    m_pending.erase(it);
+
+    const bool accepted = result.outcome == StratumClient::ShareOutcome::Accepted;
+    (accepted ? m_sharesAccepted : m_sharesRejected).fetch_add(1, std::memory_order_relaxed);
+    if (!session || !session->open) return;
+
+    if (accepted) {
+        reply(session, requestId, R"({"status":"OK"})");
+    } else {
+        replyError(session, requestId, result.reason.empty() ? "Share rechazada por la pool" : result.reason);
+    }
+}
+
+void StratumProxy::armSweep() {
+    m_sweepTimer.expires_after(SWEEP_INTERVAL);
+    m_sweepTimer.async_wait([this](const boost::system::error_code& ec) {
+        if (!ec && m_running) {
+            sweep();
+            armSweep();
+        }
+    });
+}
+
+void StratumProxy::sweep() {
+    const auto now = Clock::now();
+
+    // Un solo temporizador para todas las sesiones: escala a miles de conexiones
+    for (const auto& slot : m_slots) {
+        auto session = slot;
+        if (!session) continue;
+        if (!session->loggedIn && now - session->connectedAt > m_options.loginTimeout) {
+            close(session, "sin login");
+        } else if (session->loggedIn && now - session->lastActivity > m_options.idleTimeout) {
+            close(session, "inactivo");
+        }
+    }
+
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (now - it->second.forwardedAt <= m_options.shareTimeout) {
+            ++it;
+            continue;
+        }
+        m_sharesRejected.fetch_add(1, std::memory_order_relaxed);
+        if (auto session = it->second.session.lock(); session && session->open) {
+            replyError(session, it->second.requestId, "La pool no respondió a la share");
+        }
+        it = m_pending.erase(it);
+    }
+
+    if (now >= m_nextStatsLog) {
+        m_nextStatsLog = now + STATS_INTERVAL;
+        const Stats stats = getStats();
+        Logger::info("StratumProxy", fmt::format(
+            "{} rigs ({} conexiones), {} trabajos, shares: {} enviadas, {} aceptadas, {} rechazadas, {} inválidas",
+            stats.miners, stats.connections, stats.jobs, stats.sharesForwarded,
+            stats.sharesAccepted, stats.sharesRejected, stats.sharesInvalid));
+    }
+}
+
+} // namespace zartrux::network
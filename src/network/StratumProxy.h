@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/asio.hpp>
+
+#include "network/PoolFailover.h"
+#include "network/StratumParser.h"
+
+namespace zartrux::network {
+
+/**
+ * @class StratumProxy
+ * @brief Modo proxy: los rigs se conectan por Stratum a este proceso, que mantiene una sola
+ *        sesión con la pool (PoolFailover) y les reparte el espacio de nonces.
+ *
+ * Cada rig recibe un prefijo fijo en el byte alto del nonce (byte 42 del blob, modo "nicehash"
+ * de xmrig): el rig sólo recorre los 24 bits bajos y las shares de todos van a la pool por la
+ * misma sesión sin solaparse. Por eso el límite es de 256 rigs por sesión de pool.
+ *
+ * Todo corre en el hilo del io_context (sin locks): la notificación de trabajo se serializa una
+ * vez por trabajo y a cada rig sólo se le parchean los dos caracteres hex de su prefijo.
+ */
+class StratumProxy {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t NONCE_OFFSET = 39;                  // nonce de Monero en el blob
+    static constexpr size_t PREFIX_BYTE = NONCE_OFFSET + 3;     // byte alto del nonce (little-endian)
+    static constexpr size_t MAX_SLOTS = 256;
+
+    struct Options {
+        std::string bindAddress = "0.0.0.0";
+        uint16_t port = 3333;
+        size_t maxConnections = MAX_SLOTS;
+        std::chrono::seconds loginTimeout{30};
+        std::chrono::seconds idleTimeout{600};
+        std::chrono::seconds shareTimeout{60};      // sin resultado de la pool se responde con error
+        size_t maxOutgoingBytes = 1 << 20;          // un rig que no lee se desconecta
+    };
+
+    struct Stats {
+        size_t connections{0};
+        size_t miners{0};               // con login
+        uint64_t jobs{0};
+        uint64_t sharesForwarded{0};
+        uint64_t sharesAccepted{0};
+        uint64_t sharesRejected{0};     // por la pool (incluye caducadas y sin respuesta)
+        uint64_t sharesInvalid{0};      // rechazadas en el proxy: prefijo ajeno, trabajo desconocido, duplicadas
+    };
+
+    StratumProxy(asio::io_context& io_context, PoolFailover& upstream, Options options);
+    ~StratumProxy();
+
+    // Abre el puerto y toma los callbacks de trabajo y resultados de PoolFailover
+    void start();
+    void stop();
+
+    Stats getStats() const;
+
+private:
+    struct Session;
+
+    // Trabajos recientes de la pool: las shares de un trabajo anterior siguen valiendo un rato
+    struct UpstreamJob {
+        std::string id;
+        std::unordered_set<uint32_t> nonces;    // para rechazar duplicadas sin molestar a la pool
+    };
+
+    struct PendingShare {
+        std::weak_ptr<Session> session;
+        std::string requestId;
+        Clock::time_point forwardedAt;
+    };
+
+    void accept();
+    void read(const std::shared_ptr<Session>& session);
+    void handleLine(const std::shared_ptr<Session>& session, std::string_view line);
+    void handleLogin(const std::shared_ptr<Session>& session, const StratumRequest& request);
+    void handleSubmit(const std::shared_ptr<Session>& session, const StratumRequest& request);
+    void close(const std::shared_ptr<Session>& session, std::string_view reason);
+
+    void reply(const std::shared_ptr<Session>& session, std::string_view id, std::string_view result);
+    void replyError(const std::shared_ptr<Session>& session, std::string_view id, std::string_view message);
+    void write(const std::shared_ptr<Session>& session, std::string_view message);
+    void flush(const std::shared_ptr<Session>& session);
+
+    void onUpstreamJob(const MiningJob& job);
+    void onShareResult(const StratumClient::ShareResult& result);
+    void sendJob(const std::shared_ptr<Session>& session);
+
+    void armSweep();
+    void sweep();
+
+    asio::io_context& m_io_context;
+    PoolFailover& m_upstream;
+    const Options m_options;
+    tcp::acceptor m_acceptor;
+    asio::steady_timer m_sweepTimer;
+    bool m_running = false;
+
+    // Un rig por prefijo; el siguiente se busca a partir del último asignado
+    std::array<std::shared_ptr<Session>, MAX_SLOTS> m_slots;
+    size_t m_nextSlot = 0;
+    uint64_t m_sessionCounter = 0;
+
+    // Trabajo actual ya serializado; el prefijo se escribe sobre una copia para cada rig
+    std::string m_jobParams;        // objeto params (también va dentro de la respuesta al login)
+    std::string m_jobNotify;        // notificación completa terminada en '\n'
+    size_t m_notifyPrefixOffset = 0;
+    std::deque<UpstreamJob> m_jobs;
+    std::unordered_map<std::string, PendingShare> m_pending;    // "job_id:nonce"
+
+    Clock::time_point m_nextStatsLog;
+    std::atomic<size_t> m_connections{0};
+    std::atomic<size_t> m_miners{0};
+    std::atomic<uint64_t> m_jobsBroadcast{0};
+    std::atomic<uint64_t> m_sharesForwarded{0};
+    std::atomic<uint64_t> m_sharesAccepted{0};
+    std::atomic<uint64_t> m_sharesRejected{0};
+    std::atomic<uint64_t> m_sharesInvalid{0};
+};
+
+} // namespace zartrux::network
@@ -0,0 +1,252 @@
+#include "JitSymbols.h"
+#include "utils/Logger.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace zartrux::runtime {
+
+std::atomic<bool> JitSymbols::s_enabled{false};
+
+namespace {
+
+#if defined(__linux__)
+
+// Formato jitdump de perf (tools/perf/Documentation/jitdump-specification.txt)
+constexpr uint32_t JITDUMP_MAGIC = 0x4A695444;
+constexpr uint32_t JITDUMP_VERSION = 1;
+constexpr uint32_t JIT_CODE_LOAD = 0;
+constexpr uint32_t JIT_CODE_CLOSE = 3;
+
+struct JitdumpHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t totalSize;
+    uint32_t elfMach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+};
+
+struct JitdumpRecord {
+    uint32_t id;
+    uint32_t totalSize;
+    uint64_t timestamp;
+};
+
+struct JitdumpCodeLoad {
+    JitdumpRecord record;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t codeAddress;
+    uint64_t codeSize;
+    uint64_t codeIndex;
+    // a continuación: nombre terminado en '\0' y los bytes del código
+};
+
+// perf record -k mono usa el mismo reloj
+uint64_t monotonicNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint32_t elfMachine() {
+#if defined(__x86_64__)
+    return 62;      // EM_X86_64
+#elif defined(__aarch64__)
+    return 183;     // EM_AARCH64
+#else
+    return 0;
+#endif
+}
+
+#endif
+
+struct State {
+    std::mutex mutex;
+    JitSymbols::Options options;
+    FILE* perfMap = nullptr;
+    int jitdump = -1;
+    void* jitdumpMarker = nullptr;
+    size_t markerSize = 0;
+    uint64_t codeIndex = 0;
+    std::set<std::tuple<uintptr_t, size_t, std::string>> regions;
+
+    // Ventana de un segundo para los cuerpos de programa
+    std::atomic<uint64_t> windowStart{0};
+    std::atomic<unsigned> windowCount{0};
+};
+
+State& state() {
+    static State instance;
+    return instance;
+}
+
+// Con el mutex tomado
+void writeEntry(State& s, const void* start, size_t size, const std::string& name) {
+    const uint64_t index = s.codeIndex++;
+    if (s.perfMap) {
+        std::fprintf(s.perfMap, "%" PRIxPTR " %zx %s\n", reinterpret_cast<uintptr_t>(start), size, name.c_str());
+        std::fflush(s.perfMap);
+    }
+
+#if defined(__linux__)
+    if (s.jitdump >= 0) {
+        JitdumpCodeLoad load{};
+        load.record.id = JIT_CODE_LOAD;
+        load.record.totalSize = static_cast<uint32_t>(sizeof(load) + name.size() + 1 + size);
+        load.record.timestamp = monotonicNs();
+        load.pid = static_cast<uint32_t>(getpid());
+        load.tid = static_cast<uint32_t>(syscall(SYS_gettid));
+        load.vma = reinterpret_cast<uintptr_t>(start);
+        load.codeAddress = load.vma;
+        load.codeSize = size;
+        load.codeIndex = index;
+
+        std::vector<uint8_t> buffer(load.record.totalSize);
+        std::memcpy(buffer.data(), &load, sizeof(load));
+        std::memcpy(buffer.data() + sizeof(load), name.c_str(), name.size() + 1);
+        std::memcpy(buffer.data() + sizeof(load) + name.size() + 1, start, size);
+        if (write(s.jitdump, buffer.data(), buffer.size()) != static_cast<ssize_t>(buffer.size())) {
+            Logger::warn("JitSymbols", "Escritura jitdump incompleta; se desactiva");
+            close(s.jitdump);
+            s.jitdump = -1;
+        }
+    }
+#else
+    (void)index;
+#endif
+}
+
+void closeFiles(State& s) {
+    if (s.perfMap) {
+        std::fclose(s.perfMap);
+        s.perfMap = nullptr;
+    }
+#if defined(__linux__)
+    if (s.jitdump >= 0) {
+        JitdumpRecord record{JIT_CODE_CLOSE, sizeof(JitdumpRecord), monotonicNs()};
+        (void)!write(s.jitdump, &record, sizeof(record));
+        if (s.jitdumpMarker) munmap(s.jitdumpMarker, s.markerSize);
+        close(s.jitdump);
+        s.jitdump = -1;
+        s.jitdumpMarker = nullptr;
+    }
+#endif
+}
+
+} // namespace
+
+void JitSymbols::configure(const Options& options) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s_enabled.store(false);
+    closeFiles(s);
+    s.regions.clear();
+    s.options = options;
+
+#if defined(__linux__)
+    const std::string pid = std::to_string(getpid());
+
+    if (options.perfMap) {
+        const std::string path = "/tmp/perf-" + pid + ".map";
+        s.perfMap = std::fopen(path.c_str(), "w");
+        if (s.perfMap) {
+            Logger::info("JitSymbols", "Símbolos JIT en " + path);
+        } else {
+            Logger::warn("JitSymbols", "No se pudo crear " + path);
+        }
+    }
+
+    if (options.jitdump) {
+        const std::string path = "/tmp/jit-" + pid + ".dump";
+        s.jitdump = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0644);
+        if (s.jitdump >= 0) {
+            JitdumpHeader header{JITDUMP_MAGIC, JITDUMP_VERSION, sizeof(JitdumpHeader), elfMachine(), 0,
+                                 static_cast<uint32_t>(getpid()), monotonicNs(), 0};
+            // perf record localiza el fichero por este mapeo ejecutable
+            s.markerSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            void* marker = MAP_FAILED;
+            if (write(s.jitdump, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header))) {
+                marker = mmap(nullptr, s.markerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, s.jitdump, 0);
+            }
+            if (marker != MAP_FAILED) {
+                s.jitdumpMarker = marker;
+                Logger::info("JitSymbols", "Registros jitdump en " + path + " (perf record -k mono)");
+            } else {
+                Logger::warn("JitSymbols", "No se pudo preparar " + path);
+                close(s.jitdump);
+                s.jitdump = -1;
+            }
+        } else {
+            Logger::warn("JitSymbols", "No se pudo crear " + path);
+        }
+    }
+
+    s_enabled.store(s.perfMap != nullptr || s.jitdump >= 0);
+#else
+    if (options.perfMap || options.jitdump) {
+        Logger::warn("JitSymbols", "perf-map y jitdump sólo están disponibles en Linux");
+    }
+#endif
+}
+
+void JitSymbols::shutdown() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s_enabled.store(false);
+    closeFiles(s);
+}
+
+void JitSymbols::region(const void* start, size_t size, const char* name) {
+    if (!enabled() || size == 0) return;
+
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.regions.emplace(reinterpret_cast<uintptr_t>(start), size, name).second) return;
+    writeEntry(s, start, size, name);
+}
+
+void JitSymbols::program(const void* start, size_t size, const char* name) {
+    if (!enabled() || size == 0) return;
+
+    auto& s = state();
+    const unsigned limit = s.options.programsPerSecond;
+    if (limit == 0) return;
+
+#if defined(__linux__)
+    // Ventana de un segundo sin mutex: el caso común (límite alcanzado) no bloquea a los workers
+    const uint64_t now = monotonicNs();
+    uint64_t window = s.windowStart.load(std::memory_order_relaxed);
+    if (now - window >= 1000000000ull &&
+        s.windowStart.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        s.windowCount.store(0, std::memory_order_relaxed);
+    }
+    if (s.windowCount.fetch_add(1, std::memory_order_relaxed) >= limit) return;
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    writeEntry(s, start, size, std::string(name) + "_" + std::to_string(s.codeIndex));
+#else
+    (void)start;
+    (void)name;
+#endif
+}
+
+} // namespace zartrux::runtime
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace zartrux::runtime {
+
+/**
+ * @class JitSymbols
+ * @brief Símbolos del código JIT de RandomX para `perf`: entradas en /tmp/perf-<pid>.map y,
+ *        opcionalmente, registros jitdump en /tmp/jit-<pid>.dump (`perf record -k mono` +
+ *        `perf inject --jit`, que además permite anotar el código generado).
+ *
+ * Desactivado por defecto. Las regiones estables (prólogo, epílogo, init del dataset y
+ * hash superescalar) se escriben una vez por dirección. Los cuerpos de programa se regeneran
+ * 8 veces por hash en cada VM, así que se limitan a `programsPerSecond` registros por
+ * segundo en todo el proceso; el resto se descarta sin tocar el fichero.
+ */
+class JitSymbols {
+public:
+    struct Options {
+        bool perfMap = false;
+        bool jitdump = false;
+        unsigned programsPerSecond = 10;    // 0 = sólo regiones estables
+    };
+
+    /**
+     * @brief Abre los ficheros pedidos. Llamar antes de crear las VMs; sin efecto fuera de Linux.
+     */
+    static void configure(const Options& options);
+
+    /**
+     * @brief Cierra los ficheros (los registros ya escritos se conservan para perf).
+     */
+    static void shutdown();
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Región de código que no cambia mientras vive el buffer JIT.
+     * @param start Dirección desde la que se ejecuta (vista RX).
+     */
+    static void region(const void* start, size_t size, const char* name);
+
+    /**
+     * @brief Cuerpo de un programa recién generado; sujeto al límite de registros por segundo.
+     */
+    static void program(const void* start, size_t size, const char* name);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+} // namespace zartrux::runtime
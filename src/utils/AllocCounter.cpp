@@ -0,0 +1,77 @@
+#include "AllocCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace zartrux {
+
+#ifndef ZARTRUX_DISABLE_ALLOC_COUNTER
+namespace {
+    thread_local uint64_t t_allocations = 0;
+
+    void* countedAlloc(std::size_t size)
+    {
+        ++t_allocations;
+        if (size == 0) size = 1;
+        if (void* p = std::malloc(size)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* countedAlignedAlloc(std::size_t size, std::align_val_t align)
+    {
+        ++t_allocations;
+        if (size == 0) size = 1;
+        void* p = nullptr;
+#       ifdef _WIN32
+        p = _aligned_malloc(size, static_cast<std::size_t>(align));
+#       else
+        if (posix_memalign(&p, static_cast<std::size_t>(align), size) != 0) {
+            p = nullptr;
+        }
+#       endif
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    void alignedFree(void* p) noexcept
+    {
+#       ifdef _WIN32
+        _aligned_free(p);
+#       else
+        std::free(p);
+#       endif
+    }
+} // namespace
+
+uint64_t AllocCounter::threadAllocations() noexcept
+{
+    return t_allocations;
+}
+#else
+uint64_t AllocCounter::threadAllocations() noexcept
+{
+    return 0;
+}
+#endif
+
+} // namespace zartrux
+
+#ifndef ZARTRUX_DISABLE_ALLOC_COUNTER
+void* operator new(std::size_t size) { return zartrux::countedAlloc(size); }
+void* operator new[](std::size_t size) { return zartrux::countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return zartrux::countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return zartrux::countedAlignedAlloc(size, align); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { zartrux::alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { zartrux::alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { zartrux::alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { zartrux::alignedFree(p); }
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+namespace zartrux {
+
+/**
+ * Contador de reservas de heap por hilo.
+ *
+ * Sustituye los operator new/delete globales (ver AllocCounter.cpp) para contar
+ * cuántas reservas hace cada hilo. Los workers lo muestrean alrededor del bucle
+ * de hash para verificar que el camino estacionario no reserva memoria.
+ * Se desactiva compilando con ZARTRUX_DISABLE_ALLOC_COUNTER; en ese caso
+ * threadAllocations() devuelve siempre 0.
+ */
+class AllocCounter
+{
+public:
+    /// Reservas de heap realizadas por el hilo actual desde su creación.
+    static uint64_t threadAllocations() noexcept;
+
+    /// true si los operadores globales están instrumentados en este binario.
+    static constexpr bool enabled()
+    {
+#       ifdef ZARTRUX_DISABLE_ALLOC_COUNTER
+        return false;
+#       else
+        return true;
+#       endif
+    }
+};
+
+} // namespace zartrux
@@ -0,0 +1,153 @@
+#include "Hex.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#   include <emmintrin.h>
+#   define ZARTRUX_HEX_SSE2 1
+#endif
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#endif
+
+namespace zartrux::hex {
+
+namespace {
+
+constexpr int8_t INVALID = -1;
+
+constexpr int8_t nibble(char c)
+{
+    if (c >= '0' && c <= '9') return static_cast<int8_t>(c - '0');
+    if (c >= 'a' && c <= 'f') return static_cast<int8_t>(c - 'a' + 10);
+    if (c >= 'A' && c <= 'F') return static_cast<int8_t>(c - 'A' + 10);
+    return INVALID;
+}
+
+#ifdef ZARTRUX_HEX_SSE2
+// 16 caracteres ASCII → 16 nibbles; `valid` queda a 0xFF en los carriles correctos.
+// Las comparaciones son con signo: los bytes >= 0x80 quedan por debajo de '0' y se rechazan.
+inline __m128i nibbles16(__m128i chars, __m128i& valid)
+{
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                          _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+
+    const __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    const __m128i alpha = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+    const __m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                          _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    valid = _mm_or_si128(isDigit, isAlpha);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit), _mm_and_si128(isAlpha, alpha));
+}
+
+// Pares (alto, bajo) de cada carril de 16 bits → byte en la parte baja del carril
+inline __m128i combine16(__m128i nibbles)
+{
+    const __m128i high = _mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00F0));
+    return _mm_or_si128(high, _mm_srli_epi16(nibbles, 8));
+}
+
+// 32 caracteres → 16 bytes
+inline bool decode32(const char* in, uint8_t* out)
+{
+    __m128i validA;
+    __m128i validB;
+    const __m128i a = nibbles16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), validA);
+    const __m128i b = nibbles16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), validB);
+    if (_mm_movemask_epi8(_mm_and_si128(validA, validB)) != 0xFFFF) {
+        return false;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(combine16(a), combine16(b)));
+    return true;
+}
+#endif
+
+#ifdef __AVX2__
+inline __m256i nibbles32(__m256i chars, __m256i& valid)
+{
+    const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)),
+                                             _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+
+    const __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+    const __m256i alpha = _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10));
+    const __m256i isAlpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                             _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+
+    valid = _mm256_or_si256(isDigit, isAlpha);
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digit), _mm256_and_si256(isAlpha, alpha));
+}
+
+// 64 caracteres → 32 bytes (un hash o un seed_hash de una pasada)
+inline bool decode64(const char* in, uint8_t* out)
+{
+    __m256i validA;
+    __m256i validB;
+    const __m256i a = nibbles32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), validA);
+    const __m256i b = nibbles32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 32)), validB);
+    if (_mm256_movemask_epi8(_mm256_and_si256(validA, validB)) != -1) {
+        return false;
+    }
+
+    // maddubs: alto·16 + bajo en cada carril de 16 bits; packus intercala por mitades de 128
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(packed, 0xD8));
+    return true;
+}
+#endif
+
+} // namespace
+
+bool decodeScalar(std::string_view hex, uint8_t* out)
+{
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < hex.size() / 2; ++i) {
+        const int8_t high = nibble(hex[2 * i]);
+        const int8_t low = nibble(hex[2 * i + 1]);
+        if (high == INVALID || low == INVALID) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+bool decode(std::string_view hex, uint8_t* out)
+{
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+
+    size_t pos = 0;
+#ifdef __AVX2__
+    for (; pos + 64 <= hex.size(); pos += 64) {
+        if (!decode64(hex.data() + pos, out + pos / 2)) {
+            return false;
+        }
+    }
+#endif
+#ifdef ZARTRUX_HEX_SSE2
+    for (; pos + 32 <= hex.size(); pos += 32) {
+        if (!decode32(hex.data() + pos, out + pos / 2)) {
+            return false;
+        }
+    }
+#endif
+    return decodeScalar(hex.substr(pos), out + pos / 2);
+}
+
+std::string encode(const uint8_t* data, size_t size)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string result(size * 2, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        result[2 * i] = digits[data[i] >> 4];
+        result[2 * i + 1] = digits[data[i] & 0x0F];
+    }
+    return result;
+}
+
+} // namespace zartrux::hex
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace zartrux::hex {
+
+/**
+ * Decodifica hex (mayúsculas o minúsculas) en `out`, que debe tener hex.size() / 2 bytes.
+ * En x86-64 procesa 32 caracteres por iteración con SSE2 (AVX2 si se compila con -mavx2);
+ * el resto, y las demás arquitecturas, van por la ruta escalar. No reserva memoria.
+ * @return false si la longitud es impar o hay algún carácter no hexadecimal.
+ */
+bool decode(std::string_view hex, uint8_t* out);
+
+/// Ruta escalar de referencia (la usa decode() para la cola y fuera de x86).
+bool decodeScalar(std::string_view hex, uint8_t* out);
+
+/// Codifica en hex minúsculas.
+std::string encode(const uint8_t* data, size_t size);
+
+} // namespace zartrux::hex
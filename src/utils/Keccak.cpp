@@ -0,0 +1,94 @@
+#include "Keccak.h"
+
+#include <cstring>
+
+namespace zartrux::keccak {
+
+namespace {
+
+constexpr size_t RATE = 136;    // 1600 - 2 * 256 bits
+
+constexpr uint64_t ROUND_CONSTANTS[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+constexpr unsigned ROTATIONS[24] = {
+    1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44,
+};
+
+constexpr unsigned PI_LANES[24] = {
+    10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1,
+};
+
+inline uint64_t rotl(uint64_t value, unsigned bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Las palabras del estado son little-endian, como en el resto del minero (sólo x86/ARM LE)
+inline void absorb(uint64_t state[25], const uint8_t* block, size_t size) {
+    for (size_t i = 0; i < size / 8; ++i) {
+        uint64_t word;
+        std::memcpy(&word, block + 8 * i, sizeof(word));
+        state[i] ^= word;
+    }
+}
+
+} // namespace
+
+void permute(uint64_t state[25]) {
+    uint64_t c[5];
+    for (unsigned round = 0; round < 24; ++round) {
+        // Theta
+        for (unsigned x = 0; x < 5; ++x) {
+            c[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^ state[x + 20];
+        }
+        for (unsigned x = 0; x < 5; ++x) {
+            const uint64_t d = c[(x + 4) % 5] ^ rotl(c[(x + 1) % 5], 1);
+            for (unsigned y = 0; y < 25; y += 5) state[y + x] ^= d;
+        }
+
+        // Rho y Pi
+        uint64_t carry = state[1];
+        for (unsigned i = 0; i < 24; ++i) {
+            const unsigned lane = PI_LANES[i];
+            const uint64_t next = state[lane];
+            state[lane] = rotl(carry, ROTATIONS[i]);
+            carry = next;
+        }
+
+        // Chi
+        for (unsigned y = 0; y < 25; y += 5) {
+            for (unsigned x = 0; x < 5; ++x) c[x] = state[y + x];
+            for (unsigned x = 0; x < 5; ++x) state[y + x] = c[x] ^ (~c[(x + 1) % 5] & c[(x + 2) % 5]);
+        }
+
+        // Iota
+        state[0] ^= ROUND_CONSTANTS[round];
+    }
+}
+
+hash_t hash256(const uint8_t* data, size_t size) {
+    uint64_t state[25] = {};
+    for (; size >= RATE; data += RATE, size -= RATE) {
+        absorb(state, data, RATE);
+        permute(state);
+    }
+
+    uint8_t last[RATE] = {};
+    if (size > 0) std::memcpy(last, data, size);
+    last[size] = 0x01;
+    last[RATE - 1] |= 0x80;
+    absorb(state, last, RATE);
+    permute(state);
+
+    hash_t out;
+    std::memcpy(out.data(), state, out.size());
+    return out;
+}
+
+} // namespace zartrux::keccak
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace zartrux::keccak {
+
+using hash_t = std::array<uint8_t, 32>;
+
+/**
+ * Keccak-256 con el relleno original (0x01), el `cn_fast_hash` de Monero: hash de la cabecera
+ * de transacción y del árbol de Merkle de un bloque. No es SHA3-256 (relleno 0x06).
+ */
+hash_t hash256(const uint8_t* data, size_t size);
+
+/// Permutación Keccak-f[1600] sobre el estado de 25 palabras.
+void permute(uint64_t state[25]);
+
+} // namespace zartrux::keccak
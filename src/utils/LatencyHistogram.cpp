@@ -0,0 +1,147 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace zartrux {
+
+namespace {
+
+int64_t steadyNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram(std::chrono::seconds halfLife) :
+    m_halfLifeNs(std::chrono::duration_cast<std::chrono::nanoseconds>(halfLife).count()),
+    m_lastDecayNs(steadyNs())
+{
+}
+
+unsigned LatencyHistogram::bucketIndex(uint64_t us)
+{
+    if (us < SUB_BUCKETS) {
+        return static_cast<unsigned>(us);
+    }
+
+    const unsigned exponent = static_cast<unsigned>(std::bit_width(us)) - 1;
+    if (exponent > MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+    const unsigned sub = static_cast<unsigned>(us >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS * (exponent - SUB_BUCKET_BITS + 1) + sub;
+}
+
+double LatencyHistogram::bucketUpperMs(unsigned index)
+{
+    if (index < SUB_BUCKETS) {
+        return (index + 1) / 1000.0;
+    }
+
+    const unsigned exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const unsigned sub = index % SUB_BUCKETS;
+    const uint64_t width = uint64_t(1) << (exponent - SUB_BUCKET_BITS);
+    return static_cast<double>((uint64_t(1) << exponent) + (sub + 1) * width) / 1000.0;
+}
+
+void LatencyHistogram::record(double ms)
+{
+    decay();
+    const uint64_t us = ms > 0.0 ? static_cast<uint64_t>(std::llround(ms * 1000.0)) : 0;
+    m_counts[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::decay() const
+{
+    const int64_t now = steadyNs();
+    int64_t last = m_lastDecayNs.load(std::memory_order_relaxed);
+    if (now - last < m_halfLifeNs) {
+        return;
+    }
+
+    // Un solo hilo gana el CAS y aplica las mitades pendientes (se limita a 64: todo a cero)
+    const int64_t halvings = std::min<int64_t>((now - last) / m_halfLifeNs, 64);
+    if (!m_lastDecayNs.compare_exchange_strong(last, last + halvings * m_halfLifeNs, std::memory_order_relaxed)) {
+        return;
+    }
+
+    for (auto& counter : m_counts) {
+        const uint64_t value = counter.load(std::memory_order_relaxed);
+        if (value == 0) {
+            continue;
+        }
+        // fetch_sub conserva los incrementos concurrentes
+        const uint64_t kept = halvings >= 64 ? 0 : value >> halvings;
+        counter.fetch_sub(value - kept, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    decay();
+    uint64_t total = 0;
+    for (const auto& counter : m_counts) {
+        total += counter.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double LatencyHistogram::percentile(double quantile) const
+{
+    decay();
+    std::array<uint64_t, BUCKETS> counts;
+    uint64_t total = 0;
+    for (unsigned i = 0; i < BUCKETS; ++i) {
+        counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    return percentileFrom(counts, total, quantile);
+}
+
+double LatencyHistogram::percentileFrom(const std::array<uint64_t, BUCKETS>& counts, uint64_t total, double quantile) const
+{
+    if (total == 0) {
+        return 0.0;
+    }
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total))));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucketUpperMs(i);
+        }
+    }
+    return bucketUpperMs(BUCKETS - 1);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    decay();
+    std::array<uint64_t, BUCKETS> counts;
+    Snapshot result;
+    double weighted = 0.0;
+    for (unsigned i = 0; i < BUCKETS; ++i) {
+        counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        if (counts[i] == 0) {
+            continue;
+        }
+        result.count += counts[i];
+        weighted += counts[i] * bucketUpperMs(i);
+        result.buckets.push_back({bucketUpperMs(i), counts[i]});
+    }
+
+    if (result.count > 0) {
+        result.meanMs = weighted / static_cast<double>(result.count);
+        result.p50Ms = percentileFrom(counts, result.count, 0.50);
+        result.p95Ms = percentileFrom(counts, result.count, 0.95);
+        result.p99Ms = percentileFrom(counts, result.count, 0.99);
+    }
+    return result;
+}
+
+} // namespace zartrux
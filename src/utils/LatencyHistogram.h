@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace zartrux {
+
+/**
+ * Histograma de latencias log-lineal (estilo HDR) sin locks y con olvido exponencial.
+ *
+ * Las muestras se guardan en microsegundos: los valores < 16 µs van en cubos lineales y a partir
+ * de ahí cada potencia de dos se divide en 16 sub-cubos (error relativo <= 6.25 %), hasta ~67 s.
+ * record() es un fetch_add relajado, así que varios hilos pueden registrar y leer a la vez.
+ * Cada `halfLife` los contadores se reducen a la mitad: las muestras antiguas pesan cada vez
+ * menos y los percentiles siguen los cambios de latencia en minutos, no en horas.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_EXPONENT = 26;    // 2^26 µs ≈ 67 s
+    static constexpr unsigned BUCKETS = SUB_BUCKETS * (MAX_EXPONENT - SUB_BUCKET_BITS + 2);
+
+    struct Bucket {
+        double upperMs;
+        uint64_t count;
+    };
+
+    struct Snapshot {
+        uint64_t count = 0;         // peso actual tras el olvido
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        std::vector<Bucket> buckets;    // sólo los cubos no vacíos
+    };
+
+    explicit LatencyHistogram(std::chrono::seconds halfLife = std::chrono::seconds(60));
+
+    void record(double ms);
+
+    /// Percentil en ms (límite superior del cubo); 0 sin muestras.
+    double percentile(double quantile) const;
+    uint64_t count() const;
+    Snapshot snapshot() const;
+
+    /// Aplica las reducciones a la mitad pendientes; la llaman record() y los lectores.
+    void decay() const;
+
+    static unsigned bucketIndex(uint64_t us);
+    static double bucketUpperMs(unsigned index);
+
+private:
+    double percentileFrom(const std::array<uint64_t, BUCKETS>& counts, uint64_t total, double quantile) const;
+
+    mutable std::array<std::atomic<uint64_t>, BUCKETS> m_counts{};
+    const int64_t m_halfLifeNs;
+    mutable std::atomic<int64_t> m_lastDecayNs;
+};
+
+} // namespace zartrux
@@ -33,6 +33,9 @@ void StatusExporter::exportStatus(const MinerStatus& status) {
         j["shares_trend"] = status.shares_trend;
         j["diff_trend"] = status.diff_trend;
         j["mode"] = status.mode;
+        j["hash_ways"] = status.hash_ways;
+        j["hash_ways_mode"] = status.hash_ways_mode;
+        j["way_hashrate"] = status.way_hashrate;
 
         // Historial de hashrate rotativo (máx 120 muestras por defecto)
         std::vector<float> hist = status.hashrate_history;
@@ -26,6 +26,9 @@ struct MinerStatus {
     std::string diff_trend;
     std::vector<float> hashrate_history; // Historial de hashrate para la gráfica
     std::string mode;       // Modo de minería: "Pool", "IA", "Hybrid"
+    unsigned hash_ways = 1;             // VMs entrelazadas por hilo (1, 2 o 4)
+    std::string hash_ways_mode;         // "auto" (benchmark al arrancar) o "manual"
+    std::vector<float> way_hashrate;    // H/s agregado por vía
 };
 
 class StatusExporter {
@@ -66,6 +66,7 @@ template int ConfigManager::get(const std::string&, int) const;
 template double ConfigManager::get(const std::string&, double) const;
 template bool ConfigManager::get(const std::string&, bool) const;
 template std::string ConfigManager::get(const std::string&, std::string) const;
+template nlohmann::json ConfigManager::get(const std::string&, nlohmann::json) const;
 
 template void ConfigManager::set(const std::string&, int);
 template void ConfigManager::set(const std::string&, double);
@@ -5,18 +5,30 @@
 #include <filesystem>
 #include <atomic>
 #include <csignal>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string_view>
 #include <nlohmann/json.hpp>
 #include <fmt/format.h>
 
 #include "utils/Logger.h"
 #include "core/MinerCore.h"
+#include "core/Benchmark.h"
 #include "core/JobManager.h"
 #include "core/NonceValidator.h"
+#include "core/PoolDispatcher.h"
+#include "network/DaemonClient.h"
 #include "network/PoolDispatcher.h"
+#include "network/PoolFailover.h"
+#include "network/StratumProxy.h"
 #include "metrics/PrometheusExporter.h"
 #include "utils/ConfigManager.h"
+#include "utils/Hex.h"
+#include "utils/LatencyHistogram.h"
 #include "utils/Profiler.h"
 #include "utils/StatusExporter.h"
+#include "runtime/JitSymbols.h"
 
 using json = nlohmann::json;
 using namespace std::chrono;
@@ -27,6 +39,7 @@ std::atomic<bool> g_running = true;
 std::unique_ptr<MinerCore> g_miner;
 std::unique_ptr<JobManager> g_jobManager;
 std::unique_ptr<PoolDispatcher> g_poolDispatcher;
+std::unique_ptr<zartrux::network::DaemonClient> g_daemonClient;
 std::shared_ptr<ConfigManager> g_config;
 
 // Estructura para estado del minero
@@ -67,6 +80,264 @@ void signalHandler(int signum) {
     g_running = false;
 }
 
+// Configuración del minero a partir de config.json (también la usa el benchmark)
+MinerCore::MiningConfig loadMiningConfig() {
+    MinerCore::MiningConfig minerConfig;
+    minerConfig.threadCount = g_config->get<unsigned>("threads", std::thread::hardware_concurrency());
+    minerConfig.mode = g_config->get<std::string>("mining_mode", "normal");
+    // Pools NiceHash: el pool fija el byte alto del nonce y los hilos sólo recorren el resto
+    minerConfig.niceHash = g_config->get<bool>("nicehash", false);
+    // Directorio del almacén de cache/dataset por semilla (vacío = desactivado)
+    minerConfig.randomx.storeDirectory = g_config->get<std::string>("randomx_store_dir", "");
+    // Init del dataset con JIT AVX2: -1 = según CPU, 0 = no, 1 = sí
+    minerConfig.randomx.optimizedDatasetInit = g_config->get<int>("randomx_init_avx2", -1);
+    // Buffer JIT de doble mapeo RW/RX (ninguna vista W+X). Es endurecimiento, no una mejora de
+    // velocidad: reescribir código recién ejecutado por el alias cuesta lo mismo que con RWX
+    minerConfig.randomx.jitDualMapping = g_config->get<bool>("randomx_jit_dual_map", false);
+    // Modo de memoria: "auto" (planificador), "full" (dataset) o "light" (sólo cache)
+    const std::string memoryMode = g_config->get<std::string>("randomx_mode", "auto");
+    minerConfig.memoryMode = memoryMode == "full"  ? MinerCore::MemoryMode::Full
+                           : memoryMode == "light" ? MinerCore::MemoryMode::Light
+                                                   : MinerCore::MemoryMode::Auto;
+    minerConfig.memoryReserveMB = g_config->get<size_t>("memory_reserve_mb", 256);
+    return minerConfig;
+}
+
+// Símbolos del código JIT para perf (perf_map / perf_jitdump); antes de crear las VMs
+void configureJitSymbols() {
+    zartrux::runtime::JitSymbols::Options symbols;
+    symbols.perfMap = g_config->get<bool>("perf_map", false);
+    symbols.jitdump = g_config->get<bool>("perf_jitdump", false);
+    symbols.programsPerSecond = g_config->get<unsigned>("perf_programs_per_sec", 10);
+    if (symbols.perfMap || symbols.jitdump) {
+        zartrux::runtime::JitSymbols::configure(symbols);
+    }
+}
+
+// Benchmark offline (--bench=N): sin pool, métricas ni estado persistente
+int runBenchmark(const Benchmark::Options& options) {
+    g_config = std::make_shared<ConfigManager>("config.json");
+    if (!g_config->load()) {
+        Logger::warn("Main", "Sin config.json: el benchmark usa la configuración por defecto");
+    }
+    configureJitSymbols();
+    Benchmark benchmark(options, loadMiningConfig());
+    const int result = benchmark.run();
+    zartrux::runtime::JitSymbols::shutdown();
+    return result;
+}
+
+// Latencias: percentiles en µs para Prometheus y el histograma completo en el JSON de estado
+uint64_t toMicros(double ms) {
+    return static_cast<uint64_t>(ms * 1000.0);
+}
+
+json histogramJson(const zartrux::LatencyHistogram::Snapshot& s) {
+    json buckets = json::array();
+    for (const auto& b : s.buckets) buckets.push_back({{"le_ms", b.upperMs}, {"count", b.count}});
+    return {{"count", s.count}, {"mean_ms", s.meanMs}, {"p50_ms", s.p50Ms},
+            {"p95_ms", s.p95Ms}, {"p99_ms", s.p99Ms}, {"buckets", buckets}};
+}
+
+// Tiempo de hashing perdido en cada cambio de pool: del fallo al primer trabajo de la nueva
+void exportFailoverMetrics(const PoolFailover& failover) {
+    const auto stats = failover.getFailoverStats();
+    PrometheusExporter::instance().record({
+        {"pool_failovers", stats.failovers},
+        {"pool_hot_promotions", stats.hotPromotions},
+        {"pool_failover_lost_last_us", toMicros(stats.lastLostMs)},
+        {"pool_failover_lost_total_us", toMicros(stats.totalLostMs)},
+        {"pool_failover_lost_p50_us", toMicros(stats.lost.p50Ms)},
+        {"pool_failover_lost_p95_us", toMicros(stats.lost.p95Ms)},
+        {"pool_failover_lost_p99_us", toMicros(stats.lost.p99Ms)}
+    });
+    StatusExporter::instance().exportJSON({
+        {"pool_failover", {
+            {"failovers", stats.failovers},
+            {"hot_promotions", stats.hotPromotions},
+            {"last_lost_ms", stats.lastLostMs},
+            {"total_lost_ms", stats.totalLostMs},
+            {"lost", histogramJson(stats.lost)}
+        }}
+    });
+}
+
+// Submits de la conexión actual con la pool: ida y vuelta y resultados por antigüedad del trabajo
+void exportSubmitMetrics(const StratumClient::SubmitStats& stats) {
+    static constexpr const char* OUTCOME_NAMES[StratumClient::OUTCOMES] = {"accepted", "rejected", "stale", "timed_out"};
+    static constexpr const char* AGE_NAMES[StratumClient::JOB_AGE_BUCKETS] = {"lt_5s", "lt_30s", "lt_2m", "ge_2m"};
+
+    std::map<std::string, uint64_t> metrics{
+        {"stratum_submits_sent", stats.sent},
+        {"stratum_submits_accepted", stats.accepted},
+        {"stratum_submits_rejected", stats.rejected},
+        {"stratum_submits_stale", stats.stale},
+        {"stratum_submits_timed_out", stats.timedOut},
+        {"stratum_submits_in_flight", stats.inFlight},
+        {"stratum_submit_rtt_p50_us", toMicros(stats.rtt.p50Ms)},
+        {"stratum_submit_rtt_p95_us", toMicros(stats.rtt.p95Ms)},
+        {"stratum_submit_rtt_p99_us", toMicros(stats.rtt.p99Ms)}
+    };
+    json byJobAge = json::object();
+    for (size_t age = 0; age < StratumClient::JOB_AGE_BUCKETS; ++age) {
+        json outcomes = json::object();
+        for (size_t outcome = 0; outcome < StratumClient::OUTCOMES; ++outcome) {
+            const uint64_t count = stats.byJobAge[age][outcome];
+            metrics[fmt::format("stratum_submits_{}_age_{}", OUTCOME_NAMES[outcome], AGE_NAMES[age])] = count;
+            outcomes[OUTCOME_NAMES[outcome]] = count;
+        }
+        byJobAge[AGE_NAMES[age]] = outcomes;
+    }
+    PrometheusExporter::instance().record(metrics);
+    StatusExporter::instance().exportJSON({
+        {"stratum_submit", {
+            {"sent", stats.sent},
+            {"accepted", stats.accepted},
+            {"rejected", stats.rejected},
+            {"stale", stats.stale},
+            {"timed_out", stats.timedOut},
+            {"in_flight", stats.inFlight},
+            {"rtt", histogramJson(stats.rtt)},
+            {"by_job_age", byJobAge}
+        }}
+    });
+}
+
+// Minería en solitario: retraso del trabajo tras un bloque nuevo y tiempo minando plantillas superadas
+void exportSoloMetrics(const zartrux::network::DaemonClient::Stats& stats) {
+    PrometheusExporter::instance().record({
+        {"solo_templates", stats.templates},
+        {"solo_new_blocks", stats.newBlocks},
+        {"solo_zmq_notifications", stats.zmqNotifications},
+        {"solo_zmq_connected", stats.zmqConnected ? 1u : 0u},
+        {"solo_blocks_found", stats.blocksFound},
+        {"solo_blocks_accepted", stats.blocksAccepted},
+        {"solo_blocks_rejected", stats.blocksRejected},
+        {"solo_stale_solutions", stats.staleSolutions},
+        {"solo_rpc_errors", stats.rpcErrors},
+        {"solo_height", stats.height},
+        {"solo_difficulty", stats.difficulty},
+        {"solo_wasted_us", toMicros(stats.staleMs)},
+        {"solo_wasted_ppm", static_cast<uint64_t>(stats.staleFraction * 1e6)},
+        {"solo_refresh_p50_us", toMicros(stats.refresh.p50Ms)},
+        {"solo_refresh_p95_us", toMicros(stats.refresh.p95Ms)},
+        {"solo_refresh_p99_us", toMicros(stats.refresh.p99Ms)},
+        {"solo_rpc_p95_us", toMicros(stats.rpc.p95Ms)}
+    });
+    StatusExporter::instance().exportJSON({
+        {"solo", {
+            {"templates", stats.templates},
+            {"new_blocks", stats.newBlocks},
+            {"zmq_connected", stats.zmqConnected},
+            {"zmq_notifications", stats.zmqNotifications},
+            {"blocks_found", stats.blocksFound},
+            {"blocks_accepted", stats.blocksAccepted},
+            {"blocks_rejected", stats.blocksRejected},
+            {"stale_solutions", stats.staleSolutions},
+            {"rpc_errors", stats.rpcErrors},
+            {"height", stats.height},
+            {"difficulty", stats.difficulty},
+            {"wasted_ms", stats.staleMs},
+            {"wasted_fraction", stats.staleFraction},
+            {"refresh", histogramJson(stats.refresh)},
+            {"rpc", histogramJson(stats.rpc)}
+        }}
+    });
+}
+
+// Minería en solitario: plantillas del nodo (solo_daemon) y bloques enviados con submit_block.
+// El destino de las soluciones se fija antes de que arranquen los workers.
+void configureSoloMining() {
+    zartrux::network::DaemonClient::Options options;
+    options.url = g_config->get<std::string>("solo_daemon", "");
+    options.wallet = g_config->get<std::string>("solo_wallet", "");
+    options.user = g_config->get<std::string>("solo_rpc_user", "");
+    options.pass = g_config->get<std::string>("solo_rpc_pass", "");
+    options.zmqEndpoint = g_config->get<std::string>("solo_zmq", "");
+    options.pollInterval = milliseconds(g_config->get<int>("solo_poll_ms", 500));
+    options.templateRefresh = seconds(g_config->get<int>("solo_refresh_s", 30));
+    options.instanceId = g_config->get<unsigned>("solo_instance_id", 0);
+
+    g_daemonClient = std::make_unique<zartrux::network::DaemonClient>(*g_jobManager, std::move(options));
+    g_jobManager->setSolutionHandler([](const JobManager::Job& job, uint64_t nonce, const NonceValidator::hash_t&) {
+        g_daemonClient->submit(job.jobId, nonce);
+    });
+}
+
+// Minería con pool: cada solución válida se encola en el dispatcher, que la envía desde su
+// hilo de E/S. Si la cola está llena o el dispatcher se ha detenido la share se pierde.
+void configurePoolSubmission() {
+    g_jobManager->setSolutionHandler([](const JobManager::Job& job, uint64_t nonce, const NonceValidator::hash_t& hash) {
+        const std::string resultHash = zartrux::hex::encode(hash.data(), hash.size());
+        if (!zartrux::dispatcher::PoolDispatcher::instance().dispatchValidNonce(job.jobId, nonce, resultHash)) {
+            Logger::warn("Main", fmt::format("Share descartada por el dispatcher (job {}, nonce {})", job.jobId, nonce));
+        }
+    });
+}
+
+// Modo proxy (--proxy): una sesión con la pool para todos los rigs, sin minar en este proceso
+int runProxy() {
+    g_config = std::make_shared<ConfigManager>("config.json");
+    if (!g_config->load()) {
+        Logger::error("Main", "Error al cargar configuración");
+        return 1;
+    }
+
+    std::vector<PoolFailover::PoolInfo> pools;
+    for (const auto& pool : g_config->get<json>("pools", json::array())) {
+        pools.push_back({pool.value("host", ""), pool.value("port", uint16_t{3333}),
+                         pool.value("user", ""), pool.value("pass", "x")});
+    }
+    if (pools.empty()) {
+        Logger::error("Main", "El modo proxy necesita al menos una pool en \"pools\"");
+        return 1;
+    }
+
+    // Un solo hilo para la sesión con la pool y todas las conexiones de los rigs
+    asio::io_context io;
+    PoolFailover upstream(io, std::move(pools));
+    PoolFailover::StandbyConfig standby;
+    standby.enabled = g_config->get<bool>("proxy_hot_standby", false);
+    upstream.setHotStandby(standby);
+
+    zartrux::network::StratumProxy::Options options;
+    options.bindAddress = g_config->get<std::string>("proxy_bind", "0.0.0.0");
+    options.port = static_cast<uint16_t>(g_config->get<int>("proxy_port", 3333));
+    options.maxConnections = static_cast<size_t>(
+        g_config->get<int>("proxy_max_rigs", static_cast<int>(zartrux::network::StratumProxy::MAX_SLOTS)));
+    zartrux::network::StratumProxy proxy(io, upstream, options);
+
+    // Métricas de la sesión con la pool, en el mismo hilo que la atiende
+    PrometheusExporter::getInstance().initialize(g_config->get<uint16_t>("metrics_port", 9100));
+    asio::steady_timer metricsTimer(io);
+    std::function<void()> scheduleMetrics = [&] {
+        metricsTimer.expires_after(seconds(1));
+        metricsTimer.async_wait([&](const boost::system::error_code& ec) {
+            if (ec) return;
+            exportFailoverMetrics(upstream);
+            exportSubmitMetrics(upstream.getSubmitStats());
+            PrometheusExporter::getInstance().update();
+            scheduleMetrics();
+        });
+    };
+
+    asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code&, int) {
+        Logger::info("Main", "Deteniendo proxy");
+        metricsTimer.cancel();
+        proxy.stop();
+        upstream.stop();
+        io.stop();
+    });
+
+    proxy.start();
+    upstream.start();
+    scheduleMetrics();
+    io.run();
+    PrometheusExporter::getInstance().shutdown();
+    return 0;
+}
+
 // Inicialización
 bool initialize() {
     try {
@@ -81,20 +352,29 @@ bool initialize() {
             return false;
         }
 
+        configureJitSymbols();
+
         // Inicializar componentes principales
         g_jobManager = std::make_unique<JobManager>();
         g_poolDispatcher = std::make_unique<PoolDispatcher>(*g_jobManager);
+        if (g_config->get<std::string>("mining_mode", "normal") == "solo" &&
+            !g_config->get<std::string>("solo_daemon", "").empty()) {
+            configureSoloMining();
+        } else {
+            configurePoolSubmission();
+        }
 
         // Configurar minero
-        MinerCore::MiningConfig minerConfig;
-        minerConfig.threadCount = g_config->get<unsigned>("threads", std::thread::hardware_concurrency());
-        minerConfig.mode = g_config->get<std::string>("mining_mode", "normal");
+        MinerCore::MiningConfig minerConfig = loadMiningConfig();
         g_miner = std::make_unique<MinerCore>(g_jobManager, minerConfig.threadCount);
 
         if (!g_miner->initialize(minerConfig)) {
             Logger::error("Main", "Error al inicializar minero");
             return false;
         }
+        if (g_daemonClient) {
+            g_daemonClient->start();
+        }
 
         // Configurar métricas
         PrometheusExporter::getInstance().initialize(
@@ -151,6 +431,9 @@ void mainLoop() {
             // Actualizar métricas
             if (now >= nextMetricsUpdate) {
                 updateMetrics();
+                if (g_daemonClient) {
+                    exportSoloMetrics(g_daemonClient->getStats());
+                }
                 nextMetricsUpdate = now + milliseconds(1000);
                 PrometheusExporter::getInstance().update();
             }
@@ -195,7 +478,12 @@ void cleanup() {
             stateFile << status.toJson().dump(4);
         }
 
+        if (g_daemonClient) {
+            g_daemonClient->stop();
+        }
+
         PrometheusExporter::getInstance().shutdown();
+        zartrux::runtime::JitSymbols::shutdown();
         Logger::info("Main", "Limpieza completada");
     }
     catch (const std::exception& e) {
@@ -209,6 +497,13 @@ int main(int argc, char* argv[]) {
         Logger::init("zartrux-miner.log", Logger::Level::Debug);
         Logger::info("Main", "Iniciando zartrux-miner v1.0.0");
 
+        if (const auto bench = Benchmark::parseArguments(argc, argv)) {
+            return runBenchmark(*bench);
+        }
+        if (std::find_if(argv + 1, argv + argc, [](const char* arg) { return std::string_view(arg) == "--proxy"; }) != argv + argc) {
+            return runProxy();
+        }
+
         // Inicializar componentes
         if (!initialize()) {
             Logger::error("Main", "Fallo en la inicialización");